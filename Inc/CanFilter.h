@@ -0,0 +1,358 @@
+/* =====================================================================================================================
+ *  File        : CanFilter.h
+ *  Layer       : Shared
+ *  Purpose     : O(1) software acceptance filter for CanIf RX, built once from a list of CAN_IdType + mask
+ *                 - Standard IDs : 2048-bit bitmap + per-word rank + dense handle table
+ *                                  (handle index = rank of the ID among accepted IDs, popcount based).
+ *                 - Extended IDs : exact IDs in a hash-and-displace perfect hash (two multiplies, one compare),
+ *                                  masked extended entries in a short list checked after a hash miss.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : First matching configuration entry wins for standard IDs. For extended IDs an exact entry wins
+ *                over a masked one, masked ones are tried in configuration order.
+ * ===================================================================================================================*/
+
+#ifndef CANFILTER_H_
+#define CANFILTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CAN_FILTER_AR_MAJOR_VERSION		(1u)
+#define CAN_FILTER_AR_MINOR_VERSION		(0u)
+#define CAN_FILTER_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity (RAM of CanFilter_Type ~ 384 + 2 * MAX_STD + 6 * EXT_SLOTS + EXT_SLOTS / 4 + 10 * EXT_MASKED bytes)
+ *  - CAN_FILTER_MAX_STD    : accepted standard IDs, after mask expansion.
+ *  - CAN_FILTER_EXT_SLOTS  : perfect hash slots, power of 2, >= 2 * exact extended IDs.
+ *  - CAN_FILTER_EXT_MASKED : masked extended entries.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef CAN_FILTER_MAX_STD
+#define CAN_FILTER_MAX_STD			(128u)
+#endif
+
+#ifndef CAN_FILTER_EXT_SLOTS_BITS
+#define CAN_FILTER_EXT_SLOTS_BITS	(6u)
+#endif
+
+#ifndef CAN_FILTER_EXT_MASKED
+#define CAN_FILTER_EXT_MASKED		(4u)
+#endif
+
+#define CAN_FILTER_EXT_SLOTS		(1u << CAN_FILTER_EXT_SLOTS_BITS)
+#define CAN_FILTER_EXT_BUCKETS_BITS	(CAN_FILTER_EXT_SLOTS_BITS - 2u)
+#define CAN_FILTER_EXT_BUCKETS		(1u << CAN_FILTER_EXT_BUCKETS_BITS)
+#define CAN_FILTER_STD_WORDS		((CAN_STD_ID_MASK + 1u) / 32u)
+#define CAN_FILTER_BUCKET_MAX_KEYS	(16u)		/* Build fails if more exact IDs hash into one bucket.*/
+
+#define CAN_FILTER_REJECT			((PduIdType)0xFFFFu)
+#define CAN_FILTER_MASK_EXACT		(0xFFFFFFFFu)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Configuration entry
+ *  - Id   : CAN_MAKE_STD_ID()/CAN_MAKE_EXT_ID().
+ *  - Mask : raw ID bits that must match (CAN_FILTER_MASK_EXACT = single ID).
+ *  - Handle: value returned by CanFilter_Lookup (e.g. CanIf RX PduIdType).
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	CAN_IdType	Id;
+	uint32_t	Mask;
+	PduIdType	Handle;
+}CanFilter_EntryType;
+
+typedef struct
+{
+	uint32_t	StdBitmap[CAN_FILTER_STD_WORDS];				/* Bit set = standard ID accepted.*/
+	uint16_t	StdRank[CAN_FILTER_STD_WORDS];					/* Accepted IDs before word w.*/
+	PduIdType	StdHandle[CAN_FILTER_MAX_STD];					/* Handle per accepted ID, rank order.*/
+	CAN_IdType	ExtKey[CAN_FILTER_EXT_SLOTS];					/* IDE flag | raw ID, 0 = empty slot.*/
+	PduIdType	ExtHandle[CAN_FILTER_EXT_SLOTS];
+	uint8_t		ExtDisp[CAN_FILTER_EXT_BUCKETS];				/* Displacement per bucket.*/
+	uint32_t	ExtMaskedId[CAN_FILTER_EXT_MASKED];				/* Raw ID & mask.*/
+	uint32_t	ExtMaskedMask[CAN_FILTER_EXT_MASKED];
+	PduIdType	ExtMaskedHandle[CAN_FILTER_EXT_MASKED];
+	uint8_t		ExtMaskedCount;
+}CanFilter_Type;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helpers: popcount (no instruction on Cortex-M3) and hashes
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint32_t CanFilter_PopCount32(uint32_t v)
+{
+	v = v - ((v >> 1) & 0x55555555u);
+	v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+	v = (v + (v >> 4)) & 0x0F0F0F0Fu;
+	return (v * 0x01010101u) >> 24;
+}
+
+static inline uint32_t CanFilter_ExtBucket(uint32_t raw)
+{
+	return (uint32_t)(raw * 0x9E3779B1u) >> (32u - CAN_FILTER_EXT_BUCKETS_BITS);
+}
+
+static inline uint32_t CanFilter_ExtSlot(uint32_t raw, uint8_t disp)
+{
+	return (uint32_t)((raw ^ ((uint32_t)disp * 0x85EBCA6Bu)) * 0xC2B2AE35u) >> (32u - CAN_FILTER_EXT_SLOTS_BITS);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Lookup: CAN ID -> handle, CAN_FILTER_REJECT if not accepted. O(1), no loop over the configuration.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline PduIdType CanFilter_Lookup(const CanFilter_Type* filter, CAN_IdType id)
+{
+	uint32_t raw = CAN_ID_GET_RAW(id);
+	uint32_t word;
+	uint32_t bit;
+	uint32_t slot;
+	uint8_t i;
+
+	if (!CAN_ID_IS_EXT(id))
+	{
+		word = filter->StdBitmap[raw >> 5];
+		bit = 1u << (raw & 31u);
+		if ((word & bit) == 0u)
+		{
+			return CAN_FILTER_REJECT;
+		}
+		return filter->StdHandle[filter->StdRank[raw >> 5] + CanFilter_PopCount32(word & (bit - 1u))];
+	}
+
+	slot = CanFilter_ExtSlot(raw, filter->ExtDisp[CanFilter_ExtBucket(raw)]);
+	if (filter->ExtKey[slot] == (raw | CAN_ID_FLAG_IDE))
+	{
+		return filter->ExtHandle[slot];
+	}
+
+	for (i = 0u; i < filter->ExtMaskedCount; i++)
+	{
+		if ((raw & filter->ExtMaskedMask[i]) == filter->ExtMaskedId[i])
+		{
+			return filter->ExtMaskedHandle[i];
+		}
+	}
+	return CAN_FILTER_REJECT;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Build internals
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool CanFilter_IsExtExact(const CanFilter_EntryType* e)
+{
+	return ((e->Mask & CAN_EXT_ID_MASK) == CAN_EXT_ID_MASK);
+}
+
+/* Standard part: bitmap of every ID matched by an entry, then handles in rank order (first entry wins). */
+static inline Std_ReturnType CanFilter_BuildStd(CanFilter_Type* filter, const CanFilter_EntryType* cfg, uint16_t count)
+{
+	uint32_t total = 0u;
+	uint32_t raw;
+	uint32_t mask;
+	uint32_t v;
+	uint32_t w;
+	uint32_t idx;
+	uint16_t e;
+
+	for (e = 0u; e < count; e++)
+	{
+		if (CAN_ID_IS_EXT(cfg[e].Id))
+		{
+			continue;
+		}
+		mask = cfg[e].Mask & CAN_STD_ID_MASK;
+		raw = CAN_ID_GET_RAW(cfg[e].Id) & mask;
+		for (v = raw; v <= CAN_STD_ID_MASK; v++)
+		{
+			if ((v & mask) == raw)
+			{
+				filter->StdBitmap[v >> 5] |= 1u << (v & 31u);
+			}
+			if (mask == CAN_STD_ID_MASK)
+			{
+				break;			/* Exact ID: one bit only. */
+			}
+		}
+	}
+
+	for (w = 0u; w < CAN_FILTER_STD_WORDS; w++)
+	{
+		filter->StdRank[w] = (uint16_t)total;
+		total += CanFilter_PopCount32(filter->StdBitmap[w]);
+	}
+	if (total > CAN_FILTER_MAX_STD)
+	{
+		return E_NOT_OK;
+	}
+
+	for (idx = 0u; idx < total; idx++)
+	{
+		filter->StdHandle[idx] = CAN_FILTER_REJECT;
+	}
+
+	for (e = 0u; e < count; e++)
+	{
+		if (CAN_ID_IS_EXT(cfg[e].Id))
+		{
+			continue;
+		}
+		mask = cfg[e].Mask & CAN_STD_ID_MASK;
+		raw = CAN_ID_GET_RAW(cfg[e].Id) & mask;
+		for (v = raw; v <= CAN_STD_ID_MASK; v++)
+		{
+			if ((v & mask) == raw)
+			{
+				w = filter->StdBitmap[v >> 5];
+				idx = filter->StdRank[v >> 5] + CanFilter_PopCount32(w & ((1u << (v & 31u)) - 1u));
+				if (filter->StdHandle[idx] == CAN_FILTER_REJECT)
+				{
+					filter->StdHandle[idx] = cfg[e].Handle;
+				}
+			}
+			if (mask == CAN_STD_ID_MASK)
+			{
+				break;
+			}
+		}
+	}
+	return E_OK;
+}
+
+/* Extended part: place the exact IDs of each bucket with the first displacement that finds free slots. */
+static inline Std_ReturnType CanFilter_BuildExt(CanFilter_Type* filter, const CanFilter_EntryType* cfg, uint16_t count)
+{
+	uint16_t keys[CAN_FILTER_BUCKET_MAX_KEYS];
+	uint32_t slots[CAN_FILTER_BUCKET_MAX_KEYS];
+	uint32_t size;
+	uint32_t b;
+	uint32_t raw;
+	uint16_t nKeys;
+	uint16_t e;
+	uint16_t k;
+	uint16_t j;
+	uint16_t d;
+	bool ok;
+
+	for (e = 0u; e < count; e++)
+	{
+		if (CAN_ID_IS_EXT(cfg[e].Id) && !CanFilter_IsExtExact(&cfg[e]))
+		{
+			if (filter->ExtMaskedCount >= CAN_FILTER_EXT_MASKED)
+			{
+				return E_NOT_OK;
+			}
+			filter->ExtMaskedMask[filter->ExtMaskedCount] = cfg[e].Mask & CAN_EXT_ID_MASK;
+			filter->ExtMaskedId[filter->ExtMaskedCount] = CAN_ID_GET_RAW(cfg[e].Id) & cfg[e].Mask;
+			filter->ExtMaskedHandle[filter->ExtMaskedCount] = cfg[e].Handle;
+			filter->ExtMaskedCount++;
+		}
+	}
+
+	/* Biggest buckets first: they are the hardest to place. */
+	for (size = CAN_FILTER_BUCKET_MAX_KEYS; size > 0u; size--)
+	{
+		for (b = 0u; b < CAN_FILTER_EXT_BUCKETS; b++)
+		{
+			nKeys = 0u;
+			for (e = 0u; e < count; e++)
+			{
+				if (!CAN_ID_IS_EXT(cfg[e].Id) || !CanFilter_IsExtExact(&cfg[e]) ||
+					(CanFilter_ExtBucket(CAN_ID_GET_RAW(cfg[e].Id)) != b))
+				{
+					continue;
+				}
+				for (k = 0u; (k < nKeys) && (cfg[keys[k]].Id != cfg[e].Id); k++)
+				{
+				}
+				if (k < nKeys)
+				{
+					continue;		/* Duplicate ID: first entry wins. */
+				}
+				if (nKeys == CAN_FILTER_BUCKET_MAX_KEYS)
+				{
+					return E_NOT_OK;
+				}
+				keys[nKeys++] = e;
+			}
+			if (nKeys != size)
+			{
+				continue;
+			}
+
+			for (d = 0u; d <= 0xFFu; d++)
+			{
+				ok = true;
+				for (k = 0u; (k < nKeys) && ok; k++)
+				{
+					raw = CAN_ID_GET_RAW(cfg[keys[k]].Id);
+					slots[k] = CanFilter_ExtSlot(raw, (uint8_t)d);
+					ok = (filter->ExtKey[slots[k]] == 0u);
+					for (j = 0u; (j < k) && ok; j++)
+					{
+						ok = (slots[j] != slots[k]);
+					}
+				}
+				if (ok)
+				{
+					break;
+				}
+			}
+			if (d > 0xFFu)
+			{
+				return E_NOT_OK;		/* Table too dense: raise CAN_FILTER_EXT_SLOTS_BITS. */
+			}
+
+			filter->ExtDisp[b] = (uint8_t)d;
+			for (k = 0u; k < nKeys; k++)
+			{
+				filter->ExtKey[slots[k]] = CAN_ID_GET_RAW(cfg[keys[k]].Id) | CAN_ID_FLAG_IDE;
+				filter->ExtHandle[slots[k]] = cfg[keys[k]].Handle;
+			}
+		}
+	}
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Build the classifier from the configuration (init time, not ISR).
+ *  - return E_NOT_OK if the configuration does not fit the CAN_FILTER_* capacities.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType CanFilter_Build(CanFilter_Type* filter, const CanFilter_EntryType* cfg, uint16_t count)
+{
+	uint32_t i;
+
+	for (i = 0u; i < CAN_FILTER_STD_WORDS; i++)
+	{
+		filter->StdBitmap[i] = 0u;
+		filter->StdRank[i] = 0u;
+	}
+	for (i = 0u; i < CAN_FILTER_EXT_SLOTS; i++)
+	{
+		filter->ExtKey[i] = 0u;
+		filter->ExtHandle[i] = CAN_FILTER_REJECT;
+	}
+	for (i = 0u; i < CAN_FILTER_EXT_BUCKETS; i++)
+	{
+		filter->ExtDisp[i] = 0u;
+	}
+	filter->ExtMaskedCount = 0u;
+
+	if (CanFilter_BuildStd(filter, cfg, count) != E_OK)
+	{
+		return E_NOT_OK;
+	}
+	return CanFilter_BuildExt(filter, cfg, count);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANFILTER_H_ */
@@ -0,0 +1,780 @@
+/* =====================================================================================================================
+ *  File        : CanTp.h
+ *  Layer       : Services
+ *  Purpose     : Streaming ISO 15765-2 style transport protocol over 8-byte CAN frames (normal addressing)
+ *                 - Segmented transfers up to CANTP_MAX_LENGTH (4095) bytes: SF / FF / CF / FC.
+ *                 - Zero staging: every frame is filled straight from the upper layer buffer (CopyTxData) and
+ *                   drained straight into it (CopyRxData); only one 8-byte CAN frame lives in the connection.
+ *                 - Flow control: block size and STmin on both sides, FC WAIT while the receiver buffer is full.
+ *                 - Failed CAN transmissions are retried with RetryInfoType (TP_DATARETRY + TxTpDataCnt), so the
+ *                   upper layer rewinds its own buffer instead of CanTp keeping a copy.
+ *                 - Timeouts N_As / N_Ar / N_Bs / N_Cs / N_Cr reported with NotifResultType.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : One CanTp_ConnType per connection (~72 bytes on Cortex-M3, CANTP_CONN_RAM_BYTES), full duplex.
+ *                The lower layer accepts one frame at a time per connection: CanTp waits for the TX confirmation
+ *                of a frame before the next one, FC frames of the receive side included.
+ *                RxIndication / TxConfirmation / Transmit / MainFunction of one connection from one context.
+ * ===================================================================================================================*/
+
+#ifndef CANTP_H_
+#define CANTP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CANTP_AR_MAJOR_VERSION		(1u)
+#define CANTP_AR_MINOR_VERSION		(0u)
+#define CANTP_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Protocol constants
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CANTP_FRAME_SIZE		(8u)
+#define CANTP_MAX_LENGTH		(4095u)			/* 12-bit FF_DL.*/
+#define CANTP_SF_MAX_DATA		(7u)
+#define CANTP_FF_DATA			(6u)
+#define CANTP_CF_MAX_DATA		(7u)
+
+#define CANTP_PCI_SF			(0x00u)
+#define CANTP_PCI_FF			(0x10u)
+#define CANTP_PCI_CF			(0x20u)
+#define CANTP_PCI_FC			(0x30u)
+
+#define CANTP_FS_CTS			(0u)
+#define CANTP_FS_WAIT			(1u)
+#define CANTP_FS_OVFLW			(2u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Limits
+ *  - CANTP_MAX_RETRY : CAN transmit attempts of one frame before the transfer is aborted.
+ *  - CANTP_MAX_WFT   : consecutive FC WAIT sent by the receiver before it gives up.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef CANTP_MAX_RETRY
+#define CANTP_MAX_RETRY			(3u)
+#endif
+
+#ifndef CANTP_MAX_WFT
+#define CANTP_MAX_WFT			(8u)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Connection configuration
+ *  - Upper layer (PduR / Dcm) callbacks follow the AUTOSAR TP API, id = UpperPduId.
+ *    CopyTxData      : copy info->SduLength bytes into info->SduDataPtr. retry->TpDataState == TP_DATARETRY asks
+ *                      to go back retry->TxTpDataCnt bytes first (the previous frame was not sent).
+ *    StartOfReception: a transfer of tpSduLength bytes starts, *bufferSize = free space of the receive buffer.
+ *    CopyRxData      : copy info->SduLength bytes out of info->SduDataPtr (SduLength 0 = only query space).
+ *  - Lower layer (CanIf): Transmit one CAN frame on TxPduId, CanTp_TxConfirmation() when it is on the bus.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	BufReq_ReturnType	(*CopyTxData)(PduIdType id, const PduInfoType* info, const RetryInfoType* retry,
+									  PduLengthType* availableData);
+	BufReq_ReturnType	(*StartOfReception)(PduIdType id, const PduInfoType* info, PduLengthType tpSduLength,
+											PduLengthType* bufferSize);
+	BufReq_ReturnType	(*CopyRxData)(PduIdType id, const PduInfoType* info, PduLengthType* bufferSize);
+	void				(*RxIndication)(PduIdType id, NotifResultType result);
+	void				(*TxConfirmation)(PduIdType id, NotifResultType result);
+	Std_ReturnType		(*CanTransmit)(PduIdType txPduId, const PduInfoType* info);
+
+	PduIdType			UpperPduId;
+	PduIdType			TxPduId;
+	uint8_t				BlockSize;		/* BS sent in our FC, 0 = no further FC.*/
+	uint8_t				STmin;			/* STmin sent in our FC (ISO encoding).*/
+	uint8_t				Padding;		/* Unused bytes of every frame.*/
+	uint16_t			NasMs;			/* Frame TX confirmation timeout.*/
+	uint16_t			NbsMs;			/* Sender: FC timeout.*/
+	uint16_t			NcsMs;			/* Sender: upper layer data timeout.*/
+	uint16_t			NcrMs;			/* Receiver: CF timeout.*/
+	uint16_t			NbrMs;			/* Receiver: period of FC WAIT while the buffer is full.*/
+	uint16_t			NarMs;			/* Receiver: FC TX confirmation timeout.*/
+}CanTp_ConfigType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Connection state
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	CANTP_TX_IDLE = 0,
+	CANTP_TX_SEND,				/* Next frame to build and send (main function retries when busy).*/
+	CANTP_TX_WAIT_CONF,			/* Frame handed to CanIf.*/
+	CANTP_TX_WAIT_FC,
+	CANTP_TX_WAIT_STMIN
+}CanTp_TxStateType;
+
+typedef enum
+{
+	CANTP_RX_IDLE = 0,
+	CANTP_RX_WAIT_CF,
+	CANTP_RX_WAIT_BUF			/* FC WAIT sent, polling the upper layer for space.*/
+}CanTp_RxStateType;
+
+typedef enum
+{
+	CANTP_LOWER_IDLE = 0,
+	CANTP_LOWER_DATA,			/* SF/FF/CF in flight.*/
+	CANTP_LOWER_FC				/* FC in flight.*/
+}CanTp_LowerStateType;
+
+typedef struct
+{
+	const CanTp_ConfigType*	Config;
+	uint32_t				Now;				/* Time of the last main function (ms).*/
+
+	/* Sender */
+	CanTp_TxStateType		TxState;
+	PduLengthType			TxTotal;
+	PduLengthType			TxRemaining;
+	RetryInfoType			TxRetry;
+	uint32_t				TxDeadline;
+	uint8_t					TxSn;
+	uint8_t					TxBs;				/* BS of the last FC.*/
+	uint8_t					TxBsLeft;
+	uint8_t					TxStminMs;
+	uint8_t					TxLastLen;			/* Payload bytes of the frame in flight.*/
+	uint8_t					TxAttempts;
+
+	/* Receiver */
+	CanTp_RxStateType		RxState;
+	PduLengthType			RxRemaining;
+	PduLengthType			RxBufSize;			/* Space reported by the upper layer.*/
+	uint32_t				RxDeadline;
+	uint8_t					RxSn;
+	uint8_t					RxBsLeft;
+	uint8_t					RxWft;
+	uint8_t					RxFcPending;		/* FS + 1 of a FC still to send, 0 = none.*/
+	uint8_t					RxFcBs;
+	uint32_t				FcDeadline;			/* N_Ar of the FC in flight.*/
+
+	CanTp_LowerStateType	Lower;
+	uint8_t					Frame[CANTP_FRAME_SIZE];
+}CanTp_ConnType;
+
+#define CANTP_CONN_RAM_BYTES	((uint32_t)sizeof(CanTp_ConnType))
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helpers
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool CanTp_Expired(uint32_t now, uint32_t deadline)
+{
+	return ((int32_t)(now - deadline) >= 0);
+}
+
+/* STmin ISO encoding -> ms, 100..900 us rounded up to 1 ms, reserved values = 127 ms. */
+static inline uint8_t CanTp_StminToMs(uint8_t stmin)
+{
+	if (stmin <= 0x7Fu)
+	{
+		return stmin;
+	}
+	if ((stmin >= 0xF1u) && (stmin <= 0xF9u))
+	{
+		return 1u;
+	}
+	return 0x7Fu;
+}
+
+static inline void CanTp_Init(CanTp_ConnType* conn, const CanTp_ConfigType* config)
+{
+	conn->Config = config;
+	conn->Now = 0u;
+	conn->TxState = CANTP_TX_IDLE;
+	conn->RxState = CANTP_RX_IDLE;
+	conn->RxFcPending = 0u;
+	conn->Lower = CANTP_LOWER_IDLE;
+}
+
+static inline void CanTp_TxEnd(CanTp_ConnType* conn, NotifResultType result)
+{
+	conn->TxState = CANTP_TX_IDLE;
+	conn->Config->TxConfirmation(conn->Config->UpperPduId, result);
+}
+
+static inline void CanTp_RxEnd(CanTp_ConnType* conn, NotifResultType result)
+{
+	conn->RxState = CANTP_RX_IDLE;
+	conn->RxFcPending = 0u;
+	conn->Config->RxIndication(conn->Config->UpperPduId, result);
+}
+
+/* FC lost (N_Ar or failed confirmation): the peer will not get it, end the reception it belonged to. An OVFLW FC
+ * has no reception behind it, RxState is already idle. */
+static inline void CanTp_RxFcFailed(CanTp_ConnType* conn, NotifResultType result)
+{
+	if (conn->RxState != CANTP_RX_IDLE)
+	{
+		CanTp_RxEnd(conn, result);
+	}
+}
+
+static inline Std_ReturnType CanTp_SendFrame(CanTp_ConnType* conn, uint8_t used, CanTp_LowerStateType kind)
+{
+	PduInfoType info;
+	uint8_t i;
+
+	for (i = used; i < CANTP_FRAME_SIZE; i++)
+	{
+		conn->Frame[i] = conn->Config->Padding;
+	}
+	info.SduDataPtr = conn->Frame;
+	info.SduLength = CANTP_FRAME_SIZE;
+	info.MetaDataPtr = NULL;
+
+	if (conn->Config->CanTransmit(conn->Config->TxPduId, &info) != E_OK)
+	{
+		return E_NOT_OK;
+	}
+	conn->Lower = kind;
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Sender: build the next SF/FF/CF straight from the upper layer buffer and hand it to CanIf
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_TxNext(CanTp_ConnType* conn)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+	PduInfoType info;
+	PduLengthType avail;
+	BufReq_ReturnType ret;
+	uint8_t pci;
+	uint8_t n;
+
+	if (conn->Lower != CANTP_LOWER_IDLE)
+	{
+		conn->TxState = CANTP_TX_SEND;		/* Receive side FC in flight, main function resumes. */
+		return;
+	}
+
+	if (conn->TxTotal <= CANTP_SF_MAX_DATA)
+	{
+		n = (uint8_t)conn->TxTotal;
+		conn->Frame[0] = (uint8_t)(CANTP_PCI_SF | n);
+		pci = 1u;
+	}
+	else if (conn->TxRemaining == conn->TxTotal)
+	{
+		n = CANTP_FF_DATA;
+		conn->Frame[0] = (uint8_t)(CANTP_PCI_FF | (conn->TxTotal >> 8));
+		conn->Frame[1] = (uint8_t)conn->TxTotal;
+		pci = 2u;
+	}
+	else
+	{
+		n = (conn->TxRemaining < CANTP_CF_MAX_DATA) ? (uint8_t)conn->TxRemaining : (uint8_t)CANTP_CF_MAX_DATA;
+		conn->Frame[0] = (uint8_t)(CANTP_PCI_CF | conn->TxSn);
+		pci = 1u;
+	}
+
+	info.SduDataPtr = &conn->Frame[pci];
+	info.SduLength = n;
+	info.MetaDataPtr = NULL;
+	ret = cfg->CopyTxData(cfg->UpperPduId, &info, &conn->TxRetry, &avail);
+	if (ret == BUFREQ_E_BUSY)
+	{
+		conn->TxState = CANTP_TX_SEND;		/* Data not ready yet, N_Cs running. */
+		return;
+	}
+	if (ret != BUFREQ_OK)
+	{
+		CanTp_TxEnd(conn, NTFRSLT_E_NOT_OK);
+		return;
+	}
+
+	conn->TxLastLen = n;
+	conn->TxRetry.TpDataState = TP_DATACONF;
+	conn->TxAttempts++;
+	if (CanTp_SendFrame(conn, (uint8_t)(pci + n), CANTP_LOWER_DATA) != E_OK)
+	{
+		if (conn->TxAttempts >= CANTP_MAX_RETRY)
+		{
+			CanTp_TxEnd(conn, NTFRSLT_E_NOT_OK);
+			return;
+		}
+		/* Rewind the upper layer on the next attempt. */
+		conn->TxRetry.TpDataState = TP_DATARETRY;
+		conn->TxRetry.TxTpDataCnt = n;
+		conn->TxState = CANTP_TX_SEND;
+		return;
+	}
+
+	conn->TxState = CANTP_TX_WAIT_CONF;
+	conn->TxDeadline = conn->Now + cfg->NasMs;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Start a transfer of info->SduLength bytes, data is pulled later with CopyTxData
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType CanTp_Transmit(CanTp_ConnType* conn, const PduInfoType* info)
+{
+	if ((conn->TxState != CANTP_TX_IDLE) || (info->SduLength == 0u) || (info->SduLength > CANTP_MAX_LENGTH))
+	{
+		return E_NOT_OK;
+	}
+
+	conn->TxTotal = info->SduLength;
+	conn->TxRemaining = info->SduLength;
+	conn->TxRetry.TpDataState = TP_DATACONF;
+	conn->TxRetry.TxTpDataCnt = 0u;
+	conn->TxSn = 1u;
+	conn->TxAttempts = 0u;
+	conn->TxDeadline = conn->Now + conn->Config->NcsMs;
+	CanTp_TxNext(conn);
+	return E_OK;
+}
+
+static inline void CanTp_CancelTransmit(CanTp_ConnType* conn)
+{
+	if (conn->TxState != CANTP_TX_IDLE)
+	{
+		CanTp_TxEnd(conn, NTFRSLT_E_CANCELATION);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Receiver: send CTS (block size reduced to the free buffer) or WAIT when no frame fits
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_RxFlowControl(CanTp_ConnType* conn)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+	PduLengthType need = (conn->RxRemaining < CANTP_CF_MAX_DATA) ? conn->RxRemaining : CANTP_CF_MAX_DATA;
+	uint8_t bs = cfg->BlockSize;
+
+	if (conn->RxBufSize >= need)
+	{
+		if (conn->RxBufSize < conn->RxRemaining)
+		{
+			/* Ask only for what fits: BS frames of 7 bytes (at least 1 frame). */
+			uint16_t frames = (uint16_t)(conn->RxBufSize / CANTP_CF_MAX_DATA);
+			if (frames == 0u)
+			{
+				frames = 1u;
+			}
+			if ((bs == 0u) || (frames < bs))
+			{
+				bs = (frames > 0xFFu) ? 0xFFu : (uint8_t)frames;
+			}
+		}
+		conn->RxFcBs = bs;
+		conn->RxFcPending = CANTP_FS_CTS + 1u;
+		conn->RxWft = 0u;
+	}
+	else
+	{
+		if (conn->RxWft >= CANTP_MAX_WFT)
+		{
+			CanTp_RxEnd(conn, NTFRSLT_E_NOT_OK);
+			return;
+		}
+		conn->RxWft++;
+		conn->RxFcBs = 0u;
+		conn->RxFcPending = CANTP_FS_WAIT + 1u;
+	}
+}
+
+static inline void CanTp_RxSendFc(CanTp_ConnType* conn)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+	uint8_t fs;
+
+	if ((conn->RxFcPending == 0u) || (conn->Lower != CANTP_LOWER_IDLE))
+	{
+		return;
+	}
+
+	fs = (uint8_t)(conn->RxFcPending - 1u);
+	conn->Frame[0] = (uint8_t)(CANTP_PCI_FC | fs);
+	conn->Frame[1] = conn->RxFcBs;
+	conn->Frame[2] = cfg->STmin;
+	if (CanTp_SendFrame(conn, 3u, CANTP_LOWER_FC) != E_OK)
+	{
+		return;		/* Retried by the main function. */
+	}
+	conn->RxFcPending = 0u;
+	conn->FcDeadline = conn->Now + cfg->NarMs;
+
+	if (fs == CANTP_FS_CTS)
+	{
+		conn->RxState = CANTP_RX_WAIT_CF;
+		conn->RxBsLeft = conn->RxFcBs;
+		conn->RxDeadline = conn->Now + cfg->NcrMs;
+	}
+	else if (fs == CANTP_FS_WAIT)
+	{
+		conn->RxState = CANTP_RX_WAIT_BUF;
+		conn->RxDeadline = conn->Now + cfg->NbrMs;
+	}
+	else
+	{
+		conn->RxState = CANTP_RX_IDLE;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Receiver frames
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_RxSingleOrFirst(CanTp_ConnType* conn, const uint8_t* data, PduLengthType len)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+	PduInfoType info;
+	PduLengthType total;
+	BufReq_ReturnType ret;
+	bool single = ((data[0] & 0xF0u) == CANTP_PCI_SF);
+
+	if (single)
+	{
+		total = (PduLengthType)(data[0] & 0x0Fu);
+		if ((total == 0u) || (total > CANTP_SF_MAX_DATA) || (total > (PduLengthType)(len - 1u)))
+		{
+			return;
+		}
+		info.SduDataPtr = (uint8_t*)&data[1];
+		info.SduLength = total;
+	}
+	else
+	{
+		total = (PduLengthType)(((data[0] & 0x0Fu) << 8) | data[1]);
+		if ((total <= CANTP_SF_MAX_DATA) || (len < CANTP_FRAME_SIZE))
+		{
+			return;
+		}
+		info.SduDataPtr = (uint8_t*)&data[2];
+		info.SduLength = CANTP_FF_DATA;
+	}
+	info.MetaDataPtr = NULL;
+
+	if (conn->RxState != CANTP_RX_IDLE)
+	{
+		/* A new SF/FF terminates the reception in progress. */
+		CanTp_RxEnd(conn, NTFRSLT_E_NOT_OK);
+	}
+
+	ret = cfg->StartOfReception(cfg->UpperPduId, &info, total, &conn->RxBufSize);
+	if (ret != BUFREQ_OK)
+	{
+		if ((ret == BUFREQ_E_OVFL) && !single)
+		{
+			conn->RxFcBs = 0u;
+			conn->RxFcPending = CANTP_FS_OVFLW + 1u;
+			CanTp_RxSendFc(conn);
+		}
+		return;
+	}
+
+	if (cfg->CopyRxData(cfg->UpperPduId, &info, &conn->RxBufSize) != BUFREQ_OK)
+	{
+		cfg->RxIndication(cfg->UpperPduId, NTFRSLT_E_NO_BUFFER);
+		return;
+	}
+
+	if (single)
+	{
+		cfg->RxIndication(cfg->UpperPduId, NTFRSLT_OK);
+		return;
+	}
+
+	conn->RxRemaining = (PduLengthType)(total - CANTP_FF_DATA);
+	conn->RxSn = 1u;
+	conn->RxWft = 0u;
+	conn->RxState = CANTP_RX_WAIT_CF;		/* Until the FC is out, a CF is a protocol error anyway. */
+	conn->RxDeadline = conn->Now + cfg->NcrMs;
+	CanTp_RxFlowControl(conn);
+	CanTp_RxSendFc(conn);
+}
+
+static inline void CanTp_RxConsecutive(CanTp_ConnType* conn, const uint8_t* data, PduLengthType len)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+	PduInfoType info;
+	uint8_t n;
+
+	if ((conn->RxState != CANTP_RX_WAIT_CF) || (conn->RxFcPending != 0u))
+	{
+		return;
+	}
+
+	if ((data[0] & 0x0Fu) != conn->RxSn)
+	{
+		CanTp_RxEnd(conn, NTFRSLT_E_WRONG_SN);
+		return;
+	}
+
+	n = (conn->RxRemaining < CANTP_CF_MAX_DATA) ? (uint8_t)conn->RxRemaining : (uint8_t)CANTP_CF_MAX_DATA;
+	if (len < (PduLengthType)(n + 1u))
+	{
+		CanTp_RxEnd(conn, NTFRSLT_E_PROTOCOL);
+		return;
+	}
+
+	info.SduDataPtr = (uint8_t*)&data[1];
+	info.SduLength = n;
+	info.MetaDataPtr = NULL;
+	if (cfg->CopyRxData(cfg->UpperPduId, &info, &conn->RxBufSize) != BUFREQ_OK)
+	{
+		CanTp_RxEnd(conn, NTFRSLT_E_NO_BUFFER);
+		return;
+	}
+
+	conn->RxRemaining = (PduLengthType)(conn->RxRemaining - n);
+	conn->RxSn = (uint8_t)((conn->RxSn + 1u) & 0x0Fu);
+	if (conn->RxRemaining == 0u)
+	{
+		CanTp_RxEnd(conn, NTFRSLT_OK);
+		return;
+	}
+
+	conn->RxDeadline = conn->Now + cfg->NcrMs;
+	if ((conn->RxBsLeft != 0u) && (--conn->RxBsLeft == 0u))
+	{
+		CanTp_RxFlowControl(conn);
+		CanTp_RxSendFc(conn);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Sender: flow control from the receiver
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_RxFlowControlFrame(CanTp_ConnType* conn, const uint8_t* data, PduLengthType len)
+{
+	if ((conn->TxState != CANTP_TX_WAIT_FC) || (len < 3u))
+	{
+		return;
+	}
+
+	switch (data[0] & 0x0Fu)
+	{
+		case CANTP_FS_CTS:
+			conn->TxBs = data[1];
+			conn->TxBsLeft = data[1];
+			conn->TxStminMs = CanTp_StminToMs(data[2]);
+			conn->TxAttempts = 0u;
+			conn->TxDeadline = conn->Now + conn->Config->NcsMs;
+			CanTp_TxNext(conn);
+			break;
+
+		case CANTP_FS_WAIT:
+			conn->TxDeadline = conn->Now + conn->Config->NbsMs;
+			break;
+
+		case CANTP_FS_OVFLW:
+			CanTp_TxEnd(conn, NTFRSLT_E_NO_BUFFER);
+			break;
+
+		default:
+			CanTp_TxEnd(conn, NTFRSLT_E_PROTOCOL);
+			break;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CanIf RX indication: one CAN frame of this connection
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_RxIndication(CanTp_ConnType* conn, const PduInfoType* info)
+{
+	const uint8_t* data = info->SduDataPtr;
+
+	if (info->SduLength == 0u)
+	{
+		return;
+	}
+
+	switch (data[0] & 0xF0u)
+	{
+		case CANTP_PCI_SF:
+			CanTp_RxSingleOrFirst(conn, data, info->SduLength);
+			break;
+
+		case CANTP_PCI_FF:
+			if (info->SduLength >= 2u)
+			{
+				CanTp_RxSingleOrFirst(conn, data, info->SduLength);
+			}
+			break;
+
+		case CANTP_PCI_CF:
+			CanTp_RxConsecutive(conn, data, info->SduLength);
+			break;
+
+		case CANTP_PCI_FC:
+			CanTp_RxFlowControlFrame(conn, data, info->SduLength);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CanIf TX confirmation of the frame in flight
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_TxConfirmation(CanTp_ConnType* conn, Std_ReturnType result)
+{
+	CanTp_LowerStateType kind = conn->Lower;
+
+	conn->Lower = CANTP_LOWER_IDLE;
+
+	if ((kind == CANTP_LOWER_FC) && (result != E_OK))
+	{
+		CanTp_RxFcFailed(conn, NTFRSLT_E_NOT_OK);
+	}
+
+	if ((kind == CANTP_LOWER_DATA) && (conn->TxState == CANTP_TX_WAIT_CONF))
+	{
+		if (result != E_OK)
+		{
+			if (conn->TxAttempts >= CANTP_MAX_RETRY)
+			{
+				CanTp_TxEnd(conn, NTFRSLT_E_NOT_OK);
+			}
+			else
+			{
+				conn->TxRetry.TpDataState = TP_DATARETRY;
+				conn->TxRetry.TxTpDataCnt = conn->TxLastLen;
+				conn->TxDeadline = conn->Now + conn->Config->NcsMs;
+				CanTp_TxNext(conn);
+			}
+		}
+		else
+		{
+			bool first = (conn->TxRemaining == conn->TxTotal);
+
+			conn->TxAttempts = 0u;
+			conn->TxRemaining = (PduLengthType)(conn->TxRemaining - conn->TxLastLen);
+			if (conn->TxRemaining == 0u)
+			{
+				CanTp_TxEnd(conn, NTFRSLT_OK);
+			}
+			else if (first)
+			{
+				conn->TxState = CANTP_TX_WAIT_FC;
+				conn->TxDeadline = conn->Now + conn->Config->NbsMs;
+			}
+			else
+			{
+				conn->TxSn = (uint8_t)((conn->TxSn + 1u) & 0x0Fu);
+				if ((conn->TxBs != 0u) && (--conn->TxBsLeft == 0u))
+				{
+					conn->TxState = CANTP_TX_WAIT_FC;
+					conn->TxDeadline = conn->Now + conn->Config->NbsMs;
+				}
+				else if (conn->TxStminMs == 0u)
+				{
+					conn->TxDeadline = conn->Now + conn->Config->NcsMs;
+					CanTp_TxNext(conn);
+				}
+				else
+				{
+					conn->TxState = CANTP_TX_WAIT_STMIN;
+					conn->TxDeadline = conn->Now + conn->TxStminMs;
+				}
+			}
+		}
+	}
+
+	/* Pending FC of the receive side first, it gates the peer. */
+	CanTp_RxSendFc(conn);
+	if ((conn->Lower == CANTP_LOWER_IDLE) && (conn->TxState == CANTP_TX_SEND))
+	{
+		CanTp_TxNext(conn);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Periodic processing: timeouts, STmin, retries, receiver buffer polling
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTp_MainFunction(CanTp_ConnType* conn, uint32_t nowMs)
+{
+	const CanTp_ConfigType* cfg = conn->Config;
+
+	conn->Now = nowMs;
+
+	/* N_Ar: free the lower layer first, the sender may be waiting for it */
+	if ((conn->Lower == CANTP_LOWER_FC) && CanTp_Expired(nowMs, conn->FcDeadline))
+	{
+		conn->Lower = CANTP_LOWER_IDLE;
+		CanTp_RxFcFailed(conn, NTFRSLT_E_TIMEOUT_A);
+	}
+
+	/* Sender */
+	switch (conn->TxState)
+	{
+		case CANTP_TX_SEND:
+			if (CanTp_Expired(nowMs, conn->TxDeadline))
+			{
+				CanTp_TxEnd(conn, NTFRSLT_E_NOT_OK);		/* N_Cs */
+			}
+			else
+			{
+				CanTp_TxNext(conn);
+			}
+			break;
+
+		case CANTP_TX_WAIT_CONF:
+			if (CanTp_Expired(nowMs, conn->TxDeadline))
+			{
+				conn->Lower = CANTP_LOWER_IDLE;
+				CanTp_TxEnd(conn, NTFRSLT_E_TIMEOUT_A);
+			}
+			break;
+
+		case CANTP_TX_WAIT_FC:
+			if (CanTp_Expired(nowMs, conn->TxDeadline))
+			{
+				CanTp_TxEnd(conn, NTFRSLT_E_TIMEOUT_BS);
+			}
+			break;
+
+		case CANTP_TX_WAIT_STMIN:
+			if (CanTp_Expired(nowMs, conn->TxDeadline))
+			{
+				conn->TxDeadline = nowMs + cfg->NcsMs;
+				CanTp_TxNext(conn);
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	/* Receiver */
+	if (conn->RxState == CANTP_RX_WAIT_CF)
+	{
+		if ((conn->RxFcPending == 0u) && CanTp_Expired(nowMs, conn->RxDeadline))
+		{
+			CanTp_RxEnd(conn, NTFRSLT_E_TIMEOUT_CR);
+		}
+	}
+	else if ((conn->RxState == CANTP_RX_WAIT_BUF) && (conn->RxFcPending == 0u))
+	{
+		PduInfoType query;
+		PduLengthType need = (conn->RxRemaining < CANTP_CF_MAX_DATA) ? conn->RxRemaining : CANTP_CF_MAX_DATA;
+
+		query.SduDataPtr = NULL;
+		query.SduLength = 0u;
+		query.MetaDataPtr = NULL;
+		(void)cfg->CopyRxData(cfg->UpperPduId, &query, &conn->RxBufSize);
+		if ((conn->RxBufSize >= need) || CanTp_Expired(nowMs, conn->RxDeadline))
+		{
+			CanTp_RxFlowControl(conn);
+		}
+	}
+	else
+	{
+	}
+
+	CanTp_RxSendFc(conn);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANTP_H_ */
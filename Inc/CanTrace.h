@@ -0,0 +1,177 @@
+/* =====================================================================================================================
+ *  File        : CanTrace.h
+ *  Layer       : Shared
+ *  Purpose     : Compact binary CAN trace format (recorded in the field, replayed in the lab)
+ *                 - Fixed-size records, so a capture can be memory-mapped and indexed as an array.
+ *                 - Written little-endian; on a little-endian host the record layout is CanTrace_RecordType
+ *                   itself (static check below), readers may use the mapped file directly.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : File layout (little-endian):
+ *                  Header, CAN_TRACE_HDR_SIZE bytes:
+ *                    [0..3]  Magic "CANT"
+ *                    [4]     Version
+ *                    [5]     Record size (CAN_TRACE_REC_SIZE)
+ *                    [6]     ECU role of the recorder (ECU_SENSOR/ECU_MOTOR/ECU_UNKNOWN)
+ *                    [7]     Reserved (0)
+ *                    [8..15] Start time, us since the Unix epoch (0 = unknown)
+ *                  Records, CAN_TRACE_REC_SIZE bytes each:
+ *                    [0..7]   Timestamp, us since the start time
+ *                    [8..11]  CAN_IdType (bit 31 = IDE)
+ *                    [12]     DLC
+ *                    [13]     Channel (NetworkHandleType)
+ *                    [14]     Flags (CAN_TRACE_FLAG_*)
+ *                    [15]     Reserved (0)
+ *                    [16..23] Data, DLC bytes valid
+ * ===================================================================================================================*/
+
+#ifndef CANTRACE_H_
+#define CANTRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CAN_TRACE_AR_MAJOR_VERSION		(1u)
+#define CAN_TRACE_AR_MINOR_VERSION		(0u)
+#define CAN_TRACE_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+#define CAN_TRACE_MAGIC0		((uint8_t)'C')
+#define CAN_TRACE_MAGIC1		((uint8_t)'A')
+#define CAN_TRACE_MAGIC2		((uint8_t)'N')
+#define CAN_TRACE_MAGIC3		((uint8_t)'T')
+#define CAN_TRACE_VERSION		(1u)
+#define CAN_TRACE_HDR_SIZE		(16u)
+#define CAN_TRACE_REC_SIZE		(24u)
+
+#define CAN_TRACE_FLAG_RTR		(0x01u)		/* Remote frame, no data.*/
+#define CAN_TRACE_FLAG_TX		(0x02u)		/* Frame sent by the recording node.*/
+
+typedef struct
+{
+	uint8_t		Version;
+	uint8_t		RecordSize;
+	uint8_t		EcuRole;
+	uint64_t	StartTimeUs;
+}CanTrace_HeaderType;
+
+typedef struct
+{
+	uint64_t			TimestampUs;
+	CAN_IdType			Id;
+	uint8_t				Dlc;
+	NetworkHandleType	Channel;
+	uint8_t				Flags;
+	uint8_t				Reserved;
+	uint8_t				Data[8];
+}CanTrace_RecordType;
+
+typedef char CanTrace_RecordSizeCheck_t[(sizeof(CanTrace_RecordType) == CAN_TRACE_REC_SIZE) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helpers: little-endian fields
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTrace_Put32(uint8_t* p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t CanTrace_Get32(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void CanTrace_Put64(uint8_t* p, uint64_t v)
+{
+	CanTrace_Put32(p, (uint32_t)v);
+	CanTrace_Put32(&p[4], (uint32_t)(v >> 32));
+}
+
+static inline uint64_t CanTrace_Get64(const uint8_t* p)
+{
+	return (uint64_t)CanTrace_Get32(p) | ((uint64_t)CanTrace_Get32(&p[4]) << 32);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Header
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t CanTrace_HeaderEncode(uint8_t* buf, uint8_t ecuRole, uint64_t startTimeUs)
+{
+	buf[0] = CAN_TRACE_MAGIC0;
+	buf[1] = CAN_TRACE_MAGIC1;
+	buf[2] = CAN_TRACE_MAGIC2;
+	buf[3] = CAN_TRACE_MAGIC3;
+	buf[4] = CAN_TRACE_VERSION;
+	buf[5] = CAN_TRACE_REC_SIZE;
+	buf[6] = ecuRole;
+	buf[7] = 0u;
+	CanTrace_Put64(&buf[8], startTimeUs);
+	return CAN_TRACE_HDR_SIZE;
+}
+
+static inline bool CanTrace_HeaderDecode(const uint8_t* buf, uint32_t len, CanTrace_HeaderType* hdr)
+{
+	if ((len < CAN_TRACE_HDR_SIZE) ||
+		(buf[0] != CAN_TRACE_MAGIC0) || (buf[1] != CAN_TRACE_MAGIC1) ||
+		(buf[2] != CAN_TRACE_MAGIC2) || (buf[3] != CAN_TRACE_MAGIC3) ||
+		(buf[4] != CAN_TRACE_VERSION) || (buf[5] != CAN_TRACE_REC_SIZE))
+	{
+		return false;
+	}
+
+	hdr->Version = buf[4];
+	hdr->RecordSize = buf[5];
+	hdr->EcuRole = buf[6];
+	hdr->StartTimeUs = CanTrace_Get64(&buf[8]);
+	return true;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Record (portable encode/decode, any byte order)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void CanTrace_RecordEncode(uint8_t* buf, const CanTrace_RecordType* rec)
+{
+	uint8_t i;
+
+	CanTrace_Put64(buf, rec->TimestampUs);
+	CanTrace_Put32(&buf[8], rec->Id);
+	buf[12] = rec->Dlc;
+	buf[13] = rec->Channel;
+	buf[14] = rec->Flags;
+	buf[15] = 0u;
+	for (i = 0u; i < 8u; i++)
+	{
+		buf[16u + i] = (i < rec->Dlc) ? rec->Data[i] : 0u;
+	}
+}
+
+static inline void CanTrace_RecordDecode(const uint8_t* buf, CanTrace_RecordType* rec)
+{
+	uint8_t i;
+
+	rec->TimestampUs = CanTrace_Get64(buf);
+	rec->Id = CanTrace_Get32(&buf[8]);
+	rec->Dlc = (buf[12] > 8u) ? 8u : buf[12];
+	rec->Channel = buf[13];
+	rec->Flags = buf[14];
+	rec->Reserved = 0u;
+	for (i = 0u; i < 8u; i++)
+	{
+		rec->Data[i] = buf[16u + i];
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANTRACE_H_ */
@@ -0,0 +1,294 @@
+/* =====================================================================================================================
+ *  File        : CanTxQueue.h
+ *  Layer       : ECU Abstraction
+ *  Purpose     : CAN transmit queue ordered by CAN arbitration priority (replaces FIFO + ComStack_TxPriorityType)
+ *                 - Key derived from the raw CAN_IdType exactly like bus arbitration: base 11 bits, then IDE
+ *                   (a standard frame beats an extended one with the same base), then the 18 extended bits.
+ *                 - Binary min-heap of (key, sequence): O(log n) push/pop, FIFO among frames with the same ID.
+ *                 - Optional deadline per frame: expired frames reaching the head are dropped, not sent late.
+ *                 - Mailbox helper: tells the driver which hardware mailbox to abort when the head of the queue
+ *                   outranks a frame already sitting in a mailbox (no priority inversion with 3 bxCAN mailboxes).
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Push/Pop/Requeue of one queue from one context (or under the CAN TX interrupt lock).
+ * ===================================================================================================================*/
+
+#ifndef CANTXQUEUE_H_
+#define CANTXQUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CAN_TXQ_AR_MAJOR_VERSION		(1u)
+#define CAN_TXQ_AR_MINOR_VERSION		(0u)
+#define CAN_TXQ_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity: frames waiting for a mailbox (<= 255), RAM ~ 24 * CAN_TXQ_SIZE bytes
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef CAN_TXQ_SIZE
+#define CAN_TXQ_SIZE			(16u)
+#endif
+
+typedef char CanTxQueue_SizeCheck_t[((CAN_TXQ_SIZE >= 1u) && (CAN_TXQ_SIZE <= 255u)) ? 1 : -1];
+
+#define CAN_TXQ_NO_MAILBOX		(0xFFu)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Arbitration key (lower key wins the bus)
+ *  - bits 29..19: base ID (standard ID, or extended ID >> 18)
+ *  - bit  18    : IDE (0 = standard)
+ *  - bits 17..0 : extended ID low bits (0 for a standard frame)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint32_t CanTxQueue_ArbKey(CAN_IdType id)
+{
+	uint32_t raw = CAN_ID_GET_RAW(id);
+
+	if (CAN_ID_IS_EXT(id))
+	{
+		return ((raw >> 18) << 19) | (1ul << 18) | (raw & 0x3FFFFu);
+	}
+	return raw << 19;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Frame
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	CAN_IdType		Id;
+	PduIdType		PduId;			/* Reported back to CanIf on confirmation / expiry.*/
+	uint8_t			Dlc;
+	uint8_t			Data[8];
+	bool			HasDeadline;
+	uint32_t		Deadline;		/* Time after which the frame is useless (same clock as Pop's now).*/
+	uint16_t		Seq;			/* Set by Push, kept by Requeue.*/
+}CanTxQueue_FrameType;
+
+typedef struct
+{
+	uint32_t		Key;
+	uint16_t		Seq;
+	uint8_t			Slot;
+}CanTxQueue_NodeType;
+
+typedef struct
+{
+	CanTxQueue_NodeType		Heap[CAN_TXQ_SIZE];
+	CanTxQueue_FrameType	Frame[CAN_TXQ_SIZE];
+	uint8_t					FreeSlot[CAN_TXQ_SIZE];		/* Stack of free Frame[] indexes.*/
+	uint8_t					Count;
+	uint8_t					FreeCount;
+	uint16_t				NextSeq;
+	void					(*Expired)(PduIdType pduId);	/* Optional: frame dropped on deadline.*/
+	uint32_t				ExpiredCount;				/* Statistics.*/
+	uint32_t				Overflow;					/* Statistics: Push on a full queue.*/
+}CanTxQueue_Type;
+
+static inline void CanTxQueue_Init(CanTxQueue_Type* q, void (*expired)(PduIdType pduId))
+{
+	uint8_t i;
+
+	for (i = 0u; i < CAN_TXQ_SIZE; i++)
+	{
+		q->FreeSlot[i] = i;
+	}
+	q->Count = 0u;
+	q->FreeCount = (uint8_t)CAN_TXQ_SIZE;
+	q->NextSeq = 0u;
+	q->Expired = expired;
+	q->ExpiredCount = 0u;
+	q->Overflow = 0u;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: a before b (key, then sequence, wrap safe)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool CanTxQueue_Before(const CanTxQueue_NodeType* a, const CanTxQueue_NodeType* b)
+{
+	if (a->Key != b->Key)
+	{
+		return (a->Key < b->Key);
+	}
+	return ((int16_t)(a->Seq - b->Seq) < 0);
+}
+
+static inline void CanTxQueue_SiftUp(CanTxQueue_Type* q, uint8_t i)
+{
+	CanTxQueue_NodeType node = q->Heap[i];
+
+	while (i > 0u)
+	{
+		uint8_t parent = (uint8_t)((i - 1u) / 2u);
+		if (!CanTxQueue_Before(&node, &q->Heap[parent]))
+		{
+			break;
+		}
+		q->Heap[i] = q->Heap[parent];
+		i = parent;
+	}
+	q->Heap[i] = node;
+}
+
+static inline void CanTxQueue_SiftDown(CanTxQueue_Type* q, uint8_t i)
+{
+	CanTxQueue_NodeType node = q->Heap[i];
+	uint8_t n = q->Count;
+
+	for (;;)
+	{
+		uint16_t child = (uint16_t)(2u * i + 1u);
+		if (child >= n)
+		{
+			break;
+		}
+		if (((child + 1u) < n) && CanTxQueue_Before(&q->Heap[child + 1u], &q->Heap[child]))
+		{
+			child++;
+		}
+		if (!CanTxQueue_Before(&q->Heap[child], &node))
+		{
+			break;
+		}
+		q->Heap[i] = q->Heap[child];
+		i = (uint8_t)child;
+	}
+	q->Heap[i] = node;
+}
+
+static inline Std_ReturnType CanTxQueue_Insert(CanTxQueue_Type* q, const CanTxQueue_FrameType* frame)
+{
+	uint8_t slot;
+
+	if (q->FreeCount == 0u)
+	{
+		q->Overflow++;
+		return E_NOT_OK;
+	}
+
+	slot = q->FreeSlot[--q->FreeCount];
+	q->Frame[slot] = *frame;
+	q->Heap[q->Count].Key = CanTxQueue_ArbKey(frame->Id);
+	q->Heap[q->Count].Seq = frame->Seq;
+	q->Heap[q->Count].Slot = slot;
+	q->Count++;
+	CanTxQueue_SiftUp(q, (uint8_t)(q->Count - 1u));
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Queue a new frame (Seq assigned here). E_NOT_OK: queue full.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType CanTxQueue_Push(CanTxQueue_Type* q, const CanTxQueue_FrameType* frame)
+{
+	CanTxQueue_FrameType f = *frame;
+
+	f.Seq = q->NextSeq;
+	if (CanTxQueue_Insert(q, &f) != E_OK)
+	{
+		return E_NOT_OK;
+	}
+	q->NextSeq++;
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Put back a frame aborted from a mailbox: keeps its sequence, so it stays ahead of later frames with its ID.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType CanTxQueue_Requeue(CanTxQueue_Type* q, const CanTxQueue_FrameType* frame)
+{
+	return CanTxQueue_Insert(q, frame);
+}
+
+static inline void CanTxQueue_RemoveHead(CanTxQueue_Type* q)
+{
+	q->FreeSlot[q->FreeCount++] = q->Heap[0].Slot;
+	q->Count--;
+	if (q->Count > 0u)
+	{
+		q->Heap[0] = q->Heap[q->Count];
+		CanTxQueue_SiftDown(q, 0u);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Highest priority frame still in time, without removing it
+ *  - Expired frames met at the head are dropped (Expired callback) on the way.
+ *  - Returns NULL when the queue is empty.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline const CanTxQueue_FrameType* CanTxQueue_Peek(CanTxQueue_Type* q, uint32_t now)
+{
+	while (q->Count > 0u)
+	{
+		const CanTxQueue_FrameType* head = &q->Frame[q->Heap[0].Slot];
+
+		if (!head->HasDeadline || ((int32_t)(now - head->Deadline) < 0))
+		{
+			return head;
+		}
+
+		q->ExpiredCount++;
+		if (q->Expired != NULL)
+		{
+			q->Expired(head->PduId);
+		}
+		CanTxQueue_RemoveHead(q);
+	}
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Take the highest priority frame still in time. E_NOT_OK: nothing to send.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType CanTxQueue_Pop(CanTxQueue_Type* q, uint32_t now, CanTxQueue_FrameType* frame)
+{
+	const CanTxQueue_FrameType* head = CanTxQueue_Peek(q, now);
+
+	if (head == NULL)
+	{
+		return E_NOT_OK;
+	}
+	*frame = *head;
+	CanTxQueue_RemoveHead(q);
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Mailbox helper
+ *  - mbKey[i]: arbitration key of the frame pending in mailbox i, 0xFFFFFFFF when the mailbox is empty.
+ *  - Returns the mailbox to fill with the head of the queue:
+ *      an empty mailbox if any, otherwise the mailbox holding the lowest priority frame when the head outranks
+ *      it (the driver aborts it and Requeue()s it), otherwise CAN_TXQ_NO_MAILBOX.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t CanTxQueue_SelectMailbox(const uint32_t* mbKey, uint8_t mbCount, uint32_t headKey)
+{
+	uint8_t worst = 0u;
+	uint8_t i;
+
+	for (i = 0u; i < mbCount; i++)
+	{
+		if (mbKey[i] == 0xFFFFFFFFu)
+		{
+			return i;
+		}
+		if (mbKey[i] > mbKey[worst])
+		{
+			worst = i;
+		}
+	}
+
+	return ((mbCount > 0u) && (headKey < mbKey[worst])) ? worst : (uint8_t)CAN_TXQ_NO_MAILBOX;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANTXQUEUE_H_ */
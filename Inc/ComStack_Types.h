@@ -61,11 +61,11 @@ typedef uint8_t NetworkHandleType;
 typedef uint16_t PduIdType;
 typedef uint16_t PduLengthType;
 
-struct PduInfoType {
+typedef struct PduInfoType {
 	uint8_t*		SduDataPtr;		/* Pointer of payload (Tx or Rx).*/
 	PduLengthType	SduLength;		/* Số byte hợp lệ trong payload.*/
 	uint8_t*		MetaDataPtr;	/* Metadata. */
-};
+} PduInfoType;
 
 /* ---------------------------------------------------------------------------------------------------------------------
  *  Buffer request result for Transport Protocol (TP)
@@ -134,9 +134,9 @@ static inline CAN_IdType CAN_MAKE_STD_ID(uint16_t stdId)
 	return ((CAN_IdType)(stdId & CAN_STD_ID_MASK));
 }
 
-static inline CAN_IdType CAN_MAKE_EXT_ID(uint16_t extId)
+static inline CAN_IdType CAN_MAKE_EXT_ID(uint32_t extId)
 {
-	return ((CAN_IdType)(extId & CAN_EXT_ID_MASK));
+	return ((CAN_IdType)((extId & CAN_EXT_ID_MASK) | CAN_ID_FLAG_IDE));
 }
 
 static inline bool CAN_ID_IS_EXT(CAN_IdType id)
@@ -0,0 +1,355 @@
+/* =====================================================================================================================
+ *  File        : ComStats.h
+ *  Layer       : Shared
+ *  Purpose     : Lock-free communication statistics per NetworkHandleType and per PduIdType
+ *                 - 32-bit atomic counters (LDREX/STREX on Cortex-M3): safe from any ISR, never torn.
+ *                 - Channel: TX/RX frames and bytes, BUFREQ_E_BUSY / E_OVFL, every NotifResultType, entries into
+ *                   each ComStack_ControllerStateType.
+ *                 - PDU: TX/RX frames and bytes, BUFREQ_E_BUSY / E_OVFL, notification errors.
+ *                 - Snapshot by double collect: consistent when two reads in a row are equal.
+ *                 - Rates between two snapshots: frames/s, errors/s, estimated bus load.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Counters of one channel (or PDU) are contiguous and the hot ones (frames, bytes) come first.
+ *                RAM = 4 * (COMSTATS_CH_COUNTERS + 1) * COMSTATS_MAX_CHANNELS + 4 * COMSTATS_PDU_COUNTERS *
+ *                COMSTATS_MAX_PDU bytes (~ 608 bytes with the defaults).
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef COMSTATS_H_
+#define COMSTATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define COMSTATS_AR_MAJOR_VERSION		(1u)
+#define COMSTATS_AR_MINOR_VERSION		(0u)
+#define COMSTATS_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef COMSTATS_MAX_CHANNELS
+#define COMSTATS_MAX_CHANNELS		(2u)
+#endif
+
+#ifndef COMSTATS_MAX_PDU
+#define COMSTATS_MAX_PDU			(16u)
+#endif
+
+#ifndef COMSTATS_SNAPSHOT_RETRIES
+#define COMSTATS_SNAPSHOT_RETRIES	(4u)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Bus load estimate: bits per frame = overhead (header, CRC, EOF, IFS, average stuffing) + data bits with stuffing
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef COMSTATS_FRAME_OVERHEAD_BITS
+#define COMSTATS_FRAME_OVERHEAD_BITS	(50u)
+#endif
+
+#ifndef COMSTATS_BYTE_BITS_X10
+#define COMSTATS_BYTE_BITS_X10			(88u)		/* 8.8 bits per data byte.*/
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Counter layout
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define COMSTATS_NOTIF_COUNT		((uint8_t)NTFRSLT_E_NO_BUFFER + 1u)
+#define COMSTATS_STATE_COUNT		((uint8_t)COMSTACK_CONTROLLER_SLEEP + 1u)
+
+typedef enum
+{
+	COMSTATS_TX_FRAMES = 0,
+	COMSTATS_RX_FRAMES,
+	COMSTATS_TX_BYTES,
+	COMSTATS_RX_BYTES,
+	COMSTATS_BUF_BUSY,
+	COMSTATS_BUF_OVFL,
+	COMSTATS_PDU_NOTIF_ERRORS,							/* PDU only: notifications != NTFRSLT_OK.*/
+	COMSTATS_PDU_COUNTERS,
+
+	COMSTATS_CH_NOTIF = COMSTATS_PDU_NOTIF_ERRORS,		/* Channel: one counter per NotifResultType.*/
+	COMSTATS_CH_STATE = COMSTATS_CH_NOTIF + COMSTATS_NOTIF_COUNT,	/* Channel: entries per controller state.*/
+	COMSTATS_CH_COUNTERS = COMSTATS_CH_STATE + COMSTATS_STATE_COUNT
+}ComStats_CounterType;
+
+typedef struct
+{
+	atomic_uint_least32_t	Counter[COMSTATS_CH_COUNTERS];
+	atomic_uint_least32_t	State;							/* Current ComStack_ControllerStateType.*/
+}ComStats_ChannelType;
+
+typedef struct
+{
+	atomic_uint_least32_t	Counter[COMSTATS_PDU_COUNTERS];
+}ComStats_PduType;
+
+typedef struct
+{
+	ComStats_ChannelType	Channel[COMSTATS_MAX_CHANNELS];
+	ComStats_PduType		Pdu[COMSTATS_MAX_PDU];
+}ComStats_Type;
+
+typedef struct
+{
+	uint32_t	Counter[COMSTATS_CH_COUNTERS];
+	uint32_t	State;
+}ComStats_ChannelSnapshotType;
+
+typedef struct
+{
+	uint32_t	Counter[COMSTATS_PDU_COUNTERS];
+}ComStats_PduSnapshotType;
+
+typedef struct
+{
+	uint32_t	TxFramesPerSec;
+	uint32_t	RxFramesPerSec;
+	uint32_t	ErrorsPerSec;			/* Notifications != NTFRSLT_OK + BUFREQ_E_BUSY/E_OVFL.*/
+	uint16_t	BusLoadPermille;		/* Estimated from frames and bytes, needs the bit rate.*/
+}ComStats_RateType;
+
+static inline void ComStats_Init(ComStats_Type* stats)
+{
+	uint16_t i;
+	uint16_t k;
+
+	for (i = 0u; i < COMSTATS_MAX_CHANNELS; i++)
+	{
+		for (k = 0u; k < (uint16_t)COMSTATS_CH_COUNTERS; k++)
+		{
+			atomic_init(&stats->Channel[i].Counter[k], 0u);
+		}
+		atomic_init(&stats->Channel[i].State, (uint32_t)COMSTACK_CONTROLLER_UNINIT);
+	}
+	for (i = 0u; i < COMSTATS_MAX_PDU; i++)
+	{
+		for (k = 0u; k < (uint16_t)COMSTATS_PDU_COUNTERS; k++)
+		{
+			atomic_init(&stats->Pdu[i].Counter[k], 0u);
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: relaxed add, out of range channel / PDU is ignored
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void ComStats_Add(atomic_uint_least32_t* c, uint32_t v)
+{
+	(void)atomic_fetch_add_explicit(c, v, memory_order_relaxed);
+}
+
+static inline void ComStats_Frame(ComStats_Type* stats, NetworkHandleType ch, PduIdType pdu, PduLengthType len,
+								  bool tx)
+{
+	ComStats_CounterType frames = tx ? COMSTATS_TX_FRAMES : COMSTATS_RX_FRAMES;
+	ComStats_CounterType bytes = tx ? COMSTATS_TX_BYTES : COMSTATS_RX_BYTES;
+
+	if (ch < COMSTATS_MAX_CHANNELS)
+	{
+		ComStats_Add(&stats->Channel[ch].Counter[frames], 1u);
+		ComStats_Add(&stats->Channel[ch].Counter[bytes], len);
+	}
+	if (pdu < COMSTATS_MAX_PDU)
+	{
+		ComStats_Add(&stats->Pdu[pdu].Counter[frames], 1u);
+		ComStats_Add(&stats->Pdu[pdu].Counter[bytes], len);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Update API (ISR safe)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void ComStats_TxFrame(ComStats_Type* stats, NetworkHandleType ch, PduIdType pdu, PduLengthType len)
+{
+	ComStats_Frame(stats, ch, pdu, len, true);
+}
+
+static inline void ComStats_RxFrame(ComStats_Type* stats, NetworkHandleType ch, PduIdType pdu, PduLengthType len)
+{
+	ComStats_Frame(stats, ch, pdu, len, false);
+}
+
+/* Count a buffer request answer, only BUFREQ_E_BUSY and BUFREQ_E_OVFL are counted. */
+static inline void ComStats_BufResult(ComStats_Type* stats, NetworkHandleType ch, PduIdType pdu,
+									  BufReq_ReturnType result)
+{
+	ComStats_CounterType c;
+
+	if (result == BUFREQ_E_BUSY)
+	{
+		c = COMSTATS_BUF_BUSY;
+	}
+	else if (result == BUFREQ_E_OVFL)
+	{
+		c = COMSTATS_BUF_OVFL;
+	}
+	else
+	{
+		return;
+	}
+
+	if (ch < COMSTATS_MAX_CHANNELS)
+	{
+		ComStats_Add(&stats->Channel[ch].Counter[c], 1u);
+	}
+	if (pdu < COMSTATS_MAX_PDU)
+	{
+		ComStats_Add(&stats->Pdu[pdu].Counter[c], 1u);
+	}
+}
+
+static inline void ComStats_Notif(ComStats_Type* stats, NetworkHandleType ch, PduIdType pdu, NotifResultType result)
+{
+	if ((ch < COMSTATS_MAX_CHANNELS) && ((uint8_t)result < COMSTATS_NOTIF_COUNT))
+	{
+		ComStats_Add(&stats->Channel[ch].Counter[COMSTATS_CH_NOTIF + (uint8_t)result], 1u);
+	}
+	if ((pdu < COMSTATS_MAX_PDU) && (result != NTFRSLT_OK))
+	{
+		ComStats_Add(&stats->Pdu[pdu].Counter[COMSTATS_PDU_NOTIF_ERRORS], 1u);
+	}
+}
+
+static inline void ComStats_ControllerState(ComStats_Type* stats, NetworkHandleType ch,
+											ComStack_ControllerStateType state)
+{
+	if ((ch < COMSTATS_MAX_CHANNELS) && ((uint8_t)state < COMSTATS_STATE_COUNT))
+	{
+		uint32_t prev = atomic_exchange_explicit(&stats->Channel[ch].State, (uint32_t)state, memory_order_relaxed);
+		if (prev != (uint32_t)state)
+		{
+			ComStats_Add(&stats->Channel[ch].Counter[COMSTATS_CH_STATE + (uint8_t)state], 1u);
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Snapshot (task context)
+ *  - E_OK     : consistent view (two collects in a row were identical).
+ *  - E_NOT_OK : counters kept moving for COMSTATS_SNAPSHOT_RETRIES collects, snap holds the last collect
+ *               (each counter exact, not all from the same instant).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool ComStats_Collect(const atomic_uint_least32_t* src, uint32_t* dst, uint16_t n)
+{
+	bool same = true;
+	uint16_t k;
+
+	for (k = 0u; k < n; k++)
+	{
+		uint32_t v = atomic_load_explicit(&src[k], memory_order_relaxed);
+		if (v != dst[k])
+		{
+			dst[k] = v;
+			same = false;
+		}
+	}
+	return same;
+}
+
+static inline Std_ReturnType ComStats_SnapshotChannel(ComStats_Type* stats, NetworkHandleType ch,
+													  ComStats_ChannelSnapshotType* snap)
+{
+	uint8_t i;
+
+	if (ch >= COMSTATS_MAX_CHANNELS)
+	{
+		return E_NOT_OK;
+	}
+
+	(void)ComStats_Collect(stats->Channel[ch].Counter, snap->Counter, (uint16_t)COMSTATS_CH_COUNTERS);
+	for (i = 0u; i < COMSTATS_SNAPSHOT_RETRIES; i++)
+	{
+		if (ComStats_Collect(stats->Channel[ch].Counter, snap->Counter, (uint16_t)COMSTATS_CH_COUNTERS))
+		{
+			snap->State = atomic_load_explicit(&stats->Channel[ch].State, memory_order_relaxed);
+			return E_OK;
+		}
+	}
+	snap->State = atomic_load_explicit(&stats->Channel[ch].State, memory_order_relaxed);
+	return E_NOT_OK;
+}
+
+static inline Std_ReturnType ComStats_SnapshotPdu(ComStats_Type* stats, PduIdType pdu, ComStats_PduSnapshotType* snap)
+{
+	uint8_t i;
+
+	if (pdu >= COMSTATS_MAX_PDU)
+	{
+		return E_NOT_OK;
+	}
+
+	(void)ComStats_Collect(stats->Pdu[pdu].Counter, snap->Counter, (uint16_t)COMSTATS_PDU_COUNTERS);
+	for (i = 0u; i < COMSTATS_SNAPSHOT_RETRIES; i++)
+	{
+		if (ComStats_Collect(stats->Pdu[pdu].Counter, snap->Counter, (uint16_t)COMSTATS_PDU_COUNTERS))
+		{
+			return E_OK;
+		}
+	}
+	return E_NOT_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Rates between two channel snapshots taken elapsedMs apart (counters wrap safely, uint32 differences)
+ *  - bitrate: bit/s of the channel, 0 = bus load not computed.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void ComStats_ComputeRates(const ComStats_ChannelSnapshotType* prev,
+										 const ComStats_ChannelSnapshotType* cur, uint32_t elapsedMs,
+										 uint32_t bitrate, ComStats_RateType* rate)
+{
+	uint32_t d[COMSTATS_CH_COUNTERS];
+	uint32_t errors;
+	uint64_t bits;
+	uint16_t k;
+
+	rate->TxFramesPerSec = 0u;
+	rate->RxFramesPerSec = 0u;
+	rate->ErrorsPerSec = 0u;
+	rate->BusLoadPermille = 0u;
+	if (elapsedMs == 0u)
+	{
+		return;
+	}
+
+	for (k = 0u; k < (uint16_t)COMSTATS_CH_COUNTERS; k++)
+	{
+		d[k] = cur->Counter[k] - prev->Counter[k];
+	}
+
+	errors = d[COMSTATS_BUF_BUSY] + d[COMSTATS_BUF_OVFL];
+	for (k = 1u; k < COMSTATS_NOTIF_COUNT; k++)
+	{
+		errors += d[COMSTATS_CH_NOTIF + k];
+	}
+
+	rate->TxFramesPerSec = (uint32_t)(((uint64_t)d[COMSTATS_TX_FRAMES] * 1000u) / elapsedMs);
+	rate->RxFramesPerSec = (uint32_t)(((uint64_t)d[COMSTATS_RX_FRAMES] * 1000u) / elapsedMs);
+	rate->ErrorsPerSec = (uint32_t)(((uint64_t)errors * 1000u) / elapsedMs);
+
+	if (bitrate != 0u)
+	{
+		uint64_t load;
+
+		bits = ((uint64_t)(d[COMSTATS_TX_FRAMES] + d[COMSTATS_RX_FRAMES]) * COMSTATS_FRAME_OVERHEAD_BITS) +
+			   (((uint64_t)(d[COMSTATS_TX_BYTES] + d[COMSTATS_RX_BYTES]) * COMSTATS_BYTE_BITS_X10) / 10u);
+		/* permille = bits / (bitrate * elapsedMs / 1000) * 1000 */
+		load = (bits * 1000000u) / ((uint64_t)bitrate * elapsedMs);
+		rate->BusLoadPermille = (uint16_t)((load > 1000u) ? 1000u : load);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMSTATS_H_ */
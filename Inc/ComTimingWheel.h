@@ -0,0 +1,412 @@
+/* =====================================================================================================================
+ *  File        : ComTimingWheel.h
+ *  Layer       : Services
+ *  Purpose     : Hierarchical timing wheel for Com PDU timing, keyed by PduIdType
+ *                 - TX cyclic (period + first offset), TX on change with minimum delay (MDT), or both (mixed).
+ *                 - RX deadline monitoring: no reception within the timeout -> Notify(pdu, COM_TW_RX_TIMEOUT_RESULT),
+ *                   then monitoring restarts.
+ *                 - 3 levels x 64 slots of 1 / 64 / 4096 ticks: a tick only visits the PDUs due now plus, every
+ *                   64 ticks, the PDUs cascading down one level (each PDU cascades at most twice per expiry).
+ *                   Per tick cost is O(due PDUs), independent of the configured PDU count.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : One tick = one call of ComTimingWheel_MainFunction (e.g. 1 ms or 10 ms task).
+ *                Delays are up to 65535 ticks (uint16 config), the wheel covers 262143 ticks.
+ *                RAM = 20 * COM_TW_MAX_PDU + 384 bytes. All calls from the Com main function context;
+ *                Transmit / Notify callbacks may call Trigger / RxIndication / Start / Stop.
+ * ===================================================================================================================*/
+
+#ifndef COMTIMINGWHEEL_H_
+#define COMTIMINGWHEEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define COM_TW_AR_MAJOR_VERSION		(1u)
+#define COM_TW_AR_MINOR_VERSION		(0u)
+#define COM_TW_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef COM_TW_MAX_PDU
+#define COM_TW_MAX_PDU				(64u)
+#endif
+
+#ifndef COM_TW_RX_TIMEOUT_RESULT
+#define COM_TW_RX_TIMEOUT_RESULT	NTFRSLT_E_TIMEOUT_A
+#endif
+
+#define COM_TW_LEVELS				(3u)
+#define COM_TW_SLOT_BITS			(6u)
+#define COM_TW_SLOTS				(1u << COM_TW_SLOT_BITS)
+#define COM_TW_SLOT_MASK			(COM_TW_SLOTS - 1u)
+#define COM_TW_RANGE				(1uL << (COM_TW_LEVELS * COM_TW_SLOT_BITS))
+
+#define COM_TW_NONE					(0xFFFFu)
+#define COM_TW_NOT_ARMED			(0xFFu)
+
+typedef char ComTimingWheel_SizeCheck_t[((COM_TW_MAX_PDU >= 1u) && (COM_TW_MAX_PDU < COM_TW_NONE)) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Configuration (const, one entry per PduIdType)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	COM_TW_TX = 0,
+	COM_TW_RX
+}ComTimingWheel_DirectionType;
+
+typedef struct
+{
+	ComTimingWheel_DirectionType	Direction;
+	uint16_t	PeriodTicks;		/* TX: cyclic period, 0 = event only.*/
+	uint16_t	MinDelayTicks;		/* TX: minimum delay between two transmissions of an event.*/
+	uint16_t	OffsetTicks;		/* TX: first cyclic transmission after start; RX: first timeout, 0 = TimeoutTicks.*/
+	uint16_t	TimeoutTicks;		/* RX: deadline, 0 = not monitored.*/
+}ComTimingWheel_PduConfigType;
+
+typedef struct
+{
+	const ComTimingWheel_PduConfigType*	Pdu;
+	uint16_t	PduCount;						/* <= COM_TW_MAX_PDU.*/
+	void (*Transmit)(PduIdType pduId);
+	void (*Notify)(PduIdType pduId, NotifResultType result);
+}ComTimingWheel_ConfigType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Runtime
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define COM_TW_FLAG_RUNNING			(0x01u)
+#define COM_TW_FLAG_PENDING			(0x02u)		/* TX event waiting for the minimum delay.*/
+
+typedef struct
+{
+	uint32_t	Due;			/* Tick of the armed expiry.*/
+	uint32_t	NextCyclic;
+	uint32_t	LastTx;
+	uint16_t	Next;
+	uint16_t	Prev;
+	uint8_t		Slot;			/* level * COM_TW_SLOTS + slot, COM_TW_NOT_ARMED when not linked.*/
+	uint8_t		Flags;
+}ComTimingWheel_EntryType;
+
+typedef struct
+{
+	const ComTimingWheel_ConfigType*	Config;
+	uint32_t					Now;
+	uint16_t					Head[COM_TW_LEVELS * COM_TW_SLOTS];
+	ComTimingWheel_EntryType	Entry[COM_TW_MAX_PDU];
+}ComTimingWheel_Type;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: wrap-safe "a is before b"
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool ComTimingWheel_Before(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) < 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: slot lists
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void ComTimingWheel_Unlink(ComTimingWheel_Type* tw, uint16_t idx)
+{
+	ComTimingWheel_EntryType* e = &tw->Entry[idx];
+
+	if (e->Slot == COM_TW_NOT_ARMED)
+	{
+		return;
+	}
+	if (e->Prev != COM_TW_NONE)
+	{
+		tw->Entry[e->Prev].Next = e->Next;
+	}
+	else
+	{
+		tw->Head[e->Slot] = e->Next;
+	}
+	if (e->Next != COM_TW_NONE)
+	{
+		tw->Entry[e->Next].Prev = e->Prev;
+	}
+	e->Slot = COM_TW_NOT_ARMED;
+}
+
+/* Level from the distance to Now: < 64 ticks level 0, < 4096 level 1, else level 2 (beyond the range: the level 2
+ * slot visited last, the entry is placed again when it cascades). Due == Now goes to the current level 0 slot,
+ * only valid inside the main function before that slot is processed. */
+static inline void ComTimingWheel_Insert(ComTimingWheel_Type* tw, uint16_t idx)
+{
+	ComTimingWheel_EntryType* e = &tw->Entry[idx];
+	uint32_t delta = e->Due - tw->Now;
+	uint8_t slot;
+
+	if (delta < COM_TW_SLOTS)
+	{
+		slot = (uint8_t)(e->Due & COM_TW_SLOT_MASK);
+	}
+	else if (delta < (COM_TW_SLOTS * COM_TW_SLOTS))
+	{
+		slot = (uint8_t)(COM_TW_SLOTS + ((e->Due >> COM_TW_SLOT_BITS) & COM_TW_SLOT_MASK));
+	}
+	else if (delta < COM_TW_RANGE)
+	{
+		slot = (uint8_t)((2u * COM_TW_SLOTS) + ((e->Due >> (2u * COM_TW_SLOT_BITS)) & COM_TW_SLOT_MASK));
+	}
+	else
+	{
+		slot = (uint8_t)((2u * COM_TW_SLOTS) + (((tw->Now >> (2u * COM_TW_SLOT_BITS)) - 1u) & COM_TW_SLOT_MASK));
+	}
+
+	e->Slot = slot;
+	e->Prev = COM_TW_NONE;
+	e->Next = tw->Head[slot];
+	if (e->Next != COM_TW_NONE)
+	{
+		tw->Entry[e->Next].Prev = idx;
+	}
+	tw->Head[slot] = idx;
+}
+
+/* Re-arm at the earliest pending expiry of the PDU, or leave it unlinked when nothing is pending. */
+static inline void ComTimingWheel_Arm(ComTimingWheel_Type* tw, uint16_t idx, bool has, uint32_t due)
+{
+	ComTimingWheel_Unlink(tw, idx);
+	if (has)
+	{
+		tw->Entry[idx].Due = ComTimingWheel_Before(due, tw->Now + 1u) ? (tw->Now + 1u) : due;
+		ComTimingWheel_Insert(tw, idx);
+	}
+}
+
+static inline void ComTimingWheel_ArmTx(ComTimingWheel_Type* tw, uint16_t idx)
+{
+	const ComTimingWheel_PduConfigType* cfg = &tw->Config->Pdu[idx];
+	ComTimingWheel_EntryType* e = &tw->Entry[idx];
+	bool has = false;
+	uint32_t due = 0u;
+
+	if ((e->Flags & COM_TW_FLAG_RUNNING) != 0u)
+	{
+		if (cfg->PeriodTicks != 0u)
+		{
+			due = e->NextCyclic;
+			has = true;
+		}
+		if ((e->Flags & COM_TW_FLAG_PENDING) != 0u)
+		{
+			uint32_t ev = e->LastTx + cfg->MinDelayTicks;
+			if (!has || ComTimingWheel_Before(ev, due))
+			{
+				due = ev;
+			}
+			has = true;
+		}
+	}
+	ComTimingWheel_Arm(tw, idx, has, due);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: expiry of one PDU (entry already unlinked)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void ComTimingWheel_Expire(ComTimingWheel_Type* tw, uint16_t idx)
+{
+	const ComTimingWheel_ConfigType* config = tw->Config;
+	const ComTimingWheel_PduConfigType* cfg = &config->Pdu[idx];
+	ComTimingWheel_EntryType* e = &tw->Entry[idx];
+	uint32_t now = tw->Now;
+	bool send = false;
+
+	if (cfg->Direction == COM_TW_RX)
+	{
+		ComTimingWheel_Arm(tw, idx, true, now + cfg->TimeoutTicks);
+		if (config->Notify != NULL)
+		{
+			config->Notify((PduIdType)idx, COM_TW_RX_TIMEOUT_RESULT);
+		}
+		return;
+	}
+
+	if ((cfg->PeriodTicks != 0u) && !ComTimingWheel_Before(now, e->NextCyclic))
+	{
+		e->NextCyclic += cfg->PeriodTicks;
+		if (!ComTimingWheel_Before(now, e->NextCyclic))
+		{
+			e->NextCyclic = now + cfg->PeriodTicks;		/* Late (stopped main function): no burst.*/
+		}
+		send = true;
+	}
+	if (((e->Flags & COM_TW_FLAG_PENDING) != 0u) && !ComTimingWheel_Before(now, e->LastTx + cfg->MinDelayTicks))
+	{
+		send = true;
+	}
+	if (send)
+	{
+		e->Flags &= (uint8_t)~COM_TW_FLAG_PENDING;		/* A cyclic transmission carries the event too.*/
+		e->LastTx = now;
+	}
+
+	ComTimingWheel_ArmTx(tw, idx);
+	if (send && (config->Transmit != NULL))
+	{
+		config->Transmit((PduIdType)idx);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  API
+ * -------------------------------------------------------------------------------------------------------------------*/
+/* E_NOT_OK: config->PduCount > COM_TW_MAX_PDU, tw left untouched. */
+static inline Std_ReturnType ComTimingWheel_Init(ComTimingWheel_Type* tw, const ComTimingWheel_ConfigType* config,
+												 uint32_t now)
+{
+	uint16_t i;
+
+	if (config->PduCount > COM_TW_MAX_PDU)
+	{
+		return E_NOT_OK;
+	}
+
+	tw->Config = config;
+	tw->Now = now;
+	for (i = 0u; i < (uint16_t)(COM_TW_LEVELS * COM_TW_SLOTS); i++)
+	{
+		tw->Head[i] = COM_TW_NONE;
+	}
+	for (i = 0u; i < COM_TW_MAX_PDU; i++)
+	{
+		tw->Entry[i].Slot = COM_TW_NOT_ARMED;
+		tw->Entry[i].Flags = 0u;
+	}
+	return E_OK;
+}
+
+/* Start cyclic transmission / deadline monitoring of a PDU (I-PDU group start). */
+static inline Std_ReturnType ComTimingWheel_Start(ComTimingWheel_Type* tw, PduIdType pduId)
+{
+	const ComTimingWheel_PduConfigType* cfg;
+	ComTimingWheel_EntryType* e;
+
+	if (pduId >= tw->Config->PduCount)
+	{
+		return E_NOT_OK;
+	}
+
+	cfg = &tw->Config->Pdu[pduId];
+	e = &tw->Entry[pduId];
+	e->Flags = COM_TW_FLAG_RUNNING;
+	if (cfg->Direction == COM_TW_RX)
+	{
+		uint16_t first = (cfg->OffsetTicks != 0u) ? cfg->OffsetTicks : cfg->TimeoutTicks;
+		ComTimingWheel_Arm(tw, pduId, cfg->TimeoutTicks != 0u, tw->Now + first);
+	}
+	else
+	{
+		e->NextCyclic = tw->Now + cfg->OffsetTicks;
+		e->LastTx = tw->Now - cfg->MinDelayTicks;
+		ComTimingWheel_ArmTx(tw, pduId);
+	}
+	return E_OK;
+}
+
+static inline void ComTimingWheel_Stop(ComTimingWheel_Type* tw, PduIdType pduId)
+{
+	if (pduId < tw->Config->PduCount)
+	{
+		ComTimingWheel_Unlink(tw, pduId);
+		tw->Entry[pduId].Flags = 0u;
+	}
+}
+
+/* Event transmission request (signal changed): sent once the minimum delay since the last transmission elapsed,
+ * at the earliest on the next tick. Several requests before that give one transmission. */
+static inline Std_ReturnType ComTimingWheel_Trigger(ComTimingWheel_Type* tw, PduIdType pduId)
+{
+	ComTimingWheel_EntryType* e;
+
+	if ((pduId >= tw->Config->PduCount) || (tw->Config->Pdu[pduId].Direction != COM_TW_TX))
+	{
+		return E_NOT_OK;
+	}
+
+	e = &tw->Entry[pduId];
+	if ((e->Flags & COM_TW_FLAG_RUNNING) == 0u)
+	{
+		return E_NOT_OK;
+	}
+	if ((e->Flags & COM_TW_FLAG_PENDING) == 0u)
+	{
+		e->Flags |= COM_TW_FLAG_PENDING;
+		ComTimingWheel_ArmTx(tw, pduId);
+	}
+	return E_OK;
+}
+
+/* Reception of a monitored RX PDU: restart its deadline. */
+static inline void ComTimingWheel_RxIndication(ComTimingWheel_Type* tw, PduIdType pduId)
+{
+	const ComTimingWheel_PduConfigType* cfg;
+
+	if ((pduId >= tw->Config->PduCount) || ((tw->Entry[pduId].Flags & COM_TW_FLAG_RUNNING) == 0u))
+	{
+		return;
+	}
+
+	cfg = &tw->Config->Pdu[pduId];
+	if ((cfg->Direction == COM_TW_RX) && (cfg->TimeoutTicks != 0u))
+	{
+		ComTimingWheel_Arm(tw, pduId, true, tw->Now + cfg->TimeoutTicks);
+	}
+}
+
+/* Advance one tick: cascade the upper levels when their slot comes up, then expire the current level 0 slot.
+ * Returns the number of expired PDUs. */
+static inline uint16_t ComTimingWheel_MainFunction(ComTimingWheel_Type* tw)
+{
+	uint16_t fired = 0u;
+	uint8_t level;
+	uint8_t slot;
+	uint16_t idx;
+
+	tw->Now++;
+	if ((tw->Now & COM_TW_SLOT_MASK) == 0u)
+	{
+		/* Level 2 first, its entries may land in the level 1 slot cascaded right after. */
+		for (level = (uint8_t)(COM_TW_LEVELS - 1u); level >= 1u; level--)
+		{
+			if ((level == 2u) && (((tw->Now >> COM_TW_SLOT_BITS) & COM_TW_SLOT_MASK) != 0u))
+			{
+				continue;
+			}
+			slot = (uint8_t)((level * COM_TW_SLOTS) + ((tw->Now >> (level * COM_TW_SLOT_BITS)) & COM_TW_SLOT_MASK));
+			while ((idx = tw->Head[slot]) != COM_TW_NONE)
+			{
+				ComTimingWheel_Unlink(tw, idx);
+				ComTimingWheel_Insert(tw, idx);
+			}
+		}
+	}
+
+	slot = (uint8_t)(tw->Now & COM_TW_SLOT_MASK);
+	while ((idx = tw->Head[slot]) != COM_TW_NONE)
+	{
+		ComTimingWheel_Unlink(tw, idx);
+		ComTimingWheel_Expire(tw, idx);
+		fired++;
+	}
+	return fired;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMTIMINGWHEEL_H_ */
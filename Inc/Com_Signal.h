@@ -0,0 +1,288 @@
+/* =====================================================================================================================
+ *  File        : Com_Signal.h
+ *  Layer       : Services
+ *  Purpose     : Precomputed bit-field signal pack/unpack engine for Com
+ *                 - Signal described once (start bit, length, Intel/Motorola, signedness), compiled at init to
+ *                   a window: first byte, byte count, shift and mask.
+ *                 - Pack/unpack = load the window as one word, shift, mask, store: no per-bit loop.
+ *                 - A signal group (all signals of one PDU) is packed/unpacked in one pass over its layouts.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Bit numbering follows the DBC convention:
+ *                  - Intel    (little endian): StartBit = LSB, bits grow towards higher bytes.
+ *                  - Motorola (big endian)   : StartBit = MSB, bits go down within a byte, byte N bit 0 is followed
+ *                                              by byte N+1 bit 7.
+ *                Signal length 1..32 bits, window up to 5 bytes (uint32 arithmetic up to 4 bytes).
+ * ===================================================================================================================*/
+
+#ifndef COM_SIGNAL_H_
+#define COM_SIGNAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define COM_SIGNAL_AR_MAJOR_VERSION		(1u)
+#define COM_SIGNAL_AR_MINOR_VERSION		(0u)
+#define COM_SIGNAL_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+
+#define COM_SIGNAL_MAX_LENGTH		(32u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Signal description (configuration)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	COM_LITTLE_ENDIAN = 0,		/* Intel. */
+	COM_BIG_ENDIAN				/* Motorola. */
+}Com_SignalEndiannessType;
+
+typedef struct
+{
+	uint16_t					StartBit;
+	uint8_t						Length;			/* 1..32 bits.*/
+	Com_SignalEndiannessType	ByteOrder;
+	bool						Signed;
+}Com_SignalConfigType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Compiled layout (Com_SignalCompile)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint32_t	Mask;			/* Length low bits set.*/
+	uint32_t	SignBit;		/* 1 << (Length - 1) for signed signals, 0 otherwise.*/
+	uint16_t	ByteOffset;		/* First byte of the window.*/
+	uint8_t		NumBytes;		/* Window size, 1..5.*/
+	uint8_t		Shift;			/* Position of the signal LSB inside the window.*/
+	uint8_t		BigEndian;		/* Window byte order.*/
+}Com_SignalLayoutType;
+
+typedef struct
+{
+	const Com_SignalLayoutType*	Layout;
+	uint8_t						Count;
+}Com_SignalGroupType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Compile one signal for a PDU of pduLength bytes
+ *  - E_NOT_OK: bad length or signal outside the PDU.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType Com_SignalCompile(const Com_SignalConfigType* cfg, PduLengthType pduLength,
+											   Com_SignalLayoutType* layout)
+{
+	uint32_t first;
+	uint32_t last;
+
+	if ((cfg->Length == 0u) || (cfg->Length > COM_SIGNAL_MAX_LENGTH))
+	{
+		return E_NOT_OK;
+	}
+
+	if (cfg->ByteOrder == COM_LITTLE_ENDIAN)
+	{
+		first = cfg->StartBit / 8u;
+		last = ((uint32_t)cfg->StartBit + cfg->Length - 1u) / 8u;
+		layout->Shift = (uint8_t)(cfg->StartBit % 8u);
+	}
+	else
+	{
+		/* Linear big-endian position: byte * 8 + (7 - bit), MSB of byte 0 is position 0. */
+		uint32_t msbLinear = ((uint32_t)(cfg->StartBit / 8u) * 8u) + (7u - (cfg->StartBit % 8u));
+		uint32_t lsbLinear = msbLinear + cfg->Length - 1u;
+
+		first = msbLinear / 8u;
+		last = lsbLinear / 8u;
+		layout->Shift = (uint8_t)(7u - (lsbLinear % 8u));
+	}
+
+	if (last >= pduLength)
+	{
+		return E_NOT_OK;
+	}
+
+	layout->Mask = (cfg->Length == 32u) ? 0xFFFFFFFFu : ((1ul << cfg->Length) - 1u);
+	layout->SignBit = cfg->Signed ? (1ul << (cfg->Length - 1u)) : 0u;
+	layout->ByteOffset = (uint16_t)first;
+	layout->NumBytes = (uint8_t)(last - first + 1u);
+	layout->BigEndian = (cfg->ByteOrder == COM_BIG_ENDIAN) ? 1u : 0u;
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: load / store a window of n bytes (n <= 4 as uint32, n == 5 as uint64)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint64_t Com_SignalLoad(const uint8_t* p, uint8_t n, uint8_t bigEndian)
+{
+	uint64_t w = 0u;
+	uint8_t i;
+
+	if (bigEndian != 0u)
+	{
+		for (i = 0u; i < n; i++)
+		{
+			w = (w << 8) | p[i];
+		}
+	}
+	else
+	{
+		for (i = n; i > 0u; i--)
+		{
+			w = (w << 8) | p[i - 1u];
+		}
+	}
+	return w;
+}
+
+static inline void Com_SignalStore(uint8_t* p, uint8_t n, uint8_t bigEndian, uint64_t w)
+{
+	uint8_t i;
+
+	if (bigEndian != 0u)
+	{
+		for (i = n; i > 0u; i--)
+		{
+			p[i - 1u] = (uint8_t)w;
+			w >>= 8;
+		}
+	}
+	else
+	{
+		for (i = 0u; i < n; i++)
+		{
+			p[i] = (uint8_t)w;
+			w >>= 8;
+		}
+	}
+}
+
+static inline uint32_t Com_SignalLoad32(const uint8_t* p, uint8_t n, uint8_t bigEndian)
+{
+	uint32_t w = 0u;
+	uint8_t i;
+
+	if (bigEndian != 0u)
+	{
+		for (i = 0u; i < n; i++)
+		{
+			w = (w << 8) | p[i];
+		}
+	}
+	else
+	{
+		for (i = n; i > 0u; i--)
+		{
+			w = (w << 8) | p[i - 1u];
+		}
+	}
+	return w;
+}
+
+static inline void Com_SignalStore32(uint8_t* p, uint8_t n, uint8_t bigEndian, uint32_t w)
+{
+	uint8_t i;
+
+	if (bigEndian != 0u)
+	{
+		for (i = n; i > 0u; i--)
+		{
+			p[i - 1u] = (uint8_t)w;
+			w >>= 8;
+		}
+	}
+	else
+	{
+		for (i = 0u; i < n; i++)
+		{
+			p[i] = (uint8_t)w;
+			w >>= 8;
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Pack one signal into data (value truncated to the signal length, other bits of the window untouched)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void Com_SignalPack(const Com_SignalLayoutType* layout, uint8_t* data, uint32_t value)
+{
+	uint8_t* p = &data[layout->ByteOffset];
+	uint32_t v = value & layout->Mask;
+
+	if (layout->NumBytes == 1u)
+	{
+		uint8_t m = (uint8_t)(layout->Mask << layout->Shift);
+		*p = (uint8_t)((*p & (uint8_t)~m) | (uint8_t)(v << layout->Shift));
+	}
+	else if (layout->NumBytes <= 4u)
+	{
+		uint32_t m = layout->Mask << layout->Shift;
+		uint32_t w = Com_SignalLoad32(p, layout->NumBytes, layout->BigEndian);
+		Com_SignalStore32(p, layout->NumBytes, layout->BigEndian, (w & ~m) | (v << layout->Shift));
+	}
+	else
+	{
+		uint64_t m = (uint64_t)layout->Mask << layout->Shift;
+		uint64_t w = Com_SignalLoad(p, layout->NumBytes, layout->BigEndian);
+		Com_SignalStore(p, layout->NumBytes, layout->BigEndian, (w & ~m) | ((uint64_t)v << layout->Shift));
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Unpack one signal (signed signals are sign extended to 32 bits)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint32_t Com_SignalUnpack(const Com_SignalLayoutType* layout, const uint8_t* data)
+{
+	const uint8_t* p = &data[layout->ByteOffset];
+	uint32_t v;
+
+	if (layout->NumBytes == 1u)
+	{
+		v = ((uint32_t)*p >> layout->Shift) & layout->Mask;
+	}
+	else if (layout->NumBytes <= 4u)
+	{
+		v = (Com_SignalLoad32(p, layout->NumBytes, layout->BigEndian) >> layout->Shift) & layout->Mask;
+	}
+	else
+	{
+		v = (uint32_t)(Com_SignalLoad(p, layout->NumBytes, layout->BigEndian) >> layout->Shift) & layout->Mask;
+	}
+
+	/* (v ^ s) - s sign extends when s is the sign bit, no-op when s == 0. */
+	return (v ^ layout->SignBit) - layout->SignBit;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Signal group: pack/unpack every signal of one PDU in one pass (values[i] <-> Layout[i])
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void Com_SignalGroupPack(const Com_SignalGroupType* group, const uint32_t* values, PduInfoType* pdu)
+{
+	uint8_t i;
+
+	for (i = 0u; i < group->Count; i++)
+	{
+		Com_SignalPack(&group->Layout[i], pdu->SduDataPtr, values[i]);
+	}
+}
+
+static inline void Com_SignalGroupUnpack(const Com_SignalGroupType* group, const PduInfoType* pdu, uint32_t* values)
+{
+	uint8_t i;
+
+	for (i = 0u; i < group->Count; i++)
+	{
+		values[i] = Com_SignalUnpack(&group->Layout[i], pdu->SduDataPtr);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COM_SIGNAL_H_ */
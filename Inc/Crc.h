@@ -0,0 +1,379 @@
+/* =====================================================================================================================
+ *  File        : Crc.h
+ *  Layer       : Shared
+ *  Purpose     : CRC library for E2E protection and framing (AUTOSAR Crc style API)
+ *                 - CRC-8 SAE J1850     : poly 0x1D,       init 0xFF,       xor-out 0xFF,       check 0x4B
+ *                 - CRC-8 H2F           : poly 0x2F,       init 0xFF,       xor-out 0xFF,       check 0xDF
+ *                 - CRC-16 CCITT-FALSE  : poly 0x1021,     init 0xFFFF,     xor-out 0x0000,     check 0x29B1
+ *                 - CRC-32 IEEE 802.3   : poly 0x04C11DB7, init 0xFFFFFFFF, xor-out 0xFFFFFFFF, check 0xCBF43926
+ *                   (reflected), check = CRC of the ASCII string "123456789".
+ *                 - Streaming: the first call uses the init value, later calls pass the previous result as start
+ *                   value with IsFirstCall = false (TP payloads chunk by chunk).
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Kernel per algorithm selected at compile time with CRC_<ALGO>_MODE (flash / speed trade-off):
+ *                  CRC_MODE_BITWISE : no table,                  ~8 shift/xor steps per byte.
+ *                  CRC_MODE_NIBBLE  : 16-entry table,            2 lookups per byte.
+ *                  CRC_MODE_TABLE   : 256-entry table,           1 lookup per byte.
+ *                  CRC_MODE_SLICE4  : 4 x 256-entry tables,      4 independent lookups per 4 bytes.
+ *                  CRC_MODE_SLICE8  : 8 x 256-entry tables,      8 independent lookups per 8 bytes.
+ *                All kernels are available directly (Crc_<Width><Variant>), the modes only pick the tables
+ *                compiled in and the kernel behind Crc_CalculateCRC<ALGO>.
+ * ===================================================================================================================*/
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CRC_AR_MAJOR_VERSION		(1u)
+#define CRC_AR_MINOR_VERSION		(0u)
+#define CRC_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Kernel selection
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CRC_MODE_BITWISE		(0u)
+#define CRC_MODE_NIBBLE			(1u)
+#define CRC_MODE_TABLE			(2u)
+#define CRC_MODE_SLICE4			(3u)
+#define CRC_MODE_SLICE8			(4u)
+
+/* Table flash per algorithm (see Crc_Tables.h) is paid once per translation unit calling it, unless the project
+ * defines CRC_TABLES_EXTERN and one .c file CRC_TABLES_DEFINE. */
+#ifndef CRC_8_MODE
+#define CRC_8_MODE				CRC_MODE_TABLE
+#endif
+
+#ifndef CRC_8H2F_MODE
+#define CRC_8H2F_MODE			CRC_MODE_TABLE
+#endif
+
+#ifndef CRC_16_MODE
+#define CRC_16_MODE				CRC_MODE_TABLE
+#endif
+
+#ifndef CRC_32_MODE
+#define CRC_32_MODE				CRC_MODE_TABLE
+#endif
+
+#define CRC_SLICES(mode)		(((mode) == CRC_MODE_SLICE8) ? 8u : (((mode) == CRC_MODE_SLICE4) ? 4u : 1u))
+#define CRC_8_SLICES			CRC_SLICES(CRC_8_MODE)
+#define CRC_8H2F_SLICES			CRC_SLICES(CRC_8H2F_MODE)
+#define CRC_16_SLICES			CRC_SLICES(CRC_16_MODE)
+#define CRC_32_SLICES			CRC_SLICES(CRC_32_MODE)
+
+#include "Crc_Tables.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Parameters
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define CRC_8_POLY				(0x1Du)
+#define CRC_8_INIT				(0xFFu)
+#define CRC_8_XOR				(0xFFu)
+#define CRC_8_CHECK				(0x4Bu)
+
+#define CRC_8H2F_POLY			(0x2Fu)
+#define CRC_8H2F_INIT			(0xFFu)
+#define CRC_8H2F_XOR			(0xFFu)
+#define CRC_8H2F_CHECK			(0xDFu)
+
+#define CRC_16_POLY				(0x1021u)
+#define CRC_16_INIT				(0xFFFFu)
+#define CRC_16_XOR				(0x0000u)
+#define CRC_16_CHECK			(0x29B1u)
+
+#define CRC_32_POLY				(0xEDB88320uL)		/* 0x04C11DB7 reflected.*/
+#define CRC_32_INIT				(0xFFFFFFFFuL)
+#define CRC_32_XOR				(0xFFFFFFFFuL)
+#define CRC_32_CHECK			(0xCBF43926uL)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  8-bit kernels, MSB first, operate on the raw register (no init / xor-out)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t Crc_8Bitwise(uint8_t crc, uint8_t poly, const uint8_t* p, uint32_t len)
+{
+	uint8_t b;
+
+	while (len-- != 0u)
+	{
+		crc ^= *p++;
+		for (b = 0u; b < 8u; b++)
+		{
+			crc = ((crc & 0x80u) != 0u) ? (uint8_t)((crc << 1) ^ poly) : (uint8_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static inline uint8_t Crc_8Nibble(uint8_t crc, const uint8_t nib[16], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc ^= *p++;
+		crc = (uint8_t)((crc << 4) ^ nib[crc >> 4]);
+		crc = (uint8_t)((crc << 4) ^ nib[crc >> 4]);
+	}
+	return crc;
+}
+
+static inline uint8_t Crc_8Table(uint8_t crc, const uint8_t t[256], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc = t[crc ^ *p++];
+	}
+	return crc;
+}
+
+static inline uint8_t Crc_8Slice4(uint8_t crc, const uint8_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 4u)
+	{
+		crc = (uint8_t)(t[3][crc ^ p[0]] ^ t[2][p[1]] ^ t[1][p[2]] ^ t[0][p[3]]);
+		p += 4;
+		len -= 4u;
+	}
+	return Crc_8Table(crc, t[0], p, len);
+}
+
+static inline uint8_t Crc_8Slice8(uint8_t crc, const uint8_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 8u)
+	{
+		crc = (uint8_t)(t[7][crc ^ p[0]] ^ t[6][p[1]] ^ t[5][p[2]] ^ t[4][p[3]] ^
+						t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]]);
+		p += 8;
+		len -= 8u;
+	}
+	return Crc_8Table(crc, t[0], p, len);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  16-bit kernels, MSB first
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint16_t Crc_16Bitwise(uint16_t crc, uint16_t poly, const uint8_t* p, uint32_t len)
+{
+	uint8_t b;
+
+	while (len-- != 0u)
+	{
+		crc ^= (uint16_t)((uint16_t)*p++ << 8);
+		for (b = 0u; b < 8u; b++)
+		{
+			crc = ((crc & 0x8000u) != 0u) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static inline uint16_t Crc_16Nibble(uint16_t crc, const uint16_t nib[16], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc ^= (uint16_t)((uint16_t)*p++ << 8);
+		crc = (uint16_t)((crc << 4) ^ nib[crc >> 12]);
+		crc = (uint16_t)((crc << 4) ^ nib[crc >> 12]);
+	}
+	return crc;
+}
+
+static inline uint16_t Crc_16Table(uint16_t crc, const uint16_t t[256], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc = (uint16_t)((crc << 8) ^ t[(crc >> 8) ^ *p++]);
+	}
+	return crc;
+}
+
+static inline uint16_t Crc_16Slice4(uint16_t crc, const uint16_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 4u)
+	{
+		crc = (uint16_t)(t[3][(crc >> 8) ^ p[0]] ^ t[2][(crc & 0xFFu) ^ p[1]] ^ t[1][p[2]] ^ t[0][p[3]]);
+		p += 4;
+		len -= 4u;
+	}
+	return Crc_16Table(crc, t[0], p, len);
+}
+
+static inline uint16_t Crc_16Slice8(uint16_t crc, const uint16_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 8u)
+	{
+		crc = (uint16_t)(t[7][(crc >> 8) ^ p[0]] ^ t[6][(crc & 0xFFu) ^ p[1]] ^ t[5][p[2]] ^ t[4][p[3]] ^
+						 t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]]);
+		p += 8;
+		len -= 8u;
+	}
+	return Crc_16Table(crc, t[0], p, len);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  32-bit kernels, reflected (LSB first)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint32_t Crc_32Bitwise(uint32_t crc, uint32_t poly, const uint8_t* p, uint32_t len)
+{
+	uint8_t b;
+
+	while (len-- != 0u)
+	{
+		crc ^= *p++;
+		for (b = 0u; b < 8u; b++)
+		{
+			crc = ((crc & 1u) != 0u) ? ((crc >> 1) ^ poly) : (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+static inline uint32_t Crc_32Nibble(uint32_t crc, const uint32_t nib[16], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc ^= *p++;
+		crc = (crc >> 4) ^ nib[crc & 0x0Fu];
+		crc = (crc >> 4) ^ nib[crc & 0x0Fu];
+	}
+	return crc;
+}
+
+static inline uint32_t Crc_32Table(uint32_t crc, const uint32_t t[256], const uint8_t* p, uint32_t len)
+{
+	while (len-- != 0u)
+	{
+		crc = (crc >> 8) ^ t[(crc ^ *p++) & 0xFFu];
+	}
+	return crc;
+}
+
+/* Byte loads, so the data pointer may have any alignment. */
+static inline uint32_t Crc_32Load(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t Crc_32Slice4(uint32_t crc, const uint32_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 4u)
+	{
+		crc ^= Crc_32Load(p);
+		crc = t[3][crc & 0xFFu] ^ t[2][(crc >> 8) & 0xFFu] ^ t[1][(crc >> 16) & 0xFFu] ^ t[0][crc >> 24];
+		p += 4;
+		len -= 4u;
+	}
+	return Crc_32Table(crc, t[0], p, len);
+}
+
+static inline uint32_t Crc_32Slice8(uint32_t crc, const uint32_t t[][256], const uint8_t* p, uint32_t len)
+{
+	while (len >= 8u)
+	{
+		uint32_t hi = Crc_32Load(&p[4]);
+
+		crc ^= Crc_32Load(p);
+		crc = t[7][crc & 0xFFu] ^ t[6][(crc >> 8) & 0xFFu] ^ t[5][(crc >> 16) & 0xFFu] ^ t[4][crc >> 24] ^
+			  t[3][hi & 0xFFu] ^ t[2][(hi >> 8) & 0xFFu] ^ t[1][(hi >> 16) & 0xFFu] ^ t[0][hi >> 24];
+		p += 8;
+		len -= 8u;
+	}
+	return Crc_32Table(crc, t[0], p, len);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Dispatch to the configured kernel
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (CRC_8_MODE == CRC_MODE_BITWISE)
+#define CRC_8_UPDATE(crc, p, len)		Crc_8Bitwise((crc), CRC_8_POLY, (p), (len))
+#elif (CRC_8_MODE == CRC_MODE_NIBBLE)
+#define CRC_8_UPDATE(crc, p, len)		Crc_8Nibble((crc), Crc_Nibble8, (p), (len))
+#elif (CRC_8_MODE == CRC_MODE_TABLE)
+#define CRC_8_UPDATE(crc, p, len)		Crc_8Table((crc), Crc_Table8[0], (p), (len))
+#elif (CRC_8_MODE == CRC_MODE_SLICE4)
+#define CRC_8_UPDATE(crc, p, len)		Crc_8Slice4((crc), Crc_Table8, (p), (len))
+#else
+#define CRC_8_UPDATE(crc, p, len)		Crc_8Slice8((crc), Crc_Table8, (p), (len))
+#endif
+
+#if (CRC_8H2F_MODE == CRC_MODE_BITWISE)
+#define CRC_8H2F_UPDATE(crc, p, len)	Crc_8Bitwise((crc), CRC_8H2F_POLY, (p), (len))
+#elif (CRC_8H2F_MODE == CRC_MODE_NIBBLE)
+#define CRC_8H2F_UPDATE(crc, p, len)	Crc_8Nibble((crc), Crc_Nibble8H2F, (p), (len))
+#elif (CRC_8H2F_MODE == CRC_MODE_TABLE)
+#define CRC_8H2F_UPDATE(crc, p, len)	Crc_8Table((crc), Crc_Table8H2F[0], (p), (len))
+#elif (CRC_8H2F_MODE == CRC_MODE_SLICE4)
+#define CRC_8H2F_UPDATE(crc, p, len)	Crc_8Slice4((crc), Crc_Table8H2F, (p), (len))
+#else
+#define CRC_8H2F_UPDATE(crc, p, len)	Crc_8Slice8((crc), Crc_Table8H2F, (p), (len))
+#endif
+
+#if (CRC_16_MODE == CRC_MODE_BITWISE)
+#define CRC_16_UPDATE(crc, p, len)		Crc_16Bitwise((crc), CRC_16_POLY, (p), (len))
+#elif (CRC_16_MODE == CRC_MODE_NIBBLE)
+#define CRC_16_UPDATE(crc, p, len)		Crc_16Nibble((crc), Crc_Nibble16, (p), (len))
+#elif (CRC_16_MODE == CRC_MODE_TABLE)
+#define CRC_16_UPDATE(crc, p, len)		Crc_16Table((crc), Crc_Table16[0], (p), (len))
+#elif (CRC_16_MODE == CRC_MODE_SLICE4)
+#define CRC_16_UPDATE(crc, p, len)		Crc_16Slice4((crc), Crc_Table16, (p), (len))
+#else
+#define CRC_16_UPDATE(crc, p, len)		Crc_16Slice8((crc), Crc_Table16, (p), (len))
+#endif
+
+#if (CRC_32_MODE == CRC_MODE_BITWISE)
+#define CRC_32_UPDATE(crc, p, len)		Crc_32Bitwise((crc), CRC_32_POLY, (p), (len))
+#elif (CRC_32_MODE == CRC_MODE_NIBBLE)
+#define CRC_32_UPDATE(crc, p, len)		Crc_32Nibble((crc), Crc_Nibble32, (p), (len))
+#elif (CRC_32_MODE == CRC_MODE_TABLE)
+#define CRC_32_UPDATE(crc, p, len)		Crc_32Table((crc), Crc_Table32[0], (p), (len))
+#elif (CRC_32_MODE == CRC_MODE_SLICE4)
+#define CRC_32_UPDATE(crc, p, len)		Crc_32Slice4((crc), Crc_Table32, (p), (len))
+#else
+#define CRC_32_UPDATE(crc, p, len)		Crc_32Slice8((crc), Crc_Table32, (p), (len))
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  API
+ *  - startValue is ignored when isFirstCall is true, otherwise it is the result of the previous call.
+ *  - E2E over a PDU: Crc_CalculateCRC8(info->SduDataPtr, info->SduLength, 0u, true).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t Crc_CalculateCRC8(const uint8_t* data, uint32_t len, uint8_t startValue, bool isFirstCall)
+{
+	uint8_t crc = isFirstCall ? CRC_8_INIT : (uint8_t)(startValue ^ CRC_8_XOR);
+
+	return (uint8_t)(CRC_8_UPDATE(crc, data, len) ^ CRC_8_XOR);
+}
+
+static inline uint8_t Crc_CalculateCRC8H2F(const uint8_t* data, uint32_t len, uint8_t startValue, bool isFirstCall)
+{
+	uint8_t crc = isFirstCall ? CRC_8H2F_INIT : (uint8_t)(startValue ^ CRC_8H2F_XOR);
+
+	return (uint8_t)(CRC_8H2F_UPDATE(crc, data, len) ^ CRC_8H2F_XOR);
+}
+
+static inline uint16_t Crc_CalculateCRC16(const uint8_t* data, uint32_t len, uint16_t startValue, bool isFirstCall)
+{
+	uint16_t crc = isFirstCall ? CRC_16_INIT : (uint16_t)(startValue ^ CRC_16_XOR);
+
+	return (uint16_t)(CRC_16_UPDATE(crc, data, len) ^ CRC_16_XOR);
+}
+
+static inline uint32_t Crc_CalculateCRC32(const uint8_t* data, uint32_t len, uint32_t startValue, bool isFirstCall)
+{
+	uint32_t crc = isFirstCall ? CRC_32_INIT : (startValue ^ CRC_32_XOR);
+
+	return CRC_32_UPDATE(crc, data, len) ^ CRC_32_XOR;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC_H_ */
@@ -0,0 +1,979 @@
+/* =====================================================================================================================
+ *  File        : Crc_Tables.h
+ *  Layer       : Shared
+ *  Purpose     : Constant lookup tables for Crc.h (flash, never RAM)
+ *                 - Nibble table: 16 entries, used by CRC_MODE_NIBBLE.
+ *                 - Slice tables: Table[k][b] = CRC register after byte b followed by k zero bytes (register starts
+ *                   at 0). Table[0] alone is the classic byte table, slice-by-N uses Table[0..N-1].
+ *                 - Only the tables of the selected CRC_<ALGO>_MODE are compiled in.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Generated offline from the polynomials in the section titles, do not edit by hand.
+ *                Included by Crc.h only.
+ *                Storage: by default every table is static const, so each translation unit that calls a CRC keeps
+ *                its own copy of the tables it uses. Define CRC_TABLES_EXTERN project wide to get extern
+ *                declarations instead, and CRC_TABLES_DEFINE in exactly one .c file (before Crc.h) to hold the
+ *                only copy.
+ *                Flash per algorithm (bytes): nibble 16 * w, table 256 * w, slice-by-4 1024 * w, slice-by-8 2048 * w,
+ *                w = width / 8.
+ * ===================================================================================================================*/
+
+#ifndef CRC_TABLES_H_
+#define CRC_TABLES_H_
+
+#ifndef CRC_H_
+#error "Crc_Tables.h is included by Crc.h only"
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Storage (see Note)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if defined(CRC_TABLES_EXTERN)
+#if (CRC_8_MODE == CRC_MODE_NIBBLE)
+extern const uint8_t Crc_Nibble8[16];
+#endif
+#if (CRC_8_MODE >= CRC_MODE_TABLE)
+extern const uint8_t Crc_Table8[CRC_8_SLICES][256];
+#endif
+#if (CRC_8H2F_MODE == CRC_MODE_NIBBLE)
+extern const uint8_t Crc_Nibble8H2F[16];
+#endif
+#if (CRC_8H2F_MODE >= CRC_MODE_TABLE)
+extern const uint8_t Crc_Table8H2F[CRC_8H2F_SLICES][256];
+#endif
+#if (CRC_16_MODE == CRC_MODE_NIBBLE)
+extern const uint16_t Crc_Nibble16[16];
+#endif
+#if (CRC_16_MODE >= CRC_MODE_TABLE)
+extern const uint16_t Crc_Table16[CRC_16_SLICES][256];
+#endif
+#if (CRC_32_MODE == CRC_MODE_NIBBLE)
+extern const uint32_t Crc_Nibble32[16];
+#endif
+#if (CRC_32_MODE >= CRC_MODE_TABLE)
+extern const uint32_t Crc_Table32[CRC_32_SLICES][256];
+#endif
+
+#define CRC_TABLE_CONST			const
+#else
+#define CRC_TABLE_CONST			static const
+#endif
+
+#if !defined(CRC_TABLES_EXTERN) || defined(CRC_TABLES_DEFINE)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CRC-8 SAE J1850 (poly 0x1D)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (CRC_8_MODE == CRC_MODE_NIBBLE)
+CRC_TABLE_CONST uint8_t Crc_Nibble8[16] =
+{
+	0x00u, 0x1Du, 0x3Au, 0x27u, 0x74u, 0x69u, 0x4Eu, 0x53u, 0xE8u, 0xF5u, 0xD2u, 0xCFu, 0x9Cu, 0x81u, 0xA6u, 0xBBu
+};
+#endif
+
+#if (CRC_8_MODE >= CRC_MODE_TABLE)
+CRC_TABLE_CONST uint8_t Crc_Table8[CRC_8_SLICES][256] =
+{
+	{
+		0x00u, 0x1Du, 0x3Au, 0x27u, 0x74u, 0x69u, 0x4Eu, 0x53u, 0xE8u, 0xF5u, 0xD2u, 0xCFu, 0x9Cu, 0x81u, 0xA6u, 0xBBu,
+		0xCDu, 0xD0u, 0xF7u, 0xEAu, 0xB9u, 0xA4u, 0x83u, 0x9Eu, 0x25u, 0x38u, 0x1Fu, 0x02u, 0x51u, 0x4Cu, 0x6Bu, 0x76u,
+		0x87u, 0x9Au, 0xBDu, 0xA0u, 0xF3u, 0xEEu, 0xC9u, 0xD4u, 0x6Fu, 0x72u, 0x55u, 0x48u, 0x1Bu, 0x06u, 0x21u, 0x3Cu,
+		0x4Au, 0x57u, 0x70u, 0x6Du, 0x3Eu, 0x23u, 0x04u, 0x19u, 0xA2u, 0xBFu, 0x98u, 0x85u, 0xD6u, 0xCBu, 0xECu, 0xF1u,
+		0x13u, 0x0Eu, 0x29u, 0x34u, 0x67u, 0x7Au, 0x5Du, 0x40u, 0xFBu, 0xE6u, 0xC1u, 0xDCu, 0x8Fu, 0x92u, 0xB5u, 0xA8u,
+		0xDEu, 0xC3u, 0xE4u, 0xF9u, 0xAAu, 0xB7u, 0x90u, 0x8Du, 0x36u, 0x2Bu, 0x0Cu, 0x11u, 0x42u, 0x5Fu, 0x78u, 0x65u,
+		0x94u, 0x89u, 0xAEu, 0xB3u, 0xE0u, 0xFDu, 0xDAu, 0xC7u, 0x7Cu, 0x61u, 0x46u, 0x5Bu, 0x08u, 0x15u, 0x32u, 0x2Fu,
+		0x59u, 0x44u, 0x63u, 0x7Eu, 0x2Du, 0x30u, 0x17u, 0x0Au, 0xB1u, 0xACu, 0x8Bu, 0x96u, 0xC5u, 0xD8u, 0xFFu, 0xE2u,
+		0x26u, 0x3Bu, 0x1Cu, 0x01u, 0x52u, 0x4Fu, 0x68u, 0x75u, 0xCEu, 0xD3u, 0xF4u, 0xE9u, 0xBAu, 0xA7u, 0x80u, 0x9Du,
+		0xEBu, 0xF6u, 0xD1u, 0xCCu, 0x9Fu, 0x82u, 0xA5u, 0xB8u, 0x03u, 0x1Eu, 0x39u, 0x24u, 0x77u, 0x6Au, 0x4Du, 0x50u,
+		0xA1u, 0xBCu, 0x9Bu, 0x86u, 0xD5u, 0xC8u, 0xEFu, 0xF2u, 0x49u, 0x54u, 0x73u, 0x6Eu, 0x3Du, 0x20u, 0x07u, 0x1Au,
+		0x6Cu, 0x71u, 0x56u, 0x4Bu, 0x18u, 0x05u, 0x22u, 0x3Fu, 0x84u, 0x99u, 0xBEu, 0xA3u, 0xF0u, 0xEDu, 0xCAu, 0xD7u,
+		0x35u, 0x28u, 0x0Fu, 0x12u, 0x41u, 0x5Cu, 0x7Bu, 0x66u, 0xDDu, 0xC0u, 0xE7u, 0xFAu, 0xA9u, 0xB4u, 0x93u, 0x8Eu,
+		0xF8u, 0xE5u, 0xC2u, 0xDFu, 0x8Cu, 0x91u, 0xB6u, 0xABu, 0x10u, 0x0Du, 0x2Au, 0x37u, 0x64u, 0x79u, 0x5Eu, 0x43u,
+		0xB2u, 0xAFu, 0x88u, 0x95u, 0xC6u, 0xDBu, 0xFCu, 0xE1u, 0x5Au, 0x47u, 0x60u, 0x7Du, 0x2Eu, 0x33u, 0x14u, 0x09u,
+		0x7Fu, 0x62u, 0x45u, 0x58u, 0x0Bu, 0x16u, 0x31u, 0x2Cu, 0x97u, 0x8Au, 0xADu, 0xB0u, 0xE3u, 0xFEu, 0xD9u, 0xC4u
+	},
+#if (CRC_8_SLICES >= 4)
+	{
+		0x00u, 0x4Cu, 0x98u, 0xD4u, 0x2Du, 0x61u, 0xB5u, 0xF9u, 0x5Au, 0x16u, 0xC2u, 0x8Eu, 0x77u, 0x3Bu, 0xEFu, 0xA3u,
+		0xB4u, 0xF8u, 0x2Cu, 0x60u, 0x99u, 0xD5u, 0x01u, 0x4Du, 0xEEu, 0xA2u, 0x76u, 0x3Au, 0xC3u, 0x8Fu, 0x5Bu, 0x17u,
+		0x75u, 0x39u, 0xEDu, 0xA1u, 0x58u, 0x14u, 0xC0u, 0x8Cu, 0x2Fu, 0x63u, 0xB7u, 0xFBu, 0x02u, 0x4Eu, 0x9Au, 0xD6u,
+		0xC1u, 0x8Du, 0x59u, 0x15u, 0xECu, 0xA0u, 0x74u, 0x38u, 0x9Bu, 0xD7u, 0x03u, 0x4Fu, 0xB6u, 0xFAu, 0x2Eu, 0x62u,
+		0xEAu, 0xA6u, 0x72u, 0x3Eu, 0xC7u, 0x8Bu, 0x5Fu, 0x13u, 0xB0u, 0xFCu, 0x28u, 0x64u, 0x9Du, 0xD1u, 0x05u, 0x49u,
+		0x5Eu, 0x12u, 0xC6u, 0x8Au, 0x73u, 0x3Fu, 0xEBu, 0xA7u, 0x04u, 0x48u, 0x9Cu, 0xD0u, 0x29u, 0x65u, 0xB1u, 0xFDu,
+		0x9Fu, 0xD3u, 0x07u, 0x4Bu, 0xB2u, 0xFEu, 0x2Au, 0x66u, 0xC5u, 0x89u, 0x5Du, 0x11u, 0xE8u, 0xA4u, 0x70u, 0x3Cu,
+		0x2Bu, 0x67u, 0xB3u, 0xFFu, 0x06u, 0x4Au, 0x9Eu, 0xD2u, 0x71u, 0x3Du, 0xE9u, 0xA5u, 0x5Cu, 0x10u, 0xC4u, 0x88u,
+		0xC9u, 0x85u, 0x51u, 0x1Du, 0xE4u, 0xA8u, 0x7Cu, 0x30u, 0x93u, 0xDFu, 0x0Bu, 0x47u, 0xBEu, 0xF2u, 0x26u, 0x6Au,
+		0x7Du, 0x31u, 0xE5u, 0xA9u, 0x50u, 0x1Cu, 0xC8u, 0x84u, 0x27u, 0x6Bu, 0xBFu, 0xF3u, 0x0Au, 0x46u, 0x92u, 0xDEu,
+		0xBCu, 0xF0u, 0x24u, 0x68u, 0x91u, 0xDDu, 0x09u, 0x45u, 0xE6u, 0xAAu, 0x7Eu, 0x32u, 0xCBu, 0x87u, 0x53u, 0x1Fu,
+		0x08u, 0x44u, 0x90u, 0xDCu, 0x25u, 0x69u, 0xBDu, 0xF1u, 0x52u, 0x1Eu, 0xCAu, 0x86u, 0x7Fu, 0x33u, 0xE7u, 0xABu,
+		0x23u, 0x6Fu, 0xBBu, 0xF7u, 0x0Eu, 0x42u, 0x96u, 0xDAu, 0x79u, 0x35u, 0xE1u, 0xADu, 0x54u, 0x18u, 0xCCu, 0x80u,
+		0x97u, 0xDBu, 0x0Fu, 0x43u, 0xBAu, 0xF6u, 0x22u, 0x6Eu, 0xCDu, 0x81u, 0x55u, 0x19u, 0xE0u, 0xACu, 0x78u, 0x34u,
+		0x56u, 0x1Au, 0xCEu, 0x82u, 0x7Bu, 0x37u, 0xE3u, 0xAFu, 0x0Cu, 0x40u, 0x94u, 0xD8u, 0x21u, 0x6Du, 0xB9u, 0xF5u,
+		0xE2u, 0xAEu, 0x7Au, 0x36u, 0xCFu, 0x83u, 0x57u, 0x1Bu, 0xB8u, 0xF4u, 0x20u, 0x6Cu, 0x95u, 0xD9u, 0x0Du, 0x41u
+	},
+	{
+		0x00u, 0x8Fu, 0x03u, 0x8Cu, 0x06u, 0x89u, 0x05u, 0x8Au, 0x0Cu, 0x83u, 0x0Fu, 0x80u, 0x0Au, 0x85u, 0x09u, 0x86u,
+		0x18u, 0x97u, 0x1Bu, 0x94u, 0x1Eu, 0x91u, 0x1Du, 0x92u, 0x14u, 0x9Bu, 0x17u, 0x98u, 0x12u, 0x9Du, 0x11u, 0x9Eu,
+		0x30u, 0xBFu, 0x33u, 0xBCu, 0x36u, 0xB9u, 0x35u, 0xBAu, 0x3Cu, 0xB3u, 0x3Fu, 0xB0u, 0x3Au, 0xB5u, 0x39u, 0xB6u,
+		0x28u, 0xA7u, 0x2Bu, 0xA4u, 0x2Eu, 0xA1u, 0x2Du, 0xA2u, 0x24u, 0xABu, 0x27u, 0xA8u, 0x22u, 0xADu, 0x21u, 0xAEu,
+		0x60u, 0xEFu, 0x63u, 0xECu, 0x66u, 0xE9u, 0x65u, 0xEAu, 0x6Cu, 0xE3u, 0x6Fu, 0xE0u, 0x6Au, 0xE5u, 0x69u, 0xE6u,
+		0x78u, 0xF7u, 0x7Bu, 0xF4u, 0x7Eu, 0xF1u, 0x7Du, 0xF2u, 0x74u, 0xFBu, 0x77u, 0xF8u, 0x72u, 0xFDu, 0x71u, 0xFEu,
+		0x50u, 0xDFu, 0x53u, 0xDCu, 0x56u, 0xD9u, 0x55u, 0xDAu, 0x5Cu, 0xD3u, 0x5Fu, 0xD0u, 0x5Au, 0xD5u, 0x59u, 0xD6u,
+		0x48u, 0xC7u, 0x4Bu, 0xC4u, 0x4Eu, 0xC1u, 0x4Du, 0xC2u, 0x44u, 0xCBu, 0x47u, 0xC8u, 0x42u, 0xCDu, 0x41u, 0xCEu,
+		0xC0u, 0x4Fu, 0xC3u, 0x4Cu, 0xC6u, 0x49u, 0xC5u, 0x4Au, 0xCCu, 0x43u, 0xCFu, 0x40u, 0xCAu, 0x45u, 0xC9u, 0x46u,
+		0xD8u, 0x57u, 0xDBu, 0x54u, 0xDEu, 0x51u, 0xDDu, 0x52u, 0xD4u, 0x5Bu, 0xD7u, 0x58u, 0xD2u, 0x5Du, 0xD1u, 0x5Eu,
+		0xF0u, 0x7Fu, 0xF3u, 0x7Cu, 0xF6u, 0x79u, 0xF5u, 0x7Au, 0xFCu, 0x73u, 0xFFu, 0x70u, 0xFAu, 0x75u, 0xF9u, 0x76u,
+		0xE8u, 0x67u, 0xEBu, 0x64u, 0xEEu, 0x61u, 0xEDu, 0x62u, 0xE4u, 0x6Bu, 0xE7u, 0x68u, 0xE2u, 0x6Du, 0xE1u, 0x6Eu,
+		0xA0u, 0x2Fu, 0xA3u, 0x2Cu, 0xA6u, 0x29u, 0xA5u, 0x2Au, 0xACu, 0x23u, 0xAFu, 0x20u, 0xAAu, 0x25u, 0xA9u, 0x26u,
+		0xB8u, 0x37u, 0xBBu, 0x34u, 0xBEu, 0x31u, 0xBDu, 0x32u, 0xB4u, 0x3Bu, 0xB7u, 0x38u, 0xB2u, 0x3Du, 0xB1u, 0x3Eu,
+		0x90u, 0x1Fu, 0x93u, 0x1Cu, 0x96u, 0x19u, 0x95u, 0x1Au, 0x9Cu, 0x13u, 0x9Fu, 0x10u, 0x9Au, 0x15u, 0x99u, 0x16u,
+		0x88u, 0x07u, 0x8Bu, 0x04u, 0x8Eu, 0x01u, 0x8Du, 0x02u, 0x84u, 0x0Bu, 0x87u, 0x08u, 0x82u, 0x0Du, 0x81u, 0x0Eu
+	},
+	{
+		0x00u, 0x9Du, 0x27u, 0xBAu, 0x4Eu, 0xD3u, 0x69u, 0xF4u, 0x9Cu, 0x01u, 0xBBu, 0x26u, 0xD2u, 0x4Fu, 0xF5u, 0x68u,
+		0x25u, 0xB8u, 0x02u, 0x9Fu, 0x6Bu, 0xF6u, 0x4Cu, 0xD1u, 0xB9u, 0x24u, 0x9Eu, 0x03u, 0xF7u, 0x6Au, 0xD0u, 0x4Du,
+		0x4Au, 0xD7u, 0x6Du, 0xF0u, 0x04u, 0x99u, 0x23u, 0xBEu, 0xD6u, 0x4Bu, 0xF1u, 0x6Cu, 0x98u, 0x05u, 0xBFu, 0x22u,
+		0x6Fu, 0xF2u, 0x48u, 0xD5u, 0x21u, 0xBCu, 0x06u, 0x9Bu, 0xF3u, 0x6Eu, 0xD4u, 0x49u, 0xBDu, 0x20u, 0x9Au, 0x07u,
+		0x94u, 0x09u, 0xB3u, 0x2Eu, 0xDAu, 0x47u, 0xFDu, 0x60u, 0x08u, 0x95u, 0x2Fu, 0xB2u, 0x46u, 0xDBu, 0x61u, 0xFCu,
+		0xB1u, 0x2Cu, 0x96u, 0x0Bu, 0xFFu, 0x62u, 0xD8u, 0x45u, 0x2Du, 0xB0u, 0x0Au, 0x97u, 0x63u, 0xFEu, 0x44u, 0xD9u,
+		0xDEu, 0x43u, 0xF9u, 0x64u, 0x90u, 0x0Du, 0xB7u, 0x2Au, 0x42u, 0xDFu, 0x65u, 0xF8u, 0x0Cu, 0x91u, 0x2Bu, 0xB6u,
+		0xFBu, 0x66u, 0xDCu, 0x41u, 0xB5u, 0x28u, 0x92u, 0x0Fu, 0x67u, 0xFAu, 0x40u, 0xDDu, 0x29u, 0xB4u, 0x0Eu, 0x93u,
+		0x35u, 0xA8u, 0x12u, 0x8Fu, 0x7Bu, 0xE6u, 0x5Cu, 0xC1u, 0xA9u, 0x34u, 0x8Eu, 0x13u, 0xE7u, 0x7Au, 0xC0u, 0x5Du,
+		0x10u, 0x8Du, 0x37u, 0xAAu, 0x5Eu, 0xC3u, 0x79u, 0xE4u, 0x8Cu, 0x11u, 0xABu, 0x36u, 0xC2u, 0x5Fu, 0xE5u, 0x78u,
+		0x7Fu, 0xE2u, 0x58u, 0xC5u, 0x31u, 0xACu, 0x16u, 0x8Bu, 0xE3u, 0x7Eu, 0xC4u, 0x59u, 0xADu, 0x30u, 0x8Au, 0x17u,
+		0x5Au, 0xC7u, 0x7Du, 0xE0u, 0x14u, 0x89u, 0x33u, 0xAEu, 0xC6u, 0x5Bu, 0xE1u, 0x7Cu, 0x88u, 0x15u, 0xAFu, 0x32u,
+		0xA1u, 0x3Cu, 0x86u, 0x1Bu, 0xEFu, 0x72u, 0xC8u, 0x55u, 0x3Du, 0xA0u, 0x1Au, 0x87u, 0x73u, 0xEEu, 0x54u, 0xC9u,
+		0x84u, 0x19u, 0xA3u, 0x3Eu, 0xCAu, 0x57u, 0xEDu, 0x70u, 0x18u, 0x85u, 0x3Fu, 0xA2u, 0x56u, 0xCBu, 0x71u, 0xECu,
+		0xEBu, 0x76u, 0xCCu, 0x51u, 0xA5u, 0x38u, 0x82u, 0x1Fu, 0x77u, 0xEAu, 0x50u, 0xCDu, 0x39u, 0xA4u, 0x1Eu, 0x83u,
+		0xCEu, 0x53u, 0xE9u, 0x74u, 0x80u, 0x1Du, 0xA7u, 0x3Au, 0x52u, 0xCFu, 0x75u, 0xE8u, 0x1Cu, 0x81u, 0x3Bu, 0xA6u
+	},
+#endif
+#if (CRC_8_SLICES >= 8)
+	{
+		0x00u, 0x6Au, 0xD4u, 0xBEu, 0xB5u, 0xDFu, 0x61u, 0x0Bu, 0x77u, 0x1Du, 0xA3u, 0xC9u, 0xC2u, 0xA8u, 0x16u, 0x7Cu,
+		0xEEu, 0x84u, 0x3Au, 0x50u, 0x5Bu, 0x31u, 0x8Fu, 0xE5u, 0x99u, 0xF3u, 0x4Du, 0x27u, 0x2Cu, 0x46u, 0xF8u, 0x92u,
+		0xC1u, 0xABu, 0x15u, 0x7Fu, 0x74u, 0x1Eu, 0xA0u, 0xCAu, 0xB6u, 0xDCu, 0x62u, 0x08u, 0x03u, 0x69u, 0xD7u, 0xBDu,
+		0x2Fu, 0x45u, 0xFBu, 0x91u, 0x9Au, 0xF0u, 0x4Eu, 0x24u, 0x58u, 0x32u, 0x8Cu, 0xE6u, 0xEDu, 0x87u, 0x39u, 0x53u,
+		0x9Fu, 0xF5u, 0x4Bu, 0x21u, 0x2Au, 0x40u, 0xFEu, 0x94u, 0xE8u, 0x82u, 0x3Cu, 0x56u, 0x5Du, 0x37u, 0x89u, 0xE3u,
+		0x71u, 0x1Bu, 0xA5u, 0xCFu, 0xC4u, 0xAEu, 0x10u, 0x7Au, 0x06u, 0x6Cu, 0xD2u, 0xB8u, 0xB3u, 0xD9u, 0x67u, 0x0Du,
+		0x5Eu, 0x34u, 0x8Au, 0xE0u, 0xEBu, 0x81u, 0x3Fu, 0x55u, 0x29u, 0x43u, 0xFDu, 0x97u, 0x9Cu, 0xF6u, 0x48u, 0x22u,
+		0xB0u, 0xDAu, 0x64u, 0x0Eu, 0x05u, 0x6Fu, 0xD1u, 0xBBu, 0xC7u, 0xADu, 0x13u, 0x79u, 0x72u, 0x18u, 0xA6u, 0xCCu,
+		0x23u, 0x49u, 0xF7u, 0x9Du, 0x96u, 0xFCu, 0x42u, 0x28u, 0x54u, 0x3Eu, 0x80u, 0xEAu, 0xE1u, 0x8Bu, 0x35u, 0x5Fu,
+		0xCDu, 0xA7u, 0x19u, 0x73u, 0x78u, 0x12u, 0xACu, 0xC6u, 0xBAu, 0xD0u, 0x6Eu, 0x04u, 0x0Fu, 0x65u, 0xDBu, 0xB1u,
+		0xE2u, 0x88u, 0x36u, 0x5Cu, 0x57u, 0x3Du, 0x83u, 0xE9u, 0x95u, 0xFFu, 0x41u, 0x2Bu, 0x20u, 0x4Au, 0xF4u, 0x9Eu,
+		0x0Cu, 0x66u, 0xD8u, 0xB2u, 0xB9u, 0xD3u, 0x6Du, 0x07u, 0x7Bu, 0x11u, 0xAFu, 0xC5u, 0xCEu, 0xA4u, 0x1Au, 0x70u,
+		0xBCu, 0xD6u, 0x68u, 0x02u, 0x09u, 0x63u, 0xDDu, 0xB7u, 0xCBu, 0xA1u, 0x1Fu, 0x75u, 0x7Eu, 0x14u, 0xAAu, 0xC0u,
+		0x52u, 0x38u, 0x86u, 0xECu, 0xE7u, 0x8Du, 0x33u, 0x59u, 0x25u, 0x4Fu, 0xF1u, 0x9Bu, 0x90u, 0xFAu, 0x44u, 0x2Eu,
+		0x7Du, 0x17u, 0xA9u, 0xC3u, 0xC8u, 0xA2u, 0x1Cu, 0x76u, 0x0Au, 0x60u, 0xDEu, 0xB4u, 0xBFu, 0xD5u, 0x6Bu, 0x01u,
+		0x93u, 0xF9u, 0x47u, 0x2Du, 0x26u, 0x4Cu, 0xF2u, 0x98u, 0xE4u, 0x8Eu, 0x30u, 0x5Au, 0x51u, 0x3Bu, 0x85u, 0xEFu
+	},
+	{
+		0x00u, 0x46u, 0x8Cu, 0xCAu, 0x05u, 0x43u, 0x89u, 0xCFu, 0x0Au, 0x4Cu, 0x86u, 0xC0u, 0x0Fu, 0x49u, 0x83u, 0xC5u,
+		0x14u, 0x52u, 0x98u, 0xDEu, 0x11u, 0x57u, 0x9Du, 0xDBu, 0x1Eu, 0x58u, 0x92u, 0xD4u, 0x1Bu, 0x5Du, 0x97u, 0xD1u,
+		0x28u, 0x6Eu, 0xA4u, 0xE2u, 0x2Du, 0x6Bu, 0xA1u, 0xE7u, 0x22u, 0x64u, 0xAEu, 0xE8u, 0x27u, 0x61u, 0xABu, 0xEDu,
+		0x3Cu, 0x7Au, 0xB0u, 0xF6u, 0x39u, 0x7Fu, 0xB5u, 0xF3u, 0x36u, 0x70u, 0xBAu, 0xFCu, 0x33u, 0x75u, 0xBFu, 0xF9u,
+		0x50u, 0x16u, 0xDCu, 0x9Au, 0x55u, 0x13u, 0xD9u, 0x9Fu, 0x5Au, 0x1Cu, 0xD6u, 0x90u, 0x5Fu, 0x19u, 0xD3u, 0x95u,
+		0x44u, 0x02u, 0xC8u, 0x8Eu, 0x41u, 0x07u, 0xCDu, 0x8Bu, 0x4Eu, 0x08u, 0xC2u, 0x84u, 0x4Bu, 0x0Du, 0xC7u, 0x81u,
+		0x78u, 0x3Eu, 0xF4u, 0xB2u, 0x7Du, 0x3Bu, 0xF1u, 0xB7u, 0x72u, 0x34u, 0xFEu, 0xB8u, 0x77u, 0x31u, 0xFBu, 0xBDu,
+		0x6Cu, 0x2Au, 0xE0u, 0xA6u, 0x69u, 0x2Fu, 0xE5u, 0xA3u, 0x66u, 0x20u, 0xEAu, 0xACu, 0x63u, 0x25u, 0xEFu, 0xA9u,
+		0xA0u, 0xE6u, 0x2Cu, 0x6Au, 0xA5u, 0xE3u, 0x29u, 0x6Fu, 0xAAu, 0xECu, 0x26u, 0x60u, 0xAFu, 0xE9u, 0x23u, 0x65u,
+		0xB4u, 0xF2u, 0x38u, 0x7Eu, 0xB1u, 0xF7u, 0x3Du, 0x7Bu, 0xBEu, 0xF8u, 0x32u, 0x74u, 0xBBu, 0xFDu, 0x37u, 0x71u,
+		0x88u, 0xCEu, 0x04u, 0x42u, 0x8Du, 0xCBu, 0x01u, 0x47u, 0x82u, 0xC4u, 0x0Eu, 0x48u, 0x87u, 0xC1u, 0x0Bu, 0x4Du,
+		0x9Cu, 0xDAu, 0x10u, 0x56u, 0x99u, 0xDFu, 0x15u, 0x53u, 0x96u, 0xD0u, 0x1Au, 0x5Cu, 0x93u, 0xD5u, 0x1Fu, 0x59u,
+		0xF0u, 0xB6u, 0x7Cu, 0x3Au, 0xF5u, 0xB3u, 0x79u, 0x3Fu, 0xFAu, 0xBCu, 0x76u, 0x30u, 0xFFu, 0xB9u, 0x73u, 0x35u,
+		0xE4u, 0xA2u, 0x68u, 0x2Eu, 0xE1u, 0xA7u, 0x6Du, 0x2Bu, 0xEEu, 0xA8u, 0x62u, 0x24u, 0xEBu, 0xADu, 0x67u, 0x21u,
+		0xD8u, 0x9Eu, 0x54u, 0x12u, 0xDDu, 0x9Bu, 0x51u, 0x17u, 0xD2u, 0x94u, 0x5Eu, 0x18u, 0xD7u, 0x91u, 0x5Bu, 0x1Du,
+		0xCCu, 0x8Au, 0x40u, 0x06u, 0xC9u, 0x8Fu, 0x45u, 0x03u, 0xC6u, 0x80u, 0x4Au, 0x0Cu, 0xC3u, 0x85u, 0x4Fu, 0x09u
+	},
+	{
+		0x00u, 0x5Du, 0xBAu, 0xE7u, 0x69u, 0x34u, 0xD3u, 0x8Eu, 0xD2u, 0x8Fu, 0x68u, 0x35u, 0xBBu, 0xE6u, 0x01u, 0x5Cu,
+		0xB9u, 0xE4u, 0x03u, 0x5Eu, 0xD0u, 0x8Du, 0x6Au, 0x37u, 0x6Bu, 0x36u, 0xD1u, 0x8Cu, 0x02u, 0x5Fu, 0xB8u, 0xE5u,
+		0x6Fu, 0x32u, 0xD5u, 0x88u, 0x06u, 0x5Bu, 0xBCu, 0xE1u, 0xBDu, 0xE0u, 0x07u, 0x5Au, 0xD4u, 0x89u, 0x6Eu, 0x33u,
+		0xD6u, 0x8Bu, 0x6Cu, 0x31u, 0xBFu, 0xE2u, 0x05u, 0x58u, 0x04u, 0x59u, 0xBEu, 0xE3u, 0x6Du, 0x30u, 0xD7u, 0x8Au,
+		0xDEu, 0x83u, 0x64u, 0x39u, 0xB7u, 0xEAu, 0x0Du, 0x50u, 0x0Cu, 0x51u, 0xB6u, 0xEBu, 0x65u, 0x38u, 0xDFu, 0x82u,
+		0x67u, 0x3Au, 0xDDu, 0x80u, 0x0Eu, 0x53u, 0xB4u, 0xE9u, 0xB5u, 0xE8u, 0x0Fu, 0x52u, 0xDCu, 0x81u, 0x66u, 0x3Bu,
+		0xB1u, 0xECu, 0x0Bu, 0x56u, 0xD8u, 0x85u, 0x62u, 0x3Fu, 0x63u, 0x3Eu, 0xD9u, 0x84u, 0x0Au, 0x57u, 0xB0u, 0xEDu,
+		0x08u, 0x55u, 0xB2u, 0xEFu, 0x61u, 0x3Cu, 0xDBu, 0x86u, 0xDAu, 0x87u, 0x60u, 0x3Du, 0xB3u, 0xEEu, 0x09u, 0x54u,
+		0xA1u, 0xFCu, 0x1Bu, 0x46u, 0xC8u, 0x95u, 0x72u, 0x2Fu, 0x73u, 0x2Eu, 0xC9u, 0x94u, 0x1Au, 0x47u, 0xA0u, 0xFDu,
+		0x18u, 0x45u, 0xA2u, 0xFFu, 0x71u, 0x2Cu, 0xCBu, 0x96u, 0xCAu, 0x97u, 0x70u, 0x2Du, 0xA3u, 0xFEu, 0x19u, 0x44u,
+		0xCEu, 0x93u, 0x74u, 0x29u, 0xA7u, 0xFAu, 0x1Du, 0x40u, 0x1Cu, 0x41u, 0xA6u, 0xFBu, 0x75u, 0x28u, 0xCFu, 0x92u,
+		0x77u, 0x2Au, 0xCDu, 0x90u, 0x1Eu, 0x43u, 0xA4u, 0xF9u, 0xA5u, 0xF8u, 0x1Fu, 0x42u, 0xCCu, 0x91u, 0x76u, 0x2Bu,
+		0x7Fu, 0x22u, 0xC5u, 0x98u, 0x16u, 0x4Bu, 0xACu, 0xF1u, 0xADu, 0xF0u, 0x17u, 0x4Au, 0xC4u, 0x99u, 0x7Eu, 0x23u,
+		0xC6u, 0x9Bu, 0x7Cu, 0x21u, 0xAFu, 0xF2u, 0x15u, 0x48u, 0x14u, 0x49u, 0xAEu, 0xF3u, 0x7Du, 0x20u, 0xC7u, 0x9Au,
+		0x10u, 0x4Du, 0xAAu, 0xF7u, 0x79u, 0x24u, 0xC3u, 0x9Eu, 0xC2u, 0x9Fu, 0x78u, 0x25u, 0xABu, 0xF6u, 0x11u, 0x4Cu,
+		0xA9u, 0xF4u, 0x13u, 0x4Eu, 0xC0u, 0x9Du, 0x7Au, 0x27u, 0x7Bu, 0x26u, 0xC1u, 0x9Cu, 0x12u, 0x4Fu, 0xA8u, 0xF5u
+	},
+	{
+		0x00u, 0x5Fu, 0xBEu, 0xE1u, 0x61u, 0x3Eu, 0xDFu, 0x80u, 0xC2u, 0x9Du, 0x7Cu, 0x23u, 0xA3u, 0xFCu, 0x1Du, 0x42u,
+		0x99u, 0xC6u, 0x27u, 0x78u, 0xF8u, 0xA7u, 0x46u, 0x19u, 0x5Bu, 0x04u, 0xE5u, 0xBAu, 0x3Au, 0x65u, 0x84u, 0xDBu,
+		0x2Fu, 0x70u, 0x91u, 0xCEu, 0x4Eu, 0x11u, 0xF0u, 0xAFu, 0xEDu, 0xB2u, 0x53u, 0x0Cu, 0x8Cu, 0xD3u, 0x32u, 0x6Du,
+		0xB6u, 0xE9u, 0x08u, 0x57u, 0xD7u, 0x88u, 0x69u, 0x36u, 0x74u, 0x2Bu, 0xCAu, 0x95u, 0x15u, 0x4Au, 0xABu, 0xF4u,
+		0x5Eu, 0x01u, 0xE0u, 0xBFu, 0x3Fu, 0x60u, 0x81u, 0xDEu, 0x9Cu, 0xC3u, 0x22u, 0x7Du, 0xFDu, 0xA2u, 0x43u, 0x1Cu,
+		0xC7u, 0x98u, 0x79u, 0x26u, 0xA6u, 0xF9u, 0x18u, 0x47u, 0x05u, 0x5Au, 0xBBu, 0xE4u, 0x64u, 0x3Bu, 0xDAu, 0x85u,
+		0x71u, 0x2Eu, 0xCFu, 0x90u, 0x10u, 0x4Fu, 0xAEu, 0xF1u, 0xB3u, 0xECu, 0x0Du, 0x52u, 0xD2u, 0x8Du, 0x6Cu, 0x33u,
+		0xE8u, 0xB7u, 0x56u, 0x09u, 0x89u, 0xD6u, 0x37u, 0x68u, 0x2Au, 0x75u, 0x94u, 0xCBu, 0x4Bu, 0x14u, 0xF5u, 0xAAu,
+		0xBCu, 0xE3u, 0x02u, 0x5Du, 0xDDu, 0x82u, 0x63u, 0x3Cu, 0x7Eu, 0x21u, 0xC0u, 0x9Fu, 0x1Fu, 0x40u, 0xA1u, 0xFEu,
+		0x25u, 0x7Au, 0x9Bu, 0xC4u, 0x44u, 0x1Bu, 0xFAu, 0xA5u, 0xE7u, 0xB8u, 0x59u, 0x06u, 0x86u, 0xD9u, 0x38u, 0x67u,
+		0x93u, 0xCCu, 0x2Du, 0x72u, 0xF2u, 0xADu, 0x4Cu, 0x13u, 0x51u, 0x0Eu, 0xEFu, 0xB0u, 0x30u, 0x6Fu, 0x8Eu, 0xD1u,
+		0x0Au, 0x55u, 0xB4u, 0xEBu, 0x6Bu, 0x34u, 0xD5u, 0x8Au, 0xC8u, 0x97u, 0x76u, 0x29u, 0xA9u, 0xF6u, 0x17u, 0x48u,
+		0xE2u, 0xBDu, 0x5Cu, 0x03u, 0x83u, 0xDCu, 0x3Du, 0x62u, 0x20u, 0x7Fu, 0x9Eu, 0xC1u, 0x41u, 0x1Eu, 0xFFu, 0xA0u,
+		0x7Bu, 0x24u, 0xC5u, 0x9Au, 0x1Au, 0x45u, 0xA4u, 0xFBu, 0xB9u, 0xE6u, 0x07u, 0x58u, 0xD8u, 0x87u, 0x66u, 0x39u,
+		0xCDu, 0x92u, 0x73u, 0x2Cu, 0xACu, 0xF3u, 0x12u, 0x4Du, 0x0Fu, 0x50u, 0xB1u, 0xEEu, 0x6Eu, 0x31u, 0xD0u, 0x8Fu,
+		0x54u, 0x0Bu, 0xEAu, 0xB5u, 0x35u, 0x6Au, 0x8Bu, 0xD4u, 0x96u, 0xC9u, 0x28u, 0x77u, 0xF7u, 0xA8u, 0x49u, 0x16u
+	},
+#endif
+};
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CRC-8 H2F (poly 0x2F)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (CRC_8H2F_MODE == CRC_MODE_NIBBLE)
+CRC_TABLE_CONST uint8_t Crc_Nibble8H2F[16] =
+{
+	0x00u, 0x2Fu, 0x5Eu, 0x71u, 0xBCu, 0x93u, 0xE2u, 0xCDu, 0x57u, 0x78u, 0x09u, 0x26u, 0xEBu, 0xC4u, 0xB5u, 0x9Au
+};
+#endif
+
+#if (CRC_8H2F_MODE >= CRC_MODE_TABLE)
+CRC_TABLE_CONST uint8_t Crc_Table8H2F[CRC_8H2F_SLICES][256] =
+{
+	{
+		0x00u, 0x2Fu, 0x5Eu, 0x71u, 0xBCu, 0x93u, 0xE2u, 0xCDu, 0x57u, 0x78u, 0x09u, 0x26u, 0xEBu, 0xC4u, 0xB5u, 0x9Au,
+		0xAEu, 0x81u, 0xF0u, 0xDFu, 0x12u, 0x3Du, 0x4Cu, 0x63u, 0xF9u, 0xD6u, 0xA7u, 0x88u, 0x45u, 0x6Au, 0x1Bu, 0x34u,
+		0x73u, 0x5Cu, 0x2Du, 0x02u, 0xCFu, 0xE0u, 0x91u, 0xBEu, 0x24u, 0x0Bu, 0x7Au, 0x55u, 0x98u, 0xB7u, 0xC6u, 0xE9u,
+		0xDDu, 0xF2u, 0x83u, 0xACu, 0x61u, 0x4Eu, 0x3Fu, 0x10u, 0x8Au, 0xA5u, 0xD4u, 0xFBu, 0x36u, 0x19u, 0x68u, 0x47u,
+		0xE6u, 0xC9u, 0xB8u, 0x97u, 0x5Au, 0x75u, 0x04u, 0x2Bu, 0xB1u, 0x9Eu, 0xEFu, 0xC0u, 0x0Du, 0x22u, 0x53u, 0x7Cu,
+		0x48u, 0x67u, 0x16u, 0x39u, 0xF4u, 0xDBu, 0xAAu, 0x85u, 0x1Fu, 0x30u, 0x41u, 0x6Eu, 0xA3u, 0x8Cu, 0xFDu, 0xD2u,
+		0x95u, 0xBAu, 0xCBu, 0xE4u, 0x29u, 0x06u, 0x77u, 0x58u, 0xC2u, 0xEDu, 0x9Cu, 0xB3u, 0x7Eu, 0x51u, 0x20u, 0x0Fu,
+		0x3Bu, 0x14u, 0x65u, 0x4Au, 0x87u, 0xA8u, 0xD9u, 0xF6u, 0x6Cu, 0x43u, 0x32u, 0x1Du, 0xD0u, 0xFFu, 0x8Eu, 0xA1u,
+		0xE3u, 0xCCu, 0xBDu, 0x92u, 0x5Fu, 0x70u, 0x01u, 0x2Eu, 0xB4u, 0x9Bu, 0xEAu, 0xC5u, 0x08u, 0x27u, 0x56u, 0x79u,
+		0x4Du, 0x62u, 0x13u, 0x3Cu, 0xF1u, 0xDEu, 0xAFu, 0x80u, 0x1Au, 0x35u, 0x44u, 0x6Bu, 0xA6u, 0x89u, 0xF8u, 0xD7u,
+		0x90u, 0xBFu, 0xCEu, 0xE1u, 0x2Cu, 0x03u, 0x72u, 0x5Du, 0xC7u, 0xE8u, 0x99u, 0xB6u, 0x7Bu, 0x54u, 0x25u, 0x0Au,
+		0x3Eu, 0x11u, 0x60u, 0x4Fu, 0x82u, 0xADu, 0xDCu, 0xF3u, 0x69u, 0x46u, 0x37u, 0x18u, 0xD5u, 0xFAu, 0x8Bu, 0xA4u,
+		0x05u, 0x2Au, 0x5Bu, 0x74u, 0xB9u, 0x96u, 0xE7u, 0xC8u, 0x52u, 0x7Du, 0x0Cu, 0x23u, 0xEEu, 0xC1u, 0xB0u, 0x9Fu,
+		0xABu, 0x84u, 0xF5u, 0xDAu, 0x17u, 0x38u, 0x49u, 0x66u, 0xFCu, 0xD3u, 0xA2u, 0x8Du, 0x40u, 0x6Fu, 0x1Eu, 0x31u,
+		0x76u, 0x59u, 0x28u, 0x07u, 0xCAu, 0xE5u, 0x94u, 0xBBu, 0x21u, 0x0Eu, 0x7Fu, 0x50u, 0x9Du, 0xB2u, 0xC3u, 0xECu,
+		0xD8u, 0xF7u, 0x86u, 0xA9u, 0x64u, 0x4Bu, 0x3Au, 0x15u, 0x8Fu, 0xA0u, 0xD1u, 0xFEu, 0x33u, 0x1Cu, 0x6Du, 0x42u
+	},
+#if (CRC_8H2F_SLICES >= 4)
+	{
+		0x00u, 0xE9u, 0xFDu, 0x14u, 0xD5u, 0x3Cu, 0x28u, 0xC1u, 0x85u, 0x6Cu, 0x78u, 0x91u, 0x50u, 0xB9u, 0xADu, 0x44u,
+		0x25u, 0xCCu, 0xD8u, 0x31u, 0xF0u, 0x19u, 0x0Du, 0xE4u, 0xA0u, 0x49u, 0x5Du, 0xB4u, 0x75u, 0x9Cu, 0x88u, 0x61u,
+		0x4Au, 0xA3u, 0xB7u, 0x5Eu, 0x9Fu, 0x76u, 0x62u, 0x8Bu, 0xCFu, 0x26u, 0x32u, 0xDBu, 0x1Au, 0xF3u, 0xE7u, 0x0Eu,
+		0x6Fu, 0x86u, 0x92u, 0x7Bu, 0xBAu, 0x53u, 0x47u, 0xAEu, 0xEAu, 0x03u, 0x17u, 0xFEu, 0x3Fu, 0xD6u, 0xC2u, 0x2Bu,
+		0x94u, 0x7Du, 0x69u, 0x80u, 0x41u, 0xA8u, 0xBCu, 0x55u, 0x11u, 0xF8u, 0xECu, 0x05u, 0xC4u, 0x2Du, 0x39u, 0xD0u,
+		0xB1u, 0x58u, 0x4Cu, 0xA5u, 0x64u, 0x8Du, 0x99u, 0x70u, 0x34u, 0xDDu, 0xC9u, 0x20u, 0xE1u, 0x08u, 0x1Cu, 0xF5u,
+		0xDEu, 0x37u, 0x23u, 0xCAu, 0x0Bu, 0xE2u, 0xF6u, 0x1Fu, 0x5Bu, 0xB2u, 0xA6u, 0x4Fu, 0x8Eu, 0x67u, 0x73u, 0x9Au,
+		0xFBu, 0x12u, 0x06u, 0xEFu, 0x2Eu, 0xC7u, 0xD3u, 0x3Au, 0x7Eu, 0x97u, 0x83u, 0x6Au, 0xABu, 0x42u, 0x56u, 0xBFu,
+		0x07u, 0xEEu, 0xFAu, 0x13u, 0xD2u, 0x3Bu, 0x2Fu, 0xC6u, 0x82u, 0x6Bu, 0x7Fu, 0x96u, 0x57u, 0xBEu, 0xAAu, 0x43u,
+		0x22u, 0xCBu, 0xDFu, 0x36u, 0xF7u, 0x1Eu, 0x0Au, 0xE3u, 0xA7u, 0x4Eu, 0x5Au, 0xB3u, 0x72u, 0x9Bu, 0x8Fu, 0x66u,
+		0x4Du, 0xA4u, 0xB0u, 0x59u, 0x98u, 0x71u, 0x65u, 0x8Cu, 0xC8u, 0x21u, 0x35u, 0xDCu, 0x1Du, 0xF4u, 0xE0u, 0x09u,
+		0x68u, 0x81u, 0x95u, 0x7Cu, 0xBDu, 0x54u, 0x40u, 0xA9u, 0xEDu, 0x04u, 0x10u, 0xF9u, 0x38u, 0xD1u, 0xC5u, 0x2Cu,
+		0x93u, 0x7Au, 0x6Eu, 0x87u, 0x46u, 0xAFu, 0xBBu, 0x52u, 0x16u, 0xFFu, 0xEBu, 0x02u, 0xC3u, 0x2Au, 0x3Eu, 0xD7u,
+		0xB6u, 0x5Fu, 0x4Bu, 0xA2u, 0x63u, 0x8Au, 0x9Eu, 0x77u, 0x33u, 0xDAu, 0xCEu, 0x27u, 0xE6u, 0x0Fu, 0x1Bu, 0xF2u,
+		0xD9u, 0x30u, 0x24u, 0xCDu, 0x0Cu, 0xE5u, 0xF1u, 0x18u, 0x5Cu, 0xB5u, 0xA1u, 0x48u, 0x89u, 0x60u, 0x74u, 0x9Du,
+		0xFCu, 0x15u, 0x01u, 0xE8u, 0x29u, 0xC0u, 0xD4u, 0x3Du, 0x79u, 0x90u, 0x84u, 0x6Du, 0xACu, 0x45u, 0x51u, 0xB8u
+	},
+	{
+		0x00u, 0x0Eu, 0x1Cu, 0x12u, 0x38u, 0x36u, 0x24u, 0x2Au, 0x70u, 0x7Eu, 0x6Cu, 0x62u, 0x48u, 0x46u, 0x54u, 0x5Au,
+		0xE0u, 0xEEu, 0xFCu, 0xF2u, 0xD8u, 0xD6u, 0xC4u, 0xCAu, 0x90u, 0x9Eu, 0x8Cu, 0x82u, 0xA8u, 0xA6u, 0xB4u, 0xBAu,
+		0xEFu, 0xE1u, 0xF3u, 0xFDu, 0xD7u, 0xD9u, 0xCBu, 0xC5u, 0x9Fu, 0x91u, 0x83u, 0x8Du, 0xA7u, 0xA9u, 0xBBu, 0xB5u,
+		0x0Fu, 0x01u, 0x13u, 0x1Du, 0x37u, 0x39u, 0x2Bu, 0x25u, 0x7Fu, 0x71u, 0x63u, 0x6Du, 0x47u, 0x49u, 0x5Bu, 0x55u,
+		0xF1u, 0xFFu, 0xEDu, 0xE3u, 0xC9u, 0xC7u, 0xD5u, 0xDBu, 0x81u, 0x8Fu, 0x9Du, 0x93u, 0xB9u, 0xB7u, 0xA5u, 0xABu,
+		0x11u, 0x1Fu, 0x0Du, 0x03u, 0x29u, 0x27u, 0x35u, 0x3Bu, 0x61u, 0x6Fu, 0x7Du, 0x73u, 0x59u, 0x57u, 0x45u, 0x4Bu,
+		0x1Eu, 0x10u, 0x02u, 0x0Cu, 0x26u, 0x28u, 0x3Au, 0x34u, 0x6Eu, 0x60u, 0x72u, 0x7Cu, 0x56u, 0x58u, 0x4Au, 0x44u,
+		0xFEu, 0xF0u, 0xE2u, 0xECu, 0xC6u, 0xC8u, 0xDAu, 0xD4u, 0x8Eu, 0x80u, 0x92u, 0x9Cu, 0xB6u, 0xB8u, 0xAAu, 0xA4u,
+		0xCDu, 0xC3u, 0xD1u, 0xDFu, 0xF5u, 0xFBu, 0xE9u, 0xE7u, 0xBDu, 0xB3u, 0xA1u, 0xAFu, 0x85u, 0x8Bu, 0x99u, 0x97u,
+		0x2Du, 0x23u, 0x31u, 0x3Fu, 0x15u, 0x1Bu, 0x09u, 0x07u, 0x5Du, 0x53u, 0x41u, 0x4Fu, 0x65u, 0x6Bu, 0x79u, 0x77u,
+		0x22u, 0x2Cu, 0x3Eu, 0x30u, 0x1Au, 0x14u, 0x06u, 0x08u, 0x52u, 0x5Cu, 0x4Eu, 0x40u, 0x6Au, 0x64u, 0x76u, 0x78u,
+		0xC2u, 0xCCu, 0xDEu, 0xD0u, 0xFAu, 0xF4u, 0xE6u, 0xE8u, 0xB2u, 0xBCu, 0xAEu, 0xA0u, 0x8Au, 0x84u, 0x96u, 0x98u,
+		0x3Cu, 0x32u, 0x20u, 0x2Eu, 0x04u, 0x0Au, 0x18u, 0x16u, 0x4Cu, 0x42u, 0x50u, 0x5Eu, 0x74u, 0x7Au, 0x68u, 0x66u,
+		0xDCu, 0xD2u, 0xC0u, 0xCEu, 0xE4u, 0xEAu, 0xF8u, 0xF6u, 0xACu, 0xA2u, 0xB0u, 0xBEu, 0x94u, 0x9Au, 0x88u, 0x86u,
+		0xD3u, 0xDDu, 0xCFu, 0xC1u, 0xEBu, 0xE5u, 0xF7u, 0xF9u, 0xA3u, 0xADu, 0xBFu, 0xB1u, 0x9Bu, 0x95u, 0x87u, 0x89u,
+		0x33u, 0x3Du, 0x2Fu, 0x21u, 0x0Bu, 0x05u, 0x17u, 0x19u, 0x43u, 0x4Du, 0x5Fu, 0x51u, 0x7Bu, 0x75u, 0x67u, 0x69u
+	},
+	{
+		0x00u, 0xB5u, 0x45u, 0xF0u, 0x8Au, 0x3Fu, 0xCFu, 0x7Au, 0x3Bu, 0x8Eu, 0x7Eu, 0xCBu, 0xB1u, 0x04u, 0xF4u, 0x41u,
+		0x76u, 0xC3u, 0x33u, 0x86u, 0xFCu, 0x49u, 0xB9u, 0x0Cu, 0x4Du, 0xF8u, 0x08u, 0xBDu, 0xC7u, 0x72u, 0x82u, 0x37u,
+		0xECu, 0x59u, 0xA9u, 0x1Cu, 0x66u, 0xD3u, 0x23u, 0x96u, 0xD7u, 0x62u, 0x92u, 0x27u, 0x5Du, 0xE8u, 0x18u, 0xADu,
+		0x9Au, 0x2Fu, 0xDFu, 0x6Au, 0x10u, 0xA5u, 0x55u, 0xE0u, 0xA1u, 0x14u, 0xE4u, 0x51u, 0x2Bu, 0x9Eu, 0x6Eu, 0xDBu,
+		0xF7u, 0x42u, 0xB2u, 0x07u, 0x7Du, 0xC8u, 0x38u, 0x8Du, 0xCCu, 0x79u, 0x89u, 0x3Cu, 0x46u, 0xF3u, 0x03u, 0xB6u,
+		0x81u, 0x34u, 0xC4u, 0x71u, 0x0Bu, 0xBEu, 0x4Eu, 0xFBu, 0xBAu, 0x0Fu, 0xFFu, 0x4Au, 0x30u, 0x85u, 0x75u, 0xC0u,
+		0x1Bu, 0xAEu, 0x5Eu, 0xEBu, 0x91u, 0x24u, 0xD4u, 0x61u, 0x20u, 0x95u, 0x65u, 0xD0u, 0xAAu, 0x1Fu, 0xEFu, 0x5Au,
+		0x6Du, 0xD8u, 0x28u, 0x9Du, 0xE7u, 0x52u, 0xA2u, 0x17u, 0x56u, 0xE3u, 0x13u, 0xA6u, 0xDCu, 0x69u, 0x99u, 0x2Cu,
+		0xC1u, 0x74u, 0x84u, 0x31u, 0x4Bu, 0xFEu, 0x0Eu, 0xBBu, 0xFAu, 0x4Fu, 0xBFu, 0x0Au, 0x70u, 0xC5u, 0x35u, 0x80u,
+		0xB7u, 0x02u, 0xF2u, 0x47u, 0x3Du, 0x88u, 0x78u, 0xCDu, 0x8Cu, 0x39u, 0xC9u, 0x7Cu, 0x06u, 0xB3u, 0x43u, 0xF6u,
+		0x2Du, 0x98u, 0x68u, 0xDDu, 0xA7u, 0x12u, 0xE2u, 0x57u, 0x16u, 0xA3u, 0x53u, 0xE6u, 0x9Cu, 0x29u, 0xD9u, 0x6Cu,
+		0x5Bu, 0xEEu, 0x1Eu, 0xABu, 0xD1u, 0x64u, 0x94u, 0x21u, 0x60u, 0xD5u, 0x25u, 0x90u, 0xEAu, 0x5Fu, 0xAFu, 0x1Au,
+		0x36u, 0x83u, 0x73u, 0xC6u, 0xBCu, 0x09u, 0xF9u, 0x4Cu, 0x0Du, 0xB8u, 0x48u, 0xFDu, 0x87u, 0x32u, 0xC2u, 0x77u,
+		0x40u, 0xF5u, 0x05u, 0xB0u, 0xCAu, 0x7Fu, 0x8Fu, 0x3Au, 0x7Bu, 0xCEu, 0x3Eu, 0x8Bu, 0xF1u, 0x44u, 0xB4u, 0x01u,
+		0xDAu, 0x6Fu, 0x9Fu, 0x2Au, 0x50u, 0xE5u, 0x15u, 0xA0u, 0xE1u, 0x54u, 0xA4u, 0x11u, 0x6Bu, 0xDEu, 0x2Eu, 0x9Bu,
+		0xACu, 0x19u, 0xE9u, 0x5Cu, 0x26u, 0x93u, 0x63u, 0xD6u, 0x97u, 0x22u, 0xD2u, 0x67u, 0x1Du, 0xA8u, 0x58u, 0xEDu
+	},
+#endif
+#if (CRC_8H2F_SLICES >= 8)
+	{
+		0x00u, 0xADu, 0x75u, 0xD8u, 0xEAu, 0x47u, 0x9Fu, 0x32u, 0xFBu, 0x56u, 0x8Eu, 0x23u, 0x11u, 0xBCu, 0x64u, 0xC9u,
+		0xD9u, 0x74u, 0xACu, 0x01u, 0x33u, 0x9Eu, 0x46u, 0xEBu, 0x22u, 0x8Fu, 0x57u, 0xFAu, 0xC8u, 0x65u, 0xBDu, 0x10u,
+		0x9Du, 0x30u, 0xE8u, 0x45u, 0x77u, 0xDAu, 0x02u, 0xAFu, 0x66u, 0xCBu, 0x13u, 0xBEu, 0x8Cu, 0x21u, 0xF9u, 0x54u,
+		0x44u, 0xE9u, 0x31u, 0x9Cu, 0xAEu, 0x03u, 0xDBu, 0x76u, 0xBFu, 0x12u, 0xCAu, 0x67u, 0x55u, 0xF8u, 0x20u, 0x8Du,
+		0x15u, 0xB8u, 0x60u, 0xCDu, 0xFFu, 0x52u, 0x8Au, 0x27u, 0xEEu, 0x43u, 0x9Bu, 0x36u, 0x04u, 0xA9u, 0x71u, 0xDCu,
+		0xCCu, 0x61u, 0xB9u, 0x14u, 0x26u, 0x8Bu, 0x53u, 0xFEu, 0x37u, 0x9Au, 0x42u, 0xEFu, 0xDDu, 0x70u, 0xA8u, 0x05u,
+		0x88u, 0x25u, 0xFDu, 0x50u, 0x62u, 0xCFu, 0x17u, 0xBAu, 0x73u, 0xDEu, 0x06u, 0xABu, 0x99u, 0x34u, 0xECu, 0x41u,
+		0x51u, 0xFCu, 0x24u, 0x89u, 0xBBu, 0x16u, 0xCEu, 0x63u, 0xAAu, 0x07u, 0xDFu, 0x72u, 0x40u, 0xEDu, 0x35u, 0x98u,
+		0x2Au, 0x87u, 0x5Fu, 0xF2u, 0xC0u, 0x6Du, 0xB5u, 0x18u, 0xD1u, 0x7Cu, 0xA4u, 0x09u, 0x3Bu, 0x96u, 0x4Eu, 0xE3u,
+		0xF3u, 0x5Eu, 0x86u, 0x2Bu, 0x19u, 0xB4u, 0x6Cu, 0xC1u, 0x08u, 0xA5u, 0x7Du, 0xD0u, 0xE2u, 0x4Fu, 0x97u, 0x3Au,
+		0xB7u, 0x1Au, 0xC2u, 0x6Fu, 0x5Du, 0xF0u, 0x28u, 0x85u, 0x4Cu, 0xE1u, 0x39u, 0x94u, 0xA6u, 0x0Bu, 0xD3u, 0x7Eu,
+		0x6Eu, 0xC3u, 0x1Bu, 0xB6u, 0x84u, 0x29u, 0xF1u, 0x5Cu, 0x95u, 0x38u, 0xE0u, 0x4Du, 0x7Fu, 0xD2u, 0x0Au, 0xA7u,
+		0x3Fu, 0x92u, 0x4Au, 0xE7u, 0xD5u, 0x78u, 0xA0u, 0x0Du, 0xC4u, 0x69u, 0xB1u, 0x1Cu, 0x2Eu, 0x83u, 0x5Bu, 0xF6u,
+		0xE6u, 0x4Bu, 0x93u, 0x3Eu, 0x0Cu, 0xA1u, 0x79u, 0xD4u, 0x1Du, 0xB0u, 0x68u, 0xC5u, 0xF7u, 0x5Au, 0x82u, 0x2Fu,
+		0xA2u, 0x0Fu, 0xD7u, 0x7Au, 0x48u, 0xE5u, 0x3Du, 0x90u, 0x59u, 0xF4u, 0x2Cu, 0x81u, 0xB3u, 0x1Eu, 0xC6u, 0x6Bu,
+		0x7Bu, 0xD6u, 0x0Eu, 0xA3u, 0x91u, 0x3Cu, 0xE4u, 0x49u, 0x80u, 0x2Du, 0xF5u, 0x58u, 0x6Au, 0xC7u, 0x1Fu, 0xB2u
+	},
+	{
+		0x00u, 0x54u, 0xA8u, 0xFCu, 0x7Fu, 0x2Bu, 0xD7u, 0x83u, 0xFEu, 0xAAu, 0x56u, 0x02u, 0x81u, 0xD5u, 0x29u, 0x7Du,
+		0xD3u, 0x87u, 0x7Bu, 0x2Fu, 0xACu, 0xF8u, 0x04u, 0x50u, 0x2Du, 0x79u, 0x85u, 0xD1u, 0x52u, 0x06u, 0xFAu, 0xAEu,
+		0x89u, 0xDDu, 0x21u, 0x75u, 0xF6u, 0xA2u, 0x5Eu, 0x0Au, 0x77u, 0x23u, 0xDFu, 0x8Bu, 0x08u, 0x5Cu, 0xA0u, 0xF4u,
+		0x5Au, 0x0Eu, 0xF2u, 0xA6u, 0x25u, 0x71u, 0x8Du, 0xD9u, 0xA4u, 0xF0u, 0x0Cu, 0x58u, 0xDBu, 0x8Fu, 0x73u, 0x27u,
+		0x3Du, 0x69u, 0x95u, 0xC1u, 0x42u, 0x16u, 0xEAu, 0xBEu, 0xC3u, 0x97u, 0x6Bu, 0x3Fu, 0xBCu, 0xE8u, 0x14u, 0x40u,
+		0xEEu, 0xBAu, 0x46u, 0x12u, 0x91u, 0xC5u, 0x39u, 0x6Du, 0x10u, 0x44u, 0xB8u, 0xECu, 0x6Fu, 0x3Bu, 0xC7u, 0x93u,
+		0xB4u, 0xE0u, 0x1Cu, 0x48u, 0xCBu, 0x9Fu, 0x63u, 0x37u, 0x4Au, 0x1Eu, 0xE2u, 0xB6u, 0x35u, 0x61u, 0x9Du, 0xC9u,
+		0x67u, 0x33u, 0xCFu, 0x9Bu, 0x18u, 0x4Cu, 0xB0u, 0xE4u, 0x99u, 0xCDu, 0x31u, 0x65u, 0xE6u, 0xB2u, 0x4Eu, 0x1Au,
+		0x7Au, 0x2Eu, 0xD2u, 0x86u, 0x05u, 0x51u, 0xADu, 0xF9u, 0x84u, 0xD0u, 0x2Cu, 0x78u, 0xFBu, 0xAFu, 0x53u, 0x07u,
+		0xA9u, 0xFDu, 0x01u, 0x55u, 0xD6u, 0x82u, 0x7Eu, 0x2Au, 0x57u, 0x03u, 0xFFu, 0xABu, 0x28u, 0x7Cu, 0x80u, 0xD4u,
+		0xF3u, 0xA7u, 0x5Bu, 0x0Fu, 0x8Cu, 0xD8u, 0x24u, 0x70u, 0x0Du, 0x59u, 0xA5u, 0xF1u, 0x72u, 0x26u, 0xDAu, 0x8Eu,
+		0x20u, 0x74u, 0x88u, 0xDCu, 0x5Fu, 0x0Bu, 0xF7u, 0xA3u, 0xDEu, 0x8Au, 0x76u, 0x22u, 0xA1u, 0xF5u, 0x09u, 0x5Du,
+		0x47u, 0x13u, 0xEFu, 0xBBu, 0x38u, 0x6Cu, 0x90u, 0xC4u, 0xB9u, 0xEDu, 0x11u, 0x45u, 0xC6u, 0x92u, 0x6Eu, 0x3Au,
+		0x94u, 0xC0u, 0x3Cu, 0x68u, 0xEBu, 0xBFu, 0x43u, 0x17u, 0x6Au, 0x3Eu, 0xC2u, 0x96u, 0x15u, 0x41u, 0xBDu, 0xE9u,
+		0xCEu, 0x9Au, 0x66u, 0x32u, 0xB1u, 0xE5u, 0x19u, 0x4Du, 0x30u, 0x64u, 0x98u, 0xCCu, 0x4Fu, 0x1Bu, 0xE7u, 0xB3u,
+		0x1Du, 0x49u, 0xB5u, 0xE1u, 0x62u, 0x36u, 0xCAu, 0x9Eu, 0xE3u, 0xB7u, 0x4Bu, 0x1Fu, 0x9Cu, 0xC8u, 0x34u, 0x60u
+	},
+	{
+		0x00u, 0xF4u, 0xC7u, 0x33u, 0xA1u, 0x55u, 0x66u, 0x92u, 0x6Du, 0x99u, 0xAAu, 0x5Eu, 0xCCu, 0x38u, 0x0Bu, 0xFFu,
+		0xDAu, 0x2Eu, 0x1Du, 0xE9u, 0x7Bu, 0x8Fu, 0xBCu, 0x48u, 0xB7u, 0x43u, 0x70u, 0x84u, 0x16u, 0xE2u, 0xD1u, 0x25u,
+		0x9Bu, 0x6Fu, 0x5Cu, 0xA8u, 0x3Au, 0xCEu, 0xFDu, 0x09u, 0xF6u, 0x02u, 0x31u, 0xC5u, 0x57u, 0xA3u, 0x90u, 0x64u,
+		0x41u, 0xB5u, 0x86u, 0x72u, 0xE0u, 0x14u, 0x27u, 0xD3u, 0x2Cu, 0xD8u, 0xEBu, 0x1Fu, 0x8Du, 0x79u, 0x4Au, 0xBEu,
+		0x19u, 0xEDu, 0xDEu, 0x2Au, 0xB8u, 0x4Cu, 0x7Fu, 0x8Bu, 0x74u, 0x80u, 0xB3u, 0x47u, 0xD5u, 0x21u, 0x12u, 0xE6u,
+		0xC3u, 0x37u, 0x04u, 0xF0u, 0x62u, 0x96u, 0xA5u, 0x51u, 0xAEu, 0x5Au, 0x69u, 0x9Du, 0x0Fu, 0xFBu, 0xC8u, 0x3Cu,
+		0x82u, 0x76u, 0x45u, 0xB1u, 0x23u, 0xD7u, 0xE4u, 0x10u, 0xEFu, 0x1Bu, 0x28u, 0xDCu, 0x4Eu, 0xBAu, 0x89u, 0x7Du,
+		0x58u, 0xACu, 0x9Fu, 0x6Bu, 0xF9u, 0x0Du, 0x3Eu, 0xCAu, 0x35u, 0xC1u, 0xF2u, 0x06u, 0x94u, 0x60u, 0x53u, 0xA7u,
+		0x32u, 0xC6u, 0xF5u, 0x01u, 0x93u, 0x67u, 0x54u, 0xA0u, 0x5Fu, 0xABu, 0x98u, 0x6Cu, 0xFEu, 0x0Au, 0x39u, 0xCDu,
+		0xE8u, 0x1Cu, 0x2Fu, 0xDBu, 0x49u, 0xBDu, 0x8Eu, 0x7Au, 0x85u, 0x71u, 0x42u, 0xB6u, 0x24u, 0xD0u, 0xE3u, 0x17u,
+		0xA9u, 0x5Du, 0x6Eu, 0x9Au, 0x08u, 0xFCu, 0xCFu, 0x3Bu, 0xC4u, 0x30u, 0x03u, 0xF7u, 0x65u, 0x91u, 0xA2u, 0x56u,
+		0x73u, 0x87u, 0xB4u, 0x40u, 0xD2u, 0x26u, 0x15u, 0xE1u, 0x1Eu, 0xEAu, 0xD9u, 0x2Du, 0xBFu, 0x4Bu, 0x78u, 0x8Cu,
+		0x2Bu, 0xDFu, 0xECu, 0x18u, 0x8Au, 0x7Eu, 0x4Du, 0xB9u, 0x46u, 0xB2u, 0x81u, 0x75u, 0xE7u, 0x13u, 0x20u, 0xD4u,
+		0xF1u, 0x05u, 0x36u, 0xC2u, 0x50u, 0xA4u, 0x97u, 0x63u, 0x9Cu, 0x68u, 0x5Bu, 0xAFu, 0x3Du, 0xC9u, 0xFAu, 0x0Eu,
+		0xB0u, 0x44u, 0x77u, 0x83u, 0x11u, 0xE5u, 0xD6u, 0x22u, 0xDDu, 0x29u, 0x1Au, 0xEEu, 0x7Cu, 0x88u, 0xBBu, 0x4Fu,
+		0x6Au, 0x9Eu, 0xADu, 0x59u, 0xCBu, 0x3Fu, 0x0Cu, 0xF8u, 0x07u, 0xF3u, 0xC0u, 0x34u, 0xA6u, 0x52u, 0x61u, 0x95u
+	},
+	{
+		0x00u, 0x64u, 0xC8u, 0xACu, 0xBFu, 0xDBu, 0x77u, 0x13u, 0x51u, 0x35u, 0x99u, 0xFDu, 0xEEu, 0x8Au, 0x26u, 0x42u,
+		0xA2u, 0xC6u, 0x6Au, 0x0Eu, 0x1Du, 0x79u, 0xD5u, 0xB1u, 0xF3u, 0x97u, 0x3Bu, 0x5Fu, 0x4Cu, 0x28u, 0x84u, 0xE0u,
+		0x6Bu, 0x0Fu, 0xA3u, 0xC7u, 0xD4u, 0xB0u, 0x1Cu, 0x78u, 0x3Au, 0x5Eu, 0xF2u, 0x96u, 0x85u, 0xE1u, 0x4Du, 0x29u,
+		0xC9u, 0xADu, 0x01u, 0x65u, 0x76u, 0x12u, 0xBEu, 0xDAu, 0x98u, 0xFCu, 0x50u, 0x34u, 0x27u, 0x43u, 0xEFu, 0x8Bu,
+		0xD6u, 0xB2u, 0x1Eu, 0x7Au, 0x69u, 0x0Du, 0xA1u, 0xC5u, 0x87u, 0xE3u, 0x4Fu, 0x2Bu, 0x38u, 0x5Cu, 0xF0u, 0x94u,
+		0x74u, 0x10u, 0xBCu, 0xD8u, 0xCBu, 0xAFu, 0x03u, 0x67u, 0x25u, 0x41u, 0xEDu, 0x89u, 0x9Au, 0xFEu, 0x52u, 0x36u,
+		0xBDu, 0xD9u, 0x75u, 0x11u, 0x02u, 0x66u, 0xCAu, 0xAEu, 0xECu, 0x88u, 0x24u, 0x40u, 0x53u, 0x37u, 0x9Bu, 0xFFu,
+		0x1Fu, 0x7Bu, 0xD7u, 0xB3u, 0xA0u, 0xC4u, 0x68u, 0x0Cu, 0x4Eu, 0x2Au, 0x86u, 0xE2u, 0xF1u, 0x95u, 0x39u, 0x5Du,
+		0x83u, 0xE7u, 0x4Bu, 0x2Fu, 0x3Cu, 0x58u, 0xF4u, 0x90u, 0xD2u, 0xB6u, 0x1Au, 0x7Eu, 0x6Du, 0x09u, 0xA5u, 0xC1u,
+		0x21u, 0x45u, 0xE9u, 0x8Du, 0x9Eu, 0xFAu, 0x56u, 0x32u, 0x70u, 0x14u, 0xB8u, 0xDCu, 0xCFu, 0xABu, 0x07u, 0x63u,
+		0xE8u, 0x8Cu, 0x20u, 0x44u, 0x57u, 0x33u, 0x9Fu, 0xFBu, 0xB9u, 0xDDu, 0x71u, 0x15u, 0x06u, 0x62u, 0xCEu, 0xAAu,
+		0x4Au, 0x2Eu, 0x82u, 0xE6u, 0xF5u, 0x91u, 0x3Du, 0x59u, 0x1Bu, 0x7Fu, 0xD3u, 0xB7u, 0xA4u, 0xC0u, 0x6Cu, 0x08u,
+		0x55u, 0x31u, 0x9Du, 0xF9u, 0xEAu, 0x8Eu, 0x22u, 0x46u, 0x04u, 0x60u, 0xCCu, 0xA8u, 0xBBu, 0xDFu, 0x73u, 0x17u,
+		0xF7u, 0x93u, 0x3Fu, 0x5Bu, 0x48u, 0x2Cu, 0x80u, 0xE4u, 0xA6u, 0xC2u, 0x6Eu, 0x0Au, 0x19u, 0x7Du, 0xD1u, 0xB5u,
+		0x3Eu, 0x5Au, 0xF6u, 0x92u, 0x81u, 0xE5u, 0x49u, 0x2Du, 0x6Fu, 0x0Bu, 0xA7u, 0xC3u, 0xD0u, 0xB4u, 0x18u, 0x7Cu,
+		0x9Cu, 0xF8u, 0x54u, 0x30u, 0x23u, 0x47u, 0xEBu, 0x8Fu, 0xCDu, 0xA9u, 0x05u, 0x61u, 0x72u, 0x16u, 0xBAu, 0xDEu
+	},
+#endif
+};
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CRC-16 CCITT-FALSE (poly 0x1021)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (CRC_16_MODE == CRC_MODE_NIBBLE)
+CRC_TABLE_CONST uint16_t Crc_Nibble16[16] =
+{
+	0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+	0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+#endif
+
+#if (CRC_16_MODE >= CRC_MODE_TABLE)
+CRC_TABLE_CONST uint16_t Crc_Table16[CRC_16_SLICES][256] =
+{
+	{
+		0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+		0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu,
+		0x1231u, 0x0210u, 0x3273u, 0x2252u, 0x52B5u, 0x4294u, 0x72F7u, 0x62D6u,
+		0x9339u, 0x8318u, 0xB37Bu, 0xA35Au, 0xD3BDu, 0xC39Cu, 0xF3FFu, 0xE3DEu,
+		0x2462u, 0x3443u, 0x0420u, 0x1401u, 0x64E6u, 0x74C7u, 0x44A4u, 0x5485u,
+		0xA56Au, 0xB54Bu, 0x8528u, 0x9509u, 0xE5EEu, 0xF5CFu, 0xC5ACu, 0xD58Du,
+		0x3653u, 0x2672u, 0x1611u, 0x0630u, 0x76D7u, 0x66F6u, 0x5695u, 0x46B4u,
+		0xB75Bu, 0xA77Au, 0x9719u, 0x8738u, 0xF7DFu, 0xE7FEu, 0xD79Du, 0xC7BCu,
+		0x48C4u, 0x58E5u, 0x6886u, 0x78A7u, 0x0840u, 0x1861u, 0x2802u, 0x3823u,
+		0xC9CCu, 0xD9EDu, 0xE98Eu, 0xF9AFu, 0x8948u, 0x9969u, 0xA90Au, 0xB92Bu,
+		0x5AF5u, 0x4AD4u, 0x7AB7u, 0x6A96u, 0x1A71u, 0x0A50u, 0x3A33u, 0x2A12u,
+		0xDBFDu, 0xCBDCu, 0xFBBFu, 0xEB9Eu, 0x9B79u, 0x8B58u, 0xBB3Bu, 0xAB1Au,
+		0x6CA6u, 0x7C87u, 0x4CE4u, 0x5CC5u, 0x2C22u, 0x3C03u, 0x0C60u, 0x1C41u,
+		0xEDAEu, 0xFD8Fu, 0xCDECu, 0xDDCDu, 0xAD2Au, 0xBD0Bu, 0x8D68u, 0x9D49u,
+		0x7E97u, 0x6EB6u, 0x5ED5u, 0x4EF4u, 0x3E13u, 0x2E32u, 0x1E51u, 0x0E70u,
+		0xFF9Fu, 0xEFBEu, 0xDFDDu, 0xCFFCu, 0xBF1Bu, 0xAF3Au, 0x9F59u, 0x8F78u,
+		0x9188u, 0x81A9u, 0xB1CAu, 0xA1EBu, 0xD10Cu, 0xC12Du, 0xF14Eu, 0xE16Fu,
+		0x1080u, 0x00A1u, 0x30C2u, 0x20E3u, 0x5004u, 0x4025u, 0x7046u, 0x6067u,
+		0x83B9u, 0x9398u, 0xA3FBu, 0xB3DAu, 0xC33Du, 0xD31Cu, 0xE37Fu, 0xF35Eu,
+		0x02B1u, 0x1290u, 0x22F3u, 0x32D2u, 0x4235u, 0x5214u, 0x6277u, 0x7256u,
+		0xB5EAu, 0xA5CBu, 0x95A8u, 0x8589u, 0xF56Eu, 0xE54Fu, 0xD52Cu, 0xC50Du,
+		0x34E2u, 0x24C3u, 0x14A0u, 0x0481u, 0x7466u, 0x6447u, 0x5424u, 0x4405u,
+		0xA7DBu, 0xB7FAu, 0x8799u, 0x97B8u, 0xE75Fu, 0xF77Eu, 0xC71Du, 0xD73Cu,
+		0x26D3u, 0x36F2u, 0x0691u, 0x16B0u, 0x6657u, 0x7676u, 0x4615u, 0x5634u,
+		0xD94Cu, 0xC96Du, 0xF90Eu, 0xE92Fu, 0x99C8u, 0x89E9u, 0xB98Au, 0xA9ABu,
+		0x5844u, 0x4865u, 0x7806u, 0x6827u, 0x18C0u, 0x08E1u, 0x3882u, 0x28A3u,
+		0xCB7Du, 0xDB5Cu, 0xEB3Fu, 0xFB1Eu, 0x8BF9u, 0x9BD8u, 0xABBBu, 0xBB9Au,
+		0x4A75u, 0x5A54u, 0x6A37u, 0x7A16u, 0x0AF1u, 0x1AD0u, 0x2AB3u, 0x3A92u,
+		0xFD2Eu, 0xED0Fu, 0xDD6Cu, 0xCD4Du, 0xBDAAu, 0xAD8Bu, 0x9DE8u, 0x8DC9u,
+		0x7C26u, 0x6C07u, 0x5C64u, 0x4C45u, 0x3CA2u, 0x2C83u, 0x1CE0u, 0x0CC1u,
+		0xEF1Fu, 0xFF3Eu, 0xCF5Du, 0xDF7Cu, 0xAF9Bu, 0xBFBAu, 0x8FD9u, 0x9FF8u,
+		0x6E17u, 0x7E36u, 0x4E55u, 0x5E74u, 0x2E93u, 0x3EB2u, 0x0ED1u, 0x1EF0u
+	},
+#if (CRC_16_SLICES >= 4)
+	{
+		0x0000u, 0x3331u, 0x6662u, 0x5553u, 0xCCC4u, 0xFFF5u, 0xAAA6u, 0x9997u,
+		0x89A9u, 0xBA98u, 0xEFCBu, 0xDCFAu, 0x456Du, 0x765Cu, 0x230Fu, 0x103Eu,
+		0x0373u, 0x3042u, 0x6511u, 0x5620u, 0xCFB7u, 0xFC86u, 0xA9D5u, 0x9AE4u,
+		0x8ADAu, 0xB9EBu, 0xECB8u, 0xDF89u, 0x461Eu, 0x752Fu, 0x207Cu, 0x134Du,
+		0x06E6u, 0x35D7u, 0x6084u, 0x53B5u, 0xCA22u, 0xF913u, 0xAC40u, 0x9F71u,
+		0x8F4Fu, 0xBC7Eu, 0xE92Du, 0xDA1Cu, 0x438Bu, 0x70BAu, 0x25E9u, 0x16D8u,
+		0x0595u, 0x36A4u, 0x63F7u, 0x50C6u, 0xC951u, 0xFA60u, 0xAF33u, 0x9C02u,
+		0x8C3Cu, 0xBF0Du, 0xEA5Eu, 0xD96Fu, 0x40F8u, 0x73C9u, 0x269Au, 0x15ABu,
+		0x0DCCu, 0x3EFDu, 0x6BAEu, 0x589Fu, 0xC108u, 0xF239u, 0xA76Au, 0x945Bu,
+		0x8465u, 0xB754u, 0xE207u, 0xD136u, 0x48A1u, 0x7B90u, 0x2EC3u, 0x1DF2u,
+		0x0EBFu, 0x3D8Eu, 0x68DDu, 0x5BECu, 0xC27Bu, 0xF14Au, 0xA419u, 0x9728u,
+		0x8716u, 0xB427u, 0xE174u, 0xD245u, 0x4BD2u, 0x78E3u, 0x2DB0u, 0x1E81u,
+		0x0B2Au, 0x381Bu, 0x6D48u, 0x5E79u, 0xC7EEu, 0xF4DFu, 0xA18Cu, 0x92BDu,
+		0x8283u, 0xB1B2u, 0xE4E1u, 0xD7D0u, 0x4E47u, 0x7D76u, 0x2825u, 0x1B14u,
+		0x0859u, 0x3B68u, 0x6E3Bu, 0x5D0Au, 0xC49Du, 0xF7ACu, 0xA2FFu, 0x91CEu,
+		0x81F0u, 0xB2C1u, 0xE792u, 0xD4A3u, 0x4D34u, 0x7E05u, 0x2B56u, 0x1867u,
+		0x1B98u, 0x28A9u, 0x7DFAu, 0x4ECBu, 0xD75Cu, 0xE46Du, 0xB13Eu, 0x820Fu,
+		0x9231u, 0xA100u, 0xF453u, 0xC762u, 0x5EF5u, 0x6DC4u, 0x3897u, 0x0BA6u,
+		0x18EBu, 0x2BDAu, 0x7E89u, 0x4DB8u, 0xD42Fu, 0xE71Eu, 0xB24Du, 0x817Cu,
+		0x9142u, 0xA273u, 0xF720u, 0xC411u, 0x5D86u, 0x6EB7u, 0x3BE4u, 0x08D5u,
+		0x1D7Eu, 0x2E4Fu, 0x7B1Cu, 0x482Du, 0xD1BAu, 0xE28Bu, 0xB7D8u, 0x84E9u,
+		0x94D7u, 0xA7E6u, 0xF2B5u, 0xC184u, 0x5813u, 0x6B22u, 0x3E71u, 0x0D40u,
+		0x1E0Du, 0x2D3Cu, 0x786Fu, 0x4B5Eu, 0xD2C9u, 0xE1F8u, 0xB4ABu, 0x879Au,
+		0x97A4u, 0xA495u, 0xF1C6u, 0xC2F7u, 0x5B60u, 0x6851u, 0x3D02u, 0x0E33u,
+		0x1654u, 0x2565u, 0x7036u, 0x4307u, 0xDA90u, 0xE9A1u, 0xBCF2u, 0x8FC3u,
+		0x9FFDu, 0xACCCu, 0xF99Fu, 0xCAAEu, 0x5339u, 0x6008u, 0x355Bu, 0x066Au,
+		0x1527u, 0x2616u, 0x7345u, 0x4074u, 0xD9E3u, 0xEAD2u, 0xBF81u, 0x8CB0u,
+		0x9C8Eu, 0xAFBFu, 0xFAECu, 0xC9DDu, 0x504Au, 0x637Bu, 0x3628u, 0x0519u,
+		0x10B2u, 0x2383u, 0x76D0u, 0x45E1u, 0xDC76u, 0xEF47u, 0xBA14u, 0x8925u,
+		0x991Bu, 0xAA2Au, 0xFF79u, 0xCC48u, 0x55DFu, 0x66EEu, 0x33BDu, 0x008Cu,
+		0x13C1u, 0x20F0u, 0x75A3u, 0x4692u, 0xDF05u, 0xEC34u, 0xB967u, 0x8A56u,
+		0x9A68u, 0xA959u, 0xFC0Au, 0xCF3Bu, 0x56ACu, 0x659Du, 0x30CEu, 0x03FFu
+	},
+	{
+		0x0000u, 0x3730u, 0x6E60u, 0x5950u, 0xDCC0u, 0xEBF0u, 0xB2A0u, 0x8590u,
+		0xA9A1u, 0x9E91u, 0xC7C1u, 0xF0F1u, 0x7561u, 0x4251u, 0x1B01u, 0x2C31u,
+		0x4363u, 0x7453u, 0x2D03u, 0x1A33u, 0x9FA3u, 0xA893u, 0xF1C3u, 0xC6F3u,
+		0xEAC2u, 0xDDF2u, 0x84A2u, 0xB392u, 0x3602u, 0x0132u, 0x5862u, 0x6F52u,
+		0x86C6u, 0xB1F6u, 0xE8A6u, 0xDF96u, 0x5A06u, 0x6D36u, 0x3466u, 0x0356u,
+		0x2F67u, 0x1857u, 0x4107u, 0x7637u, 0xF3A7u, 0xC497u, 0x9DC7u, 0xAAF7u,
+		0xC5A5u, 0xF295u, 0xABC5u, 0x9CF5u, 0x1965u, 0x2E55u, 0x7705u, 0x4035u,
+		0x6C04u, 0x5B34u, 0x0264u, 0x3554u, 0xB0C4u, 0x87F4u, 0xDEA4u, 0xE994u,
+		0x1DADu, 0x2A9Du, 0x73CDu, 0x44FDu, 0xC16Du, 0xF65Du, 0xAF0Du, 0x983Du,
+		0xB40Cu, 0x833Cu, 0xDA6Cu, 0xED5Cu, 0x68CCu, 0x5FFCu, 0x06ACu, 0x319Cu,
+		0x5ECEu, 0x69FEu, 0x30AEu, 0x079Eu, 0x820Eu, 0xB53Eu, 0xEC6Eu, 0xDB5Eu,
+		0xF76Fu, 0xC05Fu, 0x990Fu, 0xAE3Fu, 0x2BAFu, 0x1C9Fu, 0x45CFu, 0x72FFu,
+		0x9B6Bu, 0xAC5Bu, 0xF50Bu, 0xC23Bu, 0x47ABu, 0x709Bu, 0x29CBu, 0x1EFBu,
+		0x32CAu, 0x05FAu, 0x5CAAu, 0x6B9Au, 0xEE0Au, 0xD93Au, 0x806Au, 0xB75Au,
+		0xD808u, 0xEF38u, 0xB668u, 0x8158u, 0x04C8u, 0x33F8u, 0x6AA8u, 0x5D98u,
+		0x71A9u, 0x4699u, 0x1FC9u, 0x28F9u, 0xAD69u, 0x9A59u, 0xC309u, 0xF439u,
+		0x3B5Au, 0x0C6Au, 0x553Au, 0x620Au, 0xE79Au, 0xD0AAu, 0x89FAu, 0xBECAu,
+		0x92FBu, 0xA5CBu, 0xFC9Bu, 0xCBABu, 0x4E3Bu, 0x790Bu, 0x205Bu, 0x176Bu,
+		0x7839u, 0x4F09u, 0x1659u, 0x2169u, 0xA4F9u, 0x93C9u, 0xCA99u, 0xFDA9u,
+		0xD198u, 0xE6A8u, 0xBFF8u, 0x88C8u, 0x0D58u, 0x3A68u, 0x6338u, 0x5408u,
+		0xBD9Cu, 0x8AACu, 0xD3FCu, 0xE4CCu, 0x615Cu, 0x566Cu, 0x0F3Cu, 0x380Cu,
+		0x143Du, 0x230Du, 0x7A5Du, 0x4D6Du, 0xC8FDu, 0xFFCDu, 0xA69Du, 0x91ADu,
+		0xFEFFu, 0xC9CFu, 0x909Fu, 0xA7AFu, 0x223Fu, 0x150Fu, 0x4C5Fu, 0x7B6Fu,
+		0x575Eu, 0x606Eu, 0x393Eu, 0x0E0Eu, 0x8B9Eu, 0xBCAEu, 0xE5FEu, 0xD2CEu,
+		0x26F7u, 0x11C7u, 0x4897u, 0x7FA7u, 0xFA37u, 0xCD07u, 0x9457u, 0xA367u,
+		0x8F56u, 0xB866u, 0xE136u, 0xD606u, 0x5396u, 0x64A6u, 0x3DF6u, 0x0AC6u,
+		0x6594u, 0x52A4u, 0x0BF4u, 0x3CC4u, 0xB954u, 0x8E64u, 0xD734u, 0xE004u,
+		0xCC35u, 0xFB05u, 0xA255u, 0x9565u, 0x10F5u, 0x27C5u, 0x7E95u, 0x49A5u,
+		0xA031u, 0x9701u, 0xCE51u, 0xF961u, 0x7CF1u, 0x4BC1u, 0x1291u, 0x25A1u,
+		0x0990u, 0x3EA0u, 0x67F0u, 0x50C0u, 0xD550u, 0xE260u, 0xBB30u, 0x8C00u,
+		0xE352u, 0xD462u, 0x8D32u, 0xBA02u, 0x3F92u, 0x08A2u, 0x51F2u, 0x66C2u,
+		0x4AF3u, 0x7DC3u, 0x2493u, 0x13A3u, 0x9633u, 0xA103u, 0xF853u, 0xCF63u
+	},
+	{
+		0x0000u, 0x76B4u, 0xED68u, 0x9BDCu, 0xCAF1u, 0xBC45u, 0x2799u, 0x512Du,
+		0x85C3u, 0xF377u, 0x68ABu, 0x1E1Fu, 0x4F32u, 0x3986u, 0xA25Au, 0xD4EEu,
+		0x1BA7u, 0x6D13u, 0xF6CFu, 0x807Bu, 0xD156u, 0xA7E2u, 0x3C3Eu, 0x4A8Au,
+		0x9E64u, 0xE8D0u, 0x730Cu, 0x05B8u, 0x5495u, 0x2221u, 0xB9FDu, 0xCF49u,
+		0x374Eu, 0x41FAu, 0xDA26u, 0xAC92u, 0xFDBFu, 0x8B0Bu, 0x10D7u, 0x6663u,
+		0xB28Du, 0xC439u, 0x5FE5u, 0x2951u, 0x787Cu, 0x0EC8u, 0x9514u, 0xE3A0u,
+		0x2CE9u, 0x5A5Du, 0xC181u, 0xB735u, 0xE618u, 0x90ACu, 0x0B70u, 0x7DC4u,
+		0xA92Au, 0xDF9Eu, 0x4442u, 0x32F6u, 0x63DBu, 0x156Fu, 0x8EB3u, 0xF807u,
+		0x6E9Cu, 0x1828u, 0x83F4u, 0xF540u, 0xA46Du, 0xD2D9u, 0x4905u, 0x3FB1u,
+		0xEB5Fu, 0x9DEBu, 0x0637u, 0x7083u, 0x21AEu, 0x571Au, 0xCCC6u, 0xBA72u,
+		0x753Bu, 0x038Fu, 0x9853u, 0xEEE7u, 0xBFCAu, 0xC97Eu, 0x52A2u, 0x2416u,
+		0xF0F8u, 0x864Cu, 0x1D90u, 0x6B24u, 0x3A09u, 0x4CBDu, 0xD761u, 0xA1D5u,
+		0x59D2u, 0x2F66u, 0xB4BAu, 0xC20Eu, 0x9323u, 0xE597u, 0x7E4Bu, 0x08FFu,
+		0xDC11u, 0xAAA5u, 0x3179u, 0x47CDu, 0x16E0u, 0x6054u, 0xFB88u, 0x8D3Cu,
+		0x4275u, 0x34C1u, 0xAF1Du, 0xD9A9u, 0x8884u, 0xFE30u, 0x65ECu, 0x1358u,
+		0xC7B6u, 0xB102u, 0x2ADEu, 0x5C6Au, 0x0D47u, 0x7BF3u, 0xE02Fu, 0x969Bu,
+		0xDD38u, 0xAB8Cu, 0x3050u, 0x46E4u, 0x17C9u, 0x617Du, 0xFAA1u, 0x8C15u,
+		0x58FBu, 0x2E4Fu, 0xB593u, 0xC327u, 0x920Au, 0xE4BEu, 0x7F62u, 0x09D6u,
+		0xC69Fu, 0xB02Bu, 0x2BF7u, 0x5D43u, 0x0C6Eu, 0x7ADAu, 0xE106u, 0x97B2u,
+		0x435Cu, 0x35E8u, 0xAE34u, 0xD880u, 0x89ADu, 0xFF19u, 0x64C5u, 0x1271u,
+		0xEA76u, 0x9CC2u, 0x071Eu, 0x71AAu, 0x2087u, 0x5633u, 0xCDEFu, 0xBB5Bu,
+		0x6FB5u, 0x1901u, 0x82DDu, 0xF469u, 0xA544u, 0xD3F0u, 0x482Cu, 0x3E98u,
+		0xF1D1u, 0x8765u, 0x1CB9u, 0x6A0Du, 0x3B20u, 0x4D94u, 0xD648u, 0xA0FCu,
+		0x7412u, 0x02A6u, 0x997Au, 0xEFCEu, 0xBEE3u, 0xC857u, 0x538Bu, 0x253Fu,
+		0xB3A4u, 0xC510u, 0x5ECCu, 0x2878u, 0x7955u, 0x0FE1u, 0x943Du, 0xE289u,
+		0x3667u, 0x40D3u, 0xDB0Fu, 0xADBBu, 0xFC96u, 0x8A22u, 0x11FEu, 0x674Au,
+		0xA803u, 0xDEB7u, 0x456Bu, 0x33DFu, 0x62F2u, 0x1446u, 0x8F9Au, 0xF92Eu,
+		0x2DC0u, 0x5B74u, 0xC0A8u, 0xB61Cu, 0xE731u, 0x9185u, 0x0A59u, 0x7CEDu,
+		0x84EAu, 0xF25Eu, 0x6982u, 0x1F36u, 0x4E1Bu, 0x38AFu, 0xA373u, 0xD5C7u,
+		0x0129u, 0x779Du, 0xEC41u, 0x9AF5u, 0xCBD8u, 0xBD6Cu, 0x26B0u, 0x5004u,
+		0x9F4Du, 0xE9F9u, 0x7225u, 0x0491u, 0x55BCu, 0x2308u, 0xB8D4u, 0xCE60u,
+		0x1A8Eu, 0x6C3Au, 0xF7E6u, 0x8152u, 0xD07Fu, 0xA6CBu, 0x3D17u, 0x4BA3u
+	},
+#endif
+#if (CRC_16_SLICES >= 8)
+	{
+		0x0000u, 0xAA51u, 0x4483u, 0xEED2u, 0x8906u, 0x2357u, 0xCD85u, 0x67D4u,
+		0x022Du, 0xA87Cu, 0x46AEu, 0xECFFu, 0x8B2Bu, 0x217Au, 0xCFA8u, 0x65F9u,
+		0x045Au, 0xAE0Bu, 0x40D9u, 0xEA88u, 0x8D5Cu, 0x270Du, 0xC9DFu, 0x638Eu,
+		0x0677u, 0xAC26u, 0x42F4u, 0xE8A5u, 0x8F71u, 0x2520u, 0xCBF2u, 0x61A3u,
+		0x08B4u, 0xA2E5u, 0x4C37u, 0xE666u, 0x81B2u, 0x2BE3u, 0xC531u, 0x6F60u,
+		0x0A99u, 0xA0C8u, 0x4E1Au, 0xE44Bu, 0x839Fu, 0x29CEu, 0xC71Cu, 0x6D4Du,
+		0x0CEEu, 0xA6BFu, 0x486Du, 0xE23Cu, 0x85E8u, 0x2FB9u, 0xC16Bu, 0x6B3Au,
+		0x0EC3u, 0xA492u, 0x4A40u, 0xE011u, 0x87C5u, 0x2D94u, 0xC346u, 0x6917u,
+		0x1168u, 0xBB39u, 0x55EBu, 0xFFBAu, 0x986Eu, 0x323Fu, 0xDCEDu, 0x76BCu,
+		0x1345u, 0xB914u, 0x57C6u, 0xFD97u, 0x9A43u, 0x3012u, 0xDEC0u, 0x7491u,
+		0x1532u, 0xBF63u, 0x51B1u, 0xFBE0u, 0x9C34u, 0x3665u, 0xD8B7u, 0x72E6u,
+		0x171Fu, 0xBD4Eu, 0x539Cu, 0xF9CDu, 0x9E19u, 0x3448u, 0xDA9Au, 0x70CBu,
+		0x19DCu, 0xB38Du, 0x5D5Fu, 0xF70Eu, 0x90DAu, 0x3A8Bu, 0xD459u, 0x7E08u,
+		0x1BF1u, 0xB1A0u, 0x5F72u, 0xF523u, 0x92F7u, 0x38A6u, 0xD674u, 0x7C25u,
+		0x1D86u, 0xB7D7u, 0x5905u, 0xF354u, 0x9480u, 0x3ED1u, 0xD003u, 0x7A52u,
+		0x1FABu, 0xB5FAu, 0x5B28u, 0xF179u, 0x96ADu, 0x3CFCu, 0xD22Eu, 0x787Fu,
+		0x22D0u, 0x8881u, 0x6653u, 0xCC02u, 0xABD6u, 0x0187u, 0xEF55u, 0x4504u,
+		0x20FDu, 0x8AACu, 0x647Eu, 0xCE2Fu, 0xA9FBu, 0x03AAu, 0xED78u, 0x4729u,
+		0x268Au, 0x8CDBu, 0x6209u, 0xC858u, 0xAF8Cu, 0x05DDu, 0xEB0Fu, 0x415Eu,
+		0x24A7u, 0x8EF6u, 0x6024u, 0xCA75u, 0xADA1u, 0x07F0u, 0xE922u, 0x4373u,
+		0x2A64u, 0x8035u, 0x6EE7u, 0xC4B6u, 0xA362u, 0x0933u, 0xE7E1u, 0x4DB0u,
+		0x2849u, 0x8218u, 0x6CCAu, 0xC69Bu, 0xA14Fu, 0x0B1Eu, 0xE5CCu, 0x4F9Du,
+		0x2E3Eu, 0x846Fu, 0x6ABDu, 0xC0ECu, 0xA738u, 0x0D69u, 0xE3BBu, 0x49EAu,
+		0x2C13u, 0x8642u, 0x6890u, 0xC2C1u, 0xA515u, 0x0F44u, 0xE196u, 0x4BC7u,
+		0x33B8u, 0x99E9u, 0x773Bu, 0xDD6Au, 0xBABEu, 0x10EFu, 0xFE3Du, 0x546Cu,
+		0x3195u, 0x9BC4u, 0x7516u, 0xDF47u, 0xB893u, 0x12C2u, 0xFC10u, 0x5641u,
+		0x37E2u, 0x9DB3u, 0x7361u, 0xD930u, 0xBEE4u, 0x14B5u, 0xFA67u, 0x5036u,
+		0x35CFu, 0x9F9Eu, 0x714Cu, 0xDB1Du, 0xBCC9u, 0x1698u, 0xF84Au, 0x521Bu,
+		0x3B0Cu, 0x915Du, 0x7F8Fu, 0xD5DEu, 0xB20Au, 0x185Bu, 0xF689u, 0x5CD8u,
+		0x3921u, 0x9370u, 0x7DA2u, 0xD7F3u, 0xB027u, 0x1A76u, 0xF4A4u, 0x5EF5u,
+		0x3F56u, 0x9507u, 0x7BD5u, 0xD184u, 0xB650u, 0x1C01u, 0xF2D3u, 0x5882u,
+		0x3D7Bu, 0x972Au, 0x79F8u, 0xD3A9u, 0xB47Du, 0x1E2Cu, 0xF0FEu, 0x5AAFu
+	},
+	{
+		0x0000u, 0x45A0u, 0x8B40u, 0xCEE0u, 0x06A1u, 0x4301u, 0x8DE1u, 0xC841u,
+		0x0D42u, 0x48E2u, 0x8602u, 0xC3A2u, 0x0BE3u, 0x4E43u, 0x80A3u, 0xC503u,
+		0x1A84u, 0x5F24u, 0x91C4u, 0xD464u, 0x1C25u, 0x5985u, 0x9765u, 0xD2C5u,
+		0x17C6u, 0x5266u, 0x9C86u, 0xD926u, 0x1167u, 0x54C7u, 0x9A27u, 0xDF87u,
+		0x3508u, 0x70A8u, 0xBE48u, 0xFBE8u, 0x33A9u, 0x7609u, 0xB8E9u, 0xFD49u,
+		0x384Au, 0x7DEAu, 0xB30Au, 0xF6AAu, 0x3EEBu, 0x7B4Bu, 0xB5ABu, 0xF00Bu,
+		0x2F8Cu, 0x6A2Cu, 0xA4CCu, 0xE16Cu, 0x292Du, 0x6C8Du, 0xA26Du, 0xE7CDu,
+		0x22CEu, 0x676Eu, 0xA98Eu, 0xEC2Eu, 0x246Fu, 0x61CFu, 0xAF2Fu, 0xEA8Fu,
+		0x6A10u, 0x2FB0u, 0xE150u, 0xA4F0u, 0x6CB1u, 0x2911u, 0xE7F1u, 0xA251u,
+		0x6752u, 0x22F2u, 0xEC12u, 0xA9B2u, 0x61F3u, 0x2453u, 0xEAB3u, 0xAF13u,
+		0x7094u, 0x3534u, 0xFBD4u, 0xBE74u, 0x7635u, 0x3395u, 0xFD75u, 0xB8D5u,
+		0x7DD6u, 0x3876u, 0xF696u, 0xB336u, 0x7B77u, 0x3ED7u, 0xF037u, 0xB597u,
+		0x5F18u, 0x1AB8u, 0xD458u, 0x91F8u, 0x59B9u, 0x1C19u, 0xD2F9u, 0x9759u,
+		0x525Au, 0x17FAu, 0xD91Au, 0x9CBAu, 0x54FBu, 0x115Bu, 0xDFBBu, 0x9A1Bu,
+		0x459Cu, 0x003Cu, 0xCEDCu, 0x8B7Cu, 0x433Du, 0x069Du, 0xC87Du, 0x8DDDu,
+		0x48DEu, 0x0D7Eu, 0xC39Eu, 0x863Eu, 0x4E7Fu, 0x0BDFu, 0xC53Fu, 0x809Fu,
+		0xD420u, 0x9180u, 0x5F60u, 0x1AC0u, 0xD281u, 0x9721u, 0x59C1u, 0x1C61u,
+		0xD962u, 0x9CC2u, 0x5222u, 0x1782u, 0xDFC3u, 0x9A63u, 0x5483u, 0x1123u,
+		0xCEA4u, 0x8B04u, 0x45E4u, 0x0044u, 0xC805u, 0x8DA5u, 0x4345u, 0x06E5u,
+		0xC3E6u, 0x8646u, 0x48A6u, 0x0D06u, 0xC547u, 0x80E7u, 0x4E07u, 0x0BA7u,
+		0xE128u, 0xA488u, 0x6A68u, 0x2FC8u, 0xE789u, 0xA229u, 0x6CC9u, 0x2969u,
+		0xEC6Au, 0xA9CAu, 0x672Au, 0x228Au, 0xEACBu, 0xAF6Bu, 0x618Bu, 0x242Bu,
+		0xFBACu, 0xBE0Cu, 0x70ECu, 0x354Cu, 0xFD0Du, 0xB8ADu, 0x764Du, 0x33EDu,
+		0xF6EEu, 0xB34Eu, 0x7DAEu, 0x380Eu, 0xF04Fu, 0xB5EFu, 0x7B0Fu, 0x3EAFu,
+		0xBE30u, 0xFB90u, 0x3570u, 0x70D0u, 0xB891u, 0xFD31u, 0x33D1u, 0x7671u,
+		0xB372u, 0xF6D2u, 0x3832u, 0x7D92u, 0xB5D3u, 0xF073u, 0x3E93u, 0x7B33u,
+		0xA4B4u, 0xE114u, 0x2FF4u, 0x6A54u, 0xA215u, 0xE7B5u, 0x2955u, 0x6CF5u,
+		0xA9F6u, 0xEC56u, 0x22B6u, 0x6716u, 0xAF57u, 0xEAF7u, 0x2417u, 0x61B7u,
+		0x8B38u, 0xCE98u, 0x0078u, 0x45D8u, 0x8D99u, 0xC839u, 0x06D9u, 0x4379u,
+		0x867Au, 0xC3DAu, 0x0D3Au, 0x489Au, 0x80DBu, 0xC57Bu, 0x0B9Bu, 0x4E3Bu,
+		0x91BCu, 0xD41Cu, 0x1AFCu, 0x5F5Cu, 0x971Du, 0xD2BDu, 0x1C5Du, 0x59FDu,
+		0x9CFEu, 0xD95Eu, 0x17BEu, 0x521Eu, 0x9A5Fu, 0xDFFFu, 0x111Fu, 0x54BFu
+	},
+	{
+		0x0000u, 0xB861u, 0x60E3u, 0xD882u, 0xC1C6u, 0x79A7u, 0xA125u, 0x1944u,
+		0x93ADu, 0x2BCCu, 0xF34Eu, 0x4B2Fu, 0x526Bu, 0xEA0Au, 0x3288u, 0x8AE9u,
+		0x377Bu, 0x8F1Au, 0x5798u, 0xEFF9u, 0xF6BDu, 0x4EDCu, 0x965Eu, 0x2E3Fu,
+		0xA4D6u, 0x1CB7u, 0xC435u, 0x7C54u, 0x6510u, 0xDD71u, 0x05F3u, 0xBD92u,
+		0x6EF6u, 0xD697u, 0x0E15u, 0xB674u, 0xAF30u, 0x1751u, 0xCFD3u, 0x77B2u,
+		0xFD5Bu, 0x453Au, 0x9DB8u, 0x25D9u, 0x3C9Du, 0x84FCu, 0x5C7Eu, 0xE41Fu,
+		0x598Du, 0xE1ECu, 0x396Eu, 0x810Fu, 0x984Bu, 0x202Au, 0xF8A8u, 0x40C9u,
+		0xCA20u, 0x7241u, 0xAAC3u, 0x12A2u, 0x0BE6u, 0xB387u, 0x6B05u, 0xD364u,
+		0xDDECu, 0x658Du, 0xBD0Fu, 0x056Eu, 0x1C2Au, 0xA44Bu, 0x7CC9u, 0xC4A8u,
+		0x4E41u, 0xF620u, 0x2EA2u, 0x96C3u, 0x8F87u, 0x37E6u, 0xEF64u, 0x5705u,
+		0xEA97u, 0x52F6u, 0x8A74u, 0x3215u, 0x2B51u, 0x9330u, 0x4BB2u, 0xF3D3u,
+		0x793Au, 0xC15Bu, 0x19D9u, 0xA1B8u, 0xB8FCu, 0x009Du, 0xD81Fu, 0x607Eu,
+		0xB31Au, 0x0B7Bu, 0xD3F9u, 0x6B98u, 0x72DCu, 0xCABDu, 0x123Fu, 0xAA5Eu,
+		0x20B7u, 0x98D6u, 0x4054u, 0xF835u, 0xE171u, 0x5910u, 0x8192u, 0x39F3u,
+		0x8461u, 0x3C00u, 0xE482u, 0x5CE3u, 0x45A7u, 0xFDC6u, 0x2544u, 0x9D25u,
+		0x17CCu, 0xAFADu, 0x772Fu, 0xCF4Eu, 0xD60Au, 0x6E6Bu, 0xB6E9u, 0x0E88u,
+		0xABF9u, 0x1398u, 0xCB1Au, 0x737Bu, 0x6A3Fu, 0xD25Eu, 0x0ADCu, 0xB2BDu,
+		0x3854u, 0x8035u, 0x58B7u, 0xE0D6u, 0xF992u, 0x41F3u, 0x9971u, 0x2110u,
+		0x9C82u, 0x24E3u, 0xFC61u, 0x4400u, 0x5D44u, 0xE525u, 0x3DA7u, 0x85C6u,
+		0x0F2Fu, 0xB74Eu, 0x6FCCu, 0xD7ADu, 0xCEE9u, 0x7688u, 0xAE0Au, 0x166Bu,
+		0xC50Fu, 0x7D6Eu, 0xA5ECu, 0x1D8Du, 0x04C9u, 0xBCA8u, 0x642Au, 0xDC4Bu,
+		0x56A2u, 0xEEC3u, 0x3641u, 0x8E20u, 0x9764u, 0x2F05u, 0xF787u, 0x4FE6u,
+		0xF274u, 0x4A15u, 0x9297u, 0x2AF6u, 0x33B2u, 0x8BD3u, 0x5351u, 0xEB30u,
+		0x61D9u, 0xD9B8u, 0x013Au, 0xB95Bu, 0xA01Fu, 0x187Eu, 0xC0FCu, 0x789Du,
+		0x7615u, 0xCE74u, 0x16F6u, 0xAE97u, 0xB7D3u, 0x0FB2u, 0xD730u, 0x6F51u,
+		0xE5B8u, 0x5DD9u, 0x855Bu, 0x3D3Au, 0x247Eu, 0x9C1Fu, 0x449Du, 0xFCFCu,
+		0x416Eu, 0xF90Fu, 0x218Du, 0x99ECu, 0x80A8u, 0x38C9u, 0xE04Bu, 0x582Au,
+		0xD2C3u, 0x6AA2u, 0xB220u, 0x0A41u, 0x1305u, 0xAB64u, 0x73E6u, 0xCB87u,
+		0x18E3u, 0xA082u, 0x7800u, 0xC061u, 0xD925u, 0x6144u, 0xB9C6u, 0x01A7u,
+		0x8B4Eu, 0x332Fu, 0xEBADu, 0x53CCu, 0x4A88u, 0xF2E9u, 0x2A6Bu, 0x920Au,
+		0x2F98u, 0x97F9u, 0x4F7Bu, 0xF71Au, 0xEE5Eu, 0x563Fu, 0x8EBDu, 0x36DCu,
+		0xBC35u, 0x0454u, 0xDCD6u, 0x64B7u, 0x7DF3u, 0xC592u, 0x1D10u, 0xA571u
+	},
+	{
+		0x0000u, 0x47D3u, 0x8FA6u, 0xC875u, 0x0F6Du, 0x48BEu, 0x80CBu, 0xC718u,
+		0x1EDAu, 0x5909u, 0x917Cu, 0xD6AFu, 0x11B7u, 0x5664u, 0x9E11u, 0xD9C2u,
+		0x3DB4u, 0x7A67u, 0xB212u, 0xF5C1u, 0x32D9u, 0x750Au, 0xBD7Fu, 0xFAACu,
+		0x236Eu, 0x64BDu, 0xACC8u, 0xEB1Bu, 0x2C03u, 0x6BD0u, 0xA3A5u, 0xE476u,
+		0x7B68u, 0x3CBBu, 0xF4CEu, 0xB31Du, 0x7405u, 0x33D6u, 0xFBA3u, 0xBC70u,
+		0x65B2u, 0x2261u, 0xEA14u, 0xADC7u, 0x6ADFu, 0x2D0Cu, 0xE579u, 0xA2AAu,
+		0x46DCu, 0x010Fu, 0xC97Au, 0x8EA9u, 0x49B1u, 0x0E62u, 0xC617u, 0x81C4u,
+		0x5806u, 0x1FD5u, 0xD7A0u, 0x9073u, 0x576Bu, 0x10B8u, 0xD8CDu, 0x9F1Eu,
+		0xF6D0u, 0xB103u, 0x7976u, 0x3EA5u, 0xF9BDu, 0xBE6Eu, 0x761Bu, 0x31C8u,
+		0xE80Au, 0xAFD9u, 0x67ACu, 0x207Fu, 0xE767u, 0xA0B4u, 0x68C1u, 0x2F12u,
+		0xCB64u, 0x8CB7u, 0x44C2u, 0x0311u, 0xC409u, 0x83DAu, 0x4BAFu, 0x0C7Cu,
+		0xD5BEu, 0x926Du, 0x5A18u, 0x1DCBu, 0xDAD3u, 0x9D00u, 0x5575u, 0x12A6u,
+		0x8DB8u, 0xCA6Bu, 0x021Eu, 0x45CDu, 0x82D5u, 0xC506u, 0x0D73u, 0x4AA0u,
+		0x9362u, 0xD4B1u, 0x1CC4u, 0x5B17u, 0x9C0Fu, 0xDBDCu, 0x13A9u, 0x547Au,
+		0xB00Cu, 0xF7DFu, 0x3FAAu, 0x7879u, 0xBF61u, 0xF8B2u, 0x30C7u, 0x7714u,
+		0xAED6u, 0xE905u, 0x2170u, 0x66A3u, 0xA1BBu, 0xE668u, 0x2E1Du, 0x69CEu,
+		0xFD81u, 0xBA52u, 0x7227u, 0x35F4u, 0xF2ECu, 0xB53Fu, 0x7D4Au, 0x3A99u,
+		0xE35Bu, 0xA488u, 0x6CFDu, 0x2B2Eu, 0xEC36u, 0xABE5u, 0x6390u, 0x2443u,
+		0xC035u, 0x87E6u, 0x4F93u, 0x0840u, 0xCF58u, 0x888Bu, 0x40FEu, 0x072Du,
+		0xDEEFu, 0x993Cu, 0x5149u, 0x169Au, 0xD182u, 0x9651u, 0x5E24u, 0x19F7u,
+		0x86E9u, 0xC13Au, 0x094Fu, 0x4E9Cu, 0x8984u, 0xCE57u, 0x0622u, 0x41F1u,
+		0x9833u, 0xDFE0u, 0x1795u, 0x5046u, 0x975Eu, 0xD08Du, 0x18F8u, 0x5F2Bu,
+		0xBB5Du, 0xFC8Eu, 0x34FBu, 0x7328u, 0xB430u, 0xF3E3u, 0x3B96u, 0x7C45u,
+		0xA587u, 0xE254u, 0x2A21u, 0x6DF2u, 0xAAEAu, 0xED39u, 0x254Cu, 0x629Fu,
+		0x0B51u, 0x4C82u, 0x84F7u, 0xC324u, 0x043Cu, 0x43EFu, 0x8B9Au, 0xCC49u,
+		0x158Bu, 0x5258u, 0x9A2Du, 0xDDFEu, 0x1AE6u, 0x5D35u, 0x9540u, 0xD293u,
+		0x36E5u, 0x7136u, 0xB943u, 0xFE90u, 0x3988u, 0x7E5Bu, 0xB62Eu, 0xF1FDu,
+		0x283Fu, 0x6FECu, 0xA799u, 0xE04Au, 0x2752u, 0x6081u, 0xA8F4u, 0xEF27u,
+		0x7039u, 0x37EAu, 0xFF9Fu, 0xB84Cu, 0x7F54u, 0x3887u, 0xF0F2u, 0xB721u,
+		0x6EE3u, 0x2930u, 0xE145u, 0xA696u, 0x618Eu, 0x265Du, 0xEE28u, 0xA9FBu,
+		0x4D8Du, 0x0A5Eu, 0xC22Bu, 0x85F8u, 0x42E0u, 0x0533u, 0xCD46u, 0x8A95u,
+		0x5357u, 0x1484u, 0xDCF1u, 0x9B22u, 0x5C3Au, 0x1BE9u, 0xD39Cu, 0x944Fu
+	},
+#endif
+};
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CRC-32 IEEE 802.3 (reflected poly 0xEDB88320)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (CRC_32_MODE == CRC_MODE_NIBBLE)
+CRC_TABLE_CONST uint32_t Crc_Nibble32[16] =
+{
+	0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+	0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+#endif
+
+#if (CRC_32_MODE >= CRC_MODE_TABLE)
+CRC_TABLE_CONST uint32_t Crc_Table32[CRC_32_SLICES][256] =
+{
+	{
+		0x00000000u, 0x77073096u, 0xEE0E612Cu, 0x990951BAu, 0x076DC419u, 0x706AF48Fu, 0xE963A535u, 0x9E6495A3u,
+		0x0EDB8832u, 0x79DCB8A4u, 0xE0D5E91Eu, 0x97D2D988u, 0x09B64C2Bu, 0x7EB17CBDu, 0xE7B82D07u, 0x90BF1D91u,
+		0x1DB71064u, 0x6AB020F2u, 0xF3B97148u, 0x84BE41DEu, 0x1ADAD47Du, 0x6DDDE4EBu, 0xF4D4B551u, 0x83D385C7u,
+		0x136C9856u, 0x646BA8C0u, 0xFD62F97Au, 0x8A65C9ECu, 0x14015C4Fu, 0x63066CD9u, 0xFA0F3D63u, 0x8D080DF5u,
+		0x3B6E20C8u, 0x4C69105Eu, 0xD56041E4u, 0xA2677172u, 0x3C03E4D1u, 0x4B04D447u, 0xD20D85FDu, 0xA50AB56Bu,
+		0x35B5A8FAu, 0x42B2986Cu, 0xDBBBC9D6u, 0xACBCF940u, 0x32D86CE3u, 0x45DF5C75u, 0xDCD60DCFu, 0xABD13D59u,
+		0x26D930ACu, 0x51DE003Au, 0xC8D75180u, 0xBFD06116u, 0x21B4F4B5u, 0x56B3C423u, 0xCFBA9599u, 0xB8BDA50Fu,
+		0x2802B89Eu, 0x5F058808u, 0xC60CD9B2u, 0xB10BE924u, 0x2F6F7C87u, 0x58684C11u, 0xC1611DABu, 0xB6662D3Du,
+		0x76DC4190u, 0x01DB7106u, 0x98D220BCu, 0xEFD5102Au, 0x71B18589u, 0x06B6B51Fu, 0x9FBFE4A5u, 0xE8B8D433u,
+		0x7807C9A2u, 0x0F00F934u, 0x9609A88Eu, 0xE10E9818u, 0x7F6A0DBBu, 0x086D3D2Du, 0x91646C97u, 0xE6635C01u,
+		0x6B6B51F4u, 0x1C6C6162u, 0x856530D8u, 0xF262004Eu, 0x6C0695EDu, 0x1B01A57Bu, 0x8208F4C1u, 0xF50FC457u,
+		0x65B0D9C6u, 0x12B7E950u, 0x8BBEB8EAu, 0xFCB9887Cu, 0x62DD1DDFu, 0x15DA2D49u, 0x8CD37CF3u, 0xFBD44C65u,
+		0x4DB26158u, 0x3AB551CEu, 0xA3BC0074u, 0xD4BB30E2u, 0x4ADFA541u, 0x3DD895D7u, 0xA4D1C46Du, 0xD3D6F4FBu,
+		0x4369E96Au, 0x346ED9FCu, 0xAD678846u, 0xDA60B8D0u, 0x44042D73u, 0x33031DE5u, 0xAA0A4C5Fu, 0xDD0D7CC9u,
+		0x5005713Cu, 0x270241AAu, 0xBE0B1010u, 0xC90C2086u, 0x5768B525u, 0x206F85B3u, 0xB966D409u, 0xCE61E49Fu,
+		0x5EDEF90Eu, 0x29D9C998u, 0xB0D09822u, 0xC7D7A8B4u, 0x59B33D17u, 0x2EB40D81u, 0xB7BD5C3Bu, 0xC0BA6CADu,
+		0xEDB88320u, 0x9ABFB3B6u, 0x03B6E20Cu, 0x74B1D29Au, 0xEAD54739u, 0x9DD277AFu, 0x04DB2615u, 0x73DC1683u,
+		0xE3630B12u, 0x94643B84u, 0x0D6D6A3Eu, 0x7A6A5AA8u, 0xE40ECF0Bu, 0x9309FF9Du, 0x0A00AE27u, 0x7D079EB1u,
+		0xF00F9344u, 0x8708A3D2u, 0x1E01F268u, 0x6906C2FEu, 0xF762575Du, 0x806567CBu, 0x196C3671u, 0x6E6B06E7u,
+		0xFED41B76u, 0x89D32BE0u, 0x10DA7A5Au, 0x67DD4ACCu, 0xF9B9DF6Fu, 0x8EBEEFF9u, 0x17B7BE43u, 0x60B08ED5u,
+		0xD6D6A3E8u, 0xA1D1937Eu, 0x38D8C2C4u, 0x4FDFF252u, 0xD1BB67F1u, 0xA6BC5767u, 0x3FB506DDu, 0x48B2364Bu,
+		0xD80D2BDAu, 0xAF0A1B4Cu, 0x36034AF6u, 0x41047A60u, 0xDF60EFC3u, 0xA867DF55u, 0x316E8EEFu, 0x4669BE79u,
+		0xCB61B38Cu, 0xBC66831Au, 0x256FD2A0u, 0x5268E236u, 0xCC0C7795u, 0xBB0B4703u, 0x220216B9u, 0x5505262Fu,
+		0xC5BA3BBEu, 0xB2BD0B28u, 0x2BB45A92u, 0x5CB36A04u, 0xC2D7FFA7u, 0xB5D0CF31u, 0x2CD99E8Bu, 0x5BDEAE1Du,
+		0x9B64C2B0u, 0xEC63F226u, 0x756AA39Cu, 0x026D930Au, 0x9C0906A9u, 0xEB0E363Fu, 0x72076785u, 0x05005713u,
+		0x95BF4A82u, 0xE2B87A14u, 0x7BB12BAEu, 0x0CB61B38u, 0x92D28E9Bu, 0xE5D5BE0Du, 0x7CDCEFB7u, 0x0BDBDF21u,
+		0x86D3D2D4u, 0xF1D4E242u, 0x68DDB3F8u, 0x1FDA836Eu, 0x81BE16CDu, 0xF6B9265Bu, 0x6FB077E1u, 0x18B74777u,
+		0x88085AE6u, 0xFF0F6A70u, 0x66063BCAu, 0x11010B5Cu, 0x8F659EFFu, 0xF862AE69u, 0x616BFFD3u, 0x166CCF45u,
+		0xA00AE278u, 0xD70DD2EEu, 0x4E048354u, 0x3903B3C2u, 0xA7672661u, 0xD06016F7u, 0x4969474Du, 0x3E6E77DBu,
+		0xAED16A4Au, 0xD9D65ADCu, 0x40DF0B66u, 0x37D83BF0u, 0xA9BCAE53u, 0xDEBB9EC5u, 0x47B2CF7Fu, 0x30B5FFE9u,
+		0xBDBDF21Cu, 0xCABAC28Au, 0x53B39330u, 0x24B4A3A6u, 0xBAD03605u, 0xCDD70693u, 0x54DE5729u, 0x23D967BFu,
+		0xB3667A2Eu, 0xC4614AB8u, 0x5D681B02u, 0x2A6F2B94u, 0xB40BBE37u, 0xC30C8EA1u, 0x5A05DF1Bu, 0x2D02EF8Du
+	},
+#if (CRC_32_SLICES >= 4)
+	{
+		0x00000000u, 0x191B3141u, 0x32366282u, 0x2B2D53C3u, 0x646CC504u, 0x7D77F445u, 0x565AA786u, 0x4F4196C7u,
+		0xC8D98A08u, 0xD1C2BB49u, 0xFAEFE88Au, 0xE3F4D9CBu, 0xACB54F0Cu, 0xB5AE7E4Du, 0x9E832D8Eu, 0x87981CCFu,
+		0x4AC21251u, 0x53D92310u, 0x78F470D3u, 0x61EF4192u, 0x2EAED755u, 0x37B5E614u, 0x1C98B5D7u, 0x05838496u,
+		0x821B9859u, 0x9B00A918u, 0xB02DFADBu, 0xA936CB9Au, 0xE6775D5Du, 0xFF6C6C1Cu, 0xD4413FDFu, 0xCD5A0E9Eu,
+		0x958424A2u, 0x8C9F15E3u, 0xA7B24620u, 0xBEA97761u, 0xF1E8E1A6u, 0xE8F3D0E7u, 0xC3DE8324u, 0xDAC5B265u,
+		0x5D5DAEAAu, 0x44469FEBu, 0x6F6BCC28u, 0x7670FD69u, 0x39316BAEu, 0x202A5AEFu, 0x0B07092Cu, 0x121C386Du,
+		0xDF4636F3u, 0xC65D07B2u, 0xED705471u, 0xF46B6530u, 0xBB2AF3F7u, 0xA231C2B6u, 0x891C9175u, 0x9007A034u,
+		0x179FBCFBu, 0x0E848DBAu, 0x25A9DE79u, 0x3CB2EF38u, 0x73F379FFu, 0x6AE848BEu, 0x41C51B7Du, 0x58DE2A3Cu,
+		0xF0794F05u, 0xE9627E44u, 0xC24F2D87u, 0xDB541CC6u, 0x94158A01u, 0x8D0EBB40u, 0xA623E883u, 0xBF38D9C2u,
+		0x38A0C50Du, 0x21BBF44Cu, 0x0A96A78Fu, 0x138D96CEu, 0x5CCC0009u, 0x45D73148u, 0x6EFA628Bu, 0x77E153CAu,
+		0xBABB5D54u, 0xA3A06C15u, 0x888D3FD6u, 0x91960E97u, 0xDED79850u, 0xC7CCA911u, 0xECE1FAD2u, 0xF5FACB93u,
+		0x7262D75Cu, 0x6B79E61Du, 0x4054B5DEu, 0x594F849Fu, 0x160E1258u, 0x0F152319u, 0x243870DAu, 0x3D23419Bu,
+		0x65FD6BA7u, 0x7CE65AE6u, 0x57CB0925u, 0x4ED03864u, 0x0191AEA3u, 0x188A9FE2u, 0x33A7CC21u, 0x2ABCFD60u,
+		0xAD24E1AFu, 0xB43FD0EEu, 0x9F12832Du, 0x8609B26Cu, 0xC94824ABu, 0xD05315EAu, 0xFB7E4629u, 0xE2657768u,
+		0x2F3F79F6u, 0x362448B7u, 0x1D091B74u, 0x04122A35u, 0x4B53BCF2u, 0x52488DB3u, 0x7965DE70u, 0x607EEF31u,
+		0xE7E6F3FEu, 0xFEFDC2BFu, 0xD5D0917Cu, 0xCCCBA03Du, 0x838A36FAu, 0x9A9107BBu, 0xB1BC5478u, 0xA8A76539u,
+		0x3B83984Bu, 0x2298A90Au, 0x09B5FAC9u, 0x10AECB88u, 0x5FEF5D4Fu, 0x46F46C0Eu, 0x6DD93FCDu, 0x74C20E8Cu,
+		0xF35A1243u, 0xEA412302u, 0xC16C70C1u, 0xD8774180u, 0x9736D747u, 0x8E2DE606u, 0xA500B5C5u, 0xBC1B8484u,
+		0x71418A1Au, 0x685ABB5Bu, 0x4377E898u, 0x5A6CD9D9u, 0x152D4F1Eu, 0x0C367E5Fu, 0x271B2D9Cu, 0x3E001CDDu,
+		0xB9980012u, 0xA0833153u, 0x8BAE6290u, 0x92B553D1u, 0xDDF4C516u, 0xC4EFF457u, 0xEFC2A794u, 0xF6D996D5u,
+		0xAE07BCE9u, 0xB71C8DA8u, 0x9C31DE6Bu, 0x852AEF2Au, 0xCA6B79EDu, 0xD37048ACu, 0xF85D1B6Fu, 0xE1462A2Eu,
+		0x66DE36E1u, 0x7FC507A0u, 0x54E85463u, 0x4DF36522u, 0x02B2F3E5u, 0x1BA9C2A4u, 0x30849167u, 0x299FA026u,
+		0xE4C5AEB8u, 0xFDDE9FF9u, 0xD6F3CC3Au, 0xCFE8FD7Bu, 0x80A96BBCu, 0x99B25AFDu, 0xB29F093Eu, 0xAB84387Fu,
+		0x2C1C24B0u, 0x350715F1u, 0x1E2A4632u, 0x07317773u, 0x4870E1B4u, 0x516BD0F5u, 0x7A468336u, 0x635DB277u,
+		0xCBFAD74Eu, 0xD2E1E60Fu, 0xF9CCB5CCu, 0xE0D7848Du, 0xAF96124Au, 0xB68D230Bu, 0x9DA070C8u, 0x84BB4189u,
+		0x03235D46u, 0x1A386C07u, 0x31153FC4u, 0x280E0E85u, 0x674F9842u, 0x7E54A903u, 0x5579FAC0u, 0x4C62CB81u,
+		0x8138C51Fu, 0x9823F45Eu, 0xB30EA79Du, 0xAA1596DCu, 0xE554001Bu, 0xFC4F315Au, 0xD7626299u, 0xCE7953D8u,
+		0x49E14F17u, 0x50FA7E56u, 0x7BD72D95u, 0x62CC1CD4u, 0x2D8D8A13u, 0x3496BB52u, 0x1FBBE891u, 0x06A0D9D0u,
+		0x5E7EF3ECu, 0x4765C2ADu, 0x6C48916Eu, 0x7553A02Fu, 0x3A1236E8u, 0x230907A9u, 0x0824546Au, 0x113F652Bu,
+		0x96A779E4u, 0x8FBC48A5u, 0xA4911B66u, 0xBD8A2A27u, 0xF2CBBCE0u, 0xEBD08DA1u, 0xC0FDDE62u, 0xD9E6EF23u,
+		0x14BCE1BDu, 0x0DA7D0FCu, 0x268A833Fu, 0x3F91B27Eu, 0x70D024B9u, 0x69CB15F8u, 0x42E6463Bu, 0x5BFD777Au,
+		0xDC656BB5u, 0xC57E5AF4u, 0xEE530937u, 0xF7483876u, 0xB809AEB1u, 0xA1129FF0u, 0x8A3FCC33u, 0x9324FD72u
+	},
+	{
+		0x00000000u, 0x01C26A37u, 0x0384D46Eu, 0x0246BE59u, 0x0709A8DCu, 0x06CBC2EBu, 0x048D7CB2u, 0x054F1685u,
+		0x0E1351B8u, 0x0FD13B8Fu, 0x0D9785D6u, 0x0C55EFE1u, 0x091AF964u, 0x08D89353u, 0x0A9E2D0Au, 0x0B5C473Du,
+		0x1C26A370u, 0x1DE4C947u, 0x1FA2771Eu, 0x1E601D29u, 0x1B2F0BACu, 0x1AED619Bu, 0x18ABDFC2u, 0x1969B5F5u,
+		0x1235F2C8u, 0x13F798FFu, 0x11B126A6u, 0x10734C91u, 0x153C5A14u, 0x14FE3023u, 0x16B88E7Au, 0x177AE44Du,
+		0x384D46E0u, 0x398F2CD7u, 0x3BC9928Eu, 0x3A0BF8B9u, 0x3F44EE3Cu, 0x3E86840Bu, 0x3CC03A52u, 0x3D025065u,
+		0x365E1758u, 0x379C7D6Fu, 0x35DAC336u, 0x3418A901u, 0x3157BF84u, 0x3095D5B3u, 0x32D36BEAu, 0x331101DDu,
+		0x246BE590u, 0x25A98FA7u, 0x27EF31FEu, 0x262D5BC9u, 0x23624D4Cu, 0x22A0277Bu, 0x20E69922u, 0x2124F315u,
+		0x2A78B428u, 0x2BBADE1Fu, 0x29FC6046u, 0x283E0A71u, 0x2D711CF4u, 0x2CB376C3u, 0x2EF5C89Au, 0x2F37A2ADu,
+		0x709A8DC0u, 0x7158E7F7u, 0x731E59AEu, 0x72DC3399u, 0x7793251Cu, 0x76514F2Bu, 0x7417F172u, 0x75D59B45u,
+		0x7E89DC78u, 0x7F4BB64Fu, 0x7D0D0816u, 0x7CCF6221u, 0x798074A4u, 0x78421E93u, 0x7A04A0CAu, 0x7BC6CAFDu,
+		0x6CBC2EB0u, 0x6D7E4487u, 0x6F38FADEu, 0x6EFA90E9u, 0x6BB5866Cu, 0x6A77EC5Bu, 0x68315202u, 0x69F33835u,
+		0x62AF7F08u, 0x636D153Fu, 0x612BAB66u, 0x60E9C151u, 0x65A6D7D4u, 0x6464BDE3u, 0x662203BAu, 0x67E0698Du,
+		0x48D7CB20u, 0x4915A117u, 0x4B531F4Eu, 0x4A917579u, 0x4FDE63FCu, 0x4E1C09CBu, 0x4C5AB792u, 0x4D98DDA5u,
+		0x46C49A98u, 0x4706F0AFu, 0x45404EF6u, 0x448224C1u, 0x41CD3244u, 0x400F5873u, 0x4249E62Au, 0x438B8C1Du,
+		0x54F16850u, 0x55330267u, 0x5775BC3Eu, 0x56B7D609u, 0x53F8C08Cu, 0x523AAABBu, 0x507C14E2u, 0x51BE7ED5u,
+		0x5AE239E8u, 0x5B2053DFu, 0x5966ED86u, 0x58A487B1u, 0x5DEB9134u, 0x5C29FB03u, 0x5E6F455Au, 0x5FAD2F6Du,
+		0xE1351B80u, 0xE0F771B7u, 0xE2B1CFEEu, 0xE373A5D9u, 0xE63CB35Cu, 0xE7FED96Bu, 0xE5B86732u, 0xE47A0D05u,
+		0xEF264A38u, 0xEEE4200Fu, 0xECA29E56u, 0xED60F461u, 0xE82FE2E4u, 0xE9ED88D3u, 0xEBAB368Au, 0xEA695CBDu,
+		0xFD13B8F0u, 0xFCD1D2C7u, 0xFE976C9Eu, 0xFF5506A9u, 0xFA1A102Cu, 0xFBD87A1Bu, 0xF99EC442u, 0xF85CAE75u,
+		0xF300E948u, 0xF2C2837Fu, 0xF0843D26u, 0xF1465711u, 0xF4094194u, 0xF5CB2BA3u, 0xF78D95FAu, 0xF64FFFCDu,
+		0xD9785D60u, 0xD8BA3757u, 0xDAFC890Eu, 0xDB3EE339u, 0xDE71F5BCu, 0xDFB39F8Bu, 0xDDF521D2u, 0xDC374BE5u,
+		0xD76B0CD8u, 0xD6A966EFu, 0xD4EFD8B6u, 0xD52DB281u, 0xD062A404u, 0xD1A0CE33u, 0xD3E6706Au, 0xD2241A5Du,
+		0xC55EFE10u, 0xC49C9427u, 0xC6DA2A7Eu, 0xC7184049u, 0xC25756CCu, 0xC3953CFBu, 0xC1D382A2u, 0xC011E895u,
+		0xCB4DAFA8u, 0xCA8FC59Fu, 0xC8C97BC6u, 0xC90B11F1u, 0xCC440774u, 0xCD866D43u, 0xCFC0D31Au, 0xCE02B92Du,
+		0x91AF9640u, 0x906DFC77u, 0x922B422Eu, 0x93E92819u, 0x96A63E9Cu, 0x976454ABu, 0x9522EAF2u, 0x94E080C5u,
+		0x9FBCC7F8u, 0x9E7EADCFu, 0x9C381396u, 0x9DFA79A1u, 0x98B56F24u, 0x99770513u, 0x9B31BB4Au, 0x9AF3D17Du,
+		0x8D893530u, 0x8C4B5F07u, 0x8E0DE15Eu, 0x8FCF8B69u, 0x8A809DECu, 0x8B42F7DBu, 0x89044982u, 0x88C623B5u,
+		0x839A6488u, 0x82580EBFu, 0x801EB0E6u, 0x81DCDAD1u, 0x8493CC54u, 0x8551A663u, 0x8717183Au, 0x86D5720Du,
+		0xA9E2D0A0u, 0xA820BA97u, 0xAA6604CEu, 0xABA46EF9u, 0xAEEB787Cu, 0xAF29124Bu, 0xAD6FAC12u, 0xACADC625u,
+		0xA7F18118u, 0xA633EB2Fu, 0xA4755576u, 0xA5B73F41u, 0xA0F829C4u, 0xA13A43F3u, 0xA37CFDAAu, 0xA2BE979Du,
+		0xB5C473D0u, 0xB40619E7u, 0xB640A7BEu, 0xB782CD89u, 0xB2CDDB0Cu, 0xB30FB13Bu, 0xB1490F62u, 0xB08B6555u,
+		0xBBD72268u, 0xBA15485Fu, 0xB853F606u, 0xB9919C31u, 0xBCDE8AB4u, 0xBD1CE083u, 0xBF5A5EDAu, 0xBE9834EDu
+	},
+	{
+		0x00000000u, 0xB8BC6765u, 0xAA09C88Bu, 0x12B5AFEEu, 0x8F629757u, 0x37DEF032u, 0x256B5FDCu, 0x9DD738B9u,
+		0xC5B428EFu, 0x7D084F8Au, 0x6FBDE064u, 0xD7018701u, 0x4AD6BFB8u, 0xF26AD8DDu, 0xE0DF7733u, 0x58631056u,
+		0x5019579Fu, 0xE8A530FAu, 0xFA109F14u, 0x42ACF871u, 0xDF7BC0C8u, 0x67C7A7ADu, 0x75720843u, 0xCDCE6F26u,
+		0x95AD7F70u, 0x2D111815u, 0x3FA4B7FBu, 0x8718D09Eu, 0x1ACFE827u, 0xA2738F42u, 0xB0C620ACu, 0x087A47C9u,
+		0xA032AF3Eu, 0x188EC85Bu, 0x0A3B67B5u, 0xB28700D0u, 0x2F503869u, 0x97EC5F0Cu, 0x8559F0E2u, 0x3DE59787u,
+		0x658687D1u, 0xDD3AE0B4u, 0xCF8F4F5Au, 0x7733283Fu, 0xEAE41086u, 0x525877E3u, 0x40EDD80Du, 0xF851BF68u,
+		0xF02BF8A1u, 0x48979FC4u, 0x5A22302Au, 0xE29E574Fu, 0x7F496FF6u, 0xC7F50893u, 0xD540A77Du, 0x6DFCC018u,
+		0x359FD04Eu, 0x8D23B72Bu, 0x9F9618C5u, 0x272A7FA0u, 0xBAFD4719u, 0x0241207Cu, 0x10F48F92u, 0xA848E8F7u,
+		0x9B14583Du, 0x23A83F58u, 0x311D90B6u, 0x89A1F7D3u, 0x1476CF6Au, 0xACCAA80Fu, 0xBE7F07E1u, 0x06C36084u,
+		0x5EA070D2u, 0xE61C17B7u, 0xF4A9B859u, 0x4C15DF3Cu, 0xD1C2E785u, 0x697E80E0u, 0x7BCB2F0Eu, 0xC377486Bu,
+		0xCB0D0FA2u, 0x73B168C7u, 0x6104C729u, 0xD9B8A04Cu, 0x446F98F5u, 0xFCD3FF90u, 0xEE66507Eu, 0x56DA371Bu,
+		0x0EB9274Du, 0xB6054028u, 0xA4B0EFC6u, 0x1C0C88A3u, 0x81DBB01Au, 0x3967D77Fu, 0x2BD27891u, 0x936E1FF4u,
+		0x3B26F703u, 0x839A9066u, 0x912F3F88u, 0x299358EDu, 0xB4446054u, 0x0CF80731u, 0x1E4DA8DFu, 0xA6F1CFBAu,
+		0xFE92DFECu, 0x462EB889u, 0x549B1767u, 0xEC277002u, 0x71F048BBu, 0xC94C2FDEu, 0xDBF98030u, 0x6345E755u,
+		0x6B3FA09Cu, 0xD383C7F9u, 0xC1366817u, 0x798A0F72u, 0xE45D37CBu, 0x5CE150AEu, 0x4E54FF40u, 0xF6E89825u,
+		0xAE8B8873u, 0x1637EF16u, 0x048240F8u, 0xBC3E279Du, 0x21E91F24u, 0x99557841u, 0x8BE0D7AFu, 0x335CB0CAu,
+		0xED59B63Bu, 0x55E5D15Eu, 0x47507EB0u, 0xFFEC19D5u, 0x623B216Cu, 0xDA874609u, 0xC832E9E7u, 0x708E8E82u,
+		0x28ED9ED4u, 0x9051F9B1u, 0x82E4565Fu, 0x3A58313Au, 0xA78F0983u, 0x1F336EE6u, 0x0D86C108u, 0xB53AA66Du,
+		0xBD40E1A4u, 0x05FC86C1u, 0x1749292Fu, 0xAFF54E4Au, 0x322276F3u, 0x8A9E1196u, 0x982BBE78u, 0x2097D91Du,
+		0x78F4C94Bu, 0xC048AE2Eu, 0xD2FD01C0u, 0x6A4166A5u, 0xF7965E1Cu, 0x4F2A3979u, 0x5D9F9697u, 0xE523F1F2u,
+		0x4D6B1905u, 0xF5D77E60u, 0xE762D18Eu, 0x5FDEB6EBu, 0xC2098E52u, 0x7AB5E937u, 0x680046D9u, 0xD0BC21BCu,
+		0x88DF31EAu, 0x3063568Fu, 0x22D6F961u, 0x9A6A9E04u, 0x07BDA6BDu, 0xBF01C1D8u, 0xADB46E36u, 0x15080953u,
+		0x1D724E9Au, 0xA5CE29FFu, 0xB77B8611u, 0x0FC7E174u, 0x9210D9CDu, 0x2AACBEA8u, 0x38191146u, 0x80A57623u,
+		0xD8C66675u, 0x607A0110u, 0x72CFAEFEu, 0xCA73C99Bu, 0x57A4F122u, 0xEF189647u, 0xFDAD39A9u, 0x45115ECCu,
+		0x764DEE06u, 0xCEF18963u, 0xDC44268Du, 0x64F841E8u, 0xF92F7951u, 0x41931E34u, 0x5326B1DAu, 0xEB9AD6BFu,
+		0xB3F9C6E9u, 0x0B45A18Cu, 0x19F00E62u, 0xA14C6907u, 0x3C9B51BEu, 0x842736DBu, 0x96929935u, 0x2E2EFE50u,
+		0x2654B999u, 0x9EE8DEFCu, 0x8C5D7112u, 0x34E11677u, 0xA9362ECEu, 0x118A49ABu, 0x033FE645u, 0xBB838120u,
+		0xE3E09176u, 0x5B5CF613u, 0x49E959FDu, 0xF1553E98u, 0x6C820621u, 0xD43E6144u, 0xC68BCEAAu, 0x7E37A9CFu,
+		0xD67F4138u, 0x6EC3265Du, 0x7C7689B3u, 0xC4CAEED6u, 0x591DD66Fu, 0xE1A1B10Au, 0xF3141EE4u, 0x4BA87981u,
+		0x13CB69D7u, 0xAB770EB2u, 0xB9C2A15Cu, 0x017EC639u, 0x9CA9FE80u, 0x241599E5u, 0x36A0360Bu, 0x8E1C516Eu,
+		0x866616A7u, 0x3EDA71C2u, 0x2C6FDE2Cu, 0x94D3B949u, 0x090481F0u, 0xB1B8E695u, 0xA30D497Bu, 0x1BB12E1Eu,
+		0x43D23E48u, 0xFB6E592Du, 0xE9DBF6C3u, 0x516791A6u, 0xCCB0A91Fu, 0x740CCE7Au, 0x66B96194u, 0xDE0506F1u
+	},
+#endif
+#if (CRC_32_SLICES >= 8)
+	{
+		0x00000000u, 0x3D6029B0u, 0x7AC05360u, 0x47A07AD0u, 0xF580A6C0u, 0xC8E08F70u, 0x8F40F5A0u, 0xB220DC10u,
+		0x30704BC1u, 0x0D106271u, 0x4AB018A1u, 0x77D03111u, 0xC5F0ED01u, 0xF890C4B1u, 0xBF30BE61u, 0x825097D1u,
+		0x60E09782u, 0x5D80BE32u, 0x1A20C4E2u, 0x2740ED52u, 0x95603142u, 0xA80018F2u, 0xEFA06222u, 0xD2C04B92u,
+		0x5090DC43u, 0x6DF0F5F3u, 0x2A508F23u, 0x1730A693u, 0xA5107A83u, 0x98705333u, 0xDFD029E3u, 0xE2B00053u,
+		0xC1C12F04u, 0xFCA106B4u, 0xBB017C64u, 0x866155D4u, 0x344189C4u, 0x0921A074u, 0x4E81DAA4u, 0x73E1F314u,
+		0xF1B164C5u, 0xCCD14D75u, 0x8B7137A5u, 0xB6111E15u, 0x0431C205u, 0x3951EBB5u, 0x7EF19165u, 0x4391B8D5u,
+		0xA121B886u, 0x9C419136u, 0xDBE1EBE6u, 0xE681C256u, 0x54A11E46u, 0x69C137F6u, 0x2E614D26u, 0x13016496u,
+		0x9151F347u, 0xAC31DAF7u, 0xEB91A027u, 0xD6F18997u, 0x64D15587u, 0x59B17C37u, 0x1E1106E7u, 0x23712F57u,
+		0x58F35849u, 0x659371F9u, 0x22330B29u, 0x1F532299u, 0xAD73FE89u, 0x9013D739u, 0xD7B3ADE9u, 0xEAD38459u,
+		0x68831388u, 0x55E33A38u, 0x124340E8u, 0x2F236958u, 0x9D03B548u, 0xA0639CF8u, 0xE7C3E628u, 0xDAA3CF98u,
+		0x3813CFCBu, 0x0573E67Bu, 0x42D39CABu, 0x7FB3B51Bu, 0xCD93690Bu, 0xF0F340BBu, 0xB7533A6Bu, 0x8A3313DBu,
+		0x0863840Au, 0x3503ADBAu, 0x72A3D76Au, 0x4FC3FEDAu, 0xFDE322CAu, 0xC0830B7Au, 0x872371AAu, 0xBA43581Au,
+		0x9932774Du, 0xA4525EFDu, 0xE3F2242Du, 0xDE920D9Du, 0x6CB2D18Du, 0x51D2F83Du, 0x167282EDu, 0x2B12AB5Du,
+		0xA9423C8Cu, 0x9422153Cu, 0xD3826FECu, 0xEEE2465Cu, 0x5CC29A4Cu, 0x61A2B3FCu, 0x2602C92Cu, 0x1B62E09Cu,
+		0xF9D2E0CFu, 0xC4B2C97Fu, 0x8312B3AFu, 0xBE729A1Fu, 0x0C52460Fu, 0x31326FBFu, 0x7692156Fu, 0x4BF23CDFu,
+		0xC9A2AB0Eu, 0xF4C282BEu, 0xB362F86Eu, 0x8E02D1DEu, 0x3C220DCEu, 0x0142247Eu, 0x46E25EAEu, 0x7B82771Eu,
+		0xB1E6B092u, 0x8C869922u, 0xCB26E3F2u, 0xF646CA42u, 0x44661652u, 0x79063FE2u, 0x3EA64532u, 0x03C66C82u,
+		0x8196FB53u, 0xBCF6D2E3u, 0xFB56A833u, 0xC6368183u, 0x74165D93u, 0x49767423u, 0x0ED60EF3u, 0x33B62743u,
+		0xD1062710u, 0xEC660EA0u, 0xABC67470u, 0x96A65DC0u, 0x248681D0u, 0x19E6A860u, 0x5E46D2B0u, 0x6326FB00u,
+		0xE1766CD1u, 0xDC164561u, 0x9BB63FB1u, 0xA6D61601u, 0x14F6CA11u, 0x2996E3A1u, 0x6E369971u, 0x5356B0C1u,
+		0x70279F96u, 0x4D47B626u, 0x0AE7CCF6u, 0x3787E546u, 0x85A73956u, 0xB8C710E6u, 0xFF676A36u, 0xC2074386u,
+		0x4057D457u, 0x7D37FDE7u, 0x3A978737u, 0x07F7AE87u, 0xB5D77297u, 0x88B75B27u, 0xCF1721F7u, 0xF2770847u,
+		0x10C70814u, 0x2DA721A4u, 0x6A075B74u, 0x576772C4u, 0xE547AED4u, 0xD8278764u, 0x9F87FDB4u, 0xA2E7D404u,
+		0x20B743D5u, 0x1DD76A65u, 0x5A7710B5u, 0x67173905u, 0xD537E515u, 0xE857CCA5u, 0xAFF7B675u, 0x92979FC5u,
+		0xE915E8DBu, 0xD475C16Bu, 0x93D5BBBBu, 0xAEB5920Bu, 0x1C954E1Bu, 0x21F567ABu, 0x66551D7Bu, 0x5B3534CBu,
+		0xD965A31Au, 0xE4058AAAu, 0xA3A5F07Au, 0x9EC5D9CAu, 0x2CE505DAu, 0x11852C6Au, 0x562556BAu, 0x6B457F0Au,
+		0x89F57F59u, 0xB49556E9u, 0xF3352C39u, 0xCE550589u, 0x7C75D999u, 0x4115F029u, 0x06B58AF9u, 0x3BD5A349u,
+		0xB9853498u, 0x84E51D28u, 0xC34567F8u, 0xFE254E48u, 0x4C059258u, 0x7165BBE8u, 0x36C5C138u, 0x0BA5E888u,
+		0x28D4C7DFu, 0x15B4EE6Fu, 0x521494BFu, 0x6F74BD0Fu, 0xDD54611Fu, 0xE03448AFu, 0xA794327Fu, 0x9AF41BCFu,
+		0x18A48C1Eu, 0x25C4A5AEu, 0x6264DF7Eu, 0x5F04F6CEu, 0xED242ADEu, 0xD044036Eu, 0x97E479BEu, 0xAA84500Eu,
+		0x4834505Du, 0x755479EDu, 0x32F4033Du, 0x0F942A8Du, 0xBDB4F69Du, 0x80D4DF2Du, 0xC774A5FDu, 0xFA148C4Du,
+		0x78441B9Cu, 0x4524322Cu, 0x028448FCu, 0x3FE4614Cu, 0x8DC4BD5Cu, 0xB0A494ECu, 0xF704EE3Cu, 0xCA64C78Cu
+	},
+	{
+		0x00000000u, 0xCB5CD3A5u, 0x4DC8A10Bu, 0x869472AEu, 0x9B914216u, 0x50CD91B3u, 0xD659E31Du, 0x1D0530B8u,
+		0xEC53826Du, 0x270F51C8u, 0xA19B2366u, 0x6AC7F0C3u, 0x77C2C07Bu, 0xBC9E13DEu, 0x3A0A6170u, 0xF156B2D5u,
+		0x03D6029Bu, 0xC88AD13Eu, 0x4E1EA390u, 0x85427035u, 0x9847408Du, 0x531B9328u, 0xD58FE186u, 0x1ED33223u,
+		0xEF8580F6u, 0x24D95353u, 0xA24D21FDu, 0x6911F258u, 0x7414C2E0u, 0xBF481145u, 0x39DC63EBu, 0xF280B04Eu,
+		0x07AC0536u, 0xCCF0D693u, 0x4A64A43Du, 0x81387798u, 0x9C3D4720u, 0x57619485u, 0xD1F5E62Bu, 0x1AA9358Eu,
+		0xEBFF875Bu, 0x20A354FEu, 0xA6372650u, 0x6D6BF5F5u, 0x706EC54Du, 0xBB3216E8u, 0x3DA66446u, 0xF6FAB7E3u,
+		0x047A07ADu, 0xCF26D408u, 0x49B2A6A6u, 0x82EE7503u, 0x9FEB45BBu, 0x54B7961Eu, 0xD223E4B0u, 0x197F3715u,
+		0xE82985C0u, 0x23755665u, 0xA5E124CBu, 0x6EBDF76Eu, 0x73B8C7D6u, 0xB8E41473u, 0x3E7066DDu, 0xF52CB578u,
+		0x0F580A6Cu, 0xC404D9C9u, 0x4290AB67u, 0x89CC78C2u, 0x94C9487Au, 0x5F959BDFu, 0xD901E971u, 0x125D3AD4u,
+		0xE30B8801u, 0x28575BA4u, 0xAEC3290Au, 0x659FFAAFu, 0x789ACA17u, 0xB3C619B2u, 0x35526B1Cu, 0xFE0EB8B9u,
+		0x0C8E08F7u, 0xC7D2DB52u, 0x4146A9FCu, 0x8A1A7A59u, 0x971F4AE1u, 0x5C439944u, 0xDAD7EBEAu, 0x118B384Fu,
+		0xE0DD8A9Au, 0x2B81593Fu, 0xAD152B91u, 0x6649F834u, 0x7B4CC88Cu, 0xB0101B29u, 0x36846987u, 0xFDD8BA22u,
+		0x08F40F5Au, 0xC3A8DCFFu, 0x453CAE51u, 0x8E607DF4u, 0x93654D4Cu, 0x58399EE9u, 0xDEADEC47u, 0x15F13FE2u,
+		0xE4A78D37u, 0x2FFB5E92u, 0xA96F2C3Cu, 0x6233FF99u, 0x7F36CF21u, 0xB46A1C84u, 0x32FE6E2Au, 0xF9A2BD8Fu,
+		0x0B220DC1u, 0xC07EDE64u, 0x46EAACCAu, 0x8DB67F6Fu, 0x90B34FD7u, 0x5BEF9C72u, 0xDD7BEEDCu, 0x16273D79u,
+		0xE7718FACu, 0x2C2D5C09u, 0xAAB92EA7u, 0x61E5FD02u, 0x7CE0CDBAu, 0xB7BC1E1Fu, 0x31286CB1u, 0xFA74BF14u,
+		0x1EB014D8u, 0xD5ECC77Du, 0x5378B5D3u, 0x98246676u, 0x852156CEu, 0x4E7D856Bu, 0xC8E9F7C5u, 0x03B52460u,
+		0xF2E396B5u, 0x39BF4510u, 0xBF2B37BEu, 0x7477E41Bu, 0x6972D4A3u, 0xA22E0706u, 0x24BA75A8u, 0xEFE6A60Du,
+		0x1D661643u, 0xD63AC5E6u, 0x50AEB748u, 0x9BF264EDu, 0x86F75455u, 0x4DAB87F0u, 0xCB3FF55Eu, 0x006326FBu,
+		0xF135942Eu, 0x3A69478Bu, 0xBCFD3525u, 0x77A1E680u, 0x6AA4D638u, 0xA1F8059Du, 0x276C7733u, 0xEC30A496u,
+		0x191C11EEu, 0xD240C24Bu, 0x54D4B0E5u, 0x9F886340u, 0x828D53F8u, 0x49D1805Du, 0xCF45F2F3u, 0x04192156u,
+		0xF54F9383u, 0x3E134026u, 0xB8873288u, 0x73DBE12Du, 0x6EDED195u, 0xA5820230u, 0x2316709Eu, 0xE84AA33Bu,
+		0x1ACA1375u, 0xD196C0D0u, 0x5702B27Eu, 0x9C5E61DBu, 0x815B5163u, 0x4A0782C6u, 0xCC93F068u, 0x07CF23CDu,
+		0xF6999118u, 0x3DC542BDu, 0xBB513013u, 0x700DE3B6u, 0x6D08D30Eu, 0xA65400ABu, 0x20C07205u, 0xEB9CA1A0u,
+		0x11E81EB4u, 0xDAB4CD11u, 0x5C20BFBFu, 0x977C6C1Au, 0x8A795CA2u, 0x41258F07u, 0xC7B1FDA9u, 0x0CED2E0Cu,
+		0xFDBB9CD9u, 0x36E74F7Cu, 0xB0733DD2u, 0x7B2FEE77u, 0x662ADECFu, 0xAD760D6Au, 0x2BE27FC4u, 0xE0BEAC61u,
+		0x123E1C2Fu, 0xD962CF8Au, 0x5FF6BD24u, 0x94AA6E81u, 0x89AF5E39u, 0x42F38D9Cu, 0xC467FF32u, 0x0F3B2C97u,
+		0xFE6D9E42u, 0x35314DE7u, 0xB3A53F49u, 0x78F9ECECu, 0x65FCDC54u, 0xAEA00FF1u, 0x28347D5Fu, 0xE368AEFAu,
+		0x16441B82u, 0xDD18C827u, 0x5B8CBA89u, 0x90D0692Cu, 0x8DD55994u, 0x46898A31u, 0xC01DF89Fu, 0x0B412B3Au,
+		0xFA1799EFu, 0x314B4A4Au, 0xB7DF38E4u, 0x7C83EB41u, 0x6186DBF9u, 0xAADA085Cu, 0x2C4E7AF2u, 0xE712A957u,
+		0x15921919u, 0xDECECABCu, 0x585AB812u, 0x93066BB7u, 0x8E035B0Fu, 0x455F88AAu, 0xC3CBFA04u, 0x089729A1u,
+		0xF9C19B74u, 0x329D48D1u, 0xB4093A7Fu, 0x7F55E9DAu, 0x6250D962u, 0xA90C0AC7u, 0x2F987869u, 0xE4C4ABCCu
+	},
+	{
+		0x00000000u, 0xA6770BB4u, 0x979F1129u, 0x31E81A9Du, 0xF44F2413u, 0x52382FA7u, 0x63D0353Au, 0xC5A73E8Eu,
+		0x33EF4E67u, 0x959845D3u, 0xA4705F4Eu, 0x020754FAu, 0xC7A06A74u, 0x61D761C0u, 0x503F7B5Du, 0xF64870E9u,
+		0x67DE9CCEu, 0xC1A9977Au, 0xF0418DE7u, 0x56368653u, 0x9391B8DDu, 0x35E6B369u, 0x040EA9F4u, 0xA279A240u,
+		0x5431D2A9u, 0xF246D91Du, 0xC3AEC380u, 0x65D9C834u, 0xA07EF6BAu, 0x0609FD0Eu, 0x37E1E793u, 0x9196EC27u,
+		0xCFBD399Cu, 0x69CA3228u, 0x582228B5u, 0xFE552301u, 0x3BF21D8Fu, 0x9D85163Bu, 0xAC6D0CA6u, 0x0A1A0712u,
+		0xFC5277FBu, 0x5A257C4Fu, 0x6BCD66D2u, 0xCDBA6D66u, 0x081D53E8u, 0xAE6A585Cu, 0x9F8242C1u, 0x39F54975u,
+		0xA863A552u, 0x0E14AEE6u, 0x3FFCB47Bu, 0x998BBFCFu, 0x5C2C8141u, 0xFA5B8AF5u, 0xCBB39068u, 0x6DC49BDCu,
+		0x9B8CEB35u, 0x3DFBE081u, 0x0C13FA1Cu, 0xAA64F1A8u, 0x6FC3CF26u, 0xC9B4C492u, 0xF85CDE0Fu, 0x5E2BD5BBu,
+		0x440B7579u, 0xE27C7ECDu, 0xD3946450u, 0x75E36FE4u, 0xB044516Au, 0x16335ADEu, 0x27DB4043u, 0x81AC4BF7u,
+		0x77E43B1Eu, 0xD19330AAu, 0xE07B2A37u, 0x460C2183u, 0x83AB1F0Du, 0x25DC14B9u, 0x14340E24u, 0xB2430590u,
+		0x23D5E9B7u, 0x85A2E203u, 0xB44AF89Eu, 0x123DF32Au, 0xD79ACDA4u, 0x71EDC610u, 0x4005DC8Du, 0xE672D739u,
+		0x103AA7D0u, 0xB64DAC64u, 0x87A5B6F9u, 0x21D2BD4Du, 0xE47583C3u, 0x42028877u, 0x73EA92EAu, 0xD59D995Eu,
+		0x8BB64CE5u, 0x2DC14751u, 0x1C295DCCu, 0xBA5E5678u, 0x7FF968F6u, 0xD98E6342u, 0xE86679DFu, 0x4E11726Bu,
+		0xB8590282u, 0x1E2E0936u, 0x2FC613ABu, 0x89B1181Fu, 0x4C162691u, 0xEA612D25u, 0xDB8937B8u, 0x7DFE3C0Cu,
+		0xEC68D02Bu, 0x4A1FDB9Fu, 0x7BF7C102u, 0xDD80CAB6u, 0x1827F438u, 0xBE50FF8Cu, 0x8FB8E511u, 0x29CFEEA5u,
+		0xDF879E4Cu, 0x79F095F8u, 0x48188F65u, 0xEE6F84D1u, 0x2BC8BA5Fu, 0x8DBFB1EBu, 0xBC57AB76u, 0x1A20A0C2u,
+		0x8816EAF2u, 0x2E61E146u, 0x1F89FBDBu, 0xB9FEF06Fu, 0x7C59CEE1u, 0xDA2EC555u, 0xEBC6DFC8u, 0x4DB1D47Cu,
+		0xBBF9A495u, 0x1D8EAF21u, 0x2C66B5BCu, 0x8A11BE08u, 0x4FB68086u, 0xE9C18B32u, 0xD82991AFu, 0x7E5E9A1Bu,
+		0xEFC8763Cu, 0x49BF7D88u, 0x78576715u, 0xDE206CA1u, 0x1B87522Fu, 0xBDF0599Bu, 0x8C184306u, 0x2A6F48B2u,
+		0xDC27385Bu, 0x7A5033EFu, 0x4BB82972u, 0xEDCF22C6u, 0x28681C48u, 0x8E1F17FCu, 0xBFF70D61u, 0x198006D5u,
+		0x47ABD36Eu, 0xE1DCD8DAu, 0xD034C247u, 0x7643C9F3u, 0xB3E4F77Du, 0x1593FCC9u, 0x247BE654u, 0x820CEDE0u,
+		0x74449D09u, 0xD23396BDu, 0xE3DB8C20u, 0x45AC8794u, 0x800BB91Au, 0x267CB2AEu, 0x1794A833u, 0xB1E3A387u,
+		0x20754FA0u, 0x86024414u, 0xB7EA5E89u, 0x119D553Du, 0xD43A6BB3u, 0x724D6007u, 0x43A57A9Au, 0xE5D2712Eu,
+		0x139A01C7u, 0xB5ED0A73u, 0x840510EEu, 0x22721B5Au, 0xE7D525D4u, 0x41A22E60u, 0x704A34FDu, 0xD63D3F49u,
+		0xCC1D9F8Bu, 0x6A6A943Fu, 0x5B828EA2u, 0xFDF58516u, 0x3852BB98u, 0x9E25B02Cu, 0xAFCDAAB1u, 0x09BAA105u,
+		0xFFF2D1ECu, 0x5985DA58u, 0x686DC0C5u, 0xCE1ACB71u, 0x0BBDF5FFu, 0xADCAFE4Bu, 0x9C22E4D6u, 0x3A55EF62u,
+		0xABC30345u, 0x0DB408F1u, 0x3C5C126Cu, 0x9A2B19D8u, 0x5F8C2756u, 0xF9FB2CE2u, 0xC813367Fu, 0x6E643DCBu,
+		0x982C4D22u, 0x3E5B4696u, 0x0FB35C0Bu, 0xA9C457BFu, 0x6C636931u, 0xCA146285u, 0xFBFC7818u, 0x5D8B73ACu,
+		0x03A0A617u, 0xA5D7ADA3u, 0x943FB73Eu, 0x3248BC8Au, 0xF7EF8204u, 0x519889B0u, 0x6070932Du, 0xC6079899u,
+		0x304FE870u, 0x9638E3C4u, 0xA7D0F959u, 0x01A7F2EDu, 0xC400CC63u, 0x6277C7D7u, 0x539FDD4Au, 0xF5E8D6FEu,
+		0x647E3AD9u, 0xC209316Du, 0xF3E12BF0u, 0x55962044u, 0x90311ECAu, 0x3646157Eu, 0x07AE0FE3u, 0xA1D90457u,
+		0x579174BEu, 0xF1E67F0Au, 0xC00E6597u, 0x66796E23u, 0xA3DE50ADu, 0x05A95B19u, 0x34414184u, 0x92364A30u
+	},
+	{
+		0x00000000u, 0xCCAA009Eu, 0x4225077Du, 0x8E8F07E3u, 0x844A0EFAu, 0x48E00E64u, 0xC66F0987u, 0x0AC50919u,
+		0xD3E51BB5u, 0x1F4F1B2Bu, 0x91C01CC8u, 0x5D6A1C56u, 0x57AF154Fu, 0x9B0515D1u, 0x158A1232u, 0xD92012ACu,
+		0x7CBB312Bu, 0xB01131B5u, 0x3E9E3656u, 0xF23436C8u, 0xF8F13FD1u, 0x345B3F4Fu, 0xBAD438ACu, 0x767E3832u,
+		0xAF5E2A9Eu, 0x63F42A00u, 0xED7B2DE3u, 0x21D12D7Du, 0x2B142464u, 0xE7BE24FAu, 0x69312319u, 0xA59B2387u,
+		0xF9766256u, 0x35DC62C8u, 0xBB53652Bu, 0x77F965B5u, 0x7D3C6CACu, 0xB1966C32u, 0x3F196BD1u, 0xF3B36B4Fu,
+		0x2A9379E3u, 0xE639797Du, 0x68B67E9Eu, 0xA41C7E00u, 0xAED97719u, 0x62737787u, 0xECFC7064u, 0x205670FAu,
+		0x85CD537Du, 0x496753E3u, 0xC7E85400u, 0x0B42549Eu, 0x01875D87u, 0xCD2D5D19u, 0x43A25AFAu, 0x8F085A64u,
+		0x562848C8u, 0x9A824856u, 0x140D4FB5u, 0xD8A74F2Bu, 0xD2624632u, 0x1EC846ACu, 0x9047414Fu, 0x5CED41D1u,
+		0x299DC2EDu, 0xE537C273u, 0x6BB8C590u, 0xA712C50Eu, 0xADD7CC17u, 0x617DCC89u, 0xEFF2CB6Au, 0x2358CBF4u,
+		0xFA78D958u, 0x36D2D9C6u, 0xB85DDE25u, 0x74F7DEBBu, 0x7E32D7A2u, 0xB298D73Cu, 0x3C17D0DFu, 0xF0BDD041u,
+		0x5526F3C6u, 0x998CF358u, 0x1703F4BBu, 0xDBA9F425u, 0xD16CFD3Cu, 0x1DC6FDA2u, 0x9349FA41u, 0x5FE3FADFu,
+		0x86C3E873u, 0x4A69E8EDu, 0xC4E6EF0Eu, 0x084CEF90u, 0x0289E689u, 0xCE23E617u, 0x40ACE1F4u, 0x8C06E16Au,
+		0xD0EBA0BBu, 0x1C41A025u, 0x92CEA7C6u, 0x5E64A758u, 0x54A1AE41u, 0x980BAEDFu, 0x1684A93Cu, 0xDA2EA9A2u,
+		0x030EBB0Eu, 0xCFA4BB90u, 0x412BBC73u, 0x8D81BCEDu, 0x8744B5F4u, 0x4BEEB56Au, 0xC561B289u, 0x09CBB217u,
+		0xAC509190u, 0x60FA910Eu, 0xEE7596EDu, 0x22DF9673u, 0x281A9F6Au, 0xE4B09FF4u, 0x6A3F9817u, 0xA6959889u,
+		0x7FB58A25u, 0xB31F8ABBu, 0x3D908D58u, 0xF13A8DC6u, 0xFBFF84DFu, 0x37558441u, 0xB9DA83A2u, 0x7570833Cu,
+		0x533B85DAu, 0x9F918544u, 0x111E82A7u, 0xDDB48239u, 0xD7718B20u, 0x1BDB8BBEu, 0x95548C5Du, 0x59FE8CC3u,
+		0x80DE9E6Fu, 0x4C749EF1u, 0xC2FB9912u, 0x0E51998Cu, 0x04949095u, 0xC83E900Bu, 0x46B197E8u, 0x8A1B9776u,
+		0x2F80B4F1u, 0xE32AB46Fu, 0x6DA5B38Cu, 0xA10FB312u, 0xABCABA0Bu, 0x6760BA95u, 0xE9EFBD76u, 0x2545BDE8u,
+		0xFC65AF44u, 0x30CFAFDAu, 0xBE40A839u, 0x72EAA8A7u, 0x782FA1BEu, 0xB485A120u, 0x3A0AA6C3u, 0xF6A0A65Du,
+		0xAA4DE78Cu, 0x66E7E712u, 0xE868E0F1u, 0x24C2E06Fu, 0x2E07E976u, 0xE2ADE9E8u, 0x6C22EE0Bu, 0xA088EE95u,
+		0x79A8FC39u, 0xB502FCA7u, 0x3B8DFB44u, 0xF727FBDAu, 0xFDE2F2C3u, 0x3148F25Du, 0xBFC7F5BEu, 0x736DF520u,
+		0xD6F6D6A7u, 0x1A5CD639u, 0x94D3D1DAu, 0x5879D144u, 0x52BCD85Du, 0x9E16D8C3u, 0x1099DF20u, 0xDC33DFBEu,
+		0x0513CD12u, 0xC9B9CD8Cu, 0x4736CA6Fu, 0x8B9CCAF1u, 0x8159C3E8u, 0x4DF3C376u, 0xC37CC495u, 0x0FD6C40Bu,
+		0x7AA64737u, 0xB60C47A9u, 0x3883404Au, 0xF42940D4u, 0xFEEC49CDu, 0x32464953u, 0xBCC94EB0u, 0x70634E2Eu,
+		0xA9435C82u, 0x65E95C1Cu, 0xEB665BFFu, 0x27CC5B61u, 0x2D095278u, 0xE1A352E6u, 0x6F2C5505u, 0xA386559Bu,
+		0x061D761Cu, 0xCAB77682u, 0x44387161u, 0x889271FFu, 0x825778E6u, 0x4EFD7878u, 0xC0727F9Bu, 0x0CD87F05u,
+		0xD5F86DA9u, 0x19526D37u, 0x97DD6AD4u, 0x5B776A4Au, 0x51B26353u, 0x9D1863CDu, 0x1397642Eu, 0xDF3D64B0u,
+		0x83D02561u, 0x4F7A25FFu, 0xC1F5221Cu, 0x0D5F2282u, 0x079A2B9Bu, 0xCB302B05u, 0x45BF2CE6u, 0x89152C78u,
+		0x50353ED4u, 0x9C9F3E4Au, 0x121039A9u, 0xDEBA3937u, 0xD47F302Eu, 0x18D530B0u, 0x965A3753u, 0x5AF037CDu,
+		0xFF6B144Au, 0x33C114D4u, 0xBD4E1337u, 0x71E413A9u, 0x7B211AB0u, 0xB78B1A2Eu, 0x39041DCDu, 0xF5AE1D53u,
+		0x2C8E0FFFu, 0xE0240F61u, 0x6EAB0882u, 0xA201081Cu, 0xA8C40105u, 0x646E019Bu, 0xEAE10678u, 0x264B06E6u
+	},
+#endif
+};
+#endif
+
+#endif /* !CRC_TABLES_EXTERN || CRC_TABLES_DEFINE */
+
+#endif /* CRC_TABLES_H_ */
@@ -0,0 +1,335 @@
+/* =====================================================================================================================
+ *  File        : Det.h
+ *  Layer       : Services
+ *  Purpose     : Development Error Tracer (AUTOSAR Det_ReportError) with deduplication
+ *                 - Error = (module ID as in Std_VersionInfoType, instance ID, API ID, error ID).
+ *                 - Hash table of distinct errors: occurrence count, first / last timestamp. A repeated error
+ *                   costs one hash + compare + increment, whatever the report rate.
+ *                 - Ring of the most recent distinct errors (kept even when the table is full).
+ *                 - Logged once per distinct error through LOG_TOKEN (LOGTAG_SRV_DET), counts dumped on demand.
+ *                 - DET_ENABLE == 0 (release): every macro expands to nothing, no code and no RAM.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : The instance is app owned: define "Det_Type Det_Instance;" in one .c file (or point DET_INSTANCE
+ *                to another object). Reports from ISRs and tasks: define DET_ENTER_CRITICAL / DET_EXIT_CRITICAL.
+ *                RAM = 16 * 2^DET_TABLE_BITS + 12 * DET_RING_SIZE + 16 bytes (~ 368 bytes with the defaults).
+ * ===================================================================================================================*/
+
+#ifndef DET_H_
+#define DET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define DET_AR_MAJOR_VERSION		(1u)
+#define DET_AR_MINOR_VERSION		(0u)
+#define DET_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Enable switch
+ *  - DET_ENABLE is recommended to be declared in the app project (Preprocessor Defines), 0 for release builds.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef DET_ENABLE
+#define DET_ENABLE					(0)
+#endif
+
+#if (DET_ENABLE == 1)
+
+#include "Std_Types.h"
+#include "ComStack_Types.h"
+#include "LogToken.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity
+ *  - DET_TABLE_BITS : 2^DET_TABLE_BITS distinct errors counted, later ones only go to the ring (Lost counter).
+ *  - DET_RING_SIZE  : most recent distinct errors kept.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef DET_TABLE_BITS
+#define DET_TABLE_BITS				(4u)
+#endif
+
+#ifndef DET_RING_SIZE
+#define DET_RING_SIZE				(8u)
+#endif
+
+#define DET_TABLE_SIZE				(1u << DET_TABLE_BITS)
+
+typedef char Det_TableCheck_t[((DET_TABLE_BITS >= 1u) && (DET_TABLE_BITS <= 8u)) ? 1 : -1];
+typedef char Det_RingCheck_t[((DET_RING_SIZE >= 1u) && (DET_RING_SIZE <= 255u)) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Hooks
+ *  - DET_TIMESTAMP()      : timestamp of a report, defaults to the logger tick.
+ *  - DET_ENTER_CRITICAL() : needed only when errors are reported from several priority levels.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef DET_TIMESTAMP
+#define DET_TIMESTAMP()				LOG_TOKEN_TIMESTAMP()
+#endif
+
+#ifndef DET_ENTER_CRITICAL
+#define DET_ENTER_CRITICAL()
+#define DET_EXIT_CRITICAL()
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Records
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint16	ModuleId;
+	uint8	InstanceId;
+	uint8	ApiId;
+	uint8	ErrorId;
+}Det_ErrorIdType;
+
+typedef struct
+{
+	Det_ErrorIdType	Id;
+	uint16			Count;			/* Saturating, 0 = free entry.*/
+	uint32			FirstTime;
+	uint32			LastTime;
+}Det_EntryType;
+
+typedef struct
+{
+	Det_ErrorIdType	Id;
+	uint32			Time;			/* First occurrence.*/
+}Det_RecentType;
+
+typedef struct
+{
+	Det_EntryType	Table[DET_TABLE_SIZE];
+	Det_RecentType	Recent[DET_RING_SIZE];
+	uint8			RecentHead;		/* Next ring slot to write.*/
+	uint8			RecentCount;
+	uint16			Distinct;
+	uint32			Lost;			/* Reports not counted, table full.*/
+	uint32			Reports;
+}Det_Type;
+
+typedef char Det_EntrySizeCheck_t[(sizeof(Det_EntryType) == 16u) ? 1 : -1];
+
+#ifndef DET_INSTANCE
+extern Det_Type Det_Instance;
+#define DET_INSTANCE				(&Det_Instance)
+#endif
+
+static inline void Det_Init(Det_Type* det)
+{
+	uint8* p = (uint8*)det;
+	uint32 i;
+
+	for (i = 0u; i < sizeof(*det); i++)
+	{
+		p[i] = 0u;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: hash of the error (multiplicative, top DET_TABLE_BITS bits), compare
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8 Det_Hash(const Det_ErrorIdType* id)
+{
+	uint32 k = ((uint32)id->ModuleId << 16) ^ ((uint32)id->ApiId << 8) ^ (uint32)id->ErrorId ^
+			   ((uint32)id->InstanceId << 24);
+
+	return (uint8)((k * 0x9E3779B1uL) >> (32u - DET_TABLE_BITS));
+}
+
+static inline boolean Det_SameError(const Det_ErrorIdType* a, const Det_ErrorIdType* b)
+{
+	return (a->ModuleId == b->ModuleId) && (a->InstanceId == b->InstanceId) &&
+		   (a->ApiId == b->ApiId) && (a->ErrorId == b->ErrorId);
+}
+
+/* Entry of the error, or the free entry where it belongs, or NULL_PTR when the table is full (linear probing). */
+static inline Det_EntryType* Det_Lookup(Det_Type* det, const Det_ErrorIdType* id)
+{
+	uint8 h = Det_Hash(id);
+	uint16 n;
+
+	for (n = 0u; n < DET_TABLE_SIZE; n++)
+	{
+		Det_EntryType* e = &det->Table[(uint8)(h + n) & (DET_TABLE_SIZE - 1u)];
+		if ((e->Count == 0u) || Det_SameError(&e->Id, id))
+		{
+			return e;
+		}
+	}
+	return NULL_PTR;
+}
+
+/* Error already kept in the ring (only scanned for errors the full table could not count). */
+static inline boolean Det_RecentContains(const Det_Type* det, const Det_ErrorIdType* id)
+{
+	uint8 n;
+
+	for (n = 0u; n < det->RecentCount; n++)
+	{
+		if (Det_SameError(&det->Recent[n].Id, id))
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  First occurrence log (optional)
+ *  - The app adds an entry to LOG_FMT_TABLE and maps it, e.g.:
+ *      X(DET_ERR,	"det mod=%u inst=%u api=%u err=%u")
+ *      #define DET_LOG_FMT_ERROR		LOG_FMT_DET_ERR
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void Det_LogError(const Det_ErrorIdType* id)
+{
+#if defined(DET_LOG_FMT_ERROR)
+	LOG_TOKEN(LOGTAG_SRV_DET, LOG_ERROR, DET_LOG_FMT_ERROR, id->ModuleId, id->InstanceId, id->ApiId, id->ErrorId);
+#else
+	(void)id;
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  API
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType Det_ReportError(Det_Type* det, uint16 moduleId, uint8 instanceId, uint8 apiId,
+											 uint8 errorId)
+{
+	Det_ErrorIdType id;
+	Det_EntryType* e;
+	uint32 now = DET_TIMESTAMP();
+	boolean first = FALSE;
+
+	id.ModuleId = moduleId;
+	id.InstanceId = instanceId;
+	id.ApiId = apiId;
+	id.ErrorId = errorId;
+
+	DET_ENTER_CRITICAL();
+	det->Reports++;
+	e = Det_Lookup(det, &id);
+	if ((e != NULL_PTR) && (e->Count != 0u))
+	{
+		if (e->Count != 0xFFFFu)
+		{
+			e->Count++;
+		}
+		e->LastTime = now;
+	}
+	else
+	{
+		if (e != NULL_PTR)
+		{
+			e->Id = id;
+			e->Count = 1u;
+			e->FirstTime = now;
+			e->LastTime = now;
+			det->Distinct++;
+			first = TRUE;
+		}
+		else
+		{
+			/* Table full: not counted, the ring still shows the error. */
+			det->Lost++;
+		}
+
+		if ((e != NULL_PTR) || !Det_RecentContains(det, &id))
+		{
+			det->Recent[det->RecentHead].Id = id;
+			det->Recent[det->RecentHead].Time = now;
+			det->RecentHead = (uint8)((det->RecentHead + 1u) % DET_RING_SIZE);
+			if (det->RecentCount < DET_RING_SIZE)
+			{
+				det->RecentCount++;
+			}
+		}
+	}
+	DET_EXIT_CRITICAL();
+
+	if (first)
+	{
+		Det_LogError(&id);
+	}
+	return E_OK;
+}
+
+/* Same, module ID taken from the version info of the reporting module. */
+static inline Std_ReturnType Det_ReportErrorVi(Det_Type* det, const Std_VersionInfoType* vi, uint8 instanceId,
+											   uint8 apiId, uint8 errorId)
+{
+	return Det_ReportError(det, vi->moduleID, instanceId, apiId, errorId);
+}
+
+/* Counted entry of an error, NULL_PTR when never reported (or not counted). */
+static inline const Det_EntryType* Det_Find(Det_Type* det, uint16 moduleId, uint8 instanceId, uint8 apiId,
+											uint8 errorId)
+{
+	Det_ErrorIdType id;
+	const Det_EntryType* e;
+
+	id.ModuleId = moduleId;
+	id.InstanceId = instanceId;
+	id.ApiId = apiId;
+	id.ErrorId = errorId;
+	e = Det_Lookup(det, &id);
+	return ((e != NULL_PTR) && (e->Count != 0u)) ? e : NULL_PTR;
+}
+
+/* n = 0 is the most recent distinct error. E_NOT_OK when fewer than n + 1 are kept. */
+static inline Std_ReturnType Det_GetRecent(const Det_Type* det, uint8 n, Det_RecentType* out)
+{
+	if (n >= det->RecentCount)
+	{
+		return E_NOT_OK;
+	}
+	*out = det->Recent[(uint8)((det->RecentHead + (2u * DET_RING_SIZE) - 1u - n) % DET_RING_SIZE)];
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Dump of the counted errors through the logger, one entry per call
+ *  - The app adds an entry to LOG_FMT_TABLE and maps it, e.g.:
+ *      X(DET_CNT,	"det mod=%u key=%x n=%u last=%u")
+ *      #define DET_LOG_FMT_COUNT		LOG_FMT_DET_CNT
+ *    key = instance << 16 | api << 8 | error.
+ *  - *cursor starts at 0, returns false once every entry was dumped.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if defined(DET_LOG_FMT_COUNT)
+static inline boolean Det_DumpNext(const Det_Type* det, uint16* cursor)
+{
+	while (*cursor < DET_TABLE_SIZE)
+	{
+		const Det_EntryType* e = &det->Table[(*cursor)++];
+
+		if (e->Count != 0u)
+		{
+			LOG_TOKEN(LOGTAG_SRV_DET, LOG_INFO, DET_LOG_FMT_COUNT, e->Id.ModuleId,
+					  ((uint32)e->Id.InstanceId << 16) | ((uint32)e->Id.ApiId << 8) | e->Id.ErrorId,
+					  e->Count, e->LastTime);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Call-site macros
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define DET_REPORT_ERROR(_mod_, _inst_, _api_, _err_)	\
+	((void)Det_ReportError(DET_INSTANCE, (_mod_), (_inst_), (_api_), (_err_)))
+
+#else /* DET_ENABLE */
+
+#define DET_REPORT_ERROR(_mod_, _inst_, _api_, _err_)	((void)0)
+
+#endif /* DET_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DET_H_ */
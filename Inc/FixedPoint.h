@@ -0,0 +1,314 @@
+/* =====================================================================================================================
+ *  File        : FixedPoint.h
+ *  Layer       : Shared
+ *  Purpose     : Fixed-point math for signal scaling and control (the Cortex-M3 has no FPU)
+ *                 - Q15 (sint16) / Q31 (sint32) add, sub, mul, div with saturation and round-to-nearest.
+ *                 - Linear scaling raw <-> physical (Com signal factor / offset) as multiply + shift.
+ *                 - Lookup tables with linear interpolation: any breakpoints (binary search) or uniform
+ *                   power-of-two spacing (no division).
+ *                 - PI controller with clamped integrator (anti-windup) and output limits.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Constants are built at compile time from decimal values (FXP_Q15(0.25), FXP_SCALE(...)), the
+ *                float arithmetic folds away, no soft-float call at run time.
+ *                Right shift of negative values is arithmetic (GCC / ARMCC behaviour).
+ * ===================================================================================================================*/
+
+#ifndef FIXEDPOINT_H_
+#define FIXEDPOINT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define FXP_AR_MAJOR_VERSION		(1u)
+#define FXP_AR_MINOR_VERSION		(0u)
+#define FXP_AR_PATCH_VERSION		(0u)
+
+#include "Std_Types.h"
+
+typedef sint16	Fxp_Q15Type;
+typedef sint32	Fxp_Q31Type;
+
+#define FXP_Q15_MAX		((sint16)0x7FFF)
+#define FXP_Q15_MIN		((sint16)(-0x7FFF - 1))
+#define FXP_Q31_MAX		((sint32)0x7FFFFFFF)
+#define FXP_Q31_MIN		((sint32)(-0x7FFFFFFF - 1))
+
+/* Round a constant to the nearest integer (compile time only) */
+#define FXP_ROUND(x)			((x) >= 0.0 ? ((x) + 0.5) : ((x) - 0.5))
+
+/* Constant in [-1, 1) to Q15 / Q31, 1.0 saturates to the max value */
+#define FXP_Q15(x)				((sint16)(((x) >= 1.0) ? 32767.0 : FXP_ROUND((x) * 32768.0)))
+#define FXP_Q31(x)				((sint32)(((x) >= 1.0) ? 2147483647.0 : FXP_ROUND((x) * 2147483648.0)))
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: saturation, rounding shift
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline sint16 Fxp_Sat16(sint32 v)
+{
+	return (v > FXP_Q15_MAX) ? FXP_Q15_MAX : ((v < FXP_Q15_MIN) ? FXP_Q15_MIN : (sint16)v);
+}
+
+static inline sint32 Fxp_Sat32(sint64 v)
+{
+	return (v > FXP_Q31_MAX) ? FXP_Q31_MAX : ((v < FXP_Q31_MIN) ? FXP_Q31_MIN : (sint32)v);
+}
+
+/* v / 2^shift rounded to nearest (ties towards +inf), shift 1..62 */
+static inline sint64 Fxp_RoundShift(sint64 v, uint8 shift)
+{
+	return (v + ((sint64)1 << (shift - 1u))) >> shift;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Q15
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Fxp_Q15Type Fxp_Q15Add(Fxp_Q15Type a, Fxp_Q15Type b)
+{
+	return Fxp_Sat16((sint32)a + b);
+}
+
+static inline Fxp_Q15Type Fxp_Q15Sub(Fxp_Q15Type a, Fxp_Q15Type b)
+{
+	return Fxp_Sat16((sint32)a - b);
+}
+
+/* Only -1 * -1 overflows. */
+static inline Fxp_Q15Type Fxp_Q15Mul(Fxp_Q15Type a, Fxp_Q15Type b)
+{
+	return Fxp_Sat16(((sint32)a * b + 0x4000) >> 15);
+}
+
+/* a / b, saturates when |a| >= |b|; b == 0 gives max / min by the sign of a. */
+static inline Fxp_Q15Type Fxp_Q15Div(Fxp_Q15Type a, Fxp_Q15Type b)
+{
+	sint32 n;
+	sint32 half;
+
+	if (b == 0)
+	{
+		return (a >= 0) ? FXP_Q15_MAX : FXP_Q15_MIN;
+	}
+
+	n = (sint32)a * 32768;
+	half = ((b >= 0) ? (sint32)b : -(sint32)b) / 2;
+	n += (n >= 0) ? half : -half;
+	return Fxp_Sat16(n / b);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Q31
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Fxp_Q31Type Fxp_Q31Add(Fxp_Q31Type a, Fxp_Q31Type b)
+{
+	return Fxp_Sat32((sint64)a + b);
+}
+
+static inline Fxp_Q31Type Fxp_Q31Sub(Fxp_Q31Type a, Fxp_Q31Type b)
+{
+	return Fxp_Sat32((sint64)a - b);
+}
+
+/* SMULL + shift on Cortex-M3. */
+static inline Fxp_Q31Type Fxp_Q31Mul(Fxp_Q31Type a, Fxp_Q31Type b)
+{
+	return Fxp_Sat32(Fxp_RoundShift((sint64)a * b, 31u));
+}
+
+static inline Fxp_Q31Type Fxp_Q31Div(Fxp_Q31Type a, Fxp_Q31Type b)
+{
+	sint64 n;
+	sint64 half;
+
+	if (b == 0)
+	{
+		return (a >= 0) ? FXP_Q31_MAX : FXP_Q31_MIN;
+	}
+
+	n = (sint64)a * ((sint64)1 << 31);
+	half = ((b >= 0) ? (sint64)b : -(sint64)b) / 2;
+	n += (n >= 0) ? half : -half;
+	return Fxp_Sat32(n / b);
+}
+
+static inline Fxp_Q31Type Fxp_Q15ToQ31(Fxp_Q15Type a)
+{
+	return (sint32)a * 65536;
+}
+
+static inline Fxp_Q15Type Fxp_Q31ToQ15(Fxp_Q31Type a)
+{
+	return Fxp_Sat16((sint32)Fxp_RoundShift(a, 16u));
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Linear scaling: phys = raw * factor + offset
+ *  - phys is an integer in the caller's unit (e.g. 0.01 % for a pedal, mV, 0.1 degC), factor = Mul / 2^Shift.
+ *  - FXP_SCALE(factor, offset, shift): shift as large as possible with |factor| * 2^shift < 2^31.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	sint32	Mul;
+	sint32	Offset;
+	uint8	Shift;			/* 1..31.*/
+}Fxp_ScaleType;
+
+#define FXP_SCALE(factor, offset, shift)	\
+	{ (sint32)FXP_ROUND((factor) * (double)(1uLL << (shift))), (sint32)FXP_ROUND(offset), (uint8)(shift) }
+
+static inline sint32 Fxp_ScaleToPhys(const Fxp_ScaleType* scale, sint32 raw)
+{
+	return Fxp_Sat32(Fxp_RoundShift((sint64)raw * scale->Mul, scale->Shift) + scale->Offset);
+}
+
+/* Inverse for TX signals: raw = (phys - offset) / factor, rounded. Mul == 0 returns 0. */
+static inline sint32 Fxp_ScaleToRaw(const Fxp_ScaleType* scale, sint32 phys)
+{
+	sint64 n;
+	sint64 half;
+
+	if (scale->Mul == 0)
+	{
+		return 0;
+	}
+
+	n = ((sint64)phys - scale->Offset) * ((sint64)1 << scale->Shift);
+	half = ((scale->Mul >= 0) ? (sint64)scale->Mul : -(sint64)scale->Mul) / 2;
+	n += (n >= 0) ? half : -half;
+	return Fxp_Sat32(n / scale->Mul);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Lookup tables, linear interpolation, clamped to the first / last point outside the range
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	const sint32*	X;				/* Strictly ascending breakpoints.*/
+	const sint32*	Y;
+	uint16			Count;			/* >= 1.*/
+}Fxp_LutType;
+
+typedef struct
+{
+	const sint32*	Y;				/* Y[i] at X0 + i * 2^Shift.*/
+	sint32			X0;
+	uint16			Count;			/* >= 1.*/
+	uint8			Shift;			/* 0..30.*/
+}Fxp_LutUniformType;
+
+static inline sint32 Fxp_Lerp(sint32 y0, sint32 y1, sint64 num, sint64 den)
+{
+	sint64 d = ((sint64)y1 - y0) * num;
+	sint64 half = den / 2;
+
+	return (sint32)(y0 + ((d >= 0) ? ((d + half) / den) : ((d - half) / den)));
+}
+
+static inline sint32 Fxp_LutInterp(const Fxp_LutType* lut, sint32 x)
+{
+	uint16 lo = 0u;
+	uint16 hi = (uint16)(lut->Count - 1u);
+
+	if (x <= lut->X[0])
+	{
+		return lut->Y[0];
+	}
+	if (x >= lut->X[hi])
+	{
+		return lut->Y[hi];
+	}
+
+	/* X[lo] < x < X[hi] */
+	while ((uint16)(hi - lo) > 1u)
+	{
+		uint16 mid = (uint16)((lo + hi) >> 1);
+		if (lut->X[mid] <= x)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return Fxp_Lerp(lut->Y[lo], lut->Y[hi], (sint64)x - lut->X[lo], (sint64)lut->X[hi] - lut->X[lo]);
+}
+
+static inline sint32 Fxp_LutUniformInterp(const Fxp_LutUniformType* lut, sint32 x)
+{
+	uint32 pos;
+	uint32 idx;
+	uint32 frac;
+	sint64 d;
+
+	if (x <= lut->X0)
+	{
+		return lut->Y[0];
+	}
+
+	pos = (uint32)((sint64)x - lut->X0);
+	idx = pos >> lut->Shift;
+	if (idx >= (uint32)(lut->Count - 1u))
+	{
+		return lut->Y[lut->Count - 1u];
+	}
+	if (lut->Shift == 0u)
+	{
+		return lut->Y[idx];
+	}
+
+	frac = pos & ((1uL << lut->Shift) - 1u);
+	d = ((sint64)lut->Y[idx + 1u] - lut->Y[idx]) * frac;
+	return (sint32)(lut->Y[idx] + Fxp_RoundShift(d, lut->Shift));
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  PI controller
+ *  - out = Kp * e + sum(Ki * e), gains are fixed-point with Shift fraction bits (Ki includes the sample time).
+ *  - The integrator is clamped to the output limits, so it never winds up while the output saturates.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	sint32	Kp;
+	sint32	Ki;
+	sint32	OutMin;
+	sint32	OutMax;
+	uint8	Shift;			/* 1..31.*/
+}Fxp_PiConfigType;
+
+typedef struct
+{
+	const Fxp_PiConfigType*	Config;
+	sint64					Integral;		/* Scaled by 2^Shift.*/
+}Fxp_PiType;
+
+static inline void Fxp_PiInit(Fxp_PiType* pi, const Fxp_PiConfigType* cfg)
+{
+	pi->Config = cfg;
+	pi->Integral = 0;
+}
+
+static inline sint32 Fxp_PiStep(Fxp_PiType* pi, sint32 setpoint, sint32 measured)
+{
+	const Fxp_PiConfigType* cfg = pi->Config;
+	sint64 err = (sint64)setpoint - measured;
+	sint64 iMin = (sint64)cfg->OutMin * ((sint64)1 << cfg->Shift);
+	sint64 iMax = (sint64)cfg->OutMax * ((sint64)1 << cfg->Shift);
+	sint64 out;
+
+	pi->Integral += err * cfg->Ki;
+	pi->Integral = (pi->Integral > iMax) ? iMax : ((pi->Integral < iMin) ? iMin : pi->Integral);
+
+	out = Fxp_RoundShift((err * cfg->Kp) + pi->Integral, cfg->Shift);
+	return (sint32)((out > cfg->OutMax) ? cfg->OutMax : ((out < cfg->OutMin) ? cfg->OutMin : out));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIXEDPOINT_H_ */
@@ -0,0 +1,311 @@
+/* =====================================================================================================================
+ *  File        : LatencyProbe.h
+ *  Layer       : Shared
+ *  Purpose     : Hot-path latency instrumentation of the communication stack
+ *                 - Timestamps from a cheap counter: DWT CYCCNT on target, CLOCK_MONOTONIC (ns) on Linux.
+ *                 - LATPROBE_START(pdu) at the TX request, LATPROBE_MARK(pdu, layer) when the PDU enters a layer
+ *                   (Com, PduR, TP, CanIf, MCAL Can), LATPROBE_END(pdu) at the NTFRSLT_OK confirmation.
+ *                 - Log2 histograms in RAM: per layer (time since the previous mark of the same PDU, i.e. the time
+ *                   it took to reach this layer) and per PduIdType (request -> confirmation).
+ *                 - Dump through the logger (LOG_TOKEN, LOGTAG_SRV_LOGGER), one histogram per call.
+ *                 - LATENCY_PROBE_ENABLE == 0: every macro expands to nothing, no code and no RAM.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : The instance is app owned: define "LatProbe_Type LatProbe_Instance;" in one .c file (or point
+ *                LATPROBE_INSTANCE to another object). Marks of one PDU are expected from one context at a time,
+ *                a mark racing with an ISR mark of the same PDU can at worst misplace one sample.
+ *                Host build: cc -std=gnu11 (or -std=c11 -D_POSIX_C_SOURCE=199309L) for CLOCK_MONOTONIC.
+ * ===================================================================================================================*/
+
+#ifndef LATENCYPROBE_H_
+#define LATENCYPROBE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LATPROBE_AR_MAJOR_VERSION		(1u)
+#define LATPROBE_AR_MINOR_VERSION		(0u)
+#define LATPROBE_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Enable switch
+ *  - LATENCY_PROBE_ENABLE is recommended to be declared in the app project (Preprocessor Defines).
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LATENCY_PROBE_ENABLE
+#define LATENCY_PROBE_ENABLE		(0)
+#endif
+
+#if (LATENCY_PROBE_ENABLE == 1)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ComStack_Types.h"
+#include "LogToken.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity
+ *  - LATPROBE_MAX_PDU : PduIdType 0..LATPROBE_MAX_PDU-1 are measured, others are ignored.
+ *  - LATPROBE_BUCKETS : histogram buckets, bucket 0 = [0, 2^SHIFT), bucket i = [2^(SHIFT+i-1), 2^(SHIFT+i)),
+ *                       the last bucket also counts everything above.
+ *  - LATPROBE_SHIFT   : resolution of bucket 0 (ticks = CPU cycles on target, ns on host).
+ *  RAM ~ (LATPROBE_MAX_PDU + LATPROBE_LAYER_COUNT) * (4 * LATPROBE_BUCKETS + 8) + 12 * LATPROBE_MAX_PDU bytes.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LATPROBE_MAX_PDU
+#define LATPROBE_MAX_PDU			(16u)
+#endif
+
+#ifndef LATPROBE_BUCKETS
+#define LATPROBE_BUCKETS			(16u)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Time source
+ *  - LATPROBE_NOW()          : free running 32-bit tick counter.
+ *  - LATPROBE_TICKS_TO_NS(t) : conversion used by the dump only.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if defined(__arm__)
+
+#ifndef LATPROBE_CPU_HZ
+#define LATPROBE_CPU_HZ				(72000000u)
+#endif
+
+#define LATPROBE_DWT_CTRL			(*(volatile uint32_t*)0xE0001000u)
+#define LATPROBE_DWT_CYCCNT			(*(volatile uint32_t*)0xE0001004u)
+#define LATPROBE_DEMCR				(*(volatile uint32_t*)0xE000EDFCu)
+#define LATPROBE_DEMCR_TRCENA		(1ul << 24)
+
+#ifndef LATPROBE_NOW
+#define LATPROBE_NOW()				(LATPROBE_DWT_CYCCNT)
+#endif
+#ifndef LATPROBE_TICKS_TO_NS
+#define LATPROBE_TICKS_TO_NS(_t_)	((uint32_t)(((uint64_t)(_t_) * 1000000000u) / LATPROBE_CPU_HZ))
+#endif
+#ifndef LATPROBE_SHIFT
+#define LATPROBE_SHIFT				(4u)		/* Bucket 0 < 16 cycles, last bucket >= 2^18 cycles (3.6 ms).*/
+#endif
+
+static inline void LatProbe_ClockInit(void)
+{
+	LATPROBE_DEMCR |= LATPROBE_DEMCR_TRCENA;
+	LATPROBE_DWT_CYCCNT = 0u;
+	LATPROBE_DWT_CTRL |= 1u;					/* CYCCNTENA */
+}
+
+#else /* Host */
+
+#include <time.h>
+
+static inline uint32_t LatProbe_HostNow(void)
+{
+	struct timespec ts;
+
+/* clock_gettime() is POSIX: host builds use -std=gnu11 or -D_POSIX_C_SOURCE=199309L, plain -std=c11 falls back. */
+#if defined(CLOCK_MONOTONIC)
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	(void)timespec_get(&ts, TIME_UTC);			/* Wall clock: a time step can misplace one sample.*/
+#endif
+	return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec);
+}
+
+#ifndef LATPROBE_NOW
+#define LATPROBE_NOW()				LatProbe_HostNow()
+#endif
+#ifndef LATPROBE_TICKS_TO_NS
+#define LATPROBE_TICKS_TO_NS(_t_)	((uint32_t)(_t_))
+#endif
+#ifndef LATPROBE_SHIFT
+#define LATPROBE_SHIFT				(6u)		/* Bucket 0 < 64 ns, last bucket >= 2^20 ns (1 ms).*/
+#endif
+
+static inline void LatProbe_ClockInit(void)
+{
+}
+
+#endif /* __arm__ */
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Layers (order of a TX request down the stack)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	LATPROBE_LAYER_COM = 0,
+	LATPROBE_LAYER_PDUR,
+	LATPROBE_LAYER_TP,
+	LATPROBE_LAYER_CANIF,
+	LATPROBE_LAYER_CAN,			/* MCAL Can: frame written to a mailbox.*/
+	LATPROBE_LAYER_COUNT
+}LatProbe_LayerType;
+
+typedef struct
+{
+	uint32_t	Bucket[LATPROBE_BUCKETS];
+	uint32_t	Max;							/* Ticks.*/
+	uint32_t	Count;
+}LatProbe_HistType;
+
+typedef struct
+{
+	uint32_t	Start;
+	uint32_t	Last;							/* Tick of the previous mark.*/
+	bool		Active;
+}LatProbe_PduStateType;
+
+typedef struct
+{
+	LatProbe_HistType		Layer[LATPROBE_LAYER_COUNT];
+	LatProbe_HistType		Pdu[LATPROBE_MAX_PDU];
+	LatProbe_PduStateType	State[LATPROBE_MAX_PDU];
+}LatProbe_Type;
+
+#ifndef LATPROBE_INSTANCE
+extern LatProbe_Type LatProbe_Instance;
+#define LATPROBE_INSTANCE			(&LatProbe_Instance)
+#endif
+
+static inline void LatProbe_Init(LatProbe_Type* probe)
+{
+	uint8_t* p = (uint8_t*)probe;
+	uint32_t i;
+
+	for (i = 0u; i < sizeof(*probe); i++)
+	{
+		p[i] = 0u;
+	}
+	LatProbe_ClockInit();
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: log2 bucket of a duration (CLZ is one instruction on Cortex-M3)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LatProbe_BucketOf(uint32_t ticks)
+{
+	uint32_t v = ticks >> LATPROBE_SHIFT;
+	uint8_t b;
+
+	if (v == 0u)
+	{
+		return 0u;
+	}
+#if defined(__GNUC__)
+	b = (uint8_t)(32u - (uint32_t)__builtin_clz(v));
+#else
+	b = 0u;
+	while (v != 0u)
+	{
+		v >>= 1;
+		b++;
+	}
+#endif
+	return (b < LATPROBE_BUCKETS) ? b : (uint8_t)(LATPROBE_BUCKETS - 1u);
+}
+
+static inline void LatProbe_Record(LatProbe_HistType* h, uint32_t ticks)
+{
+	uint8_t b = LatProbe_BucketOf(ticks);
+
+	h->Bucket[b]++;
+	if (ticks > h->Max)
+	{
+		h->Max = ticks;
+	}
+	h->Count++;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Events
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LatProbe_Start(LatProbe_Type* probe, PduIdType pdu)
+{
+	if (pdu < LATPROBE_MAX_PDU)
+	{
+		uint32_t now = LATPROBE_NOW();
+		probe->State[pdu].Start = now;
+		probe->State[pdu].Last = now;
+		probe->State[pdu].Active = true;
+	}
+}
+
+static inline void LatProbe_Mark(LatProbe_Type* probe, PduIdType pdu, LatProbe_LayerType layer)
+{
+	if ((pdu < LATPROBE_MAX_PDU) && ((uint32_t)layer < (uint32_t)LATPROBE_LAYER_COUNT) && probe->State[pdu].Active)
+	{
+		uint32_t now = LATPROBE_NOW();
+		LatProbe_Record(&probe->Layer[layer], now - probe->State[pdu].Last);
+		probe->State[pdu].Last = now;
+	}
+}
+
+static inline void LatProbe_End(LatProbe_Type* probe, PduIdType pdu)
+{
+	if ((pdu < LATPROBE_MAX_PDU) && probe->State[pdu].Active)
+	{
+		LatProbe_Record(&probe->Pdu[pdu], LATPROBE_NOW() - probe->State[pdu].Start);
+		probe->State[pdu].Active = false;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Dump through the logger, one histogram per call (spread it over logger cycles so the ring does not overflow)
+ *  - The app adds two entries to LOG_FMT_TABLE and maps them, e.g.:
+ *      X(LAT_SUM,	"lat kind=%u idx=%u n=%u max=%uns")
+ *      X(LAT_BKT,	"lat kind=%u idx=%u b%u=%u")
+ *      #define LATPROBE_LOG_FMT_SUMMARY	LOG_FMT_LAT_SUM
+ *      #define LATPROBE_LOG_FMT_BUCKET		LOG_FMT_LAT_BKT
+ *    kind 0 = layer (idx = LatProbe_LayerType), kind 1 = PDU (idx = PduIdType).
+ *  - *cursor starts at 0, returns false once every histogram was dumped. Empty histograms are skipped.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if defined(LATPROBE_LOG_FMT_SUMMARY) && defined(LATPROBE_LOG_FMT_BUCKET)
+static inline bool LatProbe_DumpNext(const LatProbe_Type* probe, uint16_t* cursor)
+{
+	while (*cursor < (uint16_t)(LATPROBE_LAYER_COUNT + LATPROBE_MAX_PDU))
+	{
+		uint16_t idx = (*cursor)++;
+		uint32_t kind = (idx < (uint16_t)LATPROBE_LAYER_COUNT) ? 0u : 1u;
+		uint32_t n = (kind == 0u) ? idx : (uint32_t)(idx - LATPROBE_LAYER_COUNT);
+		const LatProbe_HistType* h = (kind == 0u) ? &probe->Layer[n] : &probe->Pdu[n];
+		uint32_t b;
+
+		if (h->Count == 0u)
+		{
+			continue;
+		}
+
+		LOG_TOKEN(LOGTAG_SRV_LOGGER, LOG_INFO, LATPROBE_LOG_FMT_SUMMARY, kind, n, h->Count,
+				  LATPROBE_TICKS_TO_NS(h->Max));
+		for (b = 0u; b < LATPROBE_BUCKETS; b++)
+		{
+			if (h->Bucket[b] != 0u)
+			{
+				LOG_TOKEN(LOGTAG_SRV_LOGGER, LOG_INFO, LATPROBE_LOG_FMT_BUCKET, kind, n, b, h->Bucket[b]);
+			}
+		}
+		return true;
+	}
+	return false;
+}
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Call-site macros
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LATPROBE_START(_pdu_)			LatProbe_Start(LATPROBE_INSTANCE, (_pdu_))
+#define LATPROBE_MARK(_pdu_, _layer_)	LatProbe_Mark(LATPROBE_INSTANCE, (_pdu_), (_layer_))
+#define LATPROBE_END(_pdu_)				LatProbe_End(LATPROBE_INSTANCE, (_pdu_))
+
+#else /* LATENCY_PROBE_ENABLE */
+
+#define LATPROBE_START(_pdu_)			((void)0)
+#define LATPROBE_MARK(_pdu_, _layer_)	((void)0)
+#define LATPROBE_END(_pdu_)				((void)0)
+
+#endif /* LATENCY_PROBE_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCYPROBE_H_ */
@@ -0,0 +1,98 @@
+/* =====================================================================================================================
+ *  File        : LogCapture.h
+ *  Layer       : Shared
+ *  Purpose     : Header of a log capture (UART stream saved to a file by the host)
+ *                 - Sent by the logger once at boot, before the first record, so host tools know the record
+ *                   format and which ECU (ECU_ROLE) produced the capture.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Layout (little-endian, LOG_CAPTURE_HDR_SIZE bytes):
+ *                  [0..3] Magic "LOGC"
+ *                  [4]    Version
+ *                  [5]    Format (LogCaptureFormat_t)
+ *                  [6]    ECU role (ECU_SENSOR/ECU_MOTOR/ECU_UNKNOWN)
+ *                  [7]    LOGTAG_COUNT of the producer
+ * ===================================================================================================================*/
+
+#ifndef LOGCAPTURE_H_
+#define LOGCAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_CAPTURE_AR_MAJOR_VERSION		(1u)
+#define LOG_CAPTURE_AR_MINOR_VERSION		(0u)
+#define LOG_CAPTURE_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LogTags.h"
+
+#define LOG_CAPTURE_MAGIC0		((uint8_t)'L')
+#define LOG_CAPTURE_MAGIC1		((uint8_t)'O')
+#define LOG_CAPTURE_MAGIC2		((uint8_t)'G')
+#define LOG_CAPTURE_MAGIC3		((uint8_t)'C')
+#define LOG_CAPTURE_VERSION		(1u)
+#define LOG_CAPTURE_HDR_SIZE	(8u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Record format following the header
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	LOG_CAPTURE_FMT_TOKEN = 0,		/* LogToken.h records back to back.*/
+	LOG_CAPTURE_FMT_FRAMED			/* LogFrame.h COBS frames.*/
+}LogCaptureFormat_t;
+
+typedef struct
+{
+	uint8_t		Version;
+	uint8_t		Format;			/* LogCaptureFormat_t. */
+	uint8_t		EcuRole;
+	uint8_t		TagCount;
+}LogCaptureHeader_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: write the header of this ECU into buf (LOG_CAPTURE_HDR_SIZE bytes)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_CaptureHeaderEncode(uint8_t* buf, LogCaptureFormat_t format)
+{
+	buf[0] = LOG_CAPTURE_MAGIC0;
+	buf[1] = LOG_CAPTURE_MAGIC1;
+	buf[2] = LOG_CAPTURE_MAGIC2;
+	buf[3] = LOG_CAPTURE_MAGIC3;
+	buf[4] = LOG_CAPTURE_VERSION;
+	buf[5] = (uint8_t)format;
+	buf[6] = (uint8_t)ECU_ROLE;
+	buf[7] = (uint8_t)LOGTAG_COUNT;
+	return LOG_CAPTURE_HDR_SIZE;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: parse a header, return false if buf does not start with a valid one
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool LOG_CaptureHeaderDecode(const uint8_t* buf, uint32_t len, LogCaptureHeader_t* hdr)
+{
+	if ((len < LOG_CAPTURE_HDR_SIZE) ||
+		(buf[0] != LOG_CAPTURE_MAGIC0) || (buf[1] != LOG_CAPTURE_MAGIC1) ||
+		(buf[2] != LOG_CAPTURE_MAGIC2) || (buf[3] != LOG_CAPTURE_MAGIC3) ||
+		(buf[4] != LOG_CAPTURE_VERSION) || (buf[5] > (uint8_t)LOG_CAPTURE_FMT_FRAMED))
+	{
+		return false;
+	}
+
+	hdr->Version = buf[4];
+	hdr->Format = buf[5];
+	hdr->EcuRole = buf[6];
+	hdr->TagCount = buf[7];
+	return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGCAPTURE_H_ */
@@ -0,0 +1,138 @@
+/* =====================================================================================================================
+ *  File        : LogFilter.h
+ *  Layer       : Shared
+ *  Purpose     : Per-tag log level thresholds
+ *                 - Compile time: one threshold per LogTag_t, resolved by the preprocessor/compiler so a disabled
+ *                   log call (its arguments and string literals) compiles to nothing.
+ *                 - Run time    : optional per-tag override, only for tags/levels that are compiled in.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        :
+ * ===================================================================================================================*/
+
+#ifndef LOGFILTER_H_
+#define LOGFILTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_FILTER_AR_MAJOR_VERSION		(1u)
+#define LOG_FILTER_AR_MINOR_VERSION		(0u)
+#define LOG_FILTER_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include "LogLevels.h"
+#include "LogTags.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Compile-time threshold per tag
+ *  - A tag listed in LOG_TAG_MASK_LVL_<LEVEL> is compiled in up to <LEVEL>.
+ *  - A tag not listed in any of them uses the Level column of LOG_TAG_REGISTRY (LOG_LEVEL_DEFAULT by default).
+ *  - e.g. TRACE for CAN driver, ERROR for everything else (Preprocessor Defines):
+ *  	LOG_LEVEL_DEFAULT=LOG_ERROR
+ *  	LOG_TAG_MASK_LVL_TRACE=LOG_TAG_BIT(LOGTAG_MCAL_CAN)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LOG_TAG_MASK_LVL_OFF
+#define LOG_TAG_MASK_LVL_OFF		LOG_TAG_MASK_NONE
+#endif
+#ifndef LOG_TAG_MASK_LVL_ERROR
+#define LOG_TAG_MASK_LVL_ERROR		LOG_TAG_MASK_NONE
+#endif
+#ifndef LOG_TAG_MASK_LVL_WARN
+#define LOG_TAG_MASK_LVL_WARN		LOG_TAG_MASK_NONE
+#endif
+#ifndef LOG_TAG_MASK_LVL_INFO
+#define LOG_TAG_MASK_LVL_INFO		LOG_TAG_MASK_NONE
+#endif
+#ifndef LOG_TAG_MASK_LVL_DEBUG
+#define LOG_TAG_MASK_LVL_DEBUG		LOG_TAG_MASK_NONE
+#endif
+#ifndef LOG_TAG_MASK_LVL_TRACE
+#define LOG_TAG_MASK_LVL_TRACE		LOG_TAG_MASK_NONE
+#endif
+
+#define LOG_TAG_MASK_LVL_PINNED		( LOG_TAG_MASK_LVL_OFF   | LOG_TAG_MASK_LVL_ERROR | LOG_TAG_MASK_LVL_WARN \
+									| LOG_TAG_MASK_LVL_INFO  | LOG_TAG_MASK_LVL_DEBUG | LOG_TAG_MASK_LVL_TRACE )
+
+/* Tags following the registry level, enabled at LOG_<_lvl_> */
+#define LOG_TAG_MASK_LVL_UNPINNED(_lvl_)	( (LogTagMask_t)(~LOG_TAG_MASK_LVL_PINNED) & LOG_TAG_MASK_REG_##_lvl_ )
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Compiled-in tag mask for each level (tags whose threshold >= level)
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_CT_MASK_TRACE	( LOG_TAG_MASK_LVL_TRACE | LOG_TAG_MASK_LVL_UNPINNED(TRACE) )
+#define LOG_CT_MASK_DEBUG	( LOG_TAG_MASK_LVL_DEBUG | LOG_TAG_MASK_LVL_TRACE | LOG_TAG_MASK_LVL_UNPINNED(DEBUG) )
+#define LOG_CT_MASK_INFO	( LOG_TAG_MASK_LVL_INFO  | LOG_TAG_MASK_LVL_DEBUG | LOG_TAG_MASK_LVL_TRACE \
+							| LOG_TAG_MASK_LVL_UNPINNED(INFO) )
+#define LOG_CT_MASK_WARN	( LOG_TAG_MASK_LVL_WARN  | LOG_TAG_MASK_LVL_INFO  | LOG_TAG_MASK_LVL_DEBUG \
+							| LOG_TAG_MASK_LVL_TRACE | LOG_TAG_MASK_LVL_UNPINNED(WARN) )
+#define LOG_CT_MASK_ERROR	( LOG_TAG_MASK_LVL_ERROR | LOG_TAG_MASK_LVL_WARN  | LOG_TAG_MASK_LVL_INFO \
+							| LOG_TAG_MASK_LVL_DEBUG | LOG_TAG_MASK_LVL_TRACE | LOG_TAG_MASK_LVL_UNPINNED(ERROR) )
+
+#define LOG_CT_LEVEL_MASK(_lvl_)				\
+	( ((_lvl_) == LOG_ERROR) ? LOG_CT_MASK_ERROR :	\
+	  ((_lvl_) == LOG_WARN)  ? LOG_CT_MASK_WARN  :	\
+	  ((_lvl_) == LOG_INFO)  ? LOG_CT_MASK_INFO  :	\
+	  ((_lvl_) == LOG_DEBUG) ? LOG_CT_MASK_DEBUG :	\
+	  ((_lvl_) == LOG_TRACE) ? LOG_CT_MASK_TRACE :	\
+	  LOG_TAG_MASK_NONE )
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro checks if (tag, lvl) is compiled in
+ *  - constant expression when tag and lvl are constants: "if (LOG_CT_ENABLE(...))" is removed by the compiler.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_CT_ENABLE(_tag_, _lvl_)		LOG_TAG_ENABLE(LOG_CT_LEVEL_MASK(_lvl_), _tag_)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: compiled-in threshold of one tag
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline LogLevel_t LOG_CT_TagLevel(LogTag_t tag)
+{
+	if (LOG_CT_ENABLE(tag, LOG_TRACE))	{ return LOG_TRACE; }
+	if (LOG_CT_ENABLE(tag, LOG_DEBUG))	{ return LOG_DEBUG; }
+	if (LOG_CT_ENABLE(tag, LOG_INFO))	{ return LOG_INFO; }
+	if (LOG_CT_ENABLE(tag, LOG_WARN))	{ return LOG_WARN; }
+	if (LOG_CT_ENABLE(tag, LOG_ERROR))	{ return LOG_ERROR; }
+	return LOG_OFF;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Runtime override layer
+ *  - Level[tag] starts at the compiled-in threshold, can be lowered (or raised back) at run time.
+ *  - Raising above the compiled-in threshold has no effect: those calls do not exist in the binary.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint8_t		Level[LOGTAG_COUNT];	/* LogLevel_t per tag. */
+}LogFilter_t;
+
+static inline void LOG_FilterInit(LogFilter_t* filter)
+{
+	uint8_t tag;
+
+	for (tag = 0u; tag < (uint8_t)LOGTAG_COUNT; tag++)
+	{
+		filter->Level[tag] = (uint8_t)LOG_CT_TagLevel((LogTag_t)tag);
+	}
+}
+
+static inline void LOG_FilterSetLevel(LogFilter_t* filter, LogTag_t tag, LogLevel_t lvl)
+{
+	if ((uint32_t)tag < (uint32_t)LOGTAG_COUNT)
+	{
+		filter->Level[tag] = (uint8_t)lvl;
+	}
+}
+
+/* Compile-time test first: when it is false the runtime table is never read. */
+#define LOG_FILTER_ENABLE(_filter_, _tag_, _lvl_)	\
+	( LOG_CT_ENABLE(_tag_, _lvl_) && ((uint8_t)(_lvl_) <= (_filter_)->Level[_tag_]) )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGFILTER_H_ */
@@ -0,0 +1,354 @@
+/* =====================================================================================================================
+ *  File        : LogFrame.h
+ *  Layer       : Shared
+ *  Purpose     : Compact self-synchronising wire format for log records (UART capture)
+ *                 - Frame   = COBS(payload + CRC8) + 0x00 delimiter, a receiver resyncs on the next 0x00.
+ *                 - Payload = [tag:5 | level:3] [varint delta timestamp] [varint format ID] [varint args...]
+ *                 - Sync    = level 7, payload carries the absolute timestamp (sent first and every
+ *                             LOG_FRAME_SYNC_INTERVAL frames, so a decoder recovers timestamps after lost frames).
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Encoder runs on target (logger main function), decoder is for the host capture tools.
+ * ===================================================================================================================*/
+
+#ifndef LOGFRAME_H_
+#define LOGFRAME_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_FRAME_AR_MAJOR_VERSION		(1u)
+#define LOG_FRAME_AR_MINOR_VERSION		(0u)
+#define LOG_FRAME_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Crc.h"
+#include "LogLevels.h"
+#include "LogTags.h"
+#include "LogToken.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Wire constants
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_FRAME_DELIMITER		(0x00u)
+#define LOG_FRAME_LEVEL_SYNC	(7u)			/* Level value reserved for sync frames.*/
+#define LOG_FRAME_VARINT_MAX	(5u)			/* uint32 as LEB128.*/
+
+#ifndef LOG_FRAME_SYNC_INTERVAL
+#define LOG_FRAME_SYNC_INTERVAL	(64u)
+#endif
+
+/* Worst-case payload (header + ts + fmt + args + CRC), COBS adds 1 byte per 254 + the delimiter */
+#define LOG_FRAME_MAX_PAYLOAD	(1u + (LOG_FRAME_VARINT_MAX * (2u + LOG_TOKEN_MAX_ARGS)) + 1u)
+#define LOG_FRAME_MAX_ENCODED	(LOG_FRAME_MAX_PAYLOAD + 2u)
+#define LOG_FRAME_SYNC_ENCODED	(1u + LOG_FRAME_VARINT_MAX + 1u + 2u)
+
+/* Output buffer size for LOG_FrameEncode (one record, possibly preceded by a sync frame) */
+#define LOG_FRAME_MAX_SIZE		(LOG_FRAME_SYNC_ENCODED + LOG_FRAME_MAX_ENCODED)
+
+typedef char LOG_FrameTagCheck_t[((uint32_t)LOGTAG_COUNT <= 32u) ? 1 : -1];
+typedef char LOG_FrameLevelCheck_t[((uint32_t)LOG_LEVEL_COUNT <= LOG_FRAME_LEVEL_SYNC) ? 1 : -1];
+typedef char LOG_FrameCobsCheck_t[(LOG_FRAME_MAX_PAYLOAD < 254u) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: CRC-8 SAE J1850 (poly 0x1D, init 0xFF, xor-out 0xFF) over the payload
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_FrameCrc8(const uint8_t* data, uint8_t len)
+{
+	return Crc_CalculateCRC8(data, len, 0u, true);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: varint (LEB128) put/get
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_FramePutVarint(uint8_t* buf, uint32_t value)
+{
+	uint8_t n = 0u;
+
+	while (value >= 0x80u)
+	{
+		buf[n++] = (uint8_t)(value | 0x80u);
+		value >>= 7;
+	}
+	buf[n++] = (uint8_t)value;
+	return n;
+}
+
+/* return bytes consumed, 0 if truncated or longer than LOG_FRAME_VARINT_MAX */
+static inline uint8_t LOG_FrameGetVarint(const uint8_t* buf, uint8_t len, uint32_t* value)
+{
+	uint32_t v = 0u;
+	uint8_t n;
+
+	for (n = 0u; (n < len) && (n < LOG_FRAME_VARINT_MAX); n++)
+	{
+		v |= (uint32_t)(buf[n] & 0x7Fu) << (7u * n);
+		if ((buf[n] & 0x80u) == 0u)
+		{
+			*value = v;
+			return (uint8_t)(n + 1u);
+		}
+	}
+	return 0u;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: COBS encode payload[len] into out, add the delimiter, return bytes written (len + 2 for len < 254)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_FrameCobsEncode(const uint8_t* payload, uint8_t len, uint8_t* out)
+{
+	uint8_t codePos = 0u;
+	uint8_t code = 1u;
+	uint8_t pos = 1u;
+	uint8_t i;
+
+	for (i = 0u; i < len; i++)
+	{
+		if (payload[i] == 0u)
+		{
+			out[codePos] = code;
+			codePos = pos++;
+			code = 1u;
+		}
+		else
+		{
+			out[pos++] = payload[i];
+			code++;
+		}
+	}
+	out[codePos] = code;
+	out[pos++] = LOG_FRAME_DELIMITER;
+	return pos;
+}
+
+/* return decoded length, 0 if the encoding is invalid */
+static inline uint8_t LOG_FrameCobsDecode(const uint8_t* in, uint8_t len, uint8_t* out)
+{
+	uint8_t pos = 0u;
+	uint8_t n = 0u;
+	uint8_t code;
+	uint8_t i;
+
+	while (pos < len)
+	{
+		code = in[pos++];
+		if ((code == 0u) || (((uint16_t)pos + code - 1u) > len))
+		{
+			return 0u;
+		}
+		for (i = 1u; i < code; i++)
+		{
+			out[n++] = in[pos++];
+		}
+		if ((code != 0xFFu) && (pos < len))
+		{
+			out[n++] = 0u;
+		}
+	}
+	return n;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Encoder
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint32_t	LastTimestamp;
+	uint16_t	SinceSync;			/* Frames since the last sync, LOG_FRAME_SYNC_INTERVAL forces a new sync.*/
+}LogFrameEncoder_t;
+
+static inline void LOG_FrameEncoderInit(LogFrameEncoder_t* enc)
+{
+	enc->LastTimestamp = 0u;
+	enc->SinceSync = LOG_FRAME_SYNC_INTERVAL;
+}
+
+/* Force a sync frame before the next record (e.g. after the drain lost data). */
+static inline void LOG_FrameEncoderResync(LogFrameEncoder_t* enc)
+{
+	enc->SinceSync = LOG_FRAME_SYNC_INTERVAL;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Encode one record into out (LOG_FRAME_MAX_SIZE bytes), return bytes written, 0 if argc > LOG_TOKEN_MAX_ARGS.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_FrameEncode(LogFrameEncoder_t* enc, LogTag_t tag, LogLevel_t lvl, LogFmtId_t fmtId,
+									  uint32_t timestamp, const uint32_t* args, uint8_t argc, uint8_t* out)
+{
+	uint8_t payload[LOG_FRAME_MAX_PAYLOAD];
+	uint8_t len;
+	uint8_t n = 0u;
+	uint8_t i;
+
+	if (argc > LOG_TOKEN_MAX_ARGS)
+	{
+		return 0u;
+	}
+
+	if (enc->SinceSync >= LOG_FRAME_SYNC_INTERVAL)
+	{
+		payload[0] = LOG_FRAME_LEVEL_SYNC;
+		len = (uint8_t)(1u + LOG_FramePutVarint(&payload[1], timestamp));
+		payload[len] = LOG_FrameCrc8(payload, len);
+		n = LOG_FrameCobsEncode(payload, (uint8_t)(len + 1u), out);
+		enc->LastTimestamp = timestamp;
+		enc->SinceSync = 0u;
+	}
+
+	payload[0] = (uint8_t)(((uint8_t)tag << 3) | ((uint8_t)lvl & 0x07u));
+	len = 1u;
+	len = (uint8_t)(len + LOG_FramePutVarint(&payload[len], timestamp - enc->LastTimestamp));
+	len = (uint8_t)(len + LOG_FramePutVarint(&payload[len], fmtId));
+	for (i = 0u; i < argc; i++)
+	{
+		len = (uint8_t)(len + LOG_FramePutVarint(&payload[len], args[i]));
+	}
+	payload[len] = LOG_FrameCrc8(payload, len);
+
+	enc->LastTimestamp = timestamp;
+	enc->SinceSync++;
+
+	return (uint8_t)(n + LOG_FrameCobsEncode(payload, (uint8_t)(len + 1u), &out[n]));
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Decoder (stream, one byte at a time)
+ *  - LOG_FRAME_NONE   : need more bytes (or a sync frame was consumed).
+ *  - LOG_FRAME_RECORD : rec is filled; rec->Timestamp is only meaningful when dec->TimeValid.
+ *  - LOG_FRAME_ERROR  : corrupted/oversized frame dropped, decoder waits for the next delimiter, timestamps become
+ *                       invalid until the next sync frame.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	LOG_FRAME_NONE = 0,
+	LOG_FRAME_RECORD,
+	LOG_FRAME_ERROR
+}LogFrameResult_t;
+
+typedef struct
+{
+	uint8_t		Buf[LOG_FRAME_MAX_ENCODED];
+	uint8_t		Len;
+	bool		Overflow;			/* Current frame too long, skip to the next delimiter.*/
+	bool		TimeValid;			/* Absolute time known (sync seen and no frame lost since).*/
+	uint32_t	LastTimestamp;
+	uint32_t	Errors;				/* Statistics: frames dropped.*/
+}LogFrameDecoder_t;
+
+static inline void LOG_FrameDecoderInit(LogFrameDecoder_t* dec)
+{
+	dec->Len = 0u;
+	dec->Overflow = false;
+	dec->TimeValid = false;
+	dec->LastTimestamp = 0u;
+	dec->Errors = 0u;
+}
+
+static inline LogFrameResult_t LOG_FrameParse(LogFrameDecoder_t* dec, const uint8_t* p, uint8_t len,
+											  LogTokenRecord_t* rec)
+{
+	uint32_t value;
+	uint8_t pos = 1u;
+	uint8_t n;
+	uint8_t lvl;
+
+	if ((len < 2u) || (LOG_FrameCrc8(p, (uint8_t)(len - 1u)) != p[len - 1u]))
+	{
+		return LOG_FRAME_ERROR;
+	}
+	len--;
+
+	lvl = (uint8_t)(p[0] & 0x07u);
+	n = LOG_FrameGetVarint(&p[pos], (uint8_t)(len - pos), &value);
+	if (n == 0u)
+	{
+		return LOG_FRAME_ERROR;
+	}
+	pos = (uint8_t)(pos + n);
+
+	if (lvl == LOG_FRAME_LEVEL_SYNC)
+	{
+		dec->LastTimestamp = value;
+		dec->TimeValid = true;
+		return (pos == len) ? LOG_FRAME_NONE : LOG_FRAME_ERROR;
+	}
+
+	if (((p[0] >> 3) >= (uint8_t)LOGTAG_COUNT) || (lvl >= (uint8_t)LOG_LEVEL_COUNT))
+	{
+		return LOG_FRAME_ERROR;
+	}
+	dec->LastTimestamp += value;
+
+	rec->Tag = (LogTag_t)(p[0] >> 3);
+	rec->Level = (LogLevel_t)lvl;
+	rec->Timestamp = dec->LastTimestamp;
+
+	n = LOG_FrameGetVarint(&p[pos], (uint8_t)(len - pos), &value);
+	if ((n == 0u) || (value > 0xFFFFu))
+	{
+		return LOG_FRAME_ERROR;
+	}
+	pos = (uint8_t)(pos + n);
+	rec->FmtId = (LogFmtId_t)value;
+
+	rec->ArgCount = 0u;
+	while (pos < len)
+	{
+		n = LOG_FrameGetVarint(&p[pos], (uint8_t)(len - pos), &value);
+		if ((n == 0u) || (rec->ArgCount >= LOG_TOKEN_MAX_ARGS))
+		{
+			return LOG_FRAME_ERROR;
+		}
+		pos = (uint8_t)(pos + n);
+		rec->Args[rec->ArgCount++] = value;
+	}
+
+	return LOG_FRAME_RECORD;
+}
+
+static inline LogFrameResult_t LOG_FrameDecodeByte(LogFrameDecoder_t* dec, uint8_t byte, LogTokenRecord_t* rec)
+{
+	uint8_t payload[LOG_FRAME_MAX_ENCODED];
+	LogFrameResult_t res;
+	uint8_t len;
+
+	if (byte != LOG_FRAME_DELIMITER)
+	{
+		if (dec->Len < LOG_FRAME_MAX_ENCODED)
+		{
+			dec->Buf[dec->Len++] = byte;
+		}
+		else
+		{
+			dec->Overflow = true;
+		}
+		return LOG_FRAME_NONE;
+	}
+
+	if ((dec->Len == 0u) && !dec->Overflow)
+	{
+		return LOG_FRAME_NONE;			/* Empty frame (idle delimiters). */
+	}
+
+	len = dec->Overflow ? 0u : LOG_FrameCobsDecode(dec->Buf, dec->Len, payload);
+	res = (len == 0u) ? LOG_FRAME_ERROR : LOG_FrameParse(dec, payload, len, rec);
+
+	dec->Len = 0u;
+	dec->Overflow = false;
+	if (res == LOG_FRAME_ERROR)
+	{
+		dec->Errors++;
+		dec->TimeValid = false;
+	}
+	return res;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGFRAME_H_ */
@@ -16,11 +16,13 @@ extern "C" {
  *  Macro for version
  * -------------------------------------------------------------------------------------------------------------------*/
 #define LOG_LEVELS_AR_MAJOR_VERSION		(1u)
-#define LOG_LEVELS_AR_MINOR_VERSION		(0u)
+#define LOG_LEVELS_AR_MINOR_VERSION		(1u)
 #define LOG_LEVELS_AR_PATCH_VERSION		(0u)
 
+#include <stdint.h>
+
 /* ---------------------------------------------------------------------------------------------------------------------
- *  level of log :
+ *  level of log (registry: Id, string, one character label):
  *  	- LOG_OFF 	: OFF log.
  *  	- LOG_ERROR : when error occur.
  *  	- LOG_WARN	: Warning, system can self-healing.
@@ -28,15 +30,41 @@ extern "C" {
  *  	- LOG_DEBUG : Log clearly.
  *  	- LOG_TRACE :
  * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_LEVEL_REGISTRY(X)		\
+	X(LOG_OFF,		"OFF",		'O')	\
+	X(LOG_ERROR,	"ERROR",	'E')	\
+	X(LOG_WARN,		"WARN",		'W')	\
+	X(LOG_INFO,		"INFO",		'I')	\
+	X(LOG_DEBUG,	"DEBUG",	'D')	\
+	X(LOG_TRACE,	"TRACE",	'T')
+
+#define LOG_LEVEL_ENUM_ENTRY(_id_, _str_, _chr_)	_id_,
 typedef enum
 {
-	LOG_OFF = 0,
-	LOG_ERROR,
-	LOG_WARN,
-	LOG_INFO,
-	LOG_DEBUG,
-	LOG_TRACE
+	LOG_LEVEL_REGISTRY(LOG_LEVEL_ENUM_ENTRY)
+
+	LOG_LEVEL_COUNT		// count level, always end of this enum
 }LogLevel_t;
+#undef LOG_LEVEL_ENUM_ENTRY
+
+#define LOG_LEVEL_STRING_ENTRY(_id_, _str_, _chr_)	_str_,
+static const char* const LOG_LevelStrings[] =
+{
+	LOG_LEVEL_REGISTRY(LOG_LEVEL_STRING_ENTRY)
+};
+#undef LOG_LEVEL_STRING_ENTRY
+
+#define LOG_LEVEL_CHAR_ENTRY(_id_, _str_, _chr_)	_chr_,
+static const char LOG_LevelChars[] =
+{
+	LOG_LEVEL_REGISTRY(LOG_LEVEL_CHAR_ENTRY)
+};
+#undef LOG_LEVEL_CHAR_ENTRY
+
+/* Static check: one entry per level */
+typedef char LOG_LevelStringsSizeCheck_t[
+	((sizeof(LOG_LevelStrings) / sizeof(LOG_LevelStrings[0])) == (uint32_t)LOG_LEVEL_COUNT) ? 1 : -1];
+typedef char LOG_LevelCharsSizeCheck_t[(sizeof(LOG_LevelChars) == (uint32_t)LOG_LEVEL_COUNT) ? 1 : -1];
 
 /* ---------------------------------------------------------------------------------------------------------------------
  *  level of log default for system:
@@ -59,16 +87,7 @@ typedef enum
  * -------------------------------------------------------------------------------------------------------------------*/
 static inline const char* LOG_LevelToString(LogLevel_t lvl)
 {
-	switch(lvl)
-	{
-		case LOG_ERROR: return "ERROR";
-		case LOG_WARN:	return "WARN";
-		case LOG_INFO:	return "INFO";
-		case LOG_DEBUG: return "DEBUG";
-		case LOG_TRACE: return "TRACE";
-		case LOG_OFF:
-		default:		return "OFF";
-	}
+	return ((uint32_t)lvl < (uint32_t)LOG_LEVEL_COUNT) ? LOG_LevelStrings[lvl] : "OFF";
 }
 
 /* ---------------------------------------------------------------------------------------------------------------------
@@ -80,20 +99,13 @@ static inline const char* LOG_LevelToString(LogLevel_t lvl)
 /* ---------------------------------------------------------------------------------------------------------------------
  *  One character labels for log brevity: E/W/I/D/T
  * -------------------------------------------------------------------------------------------------------------------*/
-static inline char LOG_LeveChar(LogLevel_t lvl)
+static inline char LOG_LevelChar(LogLevel_t lvl)
 {
-	switch(lvl)
-	{
-		case LOG_ERROR: return "E";
-		case LOG_WARN:	return "W";
-		case LOG_INFO:	return "I";
-		case LOG_DEBUG: return "D";
-		case LOG_TRACE: return "T";
-		case LOG_OFF:
-		default:		return "O";
-	}
+	return ((uint32_t)lvl < (uint32_t)LOG_LEVEL_COUNT) ? LOG_LevelChars[lvl] : 'O';
 }
 
+/* Old (misspelled) name, kept for existing callers */
+#define LOG_LeveChar(_lvl_)		LOG_LevelChar(_lvl_)
 
 #ifdef __cplusplus
 }
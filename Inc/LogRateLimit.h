@@ -0,0 +1,166 @@
+/* =====================================================================================================================
+ *  File        : LogRateLimit.h
+ *  Layer       : Shared
+ *  Purpose     : Per-tag token-bucket rate limiter for the UART log backend
+ *                 - One bucket per LogTag_t, burst and refill rate from LOG_TAG_REGISTRY (Burst/Rate columns),
+ *                   Burst 0 = tag not limited.
+ *                 - Hot path: one compare + one subtract, suppressed records are only counted.
+ *                 - While a bucket is suppressing, one summary "N records suppressed" is reported when it refills
+ *                   completely, or at most every LOG_RATE_LIMIT_SUMMARY_MS during a continuous storm.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Single context: call Allow/Refill from the logger main function (consumer of LogRing.h),
+ *                not from the producers, so no locking is needed.
+ * ===================================================================================================================*/
+
+#ifndef LOGRATELIMIT_H_
+#define LOGRATELIMIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_RATE_LIMIT_AR_MAJOR_VERSION		(1u)
+#define LOG_RATE_LIMIT_AR_MINOR_VERSION		(0u)
+#define LOG_RATE_LIMIT_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LogTags.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Credit unit
+ *  - One record costs LOG_RATE_LIMIT_UNIT credits, refill adds Rate credits per ms
+ *    (Rate records/s * 1 ms = Rate/1000 record), so no division is needed.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_RATE_LIMIT_UNIT		(1000u)
+
+#ifndef LOG_RATE_LIMIT_SUMMARY_MS
+#define LOG_RATE_LIMIT_SUMMARY_MS	(1000u)
+#endif
+
+/* Summary callback: tag has suppressed 'count' records since the bucket ran empty. */
+typedef void (*LogRateLimitReportFct_t)(LogTag_t tag, uint32_t count);
+
+typedef struct
+{
+	LogTagMask_t	Limited;					/* bit set = bucket empty, records are being suppressed.*/
+	uint32_t		LastTick;					/* ms tick of the last refill.*/
+	uint32_t		SummaryTick;				/* ms tick of the last periodic summary.*/
+	uint32_t		Credit[LOGTAG_COUNT];		/* Available credits (LOG_RATE_LIMIT_UNIT per record).*/
+	uint32_t		Suppressed[LOGTAG_COUNT];	/* Records suppressed since the bucket ran empty.*/
+}LogRateLimit_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Init: all buckets full.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_RateLimitInit(LogRateLimit_t* rl, uint32_t nowMs)
+{
+	uint8_t tag;
+
+	rl->Limited = LOG_TAG_MASK_NONE;
+	rl->LastTick = nowMs;
+	rl->SummaryTick = nowMs;
+	for (tag = 0u; tag < (uint8_t)LOGTAG_COUNT; tag++)
+	{
+		rl->Credit[tag] = (uint32_t)LOG_TagInfo[tag].Burst * LOG_RATE_LIMIT_UNIT;
+		rl->Suppressed[tag] = 0u;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Hot path: return true if one record of tag may be sent, false if it must be dropped (and is counted).
+ *  - A tag out of range is dropped without being counted.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool LOG_RateLimitAllow(LogRateLimit_t* rl, LogTag_t tag)
+{
+	if ((uint32_t)tag >= (uint32_t)LOGTAG_COUNT)
+	{
+		return false;
+	}
+	if (LOG_TagInfo[tag].Burst == 0u)
+	{
+		return true;
+	}
+
+	if (rl->Credit[tag] >= LOG_RATE_LIMIT_UNIT)
+	{
+		rl->Credit[tag] -= LOG_RATE_LIMIT_UNIT;
+		return true;
+	}
+
+	rl->Limited |= LOG_TAG_BIT(tag);
+	rl->Suppressed[tag]++;
+	return false;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Refill all buckets for the time elapsed since the last call (e.g. every logger main function cycle).
+ *  - A limited tag reports its suppressed count through report() when its bucket is full again (and is released),
+ *    or when LOG_RATE_LIMIT_SUMMARY_MS has passed; the summary record consumes one credit when available.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_RateLimitRefill(LogRateLimit_t* rl, uint32_t nowMs, LogRateLimitReportFct_t report)
+{
+	uint32_t elapsed = nowMs - rl->LastTick;
+	uint32_t credit;
+	uint32_t cap;
+	bool summaryDue;
+	bool full;
+	uint8_t tag;
+
+	if (elapsed == 0u)
+	{
+		return;
+	}
+	rl->LastTick = nowMs;
+
+	summaryDue = ((nowMs - rl->SummaryTick) >= LOG_RATE_LIMIT_SUMMARY_MS);
+	if (summaryDue)
+	{
+		rl->SummaryTick = nowMs;
+	}
+
+	for (tag = 0u; tag < (uint8_t)LOGTAG_COUNT; tag++)
+	{
+		cap = (uint32_t)LOG_TagInfo[tag].Burst * LOG_RATE_LIMIT_UNIT;
+		if (cap == 0u)
+		{
+			continue;		/* Not limited, never suppresses. */
+		}
+		/* Clamp elapsed so the product cannot overflow: Rate >= 1 refills cap credits within cap ms. */
+		credit = ((elapsed > cap) ? cap : elapsed) * (uint32_t)LOG_TagInfo[tag].Rate;
+		credit += rl->Credit[tag];
+		rl->Credit[tag] = (credit > cap) ? cap : credit;
+
+		if (!LOG_TAG_ENABLE(rl->Limited, tag))
+		{
+			continue;
+		}
+
+		full = (rl->Credit[tag] == cap);
+		if (full || (summaryDue && (rl->Suppressed[tag] != 0u)))
+		{
+			if (full)
+			{
+				rl->Limited &= ~LOG_TAG_BIT(tag);
+			}
+			if (rl->Credit[tag] >= LOG_RATE_LIMIT_UNIT)
+			{
+				rl->Credit[tag] -= LOG_RATE_LIMIT_UNIT;
+			}
+			if (report != (LogRateLimitReportFct_t)0)
+			{
+				report((LogTag_t)tag, rl->Suppressed[tag]);
+			}
+			rl->Suppressed[tag] = 0u;
+		}
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGRATELIMIT_H_ */
@@ -0,0 +1,224 @@
+/* =====================================================================================================================
+ *  File        : LogRing.h
+ *  Layer       : Shared
+ *  Purpose     : Lock-free multi-producer / single-consumer log ring buffer
+ *                 - Producers: ISRs (MCAL Can/Uart) and tasks at the same time, never block, never disable IRQ.
+ *                 - Consumer : Logger main function (one context only).
+ *                 - Fixed size, no allocation, dropped records are counted per LogTag_t when the ring is full.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Bounded sequence-slot queue: each slot carries a sequence number, a producer reserves a slot with
+ *                one compare-and-swap on Head (LDREX/STREX on Cortex-M3), fills it, then publishes it by writing the
+ *                slot sequence. A slow producer only delays the consumer, never another producer.
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef LOGRING_H_
+#define LOGRING_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+#include "LogTags.h"
+#include "LogToken.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_RING_AR_MAJOR_VERSION		(1u)
+#define LOG_RING_AR_MINOR_VERSION		(0u)
+#define LOG_RING_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Ring size
+ *  - LOG_RING_SIZE      : number of slots, must be a power of 2.
+ *  - LOG_RING_SLOT_SIZE : payload bytes per slot, default fits the biggest token record.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE			(32u)
+#endif
+
+#ifndef LOG_RING_SLOT_SIZE
+#define LOG_RING_SLOT_SIZE		(LOG_TOKEN_MAX_SIZE)
+#endif
+
+#define LOG_RING_MASK			(LOG_RING_SIZE - 1u)
+
+typedef char LOG_RingSizeCheck_t[((LOG_RING_SIZE & LOG_RING_MASK) == 0u) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Ring data
+ *  - Seq == pos           : slot is free for the producer that reserves position pos.
+ *  - Seq == pos + 1       : slot is published, consumer can read position pos.
+ *  - Seq == pos + SIZE    : slot consumed, free again for the next lap.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	atomic_uint_least32_t	Seq;
+	uint8_t					Len;
+	uint8_t					Data[LOG_RING_SLOT_SIZE];
+}LogRingSlot_t;
+
+typedef struct
+{
+	atomic_uint_least32_t	Head;						/* Next position to reserve (producers).*/
+	uint32_t				Tail;						/* Next position to read (consumer only).*/
+	atomic_uint_least32_t	Dropped[LOGTAG_COUNT];		/* Records lost because the ring was full.*/
+	LogRingSlot_t			Slot[LOG_RING_SIZE];
+}LogRing_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Init ring, must be called before any producer runs.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_RingInit(LogRing_t* ring)
+{
+	uint32_t i;
+
+	atomic_init(&ring->Head, 0u);
+	ring->Tail = 0u;
+	for (i = 0u; i < (uint32_t)LOGTAG_COUNT; i++)
+	{
+		atomic_init(&ring->Dropped[i], 0u);
+	}
+	for (i = 0u; i < LOG_RING_SIZE; i++)
+	{
+		atomic_init(&ring->Slot[i].Seq, i);
+		ring->Slot[i].Len = 0u;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Producer: copy one record into the ring (ISR and task safe, wait-free when no other producer races).
+ *  - return E_OK when queued, E_NOT_OK when the ring is full or len is 0 or > LOG_RING_SLOT_SIZE (counted in
+ *    Dropped[tag]).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType LOG_RingPush(LogRing_t* ring, LogTag_t tag, const uint8_t* data, uint8_t len)
+{
+	LogRingSlot_t* slot;
+	uint32_t pos;
+	uint32_t seq;
+	uint8_t i;
+
+	if ((len != 0u) && (len <= LOG_RING_SLOT_SIZE))
+	{
+		pos = atomic_load_explicit(&ring->Head, memory_order_relaxed);
+		for (;;)
+		{
+			slot = &ring->Slot[pos & LOG_RING_MASK];
+			seq = atomic_load_explicit(&slot->Seq, memory_order_acquire);
+
+			if (seq == pos)
+			{
+				/* Slot free: claim it, on failure pos is reloaded with the current Head. */
+				if (atomic_compare_exchange_weak_explicit(&ring->Head, &pos, pos + 1u,
+														  memory_order_relaxed, memory_order_relaxed))
+				{
+					for (i = 0u; i < len; i++)
+					{
+						slot->Data[i] = data[i];
+					}
+					slot->Len = len;
+					atomic_store_explicit(&slot->Seq, pos + 1u, memory_order_release);
+					return E_OK;
+				}
+			}
+			else if ((int32_t)(seq - pos) < 0)
+			{
+				/* Slot still holds the record of the previous lap: ring full. */
+				break;
+			}
+			else
+			{
+				/* Another producer took this position. */
+				pos = atomic_load_explicit(&ring->Head, memory_order_relaxed);
+			}
+		}
+	}
+
+	if ((uint32_t)tag < (uint32_t)LOGTAG_COUNT)
+	{
+		(void)atomic_fetch_add_explicit(&ring->Dropped[tag], 1u, memory_order_relaxed);
+	}
+	return E_NOT_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Consumer: pop the oldest published record.
+ *  - buf must hold LOG_RING_SLOT_SIZE bytes.
+ *  - return record length, 0 if nothing is published yet.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_RingPop(LogRing_t* ring, uint8_t* buf)
+{
+	LogRingSlot_t* slot = &ring->Slot[ring->Tail & LOG_RING_MASK];
+	uint8_t len;
+	uint8_t i;
+
+	if (atomic_load_explicit(&slot->Seq, memory_order_acquire) != (ring->Tail + 1u))
+	{
+		return 0u;
+	}
+
+	len = slot->Len;
+	for (i = 0u; i < len; i++)
+	{
+		buf[i] = slot->Data[i];
+	}
+
+	atomic_store_explicit(&slot->Seq, ring->Tail + LOG_RING_SIZE, memory_order_release);
+	ring->Tail++;
+
+	return len;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Consumer: pop as many whole records as fit into dst (space bytes), return bytes copied.
+ *  - A record that does not fit stays in the ring. Matches LogSource_t.Fill of LogUartDrain.h (ctx = ring) for a
+ *    raw token stream.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint16_t LOG_RingPopInto(void* ctx, uint8_t* dst, uint16_t space)
+{
+	LogRing_t* ring = (LogRing_t*)ctx;
+	uint16_t n = 0u;
+
+	for (;;)
+	{
+		LogRingSlot_t* slot = &ring->Slot[ring->Tail & LOG_RING_MASK];
+
+		if ((atomic_load_explicit(&slot->Seq, memory_order_acquire) != (ring->Tail + 1u)) ||
+			((uint16_t)(space - n) < slot->Len))
+		{
+			return n;
+		}
+		n = (uint16_t)(n + LOG_RingPop(ring, &dst[n]));
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Drop accounting
+ *  - LOG_RingTakeDropped: read and clear the counter of one tag (consumer side, e.g. to log "N dropped").
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint32_t LOG_RingGetDropped(LogRing_t* ring, LogTag_t tag)
+{
+	return atomic_load_explicit(&ring->Dropped[tag], memory_order_relaxed);
+}
+
+static inline uint32_t LOG_RingTakeDropped(LogRing_t* ring, LogTag_t tag)
+{
+	return atomic_exchange_explicit(&ring->Dropped[tag], 0u, memory_order_relaxed);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Hook token logger -> ring (put in the app config before including LogToken.h):
+ *  	extern LogRing_t Log_Ring;
+ *  	#define LOG_TOKEN_EMIT(_buf_, _len_)	\
+ *  		((void)LOG_RingPush(&Log_Ring, (LogTag_t)(_buf_)[0], (_buf_), (_len_)))
+ * -------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGRING_H_ */
@@ -1,7 +1,8 @@
 /* =====================================================================================================================
- *  File        : LogLevels.h
+ *  File        : LogTags.h
  *  Layer       : Shared
- *  Purpose     : Definition level of log for all system
+ *  Purpose     : Definition tag of log for all system
+ *                 - Single registry (LOG_TAG_REGISTRY) generates enum, string tables, default masks and metadata.
  *  Target MCU  : STM32F103C6T6
  *  Note        :
  * ===================================================================================================================*/
@@ -17,13 +18,27 @@ extern "C" {
  *  Macro for version
  * -------------------------------------------------------------------------------------------------------------------*/
 #define LOG_TAGS_AR_MAJOR_VERSION		(1u)
-#define LOG_TAGS_AR_MINOR_VERSION		(0u)
+#define LOG_TAGS_AR_MINOR_VERSION		(1u)
 #define LOG_TAGS_AR_PATCH_VERSION		(0u)
 
 #include <stdint.h>
+#include "LogLevels.h"
 
 /* ---------------------------------------------------------------------------------------------------------------------
-*   TAG List (enum) — arranged by layer for easy reading of logs
+*   Layer of a TAG
+* -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	LOG_LAYER_SYS = 0,
+	LOG_LAYER_MCAL,
+	LOG_LAYER_ECU,
+	LOG_LAYER_SRV,
+	LOG_LAYER_RTE,
+	LOG_LAYER_APP
+}LogLayer_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+*   TAG registry — arranged by layer for easy reading of logs
 *
 * 	Naming conventions:
 * 	- MCAL_* : MCAL level driver
@@ -33,55 +48,70 @@ extern "C" {
 * 	- APP_* : Application (SWC)
 * 	- SYS/BOOT : System/General Boot
 *
+* 	Columns:
+* 	- Id     : enum value.
+* 	- Name   : full string.
+* 	- Abbrev : fixed 5-character abbreviation (layer letter + '.' + 3 characters, padded with spaces).
+* 	- Layer  : LogLayer_t.
+* 	- Level  : compile-time threshold of the tag (see LogFilter.h).
+* 	- Mask   : 1 = part of LOG_TAG_MASK_DEFAULT.
+* 	- Burst  : rate limit, max records in a burst, 0 = not limited.
+* 	- Rate   : rate limit, sustained records per second.
+*
 * 	Note:
 * 	- The enum value is stable to be used as an index bit in the mask.
-* 	- If a new TAG is needed, add it to the end of the list (keep the old values ​​stable).
+* 	- If a new TAG is needed, add it to the end of the list (keep the old values stable).
 * -------------------------------------------------------------------------------------------------------------------*/
+/*	  Id							Name						Abbrev		Layer			Level				Mask	Burst	Rate */
+#define LOG_TAG_REGISTRY(X)																											\
+	/* System */																													\
+	X(LOGTAG_BOOT,					"BOOT",						"BOOT ",	LOG_LAYER_SYS,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	X(LOGTAG_SYS,					"SYS",						"SYS  ",	LOG_LAYER_SYS,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	/* MCAL */																														\
+	X(LOGTAG_MCAL_MCU,				"MCAL.MCU",					"M.MCU",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_PORT,				"MCAL.PORT",				"M.PRT",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_DIO,				"MCAL.DIO",					"M.DIO",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_GPT,				"MCAL.GPT",					"M.GPT",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_ICU,				"MCAL.ICU",					"M.ICU",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_ADC,				"MCAL.ADC",					"M.ADC",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_PWM,				"MCAL.PWM",					"M.PWM",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_MCAL_CAN,				"MCAL.CAN",					"M.CAN",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	1u,		32u,	20u)	\
+	X(LOGTAG_MCAL_UART,				"MCAL.UART",				"M.UAR",	LOG_LAYER_MCAL,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	/* ECU Abstraction */																											\
+	X(LOGTAG_ECU_PORTIF,			"ECU.PortIf",				"E.PRT",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_ECU_SENSORIF,			"ECU.SensorIf",				"E.SNS",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_ECU_ADCIF,				"ECU.AdcIf",				"E.ADC",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_ECU_PWMIF,				"ECU.PwmIf",				"E.PWM",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_ECU_MOTORIF,			"ECU.MotorIf",				"E.MOT",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	0u,		8u,		5u)		\
+	X(LOGTAG_ECU_CANIF,				"ECU.CanIf",				"E.CIF",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	1u,		32u,	20u)	\
+	X(LOGTAG_ECU_UARTIF,			"ECU.UartIf",				"E.UIF",	LOG_LAYER_ECU,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	/* Services */																													\
+	X(LOGTAG_SRV_ECUM,				"SRV.ECUM",					"S.ECM",	LOG_LAYER_SRV,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	X(LOGTAG_SRV_PDUR,				"SRV.Pdur",					"S.PDR",	LOG_LAYER_SRV,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	X(LOGTAG_SRV_COM,				"SRV.Com",					"S.COM",	LOG_LAYER_SRV,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	X(LOGTAG_SRV_DET,				"SRV.Det",					"S.DET",	LOG_LAYER_SRV,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	X(LOGTAG_SRV_LOGGER,			"SRV.Logger",				"S.LOG",	LOG_LAYER_SRV,	LOG_LEVEL_DEFAULT,	1u,		16u,	10u)	\
+	/* RTE */																														\
+	X(LOGTAG_RTE,					"RTE",						"RTE  ",	LOG_LAYER_RTE,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	/* Application SWCs */																											\
+	X(LOGTAG_APP_SENSORSUPERVISOR,	"APP.SensorSupervisor",		"A.SSV",	LOG_LAYER_APP,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	X(LOGTAG_APP_OBSTACLEDETECTION,	"APP.ObstacleDetection",	"A.OBS",	LOG_LAYER_APP,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	X(LOGTAG_APP_PEDALREADER,		"APP.PedalReader",			"A.PDL",	LOG_LAYER_APP,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)	\
+	X(LOGTAG_APP_MOTORCONTROL,		"APP.MotorControl",			"A.MOT",	LOG_LAYER_APP,	LOG_LEVEL_DEFAULT,	0u,		16u,	10u)
+
+#define LOG_TAG_ABBREV_LEN		(5u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+*   TAG List (enum), generated from the registry
+* -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_TAG_ENUM_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	_id_,
 typedef enum
 {
-	/* System */
-	LOGTAG_BOOT = 0,
-	LOGTAG_SYS,
-
-	/* MCAL */
-	LOGTAG_MCAL_MCU,
-	LOGTAG_MCAL_PORT,
-	LOGTAG_MCAL_DIO,
-	LOGTAG_MCAL_GPT,
-	LOGTAG_MCAL_ICU,
-	LOGTAG_MCAL_ADC,
-	LOGTAG_MCAL_PWM,
-	LOGTAG_MCAL_CAN,
-	LOGTAG_MCAL_UART,
-
-	/* ECU Abstraction */
-	LOGTAG_ECU_PORTIF,
-	LOGTAG_ECU_SENSORIF,
-	LOGTAG_ECU_ADCIF,
-	LOGTAG_ECU_PWMIF,
-	LOGTAG_ECU_MOTORIF,
-	LOGTAG_ECU_CANIF,
-	LOGTAG_ECU_UARTIF,
-
-	/* Services */
-	LOGTAG_SRV_ECUM,
-	LOGTAG_SRV_PDUR,
-	LOGTAG_SRV_COM,
-	LOGTAG_SRV_DET,
-	LOGTAG_SRV_LOGGER,
-
-	/* RTE */
-	LOGTAG_RTE,
-
-	/* Application SWCs */
-	LOGTAG_APP_SENSORSUPERVISOR,
-	LOGTAG_APP_OBSTACLEDETECTION,
-	LOGTAG_APP_PEDALREADER,
-	LOGTAG_APP_MOTORCONTROL,
-
+	LOG_TAG_REGISTRY(LOG_TAG_ENUM_ENTRY)
 
 	LOGTAG_COUNT 		// count Tag, always end of this enum
 }LogTag_t;
+#undef LOG_TAG_ENUM_ENTRY
 
 /* ---------------------------------------------------------------------------------------------------------------------
 *   Bitmask filter TAG
@@ -91,24 +121,70 @@ typedef uint64_t LogTagMask_t;
 #define LOG_TAG_MASK_NONE		((LogTagMask_t)0ULL)
 #define LOG_TAG_MASK_ALL		(~(LogTagMask_t)0ULL)
 
-/* Default: enable important TAG + some driver */
+typedef char LOG_TagCountCheck_t[((uint32_t)LOGTAG_COUNT <= 64u) ? 1 : -1];
+
+/* Default: enable important TAG + some driver (Mask column of the registry) */
+#define LOG_TAG_MASK_DEFAULT_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| (((_mask_) != 0u) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+
 #ifndef LOG_TAG_MASK_DEFAULT
-#define LOG_TAG_MASK_DEFAULT (      \
-      LOG_TAG_BIT(LOGTAG_BOOT)      \
-    | LOG_TAG_BIT(LOGTAG_SYS)       \
-    | LOG_TAG_BIT(LOGTAG_SRV_ECUM)  \
-    | LOG_TAG_BIT(LOGTAG_SRV_DET)   \
-    | LOG_TAG_BIT(LOGTAG_SRV_LOGGER)\
-    | LOG_TAG_BIT(LOGTAG_MCAL_CAN)  \
-    | LOG_TAG_BIT(LOGTAG_MCAL_UART) \
-    | LOG_TAG_BIT(LOGTAG_ECU_CANIF) \
-    | LOG_TAG_BIT(LOGTAG_ECU_UARTIF)\
-)
+#define LOG_TAG_MASK_DEFAULT	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_MASK_DEFAULT_ENTRY) )
 #endif
 
 /*Macro checks if TAG is enabled according to current mask*/
 #define LOG_TAG_ENABLE(_mask_,_tag_)	( ((LogTagMask_t)(_mask_) & LOG_TAG_BIT(_tag_)) != 0ULL )
 
+/* ---------------------------------------------------------------------------------------------------------------------
+*   Registry level per log level: mask of tags whose Level column >= level (used by LogFilter.h)
+* -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_TAG_REG_ERROR_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| ((LOG_ERROR <= (_lvl_)) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+#define LOG_TAG_REG_WARN_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| ((LOG_WARN <= (_lvl_)) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+#define LOG_TAG_REG_INFO_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| ((LOG_INFO <= (_lvl_)) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+#define LOG_TAG_REG_DEBUG_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| ((LOG_DEBUG <= (_lvl_)) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+#define LOG_TAG_REG_TRACE_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	| ((LOG_TRACE <= (_lvl_)) ? LOG_TAG_BIT(_id_) : LOG_TAG_MASK_NONE)
+
+#define LOG_TAG_MASK_REG_ERROR	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_REG_ERROR_ENTRY) )
+#define LOG_TAG_MASK_REG_WARN	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_REG_WARN_ENTRY) )
+#define LOG_TAG_MASK_REG_INFO	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_REG_INFO_ENTRY) )
+#define LOG_TAG_MASK_REG_DEBUG	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_REG_DEBUG_ENTRY) )
+#define LOG_TAG_MASK_REG_TRACE	( LOG_TAG_MASK_NONE LOG_TAG_REGISTRY(LOG_TAG_REG_TRACE_ENTRY) )
+
+/* ---------------------------------------------------------------------------------------------------------------------
+*   Per-tag metadata table, indexed by LogTag_t
+* -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	const char*		Name;		/* Full string. */
+	const char*		Abbrev;		/* Fixed LOG_TAG_ABBREV_LEN characters. */
+	uint8_t			Layer;		/* LogLayer_t. */
+	uint8_t			Level;		/* LogLevel_t, compile-time threshold. */
+	uint8_t			Burst;		/* Rate limit: bucket size (records). */
+	uint8_t			Rate;		/* Rate limit: refill (records per second). */
+}LogTagInfo_t;
+
+#define LOG_TAG_INFO_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	{ (_name_), (_abbr_), (uint8_t)(_layer_), (uint8_t)(_lvl_), (uint8_t)(_burst_), (uint8_t)(_rate_) },
+
+static const LogTagInfo_t LOG_TagInfo[] =
+{
+	LOG_TAG_REGISTRY(LOG_TAG_INFO_ENTRY)
+};
+
+/* Static check: one entry per tag, every abbreviation exactly LOG_TAG_ABBREV_LEN characters */
+typedef char LOG_TagInfoSizeCheck_t[((sizeof(LOG_TagInfo) / sizeof(LOG_TagInfo[0])) == (uint32_t)LOGTAG_COUNT) ? 1 : -1];
+
+#define LOG_TAG_ABBREV_CHECK_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	\
+	char _id_##_Abbrev[(sizeof(_abbr_) == (LOG_TAG_ABBREV_LEN + 1u)) ? 1 : -1];
+typedef struct
+{
+	LOG_TAG_REGISTRY(LOG_TAG_ABBREV_CHECK_ENTRY)
+}LOG_TagAbbrevCheck_t;
+
 /* ---------------------------------------------------------------------------------------------------------------------
 *   Helper: ECU Role -> string
 *   	- put in compile defines of app.
@@ -119,7 +195,8 @@ typedef uint64_t LogTagMask_t;
 
 #define ECU_SENSOR	1
 #define ECU_MOTOR	2
-#define ECU_UNKNOW	0
+#define ECU_UNKNOWN	0
+#define ECU_UNKNOW	ECU_UNKNOWN		/* Old (misspelled) name, kept for existing projects */
 
 static inline const char* LOG_EcuRoleString(void)
 {
@@ -132,95 +209,39 @@ static inline const char* LOG_EcuRoleString(void)
 #endif
 }
 
-/* ---------------------------------------------------------------------------------------------------------------------
-*   Helper: TAG -> full string
-* -------------------------------------------------------------------------------------------------------------------*/
-static inline const char* LOG_TagToString(LogTag_t tag)
+/* Role id (e.g. read back from a capture header) -> string */
+static inline const char* LOG_EcuRoleIdString(uint8_t role)
 {
-	switch(tag)
+	switch(role)
 	{
-		case LOGTAG_BOOT:					return "BOOT";
-		case LOGTAG_SYS:					return "SYS";
-
-		case LOGTAG_MCAL_MCU:				return "MCAL.MCU";
-		case LOGTAG_MCAL_PORT:				return "MCAL.PORT";
-		case LOGTAG_MCAL_DIO: 				return "MCAL.DIO";
-		case LOGTAG_MCAL_GPT:				return "MCAL.GPT";
-		case LOGTAG_MCAL_ICU:				return "MCAL.ICU";
-		case LOGTAG_MCAL_ADC:				return "MCAL.ADC";
-		case LOGTAG_MCAL_PWM:				return "MCAL.PWM";
-		case LOGTAG_MCAL_CAN:				return "MCAL.CAN";
-		case LOGTAG_MCAL_UART:				return "MCAL.UART";
-
-		case LOGTAG_ECU_PORTIF:				return "ECU.PortIf";
-		case LOGTAG_ECU_SENSORIF:			return "ECU.SensorIf";
-		case LOGTAG_ECU_ADCIF:				return "ECU.AdcIf";
-		case LOGTAG_ECU_PWMIF:				return "ECU.PwmIf";
-		case LOGTAG_ECU_MOTORIF:			return "ECU.MotorIf";
-		case LOGTAG_ECU_CANIF:				return "ECU.CanIf";
-		case LOGTAG_ECU_UARTIF:				return "ECU.UartIf";
-
-		case LOGTAG_SRV_ECUM:				return "SRV.ECUM";
-		case LOGTAG_SRV_PDUR:				return "SRV.Pdur";
-		case LOGTAG_SRV_COM:				return "SRV.Com";
-		case LOGTAG_SRV_DET:				return "SRV.Det";
-		case LOGTAG_SRV_LOGGER:				return "SRV.Logger";
-
-		case LOGTAG_RTE:					return "RTE";
-
-		case LOGTAG_APP_SENSORSUPERVISOR:	return "APP.SensorSupervisor";
-		case LOGTAG_APP_OBSTACLEDETECTION:	return "APP.ObstacleDetection";
-		case LOGTAG_APP_PEDALREADER:		return "APP.PedalReader";
-		case LOGTAG_APP_MOTORCONTROL:		return "APP.MotorControl";
-
-		default:							return "UNKNOWN";
+		case ECU_SENSOR:	return "SENSOR";
+		case ECU_MOTOR:		return "MOTOR";
+		default:			return "UNKNOWN";
 	}
 }
 
 /* ---------------------------------------------------------------------------------------------------------------------
-*   Helper: TAG -> 3-4 character abbreviation
+*   Helper: TAG -> full string, O(1) indexed lookup
 * -------------------------------------------------------------------------------------------------------------------*/
+static inline const char* LOG_TagToString(LogTag_t tag)
+{
+	return ((uint32_t)tag < (uint32_t)LOGTAG_COUNT) ? LOG_TagInfo[tag].Name : "UNKNOWN";
+}
 
+/* ---------------------------------------------------------------------------------------------------------------------
+*   Helper: TAG -> fixed 5-character abbreviation, O(1) indexed lookup
+* -------------------------------------------------------------------------------------------------------------------*/
 static inline const char* LOG_TagAbbrev(LogTag_t tag)
 {
-	switch(tag)
-	{
-		case LOGTAG_BOOT:					return "BOOT";
-		case LOGTAG_SYS:					return "SYS";
-
-		case LOGTAG_MCAL_MCU:				return "M.MCU";
-		case LOGTAG_MCAL_PORT:				return "M.PRT";
-		case LOGTAG_MCAL_DIO: 				return "M.DIO";
-		case LOGTAG_MCAL_GPT:				return "M.GPT";
-		case LOGTAG_MCAL_ICU:				return "M.ICU";
-		case LOGTAG_MCAL_ADC:				return "M.ADC";
-		case LOGTAG_MCAL_PWM:				return "M.PWM";
-		case LOGTAG_MCAL_CAN:				return "M.CAN";
-		case LOGTAG_MCAL_UART:				return "M.UAR";
-
-		case LOGTAG_ECU_PORTIF:				return "E.PRT";
-		case LOGTAG_ECU_SENSORIF:			return "E.SNS";
-		case LOGTAG_ECU_ADCIF:				return "E.ADC";
-		case LOGTAG_ECU_PWMIF:				return "E.PWM";
-		case LOGTAG_ECU_MOTORIF:			return "E.MOT";
-		case LOGTAG_ECU_CANIF:				return "E.CIF";
-		case LOGTAG_ECU_UARTIF:				return "E.UIF";
-
-		case LOGTAG_SRV_ECUM:				return "SRV.ECUM";
-		case LOGTAG_SRV_PDUR:				return "SRV.Pdur";
-		case LOGTAG_SRV_COM:				return "SRV.Com";
-		case LOGTAG_SRV_DET:				return "SRV.Det";
-		case LOGTAG_SRV_LOGGER:				return "SRV.Logger";
-
-		case LOGTAG_RTE:					return "RTE";
-
-		case LOGTAG_APP_SENSORSUPERVISOR:	return "A.SSV";
-		case LOGTAG_APP_OBSTACLEDETECTION:	return "A.OBS";
-		case LOGTAG_APP_PEDALREADER:		return "A.PDL";
-		case LOGTAG_APP_MOTORCONTROL:		return "A.MOT";
-
-		default:							return "UNk";
-	}
+	return ((uint32_t)tag < (uint32_t)LOGTAG_COUNT) ? LOG_TagInfo[tag].Abbrev : "UNK  ";
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+*   Helper: TAG -> metadata, NULL if tag is out of range
+* -------------------------------------------------------------------------------------------------------------------*/
+static inline const LogTagInfo_t* LOG_TagGetInfo(LogTag_t tag)
+{
+	return ((uint32_t)tag < (uint32_t)LOGTAG_COUNT) ? &LOG_TagInfo[tag] : (const LogTagInfo_t*)0;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,268 @@
+/* =====================================================================================================================
+ *  File        : LogToken.h
+ *  Layer       : Shared
+ *  Purpose     : Tokenized (deferred formatting) binary log records
+ *                 - Call site emits tag, level, format-string ID, timestamp and raw 32-bit arguments.
+ *                 - No text is formatted on the MCU, format strings never land in target flash.
+ *                 - Host decoder rebuilds the text from the same format table (LOG_FMT_TABLE).
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Record layout (little-endian, 8 + 4 * argc bytes):
+ *                  [0]    Tag
+ *                  [1]    bit7..4 Level, bit3..0 argc
+ *                  [2..3] Format ID
+ *                  [4..7] Timestamp
+ *                  [8..]  argc * uint32 arguments
+ * ===================================================================================================================*/
+
+#ifndef LOGTOKEN_H_
+#define LOGTOKEN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_TOKEN_AR_MAJOR_VERSION		(1u)
+#define LOG_TOKEN_AR_MINOR_VERSION		(0u)
+#define LOG_TOKEN_AR_PATCH_VERSION		(0u)
+
+#include <stdint.h>
+#include "LogLevels.h"
+#include "LogTags.h"
+#include "LogFilter.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Record limits
+ *  - LOG_TOKEN_MAX_ARGS  : max number of 32-bit arguments per record (4 bits in header -> max 15).
+ *  - LOG_TOKEN_HDR_SIZE  : fixed header size in bytes.
+ *  - LOG_TOKEN_MAX_SIZE  : biggest record, use it to size buffers.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LOG_TOKEN_MAX_ARGS
+#define LOG_TOKEN_MAX_ARGS		(4u)
+#endif
+
+#define LOG_TOKEN_ARGS_LIMIT	(15u)			/* Argument count field of the header.*/
+#define LOG_TOKEN_HDR_SIZE		(8u)
+#define LOG_TOKEN_MAX_SIZE		(LOG_TOKEN_HDR_SIZE + (4u * LOG_TOKEN_MAX_ARGS))
+
+typedef char LOG_TokenArgsCheck_t[(LOG_TOKEN_MAX_ARGS <= LOG_TOKEN_ARGS_LIMIT) ? 1 : -1];
+
+typedef uint16_t LogFmtId_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Format string table
+ *  - The app defines LOG_FMT_TABLE(X) once (Preprocessor Defines or a config header included before this file):
+ *  	#define LOG_FMT_TABLE(X) \
+ *  		X(CAN_RX,	"rx id=0x%x dlc=%u")	\
+ *  		X(CAN_BUSOFF,	"bus-off cnt=%u")
+ *  - Target side gets only the enum LOG_FMT_<name>, host side (LOG_TOKEN_HOST_DECODER) also gets the strings.
+ *  - Arguments are always passed as 32-bit integers, so use %u/%d/%x in the format strings.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifdef LOG_FMT_TABLE
+
+#define LOG_FMT_ENUM_ENTRY(_name_, _fmt_)		LOG_FMT_##_name_,
+typedef enum
+{
+	LOG_FMT_TABLE(LOG_FMT_ENUM_ENTRY)
+	LOG_FMT_COUNT		// count format, always end of this enum
+}LogFmt_t;
+#undef LOG_FMT_ENUM_ENTRY
+
+#ifdef LOG_TOKEN_HOST_DECODER
+#define LOG_FMT_STRING_ENTRY(_name_, _fmt_)		_fmt_,
+static const char* const LOG_FmtStrings[LOG_FMT_COUNT] =
+{
+	LOG_FMT_TABLE(LOG_FMT_STRING_ENTRY)
+};
+#undef LOG_FMT_STRING_ENTRY
+#endif
+
+#endif /* LOG_FMT_TABLE */
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Decoded record
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	LogTag_t	Tag;
+	LogLevel_t	Level;
+	LogFmtId_t	FmtId;
+	uint32_t	Timestamp;
+	uint8_t		ArgCount;
+	uint32_t	Args[LOG_TOKEN_MAX_ARGS];
+}LogTokenRecord_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: encode one record into buf
+ *  - return number of bytes written, 0 if bufSize is too small or argc > LOG_TOKEN_MAX_ARGS.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t LOG_TokenEncode(uint8_t* buf, uint8_t bufSize, LogTag_t tag, LogLevel_t lvl, LogFmtId_t fmtId,
+									  uint32_t timestamp, const uint32_t* args, uint8_t argc)
+{
+	uint8_t size = (uint8_t)(LOG_TOKEN_HDR_SIZE + (4u * argc));
+	uint8_t pos;
+	uint8_t i;
+
+	if ((argc > LOG_TOKEN_MAX_ARGS) || (bufSize < size))
+	{
+		return 0u;
+	}
+
+	buf[0] = (uint8_t)tag;
+	buf[1] = (uint8_t)(((uint8_t)lvl << 4) | argc);
+	buf[2] = (uint8_t)(fmtId);
+	buf[3] = (uint8_t)(fmtId >> 8);
+	buf[4] = (uint8_t)(timestamp);
+	buf[5] = (uint8_t)(timestamp >> 8);
+	buf[6] = (uint8_t)(timestamp >> 16);
+	buf[7] = (uint8_t)(timestamp >> 24);
+
+	pos = LOG_TOKEN_HDR_SIZE;
+	for (i = 0u; i < argc; i++)
+	{
+		buf[pos++] = (uint8_t)(args[i]);
+		buf[pos++] = (uint8_t)(args[i] >> 8);
+		buf[pos++] = (uint8_t)(args[i] >> 16);
+		buf[pos++] = (uint8_t)(args[i] >> 24);
+	}
+
+	return size;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: decode one record from buf
+ *  - return number of bytes consumed, 0 if the record is truncated or malformed.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint16_t LOG_TokenDecode(const uint8_t* buf, uint16_t len, LogTokenRecord_t* rec)
+{
+	uint8_t argc;
+	uint16_t size;
+	uint16_t pos;
+	uint8_t i;
+
+	if (len < LOG_TOKEN_HDR_SIZE)
+	{
+		return 0u;
+	}
+
+	argc = (uint8_t)(buf[1] & 0x0Fu);
+	size = (uint16_t)(LOG_TOKEN_HDR_SIZE + (4u * argc));
+	if ((buf[0] >= (uint8_t)LOGTAG_COUNT) || ((buf[1] >> 4) > (uint8_t)LOG_TRACE) ||
+		(argc > LOG_TOKEN_MAX_ARGS) || (len < size))
+	{
+		return 0u;
+	}
+
+	rec->Tag		= (LogTag_t)buf[0];
+	rec->Level		= (LogLevel_t)(buf[1] >> 4);
+	rec->FmtId		= (LogFmtId_t)((uint16_t)buf[2] | ((uint16_t)buf[3] << 8));
+	rec->Timestamp	= (uint32_t)buf[4] | ((uint32_t)buf[5] << 8) | ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+	rec->ArgCount	= argc;
+
+	pos = LOG_TOKEN_HDR_SIZE;
+	for (i = 0u; i < argc; i++)
+	{
+		rec->Args[i] = (uint32_t)buf[pos] | ((uint32_t)buf[pos + 1u] << 8) |
+					   ((uint32_t)buf[pos + 2u] << 16) | ((uint32_t)buf[pos + 3u] << 24);
+		pos = (uint16_t)(pos + 4u);
+	}
+
+	return size;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper (host only): decoded record -> text "<ts> <L> <TAG>: <formatted message>"
+ *  - fmtTable/fmtCount: format string table, normally LOG_FmtStrings/LOG_FMT_COUNT.
+ *  - return the snprintf result.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifdef LOG_TOKEN_HOST_DECODER
+#include <stdio.h>
+
+static inline int LOG_TokenFormat(const LogTokenRecord_t* rec, const char* const* fmtTable, uint16_t fmtCount,
+								  char* out, size_t outSize)
+{
+	uint32_t a[LOG_TOKEN_ARGS_LIMIT] = {0u};
+	int n;
+	uint8_t i;
+
+	for (i = 0u; i < rec->ArgCount; i++)
+	{
+		a[i] = rec->Args[i];
+	}
+
+	n = snprintf(out, outSize, "%10lu %c %-12s: ", (unsigned long)rec->Timestamp,
+				 LOG_LevelChar(rec->Level), LOG_TagToString(rec->Tag));
+	if ((n < 0) || ((size_t)n >= outSize))
+	{
+		return n;
+	}
+
+	if (rec->FmtId >= fmtCount)
+	{
+		return n + snprintf(out + n, outSize - (size_t)n, "<unknown fmt %u>", (unsigned)rec->FmtId);
+	}
+
+	/* Every argument the header can carry, unused trailing ones are evaluated and ignored by snprintf. */
+	return n + snprintf(out + n, outSize - (size_t)n, fmtTable[rec->FmtId], a[0], a[1], a[2], a[3], a[4], a[5],
+						a[6], a[7], a[8], a[9], a[10], a[11], a[12], a[13], a[14]);
+}
+#endif /* LOG_TOKEN_HOST_DECODER */
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Hooks, to define in the app project (Preprocessor Defines) or in a config header included before this file
+ *  - LOG_TOKEN_TIMESTAMP()        : current timestamp (tick), uint32.
+ *  - LOG_TOKEN_EMIT(_buf_, _len_) : push one encoded record to the log backend.
+ *  - LOG_TOKEN_TAG_MASK           : runtime tag mask (LogTagMask_t expression).
+ *  - LOG_TOKEN_FILTER             : optional, pointer to the runtime LogFilter_t (per-tag level override).
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LOG_TOKEN_TIMESTAMP
+#define LOG_TOKEN_TIMESTAMP()			(0u)
+#endif
+
+#ifndef LOG_TOKEN_EMIT
+#define LOG_TOKEN_EMIT(_buf_, _len_)	((void)(_buf_), (void)(_len_))
+#endif
+
+#ifndef LOG_TOKEN_TAG_MASK
+#define LOG_TOKEN_TAG_MASK				LOG_TAG_MASK_DEFAULT
+#endif
+
+#ifdef LOG_TOKEN_FILTER
+#define LOG_TOKEN_LEVEL_ENABLE(_tag_, _lvl_)	LOG_FILTER_ENABLE(LOG_TOKEN_FILTER, _tag_, _lvl_)
+#else
+#define LOG_TOKEN_LEVEL_ENABLE(_tag_, _lvl_)	LOG_CT_ENABLE(_tag_, _lvl_)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro log call site
+ *  - LOG_TOKEN(tag, lvl, fmtId, args...): args are converted to uint32, max LOG_TOKEN_MAX_ARGS.
+ *  - e.g. LOG_TOKEN(LOGTAG_MCAL_CAN, LOG_DEBUG, LOG_FMT_CAN_RX, id, dlc);
+ *  - tag/lvl not compiled in (LogFilter.h) -> the whole call, arguments included, is removed.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#if (ENABLE_UART_LOG == 1)
+#define LOG_TOKEN(_tag_, _lvl_, ...)																			\
+	do {																										\
+		if (LOG_TOKEN_LEVEL_ENABLE(_tag_, _lvl_) && LOG_TAG_ENABLE(LOG_TOKEN_TAG_MASK, _tag_))						\
+		{																										\
+			const uint32_t _v_[] = { __VA_ARGS__ };																\
+			uint8_t _rec_[LOG_TOKEN_MAX_SIZE];																	\
+			uint8_t _len_ = LOG_TokenEncode(_rec_, (uint8_t)sizeof(_rec_), (_tag_), (_lvl_), (LogFmtId_t)_v_[0],	\
+											(uint32_t)LOG_TOKEN_TIMESTAMP(), &_v_[1],							\
+											(uint8_t)((sizeof(_v_) / sizeof(_v_[0])) - 1u));					\
+			if (_len_ != 0u)																					\
+			{																									\
+				LOG_TOKEN_EMIT(_rec_, _len_);																	\
+			}																									\
+		}																										\
+	} while (0)
+#else
+#define LOG_TOKEN(_tag_, _lvl_, ...)	((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGTOKEN_H_ */
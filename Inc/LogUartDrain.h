@@ -0,0 +1,273 @@
+/* =====================================================================================================================
+ *  File        : LogUartDrain.h
+ *  Layer       : Shared
+ *  Purpose     : Non-blocking double-buffered log drain for the UART backend
+ *                 - Records are batched into one chunk while the other chunk is in flight.
+ *                 - Whole chunks go to a pluggable transport (UART DMA, UART TX-empty ISR, host socket...).
+ *                 - The transport reports the end of a chunk with LOG_DrainTxComplete() (TX complete ISR).
+ *                 - Nothing ever waits for the UART: a full drain answers BUFREQ_E_BUSY.
+ *                 - Pull mode (LogSource_t attached): the TX complete ISR refills and starts the next chunk itself,
+ *                   the line stays busy as long as the source (e.g. LogRing.h) has records.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Push mode: Write/Flush from one context (logger main function), TxComplete from the transport ISR,
+ *                the next chunk starts on the next Write/Flush.
+ *                Pull mode: LOG_DrainPoll from the logger main function, TxComplete from the transport ISR, no
+ *                Write/Flush. The drain calls the source from one of them at a time. A TxComplete raised from
+ *                inside StartTx (synchronous transport, or a DMA that finishes before StartTx returns) only counts
+ *                a request, the outer call starts the next chunk: no recursion, stack use does not grow per chunk.
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef LOGUARTDRAIN_H_
+#define LOGUARTDRAIN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_UART_DRAIN_AR_MAJOR_VERSION		(1u)
+#define LOG_UART_DRAIN_AR_MINOR_VERSION		(0u)
+#define LOG_UART_DRAIN_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Chunk size
+ *  - LOG_DRAIN_CHUNK_SIZE     : bytes per buffer (RAM cost = 2 * LOG_DRAIN_CHUNK_SIZE).
+ *  - LOG_DRAIN_KICK_THRESHOLD : start a transfer as soon as the filling chunk holds this many bytes.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef LOG_DRAIN_CHUNK_SIZE
+#define LOG_DRAIN_CHUNK_SIZE		(128u)
+#endif
+
+#ifndef LOG_DRAIN_KICK_THRESHOLD
+#define LOG_DRAIN_KICK_THRESHOLD	(LOG_DRAIN_CHUNK_SIZE / 2u)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Transport interface
+ *  - StartTx: start an asynchronous transfer of len bytes, return E_OK if accepted.
+ *             data stays valid and untouched until LOG_DrainTxComplete() is called.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	Std_ReturnType	(*StartTx)(void* ctx, const uint8_t* data, uint16_t len);
+	void*			Ctx;
+}LogTransport_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Source interface (pull mode, optional)
+ *  - Fill: copy whole records into dst, at most space bytes, return bytes copied (0 = nothing pending).
+ *          A record that does not fit must stay in the source. LOG_RingPopInto() fits a raw token stream.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint16_t		(*Fill)(void* ctx, uint8_t* dst, uint16_t space);
+	void*			Ctx;
+}LogSource_t;
+
+typedef struct
+{
+	const LogTransport_t*	Transport;
+	const LogSource_t*		Source;							/* NULL_PTR = push mode.*/
+	atomic_bool				InFlight;						/* A chunk is owned by the transport (pull mode: or
+															   being filled from the source).*/
+	atomic_uint_least8_t	PumpReq;						/* Pull mode: refill requests, != 0 while one context
+															   runs LOG_DrainPump.*/
+	uint8_t					Fill;							/* Index of the chunk being filled.*/
+	uint16_t				Len[2];
+	uint8_t					Buf[2][LOG_DRAIN_CHUNK_SIZE];
+	uint32_t				TxChunks;						/* Statistics: chunks handed to the transport.*/
+	uint32_t				TxBytes;						/* Statistics: bytes handed to the transport.*/
+	uint32_t				TxErrors;						/* Statistics: StartTx refused.*/
+}LogDrain_t;
+
+static inline void LOG_DrainInit(LogDrain_t* drain, const LogTransport_t* transport)
+{
+	drain->Transport = transport;
+	drain->Source = (const LogSource_t*)NULL_PTR;
+	atomic_init(&drain->InFlight, false);
+	atomic_init(&drain->PumpReq, 0u);
+	drain->Fill = 0u;
+	drain->Len[0] = 0u;
+	drain->Len[1] = 0u;
+	drain->TxChunks = 0u;
+	drain->TxBytes = 0u;
+	drain->TxErrors = 0u;
+}
+
+/* Pull mode: records are taken from the source, call it before the first LOG_DrainPoll. */
+static inline void LOG_DrainAttachSource(LogDrain_t* drain, const LogSource_t* source)
+{
+	drain->Source = source;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper, caller holds InFlight: hand the filling chunk to the transport and swap buffers, or release InFlight when
+ *  the chunk is empty or StartTx refuses it (data kept, retried by the next flush / poll).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_DrainStart(LogDrain_t* drain)
+{
+	uint8_t idx = drain->Fill;
+	uint16_t len = drain->Len[idx];
+
+	if (len != 0u)
+	{
+		drain->Fill = (uint8_t)(idx ^ 1u);
+		drain->Len[drain->Fill] = 0u;
+
+		if (drain->Transport->StartTx(drain->Transport->Ctx, drain->Buf[idx], len) == E_OK)
+		{
+			drain->TxChunks++;
+			drain->TxBytes += len;
+			return;
+		}
+
+		drain->TxErrors++;
+		drain->Fill = idx;
+	}
+	atomic_store_explicit(&drain->InFlight, false, memory_order_release);
+}
+
+/* Helper, caller holds InFlight: top up the filling chunk from the source. */
+static inline void LOG_DrainPull(LogDrain_t* drain)
+{
+	uint8_t idx = drain->Fill;
+	uint16_t n = drain->Source->Fill(drain->Source->Ctx, &drain->Buf[idx][drain->Len[idx]],
+									 (uint16_t)(LOG_DRAIN_CHUNK_SIZE - drain->Len[idx]));
+
+	drain->Len[idx] = (uint16_t)(drain->Len[idx] + n);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper, pull mode, caller holds InFlight: refill and start the next chunk.
+ *  - Only the first of nested calls runs the loop, a call made while it runs (TxComplete from inside StartTx) only
+ *    counts one more request and returns; the loop then serves it once the current StartTx returned.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_DrainPump(LogDrain_t* drain)
+{
+	if (atomic_fetch_add_explicit(&drain->PumpReq, 1u, memory_order_acq_rel) != 0u)
+	{
+		return;
+	}
+	do
+	{
+		LOG_DrainPull(drain);
+		LOG_DrainStart(drain);
+	}
+	while (atomic_fetch_sub_explicit(&drain->PumpReq, 1u, memory_order_acq_rel) != 1u);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Flush: hand the filling chunk to the transport if the line is idle, swap buffers.
+ *  - Call it periodically (logger main function) so a partial chunk does not wait for more records.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_DrainFlush(LogDrain_t* drain)
+{
+	bool idle = false;
+
+	if ((drain->Len[drain->Fill] == 0u) ||
+		!atomic_compare_exchange_strong_explicit(&drain->InFlight, &idle, true,
+												 memory_order_acquire, memory_order_relaxed))
+	{
+		return;
+	}
+	LOG_DrainStart(drain);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Poll (pull mode, logger main function): start a transfer from the source when the line is idle.
+ *  - While chunks are in flight the TX complete ISR keeps the line busy, the poll only restarts it after the
+ *    source ran dry or StartTx refused a chunk.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_DrainPoll(LogDrain_t* drain)
+{
+	bool idle = false;
+
+	if (!atomic_compare_exchange_strong_explicit(&drain->InFlight, &idle, true,
+												 memory_order_acquire, memory_order_relaxed))
+	{
+		return;
+	}
+	LOG_DrainPump(drain);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Free space in the filling chunk (after an opportunistic flush when it is full).
+ *  - Use it before popping a record from LogRing.h, so a record that does not fit stays in the ring.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint16_t LOG_DrainFree(LogDrain_t* drain)
+{
+	if (drain->Len[drain->Fill] >= LOG_DRAIN_KICK_THRESHOLD)
+	{
+		LOG_DrainFlush(drain);
+	}
+	return (uint16_t)(LOG_DRAIN_CHUNK_SIZE - drain->Len[drain->Fill]);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Write one record, never blocks
+ *  - BUFREQ_OK     : copied (and a transfer started if the chunk reached LOG_DRAIN_KICK_THRESHOLD).
+ *  - BUFREQ_E_BUSY : both chunks busy, try again after the next TX complete.
+ *  - BUFREQ_E_OVFL : record bigger than LOG_DRAIN_CHUNK_SIZE.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline BufReq_ReturnType LOG_DrainWrite(LogDrain_t* drain, const uint8_t* data, uint16_t len)
+{
+	uint8_t* dst;
+	uint16_t i;
+
+	if (len > LOG_DRAIN_CHUNK_SIZE)
+	{
+		return BUFREQ_E_OVFL;
+	}
+
+	if ((uint16_t)(LOG_DRAIN_CHUNK_SIZE - drain->Len[drain->Fill]) < len)
+	{
+		LOG_DrainFlush(drain);
+		if ((uint16_t)(LOG_DRAIN_CHUNK_SIZE - drain->Len[drain->Fill]) < len)
+		{
+			return BUFREQ_E_BUSY;
+		}
+	}
+
+	dst = &drain->Buf[drain->Fill][drain->Len[drain->Fill]];
+	for (i = 0u; i < len; i++)
+	{
+		dst[i] = data[i];
+	}
+	drain->Len[drain->Fill] = (uint16_t)(drain->Len[drain->Fill] + len);
+
+	if (drain->Len[drain->Fill] >= LOG_DRAIN_KICK_THRESHOLD)
+	{
+		LOG_DrainFlush(drain);
+	}
+
+	return BUFREQ_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Transport callback (TX complete ISR): the chunk in flight is sent, its buffer is free again.
+ *  - Pull mode: InFlight stays held, the next chunk is filled from the source and started right away (by the
+ *    outer call when this one comes from inside StartTx).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void LOG_DrainTxComplete(LogDrain_t* drain)
+{
+	if (drain->Source == NULL_PTR)
+	{
+		atomic_store_explicit(&drain->InFlight, false, memory_order_release);
+		return;
+	}
+	LOG_DrainPump(drain);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGUARTDRAIN_H_ */
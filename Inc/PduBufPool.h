@@ -0,0 +1,311 @@
+/* =====================================================================================================================
+ *  File        : PduBufPool.h
+ *  Layer       : Shared
+ *  Purpose     : Fixed-block PDU buffer pool, shared by all communication modules
+ *                 - 4 size classes (CAN / CAN-FD like / small TP / full TP payload), block counts per class
+ *                   are configuration macros, storage is one static arena: no heap, no fragmentation.
+ *                 - One atomic free bitmap per class: alloc = clear lowest set bit (CAS), free = set bit.
+ *                   O(1), lock-free, usable from ISR and task context.
+ *                 - Hands out PduInfoType descriptors, answers with BufReq_ReturnType.
+ *                 - In-use count (from the bitmap) and high-water mark per class.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : At most 32 blocks per class (one bitmap word). A class with 0 blocks is skipped.
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef PDUBUFPOOL_H_
+#define PDUBUFPOOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define PDUBUF_AR_MAJOR_VERSION		(1u)
+#define PDUBUF_AR_MINOR_VERSION		(0u)
+#define PDUBUF_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Size classes
+ *  - PDUBUF_CLASSx_SIZE  : payload bytes of one block (class sizes must be increasing).
+ *  - PDUBUF_CLASSx_COUNT : number of blocks, 0..32.
+ *  Default RAM: 16 * 8 + 8 * 64 + 2 * 256 + 0 * 4096 = 1152 bytes of arena (+ ~40 bytes of state).
+ *  The 4095 byte class is off by default, enable it only on an ECU that must hold a full TP message.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef PDUBUF_CLASS0_SIZE
+#define PDUBUF_CLASS0_SIZE			(8u)
+#endif
+#ifndef PDUBUF_CLASS0_COUNT
+#define PDUBUF_CLASS0_COUNT			(16u)
+#endif
+
+#ifndef PDUBUF_CLASS1_SIZE
+#define PDUBUF_CLASS1_SIZE			(64u)
+#endif
+#ifndef PDUBUF_CLASS1_COUNT
+#define PDUBUF_CLASS1_COUNT			(8u)
+#endif
+
+#ifndef PDUBUF_CLASS2_SIZE
+#define PDUBUF_CLASS2_SIZE			(256u)
+#endif
+#ifndef PDUBUF_CLASS2_COUNT
+#define PDUBUF_CLASS2_COUNT			(2u)
+#endif
+
+#ifndef PDUBUF_CLASS3_SIZE
+#define PDUBUF_CLASS3_SIZE			(4095u)
+#endif
+#ifndef PDUBUF_CLASS3_COUNT
+#define PDUBUF_CLASS3_COUNT			(0u)
+#endif
+
+#define PDUBUF_CLASS_COUNT			(4u)
+#define PDUBUF_MAX_BLOCKS			(32u)
+
+/* Blocks are word aligned: stride = size rounded up to 4 bytes. */
+#define PDUBUF_STRIDE(_size_)		(((_size_) + 3u) & ~3u)
+#define PDUBUF_CLASS_BYTES(_c_)		(PDUBUF_CLASS##_c_##_COUNT * PDUBUF_STRIDE(PDUBUF_CLASS##_c_##_SIZE))
+
+#define PDUBUF_CLASS0_OFFSET		(0u)
+#define PDUBUF_CLASS1_OFFSET		(PDUBUF_CLASS0_OFFSET + PDUBUF_CLASS_BYTES(0))
+#define PDUBUF_CLASS2_OFFSET		(PDUBUF_CLASS1_OFFSET + PDUBUF_CLASS_BYTES(1))
+#define PDUBUF_CLASS3_OFFSET		(PDUBUF_CLASS2_OFFSET + PDUBUF_CLASS_BYTES(2))
+#define PDUBUF_ARENA_BYTES			(PDUBUF_CLASS3_OFFSET + PDUBUF_CLASS_BYTES(3))
+
+typedef char PduBuf_CountCheck_t[((PDUBUF_CLASS0_COUNT <= PDUBUF_MAX_BLOCKS) &&
+								  (PDUBUF_CLASS1_COUNT <= PDUBUF_MAX_BLOCKS) &&
+								  (PDUBUF_CLASS2_COUNT <= PDUBUF_MAX_BLOCKS) &&
+								  (PDUBUF_CLASS3_COUNT <= PDUBUF_MAX_BLOCKS)) ? 1 : -1];
+typedef char PduBuf_OrderCheck_t[((PDUBUF_CLASS0_SIZE < PDUBUF_CLASS1_SIZE) &&
+								  (PDUBUF_CLASS1_SIZE < PDUBUF_CLASS2_SIZE) &&
+								  (PDUBUF_CLASS2_SIZE < PDUBUF_CLASS3_SIZE) &&
+								  (PDUBUF_CLASS3_SIZE <= 0xFFFFu)) ? 1 : -1];
+typedef char PduBuf_ArenaCheck_t[(PDUBUF_ARENA_BYTES > 0u) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Class layout (constant)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	PduLengthType	Size;
+	uint16_t		Stride;
+	uint8_t			Count;
+	uint32_t		Offset;			/* Byte offset of the first block in the arena.*/
+}PduBuf_ClassType;
+
+static const PduBuf_ClassType PduBuf_Classes[PDUBUF_CLASS_COUNT] =
+{
+	{ PDUBUF_CLASS0_SIZE, PDUBUF_STRIDE(PDUBUF_CLASS0_SIZE), PDUBUF_CLASS0_COUNT, PDUBUF_CLASS0_OFFSET },
+	{ PDUBUF_CLASS1_SIZE, PDUBUF_STRIDE(PDUBUF_CLASS1_SIZE), PDUBUF_CLASS1_COUNT, PDUBUF_CLASS1_OFFSET },
+	{ PDUBUF_CLASS2_SIZE, PDUBUF_STRIDE(PDUBUF_CLASS2_SIZE), PDUBUF_CLASS2_COUNT, PDUBUF_CLASS2_OFFSET },
+	{ PDUBUF_CLASS3_SIZE, PDUBUF_STRIDE(PDUBUF_CLASS3_SIZE), PDUBUF_CLASS3_COUNT, PDUBUF_CLASS3_OFFSET },
+};
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Pool
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	atomic_uint_least32_t	Free[PDUBUF_CLASS_COUNT];		/* Bit i set = block i free.*/
+	atomic_uint_least8_t	HighWater[PDUBUF_CLASS_COUNT];
+	atomic_uint_least32_t	Failed;							/* Statistics: BUSY answers.*/
+	uint32_t				Arena[PDUBUF_ARENA_BYTES / 4u];
+}PduBuf_PoolType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  RAM usage report (bytes), usable in a static check or printed by the map file review
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define PDUBUF_RAM_BYTES			((uint32_t)sizeof(PduBuf_PoolType))
+
+typedef struct
+{
+	PduLengthType	Size;
+	uint8_t			Count;
+	uint8_t			InUse;
+	uint8_t			HighWater;
+}PduBuf_StatsType;
+
+static inline void PduBuf_Init(PduBuf_PoolType* pool)
+{
+	uint8_t c;
+
+	for (c = 0u; c < PDUBUF_CLASS_COUNT; c++)
+	{
+		uint8_t n = PduBuf_Classes[c].Count;
+		atomic_init(&pool->Free[c], (n >= 32u) ? 0xFFFFFFFFu : ((1u << n) - 1u));
+		atomic_init(&pool->HighWater[c], 0u);
+	}
+	atomic_init(&pool->Failed, 0u);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: index of the lowest set bit (bits != 0), branch free De Bruijn lookup
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t PduBuf_LowestBit(uint32_t bits)
+{
+	static const uint8_t PduBuf_DeBruijn[32] =
+	{
+		0u, 1u, 28u, 2u, 29u, 14u, 24u, 3u, 30u, 22u, 20u, 15u, 25u, 17u, 4u, 8u,
+		31u, 27u, 13u, 23u, 21u, 19u, 16u, 7u, 26u, 12u, 18u, 6u, 11u, 5u, 10u, 9u
+	};
+	return PduBuf_DeBruijn[((bits & (0u - bits)) * 0x077CB531u) >> 27];
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: number of set bits (SWAR)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t PduBuf_PopCount(uint32_t bits)
+{
+	bits = bits - ((bits >> 1) & 0x55555555u);
+	bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0Fu;
+	return (uint8_t)((bits * 0x01010101u) >> 24);
+}
+
+static inline uint8_t* PduBuf_Block(PduBuf_PoolType* pool, uint8_t c, uint8_t idx)
+{
+	return (uint8_t*)pool->Arena + PduBuf_Classes[c].Offset + ((uint32_t)idx * PduBuf_Classes[c].Stride);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Try to take one block of class c, return the block index or PDUBUF_MAX_BLOCKS if the class is empty
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline uint8_t PduBuf_TakeBlock(PduBuf_PoolType* pool, uint8_t c)
+{
+	uint32_t bits = atomic_load_explicit(&pool->Free[c], memory_order_relaxed);
+	uint_least8_t used;
+	uint_least8_t hw;
+	uint8_t idx;
+
+	do
+	{
+		if (bits == 0u)
+		{
+			return (uint8_t)PDUBUF_MAX_BLOCKS;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(&pool->Free[c], &bits, bits & (bits - 1u),
+													memory_order_acquire, memory_order_relaxed));
+	idx = PduBuf_LowestBit(bits);
+
+	/* Blocks in use right after our CAS, exact even under contention. */
+	used = (uint_least8_t)(PduBuf_Classes[c].Count - PduBuf_PopCount(bits & (bits - 1u)));
+	hw = atomic_load_explicit(&pool->HighWater[c], memory_order_relaxed);
+	while ((used > hw) &&
+		   !atomic_compare_exchange_weak_explicit(&pool->HighWater[c], &hw, used,
+												  memory_order_relaxed, memory_order_relaxed))
+	{
+	}
+
+	return idx;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Allocate a buffer of at least len bytes
+ *  - Smallest class that fits, falls back to the next bigger class when it is exhausted.
+ *  - BUFREQ_OK     : info->SduDataPtr = block, info->SduLength = len, info->MetaDataPtr = NULL.
+ *  - BUFREQ_E_BUSY : every class that could hold len is exhausted, try again later.
+ *  - BUFREQ_E_OVFL : len is bigger than the biggest configured class.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline BufReq_ReturnType PduBuf_Alloc(PduBuf_PoolType* pool, PduLengthType len, PduInfoType* info)
+{
+	bool fits = false;
+	uint8_t c;
+	uint8_t idx;
+
+	for (c = 0u; c < PDUBUF_CLASS_COUNT; c++)
+	{
+		if ((PduBuf_Classes[c].Count == 0u) || (len > PduBuf_Classes[c].Size))
+		{
+			continue;
+		}
+
+		fits = true;
+		idx = PduBuf_TakeBlock(pool, c);
+		if (idx < PDUBUF_MAX_BLOCKS)
+		{
+			info->SduDataPtr = PduBuf_Block(pool, c, idx);
+			info->SduLength = len;
+			info->MetaDataPtr = NULL;
+			return BUFREQ_OK;
+		}
+	}
+
+	if (!fits)
+	{
+		return BUFREQ_E_OVFL;
+	}
+	atomic_fetch_add_explicit(&pool->Failed, 1u, memory_order_relaxed);
+	return BUFREQ_E_BUSY;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Return a buffer to the pool (class and block found from the pointer)
+ *  - E_NOT_OK: pointer not from this pool, not a block start, or block already free (double free).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType PduBuf_Free(PduBuf_PoolType* pool, const PduInfoType* info)
+{
+	const uint8_t* base = (const uint8_t*)pool->Arena;
+	uint32_t off;
+	uint32_t bit;
+	uint8_t c;
+
+	if ((info == NULL) || (info->SduDataPtr < base) || (info->SduDataPtr >= (base + PDUBUF_ARENA_BYTES)))
+	{
+		return E_NOT_OK;
+	}
+	off = (uint32_t)(info->SduDataPtr - base);
+
+	for (c = PDUBUF_CLASS_COUNT - 1u; PduBuf_Classes[c].Offset > off; c--)
+	{
+	}
+	off -= PduBuf_Classes[c].Offset;
+	if ((off % PduBuf_Classes[c].Stride) != 0u)
+	{
+		return E_NOT_OK;
+	}
+
+	bit = 1ul << (off / PduBuf_Classes[c].Stride);
+	if ((atomic_fetch_or_explicit(&pool->Free[c], bit, memory_order_release) & bit) != 0u)
+	{
+		return E_NOT_OK;
+	}
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Statistics of one class (for the RAM review: shrink PDUBUF_CLASSx_COUNT down to the high-water mark + margin)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void PduBuf_GetStats(PduBuf_PoolType* pool, uint8_t c, PduBuf_StatsType* stats)
+{
+	stats->Size = PduBuf_Classes[c].Size;
+	stats->Count = PduBuf_Classes[c].Count;
+	stats->InUse = (uint8_t)(PduBuf_Classes[c].Count -
+							 PduBuf_PopCount(atomic_load_explicit(&pool->Free[c], memory_order_relaxed)));
+	stats->HighWater = atomic_load_explicit(&pool->HighWater[c], memory_order_relaxed);
+}
+
+static inline void PduBuf_ResetHighWater(PduBuf_PoolType* pool)
+{
+	uint8_t c;
+
+	for (c = 0u; c < PDUBUF_CLASS_COUNT; c++)
+	{
+		uint8_t used = (uint8_t)(PduBuf_Classes[c].Count -
+								 PduBuf_PopCount(atomic_load_explicit(&pool->Free[c], memory_order_relaxed)));
+		atomic_store_explicit(&pool->HighWater[c], used, memory_order_relaxed);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PDUBUFPOOL_H_ */
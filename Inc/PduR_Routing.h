@@ -0,0 +1,335 @@
+/* =====================================================================================================================
+ *  File        : PduR_Routing.h
+ *  Layer       : Services
+ *  Purpose     : Zero-copy table-driven PduR routing core
+ *                 - Constant routing table indexed directly by the source PduIdType (no search).
+ *                 - One source PDU fans out to N destinations (CanIf, UartIf, Com...) with the SAME PduInfoType:
+ *                   payload is never copied, destinations get a pointer to the routed descriptor.
+ *                 - The buffer is reference counted and released (PduBufPool.h) only after every destination
+ *                   confirmed (TX confirmation) or refused it.
+ *                 - Result per destination: PDUR_ROUTING_OK / PDUR_ROUTING_E_NOT_OK.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : One buffer in flight per routing path (like one I-PDU buffer per path in AUTOSAR PduR).
+ *                RxIndication from one context per path, TxConfirmation may come from any ISR.
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef PDUR_ROUTING_H_
+#define PDUR_ROUTING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+#include "PduBufPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define PDUR_ROUTING_AR_MAJOR_VERSION		(1u)
+#define PDUR_ROUTING_AR_MINOR_VERSION		(0u)
+#define PDUR_ROUTING_AR_PATCH_VERSION		(0u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capacity
+ *  - PDUR_MAX_PATHS : routing paths (source PduIds 0..PDUR_MAX_PATHS-1), RAM ~ 16 bytes per path.
+ *  - PDUR_MAX_DESTS : destinations of one path (<= 8, results are kept in one byte mask).
+ * -------------------------------------------------------------------------------------------------------------------*/
+#ifndef PDUR_MAX_PATHS
+#define PDUR_MAX_PATHS		(16u)
+#endif
+
+#ifndef PDUR_MAX_DESTS
+#define PDUR_MAX_DESTS		(4u)
+#endif
+
+typedef char PduR_DestsCheck_t[((PDUR_MAX_DESTS >= 1u) && (PDUR_MAX_DESTS <= 8u)) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Destination modules
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef enum
+{
+	PDUR_MODULE_CANIF = 0,
+	PDUR_MODULE_UARTIF,
+	PDUR_MODULE_COM,
+	PDUR_MODULE_COUNT
+}PduR_ModuleType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Module interface
+ *  - Transmit        : hand info to the module for destPduId, E_OK if accepted. info and its payload stay valid
+ *                      until the module calls PduR_TxConfirmation() for destPduId.
+ *  - ConfirmOnAccept : true for local consumers (Com RxIndication) that are done with the buffer when Transmit
+ *                      returns: no TxConfirmation is expected from them.
+ *  - TxConfRef       : reverse table indexed by destPduId -> routing path and destination slot, for the
+ *                      O(1) TxConfirmation. NULL/0 when ConfirmOnAccept.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	PduIdType		SrcPduId;
+	uint8_t			DestIdx;
+}PduR_DestRefType;
+
+typedef struct
+{
+	Std_ReturnType			(*Transmit)(PduIdType destPduId, const PduInfoType* info);
+	bool					ConfirmOnAccept;
+	const PduR_DestRefType*	TxConfRef;
+	PduIdType				TxConfRefCount;
+}PduR_ModuleApiType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Routing table (constant, generated with the configuration)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	PduR_ModuleType		Module;
+	PduIdType			DestPduId;
+}PduR_DestType;
+
+typedef struct
+{
+	const PduR_DestType*	Dest;
+	uint8_t					DestCount;
+}PduR_RoutingPathType;
+
+typedef struct
+{
+	const PduR_RoutingPathType*	Paths;				/* Indexed by source PduIdType.*/
+	PduIdType					PathCount;
+	const PduR_ModuleApiType*	Modules;			/* Indexed by PduR_ModuleType.*/
+	PduBuf_PoolType*			Pool;				/* Owner of routed buffers, NULL: caller keeps ownership.*/
+}PduR_ConfigType;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Runtime state
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	PduInfoType				Info;				/* Descriptor handed to every destination.*/
+	atomic_uint_least8_t	Refs;				/* 0 = path idle, else destinations + fan-out + 1 until released.*/
+	atomic_uint_least8_t	Pending;			/* Bit d set = destination d accepted, TxConfirmation expected.*/
+	atomic_uint_least8_t	Failed;				/* Bit d set = destination d refused or confirmed NOT_OK.*/
+	uint8_t					LastFailed;			/* Failed mask of the last completed routing.*/
+}PduR_PathStateType;
+
+typedef struct
+{
+	const PduR_ConfigType*	Config;
+	PduR_PathStateType		Path[PDUR_MAX_PATHS];
+	uint32_t				Routed;				/* Statistics: PDUs accepted by at least one destination.*/
+	uint32_t				Dropped;			/* Statistics: PDUs refused (path busy or no destination).*/
+}PduR_Type;
+
+static inline Std_ReturnType PduR_Init(PduR_Type* pdur, const PduR_ConfigType* config)
+{
+	PduIdType i;
+
+	if (config->PathCount > PDUR_MAX_PATHS)
+	{
+		return E_NOT_OK;
+	}
+	for (i = 0u; i < config->PathCount; i++)
+	{
+		if (config->Paths[i].DestCount > PDUR_MAX_DESTS)
+		{
+			return E_NOT_OK;
+		}
+	}
+
+	pdur->Config = config;
+	for (i = 0u; i < PDUR_MAX_PATHS; i++)
+	{
+		atomic_init(&pdur->Path[i].Refs, 0u);
+		atomic_init(&pdur->Path[i].Pending, 0u);
+		atomic_init(&pdur->Path[i].Failed, 0u);
+		pdur->Path[i].LastFailed = 0u;
+	}
+	pdur->Routed = 0u;
+	pdur->Dropped = 0u;
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Helper: drop one reference, release the buffer with the last one
+ *  - Refs keeps one extra count that only the last reference drops (2 -> 1, then 1 -> 0 after PduBuf_Free): the
+ *    path stays busy until Info and Failed are used, a preempting RxIndication cannot overwrite them before.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void PduR_ReleaseRef(PduR_Type* pdur, PduR_PathStateType* path)
+{
+	if (atomic_fetch_sub_explicit(&path->Refs, 1u, memory_order_acq_rel) == 2u)
+	{
+		path->LastFailed = atomic_load_explicit(&path->Failed, memory_order_relaxed);
+		if (pdur->Config->Pool != NULL)
+		{
+			(void)PduBuf_Free(pdur->Config->Pool, &path->Info);
+		}
+		atomic_store_explicit(&path->Refs, 0u, memory_order_release);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Route one received PDU to every destination of srcPduId
+ *  - Ownership of info's buffer passes to PduR (released to Config->Pool when all destinations are done).
+ *  - results (optional, DestCount entries): per destination result of the hand-over.
+ *  - E_OK if at least one destination accepted the PDU.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline Std_ReturnType PduR_RxIndication(PduR_Type* pdur, PduIdType srcPduId, const PduInfoType* info,
+											   PduR_RoutingResultType* results)
+{
+	const PduR_ConfigType* cfg = pdur->Config;
+	const PduR_RoutingPathType* route;
+	PduR_PathStateType* path;
+	uint8_t failed = 0u;
+	uint8_t d;
+
+	if ((srcPduId >= cfg->PathCount) || (info == NULL))
+	{
+		return E_NOT_OK;
+	}
+	route = &cfg->Paths[srcPduId];
+	path = &pdur->Path[srcPduId];
+
+	if ((route->DestCount == 0u) || (atomic_load_explicit(&path->Refs, memory_order_acquire) != 0u))
+	{
+		/* Previous PDU of this path still in flight: refuse, release the new buffer. */
+		for (d = 0u; (results != NULL) && (d < route->DestCount); d++)
+		{
+			results[d] = PDUR_ROUTING_E_NOT_OK;
+		}
+		if (cfg->Pool != NULL)
+		{
+			(void)PduBuf_Free(cfg->Pool, info);
+		}
+		pdur->Dropped++;
+		return E_NOT_OK;
+	}
+
+	path->Info = *info;
+	atomic_store_explicit(&path->Failed, 0u, memory_order_relaxed);
+	atomic_store_explicit(&path->Pending, 0u, memory_order_relaxed);
+	/* One reference per destination plus one held during the fan-out, so a synchronous confirmation
+	 * cannot release the buffer before the last destination got it, plus the one that keeps the path busy
+	 * until the buffer is released (PduR_ReleaseRef). */
+	atomic_store_explicit(&path->Refs, (uint_least8_t)(route->DestCount + 2u), memory_order_release);
+
+	for (d = 0u; d < route->DestCount; d++)
+	{
+		const PduR_DestType* dest = &route->Dest[d];
+		const PduR_ModuleApiType* api = &cfg->Modules[dest->Module];
+		uint_least8_t bit = (uint_least8_t)(1u << d);
+		bool accepted;
+
+		/* Armed before Transmit: the confirmation may come from inside Transmit. */
+		if (!api->ConfirmOnAccept)
+		{
+			atomic_fetch_or_explicit(&path->Pending, bit, memory_order_acq_rel);
+		}
+		accepted = (api->Transmit(dest->DestPduId, &path->Info) == E_OK);
+
+		if (!accepted)
+		{
+			failed |= bit;
+			atomic_fetch_or_explicit(&path->Failed, bit, memory_order_relaxed);
+		}
+		if (results != NULL)
+		{
+			results[d] = accepted ? PDUR_ROUTING_OK : PDUR_ROUTING_E_NOT_OK;
+		}
+		if (api->ConfirmOnAccept)
+		{
+			PduR_ReleaseRef(pdur, path);
+		}
+		else if (!accepted &&
+				 ((atomic_fetch_and_explicit(&path->Pending, (uint_least8_t)~bit, memory_order_acq_rel) & bit) != 0u))
+		{
+			/* Refused: its reference is dropped here, an accepted one is dropped by its TxConfirmation. */
+			PduR_ReleaseRef(pdur, path);
+		}
+	}
+
+	if (failed == (uint8_t)((1u << route->DestCount) - 1u))
+	{
+		pdur->Dropped++;
+		PduR_ReleaseRef(pdur, path);
+		return E_NOT_OK;
+	}
+
+	pdur->Routed++;
+	PduR_ReleaseRef(pdur, path);
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  TX confirmation from a destination module (CanIf/UartIf TX complete), O(1) through TxConfRef
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline void PduR_TxConfirmation(PduR_Type* pdur, PduR_ModuleType module, PduIdType destPduId,
+									   Std_ReturnType result)
+{
+	const PduR_ModuleApiType* api = &pdur->Config->Modules[module];
+	const PduR_DestRefType* ref;
+	PduR_PathStateType* path;
+	uint_least8_t bit;
+
+	if ((api->TxConfRef == NULL) || (destPduId >= api->TxConfRefCount))
+	{
+		return;
+	}
+	ref = &api->TxConfRef[destPduId];
+	if (ref->SrcPduId >= pdur->Config->PathCount)
+	{
+		return;
+	}
+	if (ref->DestIdx >= PDUR_MAX_DESTS)
+	{
+		return;
+	}
+	path = &pdur->Path[ref->SrcPduId];
+	bit = (uint_least8_t)(1u << ref->DestIdx);
+
+	/* Only a destination still holding its reference may drop it: a duplicate confirmation, one from a
+	 * destination that refused the PDU or a late one from an earlier routing finds its bit clear. */
+	if ((atomic_fetch_and_explicit(&path->Pending, (uint_least8_t)~bit, memory_order_acq_rel) & bit) == 0u)
+	{
+		return;
+	}
+	if (result != E_OK)
+	{
+		atomic_fetch_or_explicit(&path->Failed, bit, memory_order_relaxed);
+	}
+	PduR_ReleaseRef(pdur, path);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Status of a routing path
+ *  - Returns true while the buffer of srcPduId is still in flight.
+ *  - failedMask (optional): destinations that failed in the last completed routing.
+ *  - false for an unknown srcPduId (failedMask untouched).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static inline bool PduR_IsPathBusy(const PduR_Type* pdur, PduIdType srcPduId, uint8_t* failedMask)
+{
+	const PduR_PathStateType* path;
+
+	if (srcPduId >= pdur->Config->PathCount)
+	{
+		return false;
+	}
+
+	path = &pdur->Path[srcPduId];
+	if (failedMask != NULL)
+	{
+		*failedMask = path->LastFailed;
+	}
+	return (atomic_load_explicit(&path->Refs, memory_order_acquire) != 0u);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PDUR_ROUTING_H_ */
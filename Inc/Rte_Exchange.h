@@ -0,0 +1,237 @@
+/* =====================================================================================================================
+ *  File        : Rte_Exchange.h
+ *  Layer       : RTE
+ *  Purpose     : Lock-free data exchange between ISRs and tasks (no interrupt locking, no jitter on CAN RX ISRs)
+ *                 - Sequence lock: one writer, any number of readers, value copied word by word. For small values
+ *                   written from an ISR (or a higher priority task) and read from tasks.
+ *                 - Triple buffer: one writer, one reader, never blocks or retries on either side. For larger
+ *                   structs, and for any priority order between writer and reader.
+ *                 - Freshness: every write increments a version (1 = first write), readers get the version of the
+ *                   value they read and compare it with the last one they saw.
+ *  Target MCU  : STM32F103C6T6
+ *  Note        : Sequence lock readers retry while a write is in progress. A reader that preempts the writer
+ *                (reader ISR, writer task) could never see the write finish: after RTE_SEQLOCK_RETRIES it gets
+ *                E_NOT_OK, use a triple buffer for that direction.
+ *                Buffers are owned by the caller (static RAM), sizes in bytes.
+ *                Uses C11 <stdatomic.h>: from C++ it needs C++23 (<stdatomic.h> compatibility header).
+ * ===================================================================================================================*/
+
+#ifndef RTE_EXCHANGE_H_
+#define RTE_EXCHANGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "ComStack_Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Macro for version
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define RTE_EXCHANGE_AR_MAJOR_VERSION		(1u)
+#define RTE_EXCHANGE_AR_MINOR_VERSION		(0u)
+#define RTE_EXCHANGE_AR_PATCH_VERSION		(0u)
+
+#ifndef RTE_SEQLOCK_RETRIES
+#define RTE_SEQLOCK_RETRIES		(8u)
+#endif
+
+/* Words of sequence lock storage for a value type: atomic_uint_least32_t buf[RTE_SEQLOCK_WORDS(MyType)] */
+#define RTE_SEQLOCK_WORDS(type)		((sizeof(type) + 3u) / 4u)
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Sequence lock
+ *  - Seq odd while a write is in progress, version = Seq / 2.
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	atomic_uint_least32_t	Seq;
+	atomic_uint_least32_t*	Buf;
+	uint16_t				Size;
+}Rte_SeqLockType;
+
+static inline void Rte_SeqLockInit(Rte_SeqLockType* sl, atomic_uint_least32_t* buf, uint16_t size)
+{
+	uint16_t i;
+
+	sl->Buf = buf;
+	sl->Size = size;
+	for (i = 0u; i < (uint16_t)((size + 3u) / 4u); i++)
+	{
+		atomic_init(&buf[i], 0u);
+	}
+	atomic_init(&sl->Seq, 0u);
+}
+
+static inline void Rte_SeqLockWrite(Rte_SeqLockType* sl, const void* value)
+{
+	const uint8_t* src = (const uint8_t*)value;
+	uint32_t seq = atomic_load_explicit(&sl->Seq, memory_order_relaxed);
+	uint16_t off;
+
+	atomic_store_explicit(&sl->Seq, seq + 1u, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	for (off = 0u; off < sl->Size; off += 4u)
+	{
+		uint32_t w = 0u;
+		(void)memcpy(&w, &src[off], ((uint16_t)(sl->Size - off) < 4u) ? (size_t)(sl->Size - off) : 4u);
+		atomic_store_explicit(&sl->Buf[off / 4u], w, memory_order_relaxed);
+	}
+
+	atomic_store_explicit(&sl->Seq, seq + 2u, memory_order_release);
+}
+
+/* E_OK: value holds a consistent copy, version (optional) its version, 0 = never written.
+ * E_NOT_OK: a write stayed in progress for RTE_SEQLOCK_RETRIES attempts, value content undefined. */
+static inline Std_ReturnType Rte_SeqLockRead(Rte_SeqLockType* sl, void* value, uint32_t* version)
+{
+	uint8_t* dst = (uint8_t*)value;
+	uint8_t retry;
+	uint16_t off;
+
+	for (retry = 0u; retry < RTE_SEQLOCK_RETRIES; retry++)
+	{
+		uint32_t s1 = atomic_load_explicit(&sl->Seq, memory_order_acquire);
+		uint32_t s2;
+
+		if ((s1 & 1u) != 0u)
+		{
+			continue;
+		}
+
+		for (off = 0u; off < sl->Size; off += 4u)
+		{
+			uint32_t w = atomic_load_explicit(&sl->Buf[off / 4u], memory_order_relaxed);
+			(void)memcpy(&dst[off], &w, ((uint16_t)(sl->Size - off) < 4u) ? (size_t)(sl->Size - off) : 4u);
+		}
+
+		atomic_thread_fence(memory_order_acquire);
+		s2 = atomic_load_explicit(&sl->Seq, memory_order_relaxed);
+		if (s1 == s2)
+		{
+			if (version != NULL)
+			{
+				*version = s1 >> 1;
+			}
+			return E_OK;
+		}
+	}
+	return E_NOT_OK;
+}
+
+/* Version of the last completed write, without copying the value. */
+static inline uint32_t Rte_SeqLockVersion(Rte_SeqLockType* sl)
+{
+	return atomic_load_explicit(&sl->Seq, memory_order_acquire) >> 1;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Triple buffer
+ *  - Three slots: Back (writer), Front (reader), Middle (last published, in State with the RTE_TB_DIRTY flag).
+ *  - Publishing / taking the latest value is a single atomic exchange of State.
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define RTE_TB_INDEX_MASK		(0x03u)
+#define RTE_TB_DIRTY			(0x04u)		/* Middle holds a value the reader has not taken yet.*/
+
+typedef struct
+{
+	atomic_uint_least8_t	State;			/* Middle index | RTE_TB_DIRTY.*/
+	uint8_t					Back;
+	uint8_t					Front;
+	uint16_t				Size;
+	uint8_t*				Buf;			/* 3 * Size bytes.*/
+	uint32_t				Version[3];		/* Version of the value in each slot.*/
+	uint32_t				Written;
+	uint32_t				LastRead;		/* Version returned by the previous read.*/
+}Rte_TripleBufType;
+
+static inline void Rte_TripleBufInit(Rte_TripleBufType* tb, void* buf, uint16_t size)
+{
+	tb->Buf = (uint8_t*)buf;
+	tb->Size = size;
+	tb->Back = 0u;
+	tb->Front = 1u;
+	tb->Version[0] = 0u;
+	tb->Version[1] = 0u;
+	tb->Version[2] = 0u;
+	tb->Written = 0u;
+	tb->LastRead = 0u;
+	(void)memset(buf, 0, (size_t)size * 3u);
+	atomic_init(&tb->State, 2u);
+}
+
+/* Writer: fill the returned slot in place, then commit. */
+static inline void* Rte_TripleBufWriteBegin(Rte_TripleBufType* tb)
+{
+	return &tb->Buf[(uint32_t)tb->Back * tb->Size];
+}
+
+static inline void Rte_TripleBufWriteCommit(Rte_TripleBufType* tb)
+{
+	uint8_t old;
+
+	tb->Written++;
+	tb->Version[tb->Back] = tb->Written;
+	old = (uint8_t)atomic_exchange_explicit(&tb->State, (uint8_t)(tb->Back | RTE_TB_DIRTY), memory_order_acq_rel);
+	tb->Back = (uint8_t)(old & RTE_TB_INDEX_MASK);
+}
+
+static inline void Rte_TripleBufWrite(Rte_TripleBufType* tb, const void* value)
+{
+	(void)memcpy(Rte_TripleBufWriteBegin(tb), value, tb->Size);
+	Rte_TripleBufWriteCommit(tb);
+}
+
+/* Reader: latest published value, valid until the next read. version (optional): 0 = never written.
+ * fresh (optional): true when the value is newer than the one returned by the previous read. */
+static inline const void* Rte_TripleBufReadLatest(Rte_TripleBufType* tb, uint32_t* version, bool* fresh)
+{
+	uint32_t v;
+
+	if ((atomic_load_explicit(&tb->State, memory_order_relaxed) & RTE_TB_DIRTY) != 0u)
+	{
+		uint8_t old = (uint8_t)atomic_exchange_explicit(&tb->State, tb->Front, memory_order_acq_rel);
+		tb->Front = (uint8_t)(old & RTE_TB_INDEX_MASK);
+	}
+
+	v = tb->Version[tb->Front];
+	if (version != NULL)
+	{
+		*version = v;
+	}
+	if (fresh != NULL)
+	{
+		*fresh = (v != tb->LastRead);
+	}
+	tb->LastRead = v;
+	return &tb->Buf[(uint32_t)tb->Front * tb->Size];
+}
+
+/* Copying read: E_OK when a value has been written at least once, E_NOT_OK otherwise (value untouched). */
+static inline Std_ReturnType Rte_TripleBufRead(Rte_TripleBufType* tb, void* value, uint32_t* version)
+{
+	uint32_t v;
+	const void* p = Rte_TripleBufReadLatest(tb, &v, NULL);
+
+	if (version != NULL)
+	{
+		*version = v;
+	}
+	if (v == 0u)
+	{
+		return E_NOT_OK;
+	}
+	(void)memcpy(value, p, tb->Size);
+	return E_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTE_EXCHANGE_H_ */
@@ -5,6 +5,9 @@
 #ifndef STD_TYPES_H_
 #define STD_TYPES_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,30 +29,26 @@ extern "C" {
 /* =====================================================================================================================
  *  Basic types
  * ===================================================================================================================*/
-typedef unsigned char 				uint8;
-typedef   signed char				sint8;
-typedef unsigned short				uint16;
-typedef   signed short				sint16;
-typedef unsigned long				uint32;
-typedef   signed long				sint32;
-typedef unsigned long long			uint64;
-typedef   signed long long			sint64;
+typedef uint8_t						uint8;
+typedef  int8_t						sint8;
+typedef uint16_t					uint16;
+typedef  int16_t					sint16;
+typedef uint32_t					uint32;
+typedef  int32_t					sint32;
+typedef uint64_t					uint64;
+typedef  int64_t					sint64;
 
 typedef float						float32;
 typedef double						float64;
 
 /* Boolean */
-typedef uint8 bool;
-
-#ifndef boolean
-#define boolean	(bool)
-#endif
+typedef bool						boolean;
 
 #ifndef TRUE
-#define TRUE	((bool)1u)
+#define TRUE	(true)
 #endif
 #ifndef FALSE
-#define FALSE	((bool)0u)
+#define FALSE	(false)
 #endif
 
 /* Std macros */
@@ -0,0 +1,273 @@
+/* =====================================================================================================================
+ *  File        : CanFilterBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : CanFilter.h classifier against the linear ID compare of CanIf
+ *                 - For 10..1000 configured IDs (half standard, half extended, plus one masked entry of each kind):
+ *                   build the filter, then classify the same frame stream (about 80% accepted IDs) with
+ *                   CanFilter_Lookup and with a linear scan of the configuration.
+ *                 - Checks: both give the same handle for every frame (and for every standard ID).
+ *                 - Report: lookups/s of both and the speedup.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o CanFilterBench CanFilterBench.c
+ *  Usage       : CanFilterBench [-n lookups] [-s seed]
+ *                  -n  lookups per measurement (default 20000000)
+ *                  -s  random seed (default 1)
+ *  Example     : CanFilterBench -n 100000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+/* Capacity for the biggest configuration measured (1000 IDs) */
+#define CAN_FILTER_MAX_STD			(1024u)
+#define CAN_FILTER_EXT_SLOTS_BITS	(11u)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CanFilter.h"
+
+#define CAN_FILTER_BENCH_MAX_CFG	(1002u)
+#define CAN_FILTER_BENCH_FRAMES		(1u << 16)
+
+static const uint32_t CanFilterBench_Sizes[] = { 10u, 50u, 100u, 250u, 500u, 1000u };
+
+static CanFilter_EntryType CanFilterBench_Cfg[CAN_FILTER_BENCH_MAX_CFG];
+static CanFilter_Type CanFilterBench_Filter;
+static CAN_IdType CanFilterBench_Frames[CAN_FILTER_BENCH_FRAMES];
+static uint64_t CanFilterBench_Seed;
+
+static uint32_t CanFilterBench_Rand(void)
+{
+	CanFilterBench_Seed ^= CanFilterBench_Seed >> 12;
+	CanFilterBench_Seed ^= CanFilterBench_Seed << 25;
+	CanFilterBench_Seed ^= CanFilterBench_Seed >> 27;
+	return (uint32_t)((CanFilterBench_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double CanFilterBench_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Reference: linear compare over the configuration, as CanIf does today
+ *  - standard IDs: first matching entry; extended IDs: an exact entry wins, then masked entries in order.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static PduIdType CanFilterBench_Linear(const CanFilter_EntryType* cfg, uint16_t count, CAN_IdType id)
+{
+	uint32_t raw = CAN_ID_GET_RAW(id);
+	bool ext = CAN_ID_IS_EXT(id);
+	uint16_t e;
+
+	for (e = 0u; e < count; e++)
+	{
+		if ((CAN_ID_IS_EXT(cfg[e].Id) == ext) && (!ext || CanFilter_IsExtExact(&cfg[e])) &&
+			((raw & cfg[e].Mask) == (CAN_ID_GET_RAW(cfg[e].Id) & cfg[e].Mask)))
+		{
+			return cfg[e].Handle;
+		}
+	}
+	if (ext)
+	{
+		for (e = 0u; e < count; e++)
+		{
+			if (CAN_ID_IS_EXT(cfg[e].Id) && !CanFilter_IsExtExact(&cfg[e]) &&
+				((raw & cfg[e].Mask) == (CAN_ID_GET_RAW(cfg[e].Id) & cfg[e].Mask)))
+			{
+				return cfg[e].Handle;
+			}
+		}
+	}
+	return CAN_FILTER_REJECT;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Configuration of n distinct IDs + one masked standard range + one masked extended range
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint16_t CanFilterBench_MakeCfg(uint32_t n)
+{
+	static uint8_t stdUsed[CAN_STD_ID_MASK + 1u];
+	uint16_t count = 0u;
+	uint32_t i;
+
+	memset(stdUsed, 0, sizeof(stdUsed));
+	for (i = 0u; i < n; i++)
+	{
+		CanFilter_EntryType* e = &CanFilterBench_Cfg[count];
+
+		if ((i & 1u) == 0u)
+		{
+			uint32_t raw;
+
+			do
+			{
+				raw = CanFilterBench_Rand() % 0x700u;		/* 0x700.. is the masked range below */
+			} while (stdUsed[raw] != 0u);
+			stdUsed[raw] = 1u;
+			e->Id = CAN_MAKE_STD_ID((uint16_t)raw);
+		}
+		else
+		{
+			uint32_t raw;
+			uint16_t k;
+			bool dup;
+
+			do
+			{
+				raw = (CanFilterBench_Rand() & CAN_EXT_ID_MASK) & ~0x18000000u;	/* outside the masked range */
+				dup = false;
+				for (k = 0u; k < count; k++)
+				{
+					dup = dup || (CanFilterBench_Cfg[k].Id == CAN_MAKE_EXT_ID(raw));
+				}
+			} while (dup);
+			e->Id = CAN_MAKE_EXT_ID(raw);
+		}
+		e->Mask = CAN_FILTER_MASK_EXACT;
+		e->Handle = (PduIdType)count;
+		count++;
+	}
+
+	CanFilterBench_Cfg[count].Id = CAN_MAKE_STD_ID(0x700u);			/* 0x700..0x70F, e.g. diagnostics */
+	CanFilterBench_Cfg[count].Mask = 0x7F0u;
+	CanFilterBench_Cfg[count].Handle = (PduIdType)count;
+	count++;
+	CanFilterBench_Cfg[count].Id = CAN_MAKE_EXT_ID(0x18DA0000u);	/* J1939-style 0x18DAxxxx */
+	CanFilterBench_Cfg[count].Mask = 0x1FFF0000u;
+	CanFilterBench_Cfg[count].Handle = (PduIdType)count;
+	count++;
+	return count;
+}
+
+/* Frame stream: 80% configured IDs, 20% random (mostly rejected) */
+static void CanFilterBench_MakeFrames(uint16_t count)
+{
+	uint32_t i;
+
+	for (i = 0u; i < CAN_FILTER_BENCH_FRAMES; i++)
+	{
+		uint32_t r = CanFilterBench_Rand();
+
+		if ((r % 10u) < 8u)
+		{
+			const CanFilter_EntryType* e = &CanFilterBench_Cfg[(r >> 8) % count];
+
+			CanFilterBench_Frames[i] = CAN_ID_IS_EXT(e->Id) ?
+									   CAN_MAKE_EXT_ID(CAN_ID_GET_RAW(e->Id) | (CanFilterBench_Rand() & ~e->Mask)) :
+									   CAN_MAKE_STD_ID((uint16_t)(CAN_ID_GET_RAW(e->Id) |
+																  (CanFilterBench_Rand() & ~e->Mask)));
+		}
+		else
+		{
+			CanFilterBench_Frames[i] = ((r & 0x100u) != 0u) ? CAN_MAKE_EXT_ID(CanFilterBench_Rand()) :
+									   CAN_MAKE_STD_ID((uint16_t)CanFilterBench_Rand());
+		}
+	}
+}
+
+static void CanFilterBench_Usage(void)
+{
+	fprintf(stderr, "usage: CanFilterBench [-n lookups] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t lookups = 20000000u;
+	uint32_t errors = 0u;
+	uint32_t s;
+	int o;
+
+	CanFilterBench_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				lookups = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				CanFilterBench_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				CanFilterBench_Usage();
+				return 2;
+		}
+	}
+	if (lookups == 0u)
+	{
+		CanFilterBench_Usage();
+		return 2;
+	}
+
+	printf("%u lookups per run, %zu bytes of filter RAM\n", lookups, sizeof(CanFilter_Type));
+	printf("%8s %16s %16s %9s %8s\n", "IDs", "filter Mlook/s", "linear Mlook/s", "speedup", "errors");
+	for (s = 0u; s < (sizeof(CanFilterBench_Sizes) / sizeof(CanFilterBench_Sizes[0])); s++)
+	{
+		uint16_t count = CanFilterBench_MakeCfg(CanFilterBench_Sizes[s]);
+		uint32_t sumFilter = 0u;
+		uint32_t sumLinear = 0u;
+		uint32_t mismatch = 0u;
+		double tFilter;
+		double tLinear;
+		double t0;
+		uint32_t i;
+
+		if (CanFilter_Build(&CanFilterBench_Filter, CanFilterBench_Cfg, count) != E_OK)
+		{
+			fprintf(stderr, "%u IDs: CanFilter_Build failed\n", CanFilterBench_Sizes[s]);
+			errors++;
+			continue;
+		}
+		CanFilterBench_MakeFrames(count);
+
+		/* Same answer on the frame stream and on the whole standard ID space */
+		for (i = 0u; i < CAN_FILTER_BENCH_FRAMES; i++)
+		{
+			CAN_IdType id = CanFilterBench_Frames[i];
+
+			mismatch += (CanFilter_Lookup(&CanFilterBench_Filter, id) !=
+						 CanFilterBench_Linear(CanFilterBench_Cfg, count, id)) ? 1u : 0u;
+		}
+		for (i = 0u; i <= CAN_STD_ID_MASK; i++)
+		{
+			CAN_IdType id = CAN_MAKE_STD_ID((uint16_t)i);
+
+			mismatch += (CanFilter_Lookup(&CanFilterBench_Filter, id) !=
+						 CanFilterBench_Linear(CanFilterBench_Cfg, count, id)) ? 1u : 0u;
+		}
+
+		t0 = CanFilterBench_Now();
+		for (i = 0u; i < lookups; i++)
+		{
+			sumFilter += CanFilter_Lookup(&CanFilterBench_Filter,
+										  CanFilterBench_Frames[i & (CAN_FILTER_BENCH_FRAMES - 1u)]);
+		}
+		tFilter = CanFilterBench_Now() - t0;
+
+		/* The linear scan is slow for big configurations: fewer lookups, same stream */
+		t0 = CanFilterBench_Now();
+		for (i = 0u; i < (lookups / 10u); i++)
+		{
+			sumLinear += CanFilterBench_Linear(CanFilterBench_Cfg, count,
+											   CanFilterBench_Frames[i & (CAN_FILTER_BENCH_FRAMES - 1u)]);
+		}
+		tLinear = (CanFilterBench_Now() - t0) * 10.0;
+
+		printf("%8u %16.1f %16.1f %8.1fx %8u\n", CanFilterBench_Sizes[s], (lookups / tFilter) * 1e-6,
+			   (lookups / tLinear) * 1e-6, tLinear / tFilter, mismatch);
+		if ((sumFilter == 0u) && (sumLinear == 0u))
+		{
+			printf("(nothing accepted)\n");
+		}
+		errors += mismatch;
+	}
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
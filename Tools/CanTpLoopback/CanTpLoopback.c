@@ -0,0 +1,527 @@
+/* =====================================================================================================================
+ *  File        : CanTpLoopback.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Loopback test of the streaming CanTp (CanTp.h) on a simulated CAN bus
+ *                 - C connection pairs share one bus: node 2i sends transfers of 1..4095 bytes to node 2i+1, frames
+ *                   are arbitrated by node index and take FRAME_BITS / bitrate on the bus, the main functions run
+ *                   every 1 ms of simulated time.
+ *                 - Upper layers stream straight from / into their message buffer (CopyTxData / CopyRxData), the
+ *                   receiver announces a limited window (-w) drained once per ms, so BS reduction and FC WAIT occur.
+ *                 - Faults: -d percent of the frames are lost on the bus (TX confirmation E_NOT_OK), the sender
+ *                   rewinds its buffer from RetryInfoType (TP_DATARETRY + TxTpDataCnt).
+ *                 - N_Ar case: the receiver's FC is swallowed by the controller (never confirmed), the receiver must
+ *                   end with NTFRSLT_E_TIMEOUT_A after NarMs, the sender with NTFRSLT_E_TIMEOUT_BS, the next transfer
+ *                   must then pass.
+ *                 - Checks: every transfer reported OK by the receiver has the sender's exact content, both ends
+ *                   agree on the result, nothing is left in flight.
+ *                 - Report: effective payload throughput against the bus bitrate, CPU time per frame and the RAM of
+ *                   one connection end (CANTP_CONN_RAM_BYTES) for the C concurrent connections.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o CanTpLoopback CanTpLoopback.c
+ *  Usage       : CanTpLoopback [-c connections] [-n transfers] [-k kbit/s] [-b bs] [-m stmin] [-w window] [-d drop]
+ *                  -c  concurrent connections (1..CANTP_LOOPBACK_MAX_CONN, default 1)
+ *                  -n  transfers per connection (default 200)
+ *                  -k  CAN bitrate in kbit/s (default 500)
+ *                  -b  receiver block size (default 8)
+ *                  -m  receiver STmin in ms (default 0)
+ *                  -w  receiver buffer window in bytes (7..4095, default 4095)
+ *                  -d  percent of frames lost on the bus (default 0)
+ *  Example     : CanTpLoopback -c 4 -n 1000 -w 256 -d 1
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CanTp.h"
+
+#define CANTP_LOOPBACK_MAX_CONN		(16u)
+#define CANTP_LOOPBACK_MAX_NODES	(CANTP_LOOPBACK_MAX_CONN * 2u)
+#define CANTP_LOOPBACK_FRAME_BITS	(125u)			/* 8 byte standard frame with average bit stuffing.*/
+#define CANTP_LOOPBACK_LIMIT_MS		(3600000u)
+
+typedef struct
+{
+	CanTp_ConnType		Conn;
+	CanTp_ConfigType	Cfg;
+
+	/* Bus mailbox: the one frame CanTp has in flight */
+	bool				Pending;
+	bool				Swallowed;
+	uint8_t				Frame[CANTP_FRAME_SIZE];
+
+	/* Sending upper layer */
+	uint8_t				TxMsg[CANTP_MAX_LENGTH];
+	PduLengthType		TxLen;
+	PduLengthType		TxOff;
+	bool				TxActive;
+	uint32_t			TxStarted;
+	uint32_t			TxOk;
+	NotifResultType		TxLast;
+
+	/* Receiving upper layer */
+	uint8_t				RxBuf[CANTP_MAX_LENGTH];
+	PduLengthType		RxLen;
+	PduLengthType		RxOff;
+	PduLengthType		RxDrained;
+	uint32_t			RxOk;
+	uint32_t			RxEnded;
+	NotifResultType		RxLast;
+	uint64_t			RxLastUs;
+	uint64_t			RxBytes;
+}CanTpLoopNode_t;
+
+static CanTpLoopNode_t CanTpLoop_Node[CANTP_LOOPBACK_MAX_NODES];
+static uint32_t CanTpLoop_Nodes;
+static uint64_t CanTpLoop_Seed;
+static uint64_t CanTpLoop_NowUs;
+static uint32_t CanTpLoop_Drop;
+static uint32_t CanTpLoop_Window;
+static bool CanTpLoop_SwallowFc;
+static uint64_t CanTpLoop_Frames;
+static uint64_t CanTpLoop_Lost;
+static uint32_t CanTpLoop_Errors;
+
+static uint32_t CanTpLoop_Rand(void)
+{
+	CanTpLoop_Seed ^= CanTpLoop_Seed >> 12;
+	CanTpLoop_Seed ^= CanTpLoop_Seed << 25;
+	CanTpLoop_Seed ^= CanTpLoop_Seed >> 27;
+	return (uint32_t)((CanTpLoop_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double CanTpLoop_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Upper layer (id = node index)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static BufReq_ReturnType CanTpLoop_CopyTxData(PduIdType id, const PduInfoType* info, const RetryInfoType* retry,
+											  PduLengthType* availableData)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[id];
+
+	if ((retry != NULL) && (retry->TpDataState == TP_DATARETRY))
+	{
+		if (retry->TxTpDataCnt > node->TxOff)
+		{
+			CanTpLoop_Errors++;
+			return BUFREQ_E_NOT_OK;
+		}
+		node->TxOff = (PduLengthType)(node->TxOff - retry->TxTpDataCnt);
+	}
+	if ((PduLengthType)(node->TxOff + info->SduLength) > node->TxLen)
+	{
+		CanTpLoop_Errors++;
+		return BUFREQ_E_NOT_OK;
+	}
+	memcpy(info->SduDataPtr, &node->TxMsg[node->TxOff], info->SduLength);
+	node->TxOff = (PduLengthType)(node->TxOff + info->SduLength);
+	*availableData = (PduLengthType)(node->TxLen - node->TxOff);
+	return BUFREQ_OK;
+}
+
+static PduLengthType CanTpLoop_RxFree(const CanTpLoopNode_t* node)
+{
+	return (PduLengthType)(CanTpLoop_Window - (node->RxOff - node->RxDrained));
+}
+
+static BufReq_ReturnType CanTpLoop_StartOfReception(PduIdType id, const PduInfoType* info, PduLengthType tpSduLength,
+													PduLengthType* bufferSize)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[id];
+
+	(void)info;
+	node->RxLen = tpSduLength;
+	node->RxOff = 0u;
+	node->RxDrained = 0u;
+	*bufferSize = CanTpLoop_RxFree(node);
+	return BUFREQ_OK;
+}
+
+static BufReq_ReturnType CanTpLoop_CopyRxData(PduIdType id, const PduInfoType* info, PduLengthType* bufferSize)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[id];
+
+	if ((info->SduLength > CanTpLoop_RxFree(node)) || ((PduLengthType)(node->RxOff + info->SduLength) > node->RxLen))
+	{
+		CanTpLoop_Errors++;
+		return BUFREQ_E_NOT_OK;
+	}
+	if (info->SduLength != 0u)
+	{
+		memcpy(&node->RxBuf[node->RxOff], info->SduDataPtr, info->SduLength);
+		node->RxOff = (PduLengthType)(node->RxOff + info->SduLength);
+	}
+	*bufferSize = CanTpLoop_RxFree(node);
+	return BUFREQ_OK;
+}
+
+static void CanTpLoop_RxIndication(PduIdType id, NotifResultType result)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[id];
+	const CanTpLoopNode_t* peer = &CanTpLoop_Node[id ^ 1u];
+
+	node->RxEnded++;
+	node->RxLast = result;
+	node->RxLastUs = CanTpLoop_NowUs;
+	if (result == NTFRSLT_OK)
+	{
+		if ((node->RxOff != node->RxLen) || (node->RxLen != peer->TxLen) ||
+			(memcmp(node->RxBuf, peer->TxMsg, node->RxLen) != 0))
+		{
+			fprintf(stderr, "node %u: transfer %u of %u bytes received corrupted\n", id, peer->TxStarted,
+					peer->TxLen);
+			CanTpLoop_Errors++;
+		}
+		node->RxOk++;
+		node->RxBytes += node->RxLen;
+	}
+}
+
+static void CanTpLoop_TxConfirmation(PduIdType id, NotifResultType result)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[id];
+	const CanTpLoopNode_t* peer = &CanTpLoop_Node[id ^ 1u];
+
+	node->TxActive = false;
+	node->TxLast = result;
+	if (result == NTFRSLT_OK)
+	{
+		node->TxOk++;
+		/* The last CF is confirmed after the receiver saw it: both ends agree */
+		if ((peer->RxOk == 0u) || (peer->RxLast != NTFRSLT_OK))
+		{
+			fprintf(stderr, "node %u: transfer %u confirmed but not received\n", id, node->TxStarted);
+			CanTpLoop_Errors++;
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Lower layer: one mailbox per node, the bus picks the lowest pending node
+ * -------------------------------------------------------------------------------------------------------------------*/
+static Std_ReturnType CanTpLoop_CanTransmit(PduIdType txPduId, const PduInfoType* info)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[txPduId];
+
+	if (node->Pending || (info->SduLength != CANTP_FRAME_SIZE))
+	{
+		CanTpLoop_Errors++;		/* CanTp must wait for the confirmation of the frame in flight. */
+		return E_NOT_OK;
+	}
+	memcpy(node->Frame, info->SduDataPtr, CANTP_FRAME_SIZE);
+	if (CanTpLoop_SwallowFc && ((node->Frame[0] & 0xF0u) == CANTP_PCI_FC))
+	{
+		node->Swallowed = true;	/* Accepted, never sent, never confirmed. */
+		return E_OK;
+	}
+	node->Pending = true;
+	return E_OK;
+}
+
+static void CanTpLoop_Deliver(uint32_t k)
+{
+	CanTpLoopNode_t* node = &CanTpLoop_Node[k];
+	PduInfoType info;
+
+	node->Pending = false;
+	CanTpLoop_Frames++;
+	if ((CanTpLoop_Rand() % 100u) < CanTpLoop_Drop)
+	{
+		CanTpLoop_Lost++;
+		CanTp_TxConfirmation(&node->Conn, E_NOT_OK);
+		return;
+	}
+	info.SduDataPtr = node->Frame;
+	info.SduLength = CANTP_FRAME_SIZE;
+	info.MetaDataPtr = NULL;
+	CanTp_RxIndication(&CanTpLoop_Node[k ^ 1u].Conn, &info);
+	CanTp_TxConfirmation(&node->Conn, E_OK);
+}
+
+static void CanTpLoop_InitNodes(uint32_t conns, uint8_t bs, uint8_t stmin)
+{
+	uint32_t k;
+
+	CanTpLoop_Nodes = conns * 2u;
+	for (k = 0u; k < CanTpLoop_Nodes; k++)
+	{
+		CanTpLoopNode_t* node = &CanTpLoop_Node[k];
+
+		memset(node, 0, sizeof(*node));
+		node->Cfg.CopyTxData = CanTpLoop_CopyTxData;
+		node->Cfg.StartOfReception = CanTpLoop_StartOfReception;
+		node->Cfg.CopyRxData = CanTpLoop_CopyRxData;
+		node->Cfg.RxIndication = CanTpLoop_RxIndication;
+		node->Cfg.TxConfirmation = CanTpLoop_TxConfirmation;
+		node->Cfg.CanTransmit = CanTpLoop_CanTransmit;
+		node->Cfg.UpperPduId = (PduIdType)k;
+		node->Cfg.TxPduId = (PduIdType)k;
+		node->Cfg.BlockSize = bs;
+		node->Cfg.STmin = stmin;
+		node->Cfg.Padding = 0xCCu;
+		node->Cfg.NasMs = 70u;
+		node->Cfg.NbsMs = 150u;
+		node->Cfg.NcsMs = 70u;
+		node->Cfg.NcrMs = 150u;
+		node->Cfg.NbrMs = 20u;
+		node->Cfg.NarMs = 70u;
+		CanTp_Init(&node->Conn, &node->Cfg);
+	}
+}
+
+/* Start the next transfer of every idle sender (fixed length when len != 0) */
+static void CanTpLoop_StartTransfers(uint32_t transfers, PduLengthType len)
+{
+	uint32_t k;
+
+	for (k = 0u; k < CanTpLoop_Nodes; k += 2u)
+	{
+		CanTpLoopNode_t* node = &CanTpLoop_Node[k];
+		PduInfoType info;
+		PduLengthType i;
+
+		if (node->TxActive || (node->TxStarted >= transfers))
+		{
+			continue;
+		}
+		node->TxLen = (len != 0u) ? len : (PduLengthType)(1u + (CanTpLoop_Rand() % CANTP_MAX_LENGTH));
+		node->TxOff = 0u;
+		for (i = 0u; i < node->TxLen; i++)
+		{
+			node->TxMsg[i] = (uint8_t)CanTpLoop_Rand();
+		}
+		info.SduDataPtr = NULL;
+		info.SduLength = node->TxLen;
+		info.MetaDataPtr = NULL;
+		node->TxStarted++;
+		node->TxActive = true;
+		if (CanTp_Transmit(&node->Conn, &info) != E_OK)
+		{
+			fprintf(stderr, "node %u: CanTp_Transmit refused\n", k);
+			CanTpLoop_Errors++;
+			node->TxActive = false;
+		}
+	}
+}
+
+static bool CanTpLoop_Done(uint32_t transfers)
+{
+	uint32_t k;
+
+	for (k = 0u; k < CanTpLoop_Nodes; k++)
+	{
+		const CanTpLoopNode_t* node = &CanTpLoop_Node[k];
+
+		if (node->TxActive || node->Pending || (node->Conn.RxState != CANTP_RX_IDLE) ||
+			(((k & 1u) == 0u) && (node->TxStarted < transfers)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Simulation: bus frames and 1 ms main function ticks in time order
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void CanTpLoop_Run(uint32_t transfers, PduLengthType len, uint32_t frameUs)
+{
+	int32_t busy = -1;
+	uint64_t endAt = 0u;
+	uint32_t k;
+
+	while (!CanTpLoop_Done(transfers) && (CanTpLoop_NowUs < (CANTP_LOOPBACK_LIMIT_MS * 1000ull)))
+	{
+		uint64_t tick = ((CanTpLoop_NowUs / 1000u) + 1u) * 1000u;
+
+		if (busy < 0)
+		{
+			for (k = 0u; (k < CanTpLoop_Nodes) && (busy < 0); k++)
+			{
+				if (CanTpLoop_Node[k].Pending)
+				{
+					busy = (int32_t)k;
+					endAt = CanTpLoop_NowUs + frameUs;
+				}
+			}
+		}
+		if ((busy >= 0) && (endAt <= tick))
+		{
+			CanTpLoop_NowUs = endAt;
+			CanTpLoop_Deliver((uint32_t)busy);
+			busy = -1;
+			continue;
+		}
+
+		CanTpLoop_NowUs = tick;
+		for (k = 0u; k < CanTpLoop_Nodes; k++)
+		{
+			CanTpLoop_Node[k].RxDrained = CanTpLoop_Node[k].RxOff;		/* Application consumed the window. */
+			CanTp_MainFunction(&CanTpLoop_Node[k].Conn, (uint32_t)(CanTpLoop_NowUs / 1000u));
+		}
+		CanTpLoop_StartTransfers(transfers, len);
+	}
+	if (!CanTpLoop_Done(transfers))
+	{
+		fprintf(stderr, "simulation did not finish\n");
+		CanTpLoop_Errors++;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  N_Ar: FC accepted by the controller but never confirmed
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void CanTpLoop_FcDrop(uint32_t frameUs)
+{
+	CanTpLoopNode_t* tx = &CanTpLoop_Node[0];
+	CanTpLoopNode_t* rx = &CanTpLoop_Node[1];
+	uint64_t ffUs;
+
+	CanTpLoop_InitNodes(1u, 8u, 0u);
+	CanTpLoop_NowUs = 0u;
+	CanTpLoop_SwallowFc = true;
+	CanTpLoop_StartTransfers(1u, 100u);
+	ffUs = CanTpLoop_NowUs + frameUs;
+	CanTpLoop_Run(1u, 100u, frameUs);
+	CanTpLoop_SwallowFc = false;
+
+	printf("FC drop (N_Ar)  : receiver %u after %.0f ms (N_Ar %u ms), sender %u\n", (unsigned)rx->RxLast,
+		   (double)(rx->RxLastUs - ffUs) * 1e-3, rx->Cfg.NarMs, (unsigned)tx->TxLast);
+	if ((rx->RxLast != NTFRSLT_E_TIMEOUT_A) || (tx->TxLast != NTFRSLT_E_TIMEOUT_BS) ||
+		((rx->RxLastUs - ffUs) > ((uint64_t)(rx->Cfg.NarMs + 1u) * 1000u)) ||
+		((rx->RxLastUs - ffUs) < ((uint64_t)(rx->Cfg.NarMs - 1u) * 1000u)))
+	{
+		CanTpLoop_Errors++;
+	}
+
+	/* The lower layer was freed by N_Ar: the next transfer passes */
+	CanTpLoop_Run(2u, 100u, frameUs);
+	if ((tx->TxLast != NTFRSLT_OK) || (rx->RxLast != NTFRSLT_OK) || (rx->RxOk != 1u))
+	{
+		fprintf(stderr, "transfer after N_Ar failed: sender %u receiver %u\n", (unsigned)tx->TxLast,
+				(unsigned)rx->RxLast);
+		CanTpLoop_Errors++;
+	}
+}
+
+static void CanTpLoop_Usage(void)
+{
+	fprintf(stderr, "usage: CanTpLoopback [-c connections] [-n transfers] [-k kbit/s] [-b bs] [-m stmin] [-w window] "
+			"[-d drop]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t conns = 1u;
+	uint32_t transfers = 200u;
+	uint32_t kbit = 500u;
+	uint32_t bs = 8u;
+	uint32_t stmin = 0u;
+	uint32_t frameUs;
+	uint64_t txOk = 0u;
+	uint64_t txFailed = 0u;
+	uint64_t rxOk = 0u;
+	uint64_t bytes = 0u;
+	double sec;
+	double t0;
+	uint32_t k;
+	int o;
+
+	CanTpLoop_Seed = 1u;
+	CanTpLoop_Window = CANTP_MAX_LENGTH;
+	CanTpLoop_Drop = 0u;
+	while ((o = getopt(argc, argv, "c:n:k:b:m:w:d:")) != -1)
+	{
+		switch (o)
+		{
+			case 'c':
+				conns = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				transfers = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'k':
+				kbit = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				bs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'm':
+				stmin = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'w':
+				CanTpLoop_Window = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				CanTpLoop_Drop = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				CanTpLoop_Usage();
+				return 2;
+		}
+	}
+	if ((conns == 0u) || (conns > CANTP_LOOPBACK_MAX_CONN) || (transfers == 0u) || (kbit == 0u) || (bs > 0xFFu) ||
+		(stmin > 0x7Fu) || (CanTpLoop_Window < CANTP_CF_MAX_DATA) || (CanTpLoop_Window > CANTP_MAX_LENGTH) ||
+		(CanTpLoop_Drop > 50u))
+	{
+		CanTpLoop_Usage();
+		return 2;
+	}
+	frameUs = (CANTP_LOOPBACK_FRAME_BITS * 1000u) / kbit;
+	CanTpLoop_Errors = 0u;
+
+	/* Throughput run */
+	CanTpLoop_InitNodes(conns, (uint8_t)bs, (uint8_t)stmin);
+	CanTpLoop_NowUs = 0u;
+	t0 = CanTpLoop_Now();
+	CanTpLoop_Run(transfers, 0u, frameUs);
+	sec = CanTpLoop_Now() - t0;
+
+	for (k = 0u; k < CanTpLoop_Nodes; k += 2u)
+	{
+		txOk += CanTpLoop_Node[k].TxOk;
+		txFailed += CanTpLoop_Node[k].TxStarted - CanTpLoop_Node[k].TxOk;
+		rxOk += CanTpLoop_Node[k + 1u].RxOk;
+		bytes += CanTpLoop_Node[k + 1u].RxBytes;
+		if (CanTpLoop_Node[k].TxOk != CanTpLoop_Node[k + 1u].RxOk)
+		{
+			fprintf(stderr, "connection %u: %u sent OK, %u received OK\n", k / 2u, CanTpLoop_Node[k].TxOk,
+					CanTpLoop_Node[k + 1u].RxOk);
+			CanTpLoop_Errors++;
+		}
+	}
+	if ((CanTpLoop_Drop == 0u) && (txFailed != 0u))
+	{
+		CanTpLoop_Errors++;		/* Nothing may fail on a clean bus. */
+	}
+
+	printf("%u connection(s) x %u transfers of 1..%u bytes, %u kbit/s, BS %u, STmin %u ms, window %u, drop %u%%\n",
+		   conns, transfers, CANTP_MAX_LENGTH, kbit, bs, stmin, CanTpLoop_Window, CanTpLoop_Drop);
+	printf("transfers       : %llu OK (%llu received OK), %llu failed\n", (unsigned long long)txOk,
+		   (unsigned long long)rxOk, (unsigned long long)txFailed);
+	printf("frames          : %llu on the bus (%llu lost), %.2f s of bus time\n", (unsigned long long)CanTpLoop_Frames,
+		   (unsigned long long)CanTpLoop_Lost, (double)CanTpLoop_NowUs * 1e-6);
+	printf("throughput      : %.1f kB/s payload = %.1f%% of the raw %u kbit/s\n",
+		   ((double)bytes / ((double)CanTpLoop_NowUs * 1e-6)) * 1e-3,
+		   (((double)bytes * 8.0) / ((double)CanTpLoop_NowUs * 1e-6)) / ((double)kbit * 10.0), kbit);
+	printf("CPU             : %.1f ns per frame (both ends)\n", (sec * 1e9) / (double)CanTpLoop_Frames);
+	printf("RAM             : %u bytes per connection end, %u bytes for %u concurrent connection(s) "
+		   "(config %u bytes, const)\n", (unsigned)CANTP_CONN_RAM_BYTES, (unsigned)(CANTP_CONN_RAM_BYTES * 2u * conns),
+		   conns, (unsigned)sizeof(CanTp_ConfigType));
+
+	CanTpLoop_FcDrop(frameUs);
+	printf("errors          : %u\n", CanTpLoop_Errors);
+	return (CanTpLoop_Errors == 0u) ? 0 : 1;
+}
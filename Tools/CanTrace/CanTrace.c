@@ -0,0 +1,713 @@
+/* =====================================================================================================================
+ *  File        : CanTrace.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Record, replay and convert CanTrace.h captures
+ *                 - record   : SocketCAN interface -> capture (buffered writes, one syscall per frame read).
+ *                 - replay   : capture is memory-mapped and fed record by record into the RX path, either
+ *                              in process (CanFilter_Lookup -> per handle counters, the CanIf RX entry) or to a
+ *                              SocketCAN interface (-o), at original timing (-t) or at maximum speed.
+ *                 - totext   : capture -> candump log text "(sec.usec) canN ID#DATA".
+ *                 - fromtext : candump log text -> capture.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o CanTrace CanTrace.c
+ *  Usage       : CanTrace record [-c channel] [-n frames] ifname out.trc
+ *                CanTrace replay [-t] [-o ifname] [-a id[/mask]]... [-l loops] in.trc
+ *                CanTrace totext in.trc [out.log]
+ *                CanTrace fromtext in.log out.trc
+ *                  -a  accept filter of the in-process RX path (default: every ID), ext IDs with > 3 hex digits
+ *                  -t  original timing (default: maximum speed)
+ *                  -l  replay the capture this many times (throughput measurement)
+ *  Example     : CanTrace replay -l 20 field.trc
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+/* In-process RX path accepts up to every standard ID. */
+#define CAN_FILTER_MAX_STD		(2048u)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "CanFilter.h"
+#include "CanTrace.h"
+#include "LogTags.h"
+
+#define CAN_TRACE_MAX_ACCEPT	(32u)
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CAN_TRACE_NATIVE		(1)		/* Mapped records are CanTrace_RecordType.*/
+#else
+#define CAN_TRACE_NATIVE		(0)
+#endif
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Mapped capture
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	const uint8_t*		Data;
+	uint64_t			Size;
+	CanTrace_HeaderType	Hdr;
+	uint64_t			Count;
+}CanTraceFile_t;
+
+typedef struct
+{
+	CanFilter_Type		Filter;
+	uint64_t			Hits[CAN_FILTER_MAX_STD];		/* Frames per handle.*/
+	uint64_t			Rejected;
+	uint64_t			Bytes;
+}CanTraceRxPath_t;
+
+static double CanTrace_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint64_t CanTrace_WallUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+}
+
+static int CanTrace_Open(CanTraceFile_t* tf, const char* path)
+{
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)CAN_TRACE_HDR_SIZE))
+	{
+		fprintf(stderr, "%s: not a CAN trace\n", path);
+		close(fd);
+		return -1;
+	}
+
+	tf->Size = (uint64_t)st.st_size;
+	tf->Data = mmap(NULL, tf->Size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close(fd);
+	if (tf->Data == MAP_FAILED)
+	{
+		fprintf(stderr, "%s: mmap: %s\n", path, strerror(errno));
+		return -1;
+	}
+	(void)madvise((void*)tf->Data, tf->Size, MADV_SEQUENTIAL);
+
+	if (!CanTrace_HeaderDecode(tf->Data, (uint32_t)tf->Size, &tf->Hdr))
+	{
+		fprintf(stderr, "%s: not a CAN trace\n", path);
+		munmap((void*)tf->Data, tf->Size);
+		return -1;
+	}
+	tf->Count = (tf->Size - CAN_TRACE_HDR_SIZE) / CAN_TRACE_REC_SIZE;
+	return 0;
+}
+
+static void CanTrace_Close(CanTraceFile_t* tf)
+{
+	munmap((void*)tf->Data, tf->Size);
+}
+
+/* Record i of the capture: in place on a little-endian host, decoded into tmp otherwise. */
+static inline const CanTrace_RecordType* CanTrace_At(const CanTraceFile_t* tf, uint64_t i, CanTrace_RecordType* tmp)
+{
+	const uint8_t* p = &tf->Data[CAN_TRACE_HDR_SIZE + (i * CAN_TRACE_REC_SIZE)];
+
+#if (CAN_TRACE_NATIVE == 1)
+	(void)tmp;
+	return (const CanTrace_RecordType*)(const void*)p;
+#else
+	CanTrace_RecordDecode(p, tmp);
+	return tmp;
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  SocketCAN
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int CanTrace_SocketOpen(const char* ifname)
+{
+	struct sockaddr_can addr;
+	struct ifreq ifr;
+	int s;
+
+	s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (s < 0)
+	{
+		perror("socket");
+		return -1;
+	}
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+	if (ioctl(s, SIOCGIFINDEX, &ifr) < 0)
+	{
+		fprintf(stderr, "%s: %s\n", ifname, strerror(errno));
+		close(s);
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		perror("bind");
+		close(s);
+		return -1;
+	}
+	return s;
+}
+
+static CAN_IdType CanTrace_FromSocketId(canid_t id)
+{
+	return ((id & CAN_EFF_FLAG) != 0u) ? CAN_MAKE_EXT_ID(id & CAN_EFF_MASK) : CAN_MAKE_STD_ID((uint16_t)(id & CAN_SFF_MASK));
+}
+
+static canid_t CanTrace_ToSocketId(const CanTrace_RecordType* rec)
+{
+	canid_t id = CAN_ID_GET_RAW(rec->Id);
+
+	if (CAN_ID_IS_EXT(rec->Id))
+	{
+		id |= CAN_EFF_FLAG;
+	}
+	if ((rec->Flags & CAN_TRACE_FLAG_RTR) != 0u)
+	{
+		id |= CAN_RTR_FLAG;
+	}
+	return id;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  record
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int CanTrace_Record(int argc, char** argv)
+{
+	uint8_t buf[CAN_TRACE_REC_SIZE];
+	CanTrace_RecordType rec;
+	struct can_frame frame;
+	NetworkHandleType channel = 0u;
+	uint64_t limit = UINT64_MAX;
+	uint64_t count = 0u;
+	uint64_t start;
+	FILE* out;
+	int opt;
+	int s;
+
+	while ((opt = getopt(argc, argv, "c:n:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'c':
+				channel = (NetworkHandleType)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				limit = strtoull(optarg, NULL, 0);
+				break;
+			default:
+				return 2;
+		}
+	}
+	if ((optind + 2) != argc)
+	{
+		fprintf(stderr, "usage: CanTrace record [-c channel] [-n frames] ifname out.trc\n");
+		return 2;
+	}
+
+	s = CanTrace_SocketOpen(argv[optind]);
+	if (s < 0)
+	{
+		return 1;
+	}
+	out = fopen(argv[optind + 1], "wb");
+	if (out == NULL)
+	{
+		perror(argv[optind + 1]);
+		close(s);
+		return 1;
+	}
+	setvbuf(out, NULL, _IOFBF, 1u << 20);
+
+	start = CanTrace_WallUs();
+	(void)CanTrace_HeaderEncode(buf, ECU_UNKNOWN, start);
+	fwrite(buf, 1u, CAN_TRACE_HDR_SIZE, out);
+
+	memset(&rec, 0, sizeof(rec));
+	rec.Channel = channel;
+	while ((count < limit) && (read(s, &frame, sizeof(frame)) == (ssize_t)sizeof(frame)))
+	{
+		if ((frame.can_id & CAN_ERR_FLAG) != 0u)
+		{
+			continue;
+		}
+		rec.TimestampUs = CanTrace_WallUs() - start;
+		rec.Id = CanTrace_FromSocketId(frame.can_id);
+		rec.Dlc = (frame.can_dlc > 8u) ? 8u : frame.can_dlc;
+		rec.Flags = ((frame.can_id & CAN_RTR_FLAG) != 0u) ? CAN_TRACE_FLAG_RTR : 0u;
+		memcpy(rec.Data, frame.data, 8u);
+		CanTrace_RecordEncode(buf, &rec);
+		fwrite(buf, 1u, CAN_TRACE_REC_SIZE, out);
+		count++;
+	}
+
+	fclose(out);
+	close(s);
+	fprintf(stderr, "%llu frames recorded\n", (unsigned long long)count);
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  replay
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int CanTrace_ParseAccept(const char* s, CanFilter_EntryType* e, PduIdType handle)
+{
+	const char* slash = strchr(s, '/');
+	size_t digits = (slash != NULL) ? (size_t)(slash - s) : strlen(s);
+	uint32_t raw = (uint32_t)strtoul(s, NULL, 16);
+
+	e->Id = (digits > 3u) ? CAN_MAKE_EXT_ID(raw) : CAN_MAKE_STD_ID((uint16_t)raw);
+	e->Mask = (slash != NULL) ? (uint32_t)strtoul(slash + 1, NULL, 16) : CAN_FILTER_MASK_EXACT;
+	e->Handle = handle;
+	return 0;
+}
+
+static inline void CanTrace_RxPath(CanTraceRxPath_t* rx, const CanTrace_RecordType* rec)
+{
+	PduIdType handle = CanFilter_Lookup(&rx->Filter, rec->Id);
+
+	if (handle == CAN_FILTER_REJECT)
+	{
+		rx->Rejected++;
+		return;
+	}
+	rx->Hits[handle]++;
+	rx->Bytes += rec->Dlc;
+}
+
+static int CanTrace_Replay(int argc, char** argv)
+{
+	static CanTraceRxPath_t rx;
+	CanFilter_EntryType accept[CAN_TRACE_MAX_ACCEPT];
+	CanTrace_RecordType tmp;
+	CanTraceFile_t tf;
+	struct can_frame frame;
+	struct timespec t0;
+	uint16_t nAccept = 0u;
+	uint64_t loops = 1u;
+	uint64_t frames = 0u;
+	uint64_t maxLateUs = 0u;
+	uint64_t l;
+	uint64_t i;
+	bool timing = false;
+	const char* ifname = NULL;
+	double start;
+	double dt;
+	int s = -1;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "to:a:l:")) != -1)
+	{
+		switch (opt)
+		{
+			case 't':
+				timing = true;
+				break;
+			case 'o':
+				ifname = optarg;
+				break;
+			case 'a':
+				if (nAccept >= CAN_TRACE_MAX_ACCEPT)
+				{
+					fprintf(stderr, "too many -a filters\n");
+					return 2;
+				}
+				(void)CanTrace_ParseAccept(optarg, &accept[nAccept], nAccept);
+				nAccept++;
+				break;
+			case 'l':
+				loops = strtoull(optarg, NULL, 0);
+				break;
+			default:
+				return 2;
+		}
+	}
+	if ((optind + 1) != argc)
+	{
+		fprintf(stderr, "usage: CanTrace replay [-t] [-o ifname] [-a id[/mask]]... [-l loops] in.trc\n");
+		return 2;
+	}
+
+	if (nAccept == 0u)
+	{
+		/* Every standard ID (handle 0) and every extended ID (handle 1). */
+		accept[0].Id = CAN_MAKE_STD_ID(0u);
+		accept[0].Mask = 0u;
+		accept[0].Handle = 0u;
+		accept[1].Id = CAN_MAKE_EXT_ID(0u);
+		accept[1].Mask = 0u;
+		accept[1].Handle = 1u;
+		nAccept = 2u;
+	}
+	if (CanFilter_Build(&rx.Filter, accept, nAccept) != E_OK)
+	{
+		fprintf(stderr, "accept filters do not fit the CAN filter capacity\n");
+		return 2;
+	}
+
+	if (CanTrace_Open(&tf, argv[optind]) != 0)
+	{
+		return 1;
+	}
+	if (ifname != NULL)
+	{
+		s = CanTrace_SocketOpen(ifname);
+		if (s < 0)
+		{
+			CanTrace_Close(&tf);
+			return 1;
+		}
+	}
+
+	start = CanTrace_Now();
+	for (l = 0u; l < loops; l++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		for (i = 0u; i < tf.Count; i++)
+		{
+			const CanTrace_RecordType* rec = CanTrace_At(&tf, i, &tmp);
+
+			if (timing)
+			{
+				struct timespec due;
+				struct timespec now;
+				uint64_t dueNs = ((uint64_t)t0.tv_sec * 1000000000u) + (uint64_t)t0.tv_nsec +
+								 (rec->TimestampUs * 1000u);
+				uint64_t nowNs;
+
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				nowNs = ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+				if (dueNs > (nowNs + 20000u))
+				{
+					due.tv_sec = (time_t)(dueNs / 1000000000u);
+					due.tv_nsec = (long)(dueNs % 1000000000u);
+					(void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+				}
+				else if ((nowNs > dueNs) && (((nowNs - dueNs) / 1000u) > maxLateUs))
+				{
+					maxLateUs = (nowNs - dueNs) / 1000u;
+				}
+			}
+
+			if (s >= 0)
+			{
+				memset(&frame, 0, sizeof(frame));
+				frame.can_id = CanTrace_ToSocketId(rec);
+				frame.can_dlc = rec->Dlc;
+				memcpy(frame.data, rec->Data, 8u);
+				if (write(s, &frame, sizeof(frame)) != (ssize_t)sizeof(frame))
+				{
+					perror("write");
+					break;
+				}
+			}
+			else
+			{
+				CanTrace_RxPath(&rx, rec);
+			}
+		}
+		frames += i;
+	}
+	dt = CanTrace_Now() - start;
+
+	fprintf(stderr, "%llu frames in %.3f s: %.2f Mframes/s", (unsigned long long)frames, dt,
+			((double)frames / 1e6) / ((dt > 0.0) ? dt : 1e-9));
+	if (timing)
+	{
+		fprintf(stderr, ", max lateness %llu us", (unsigned long long)maxLateUs);
+	}
+	fprintf(stderr, "\n");
+	if (s < 0)
+	{
+		fprintf(stderr, "RX path: %llu accepted (%llu bytes), %llu rejected\n",
+				(unsigned long long)(frames - rx.Rejected), (unsigned long long)rx.Bytes,
+				(unsigned long long)rx.Rejected);
+		for (i = 0u; i < nAccept; i++)
+		{
+			fprintf(stderr, "  handle %llu: %llu frames\n", (unsigned long long)i, (unsigned long long)rx.Hits[i]);
+		}
+	}
+	else
+	{
+		close(s);
+	}
+
+	CanTrace_Close(&tf);
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  totext: candump log format
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int CanTrace_ToText(int argc, char** argv)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	CanTrace_RecordType tmp;
+	CanTraceFile_t tf;
+	FILE* out = stdout;
+	char line[64];
+	uint64_t i;
+
+	if ((argc < 2) || (argc > 3))
+	{
+		fprintf(stderr, "usage: CanTrace totext in.trc [out.log]\n");
+		return 2;
+	}
+	if (CanTrace_Open(&tf, argv[1]) != 0)
+	{
+		return 1;
+	}
+	if (argc == 3)
+	{
+		out = fopen(argv[2], "w");
+		if (out == NULL)
+		{
+			perror(argv[2]);
+			CanTrace_Close(&tf);
+			return 1;
+		}
+	}
+	setvbuf(out, NULL, _IOFBF, 1u << 20);
+
+	for (i = 0u; i < tf.Count; i++)
+	{
+		const CanTrace_RecordType* rec = CanTrace_At(&tf, i, &tmp);
+		uint64_t ts = tf.Hdr.StartTimeUs + rec->TimestampUs;
+		int n;
+		uint8_t k;
+
+		n = snprintf(line, sizeof(line), CAN_ID_IS_EXT(rec->Id) ? "(%llu.%06llu) can%u %08X#" :
+																   "(%llu.%06llu) can%u %03X#",
+					 (unsigned long long)(ts / 1000000u), (unsigned long long)(ts % 1000000u),
+					 (unsigned)rec->Channel, (unsigned)CAN_ID_GET_RAW(rec->Id));
+		if ((rec->Flags & CAN_TRACE_FLAG_RTR) != 0u)
+		{
+			line[n++] = 'R';
+		}
+		else
+		{
+			for (k = 0u; (k < rec->Dlc) && (k < 8u); k++)
+			{
+				line[n++] = hex[rec->Data[k] >> 4];
+				line[n++] = hex[rec->Data[k] & 0x0Fu];
+			}
+		}
+		line[n++] = '\n';
+		fwrite(line, 1u, (size_t)n, out);
+	}
+
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	CanTrace_Close(&tf);
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  fromtext: "(sec.usec) ifname ID#DATA" lines, ID with more than 3 hex digits = extended
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int CanTrace_Hex(char c)
+{
+	if ((c >= '0') && (c <= '9'))
+	{
+		return c - '0';
+	}
+	if ((c >= 'a') && (c <= 'f'))
+	{
+		return c - 'a' + 10;
+	}
+	if ((c >= 'A') && (c <= 'F'))
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+static int CanTrace_ParseLine(const char* line, uint64_t* tsUs, CanTrace_RecordType* rec)
+{
+	unsigned long long sec;
+	unsigned long long usec;
+	char ifname[32];
+	char frame[64];
+	const char* p;
+	const char* c;
+	uint32_t raw = 0u;
+	int digits = 0;
+	int h;
+	int l;
+
+	if (sscanf(line, " (%llu.%llu) %31s %63s", &sec, &usec, ifname, frame) != 4)
+	{
+		return -1;
+	}
+	*tsUs = (sec * 1000000u) + usec;
+
+	memset(rec, 0, sizeof(*rec));
+	c = ifname + strlen(ifname);
+	while ((c > ifname) && (c[-1] >= '0') && (c[-1] <= '9'))
+	{
+		c--;
+	}
+	rec->Channel = (NetworkHandleType)strtoul(c, NULL, 10);
+
+	for (p = frame; (*p != '#') && (*p != '\0'); p++)
+	{
+		h = CanTrace_Hex(*p);
+		if (h < 0)
+		{
+			return -1;
+		}
+		raw = (raw << 4) | (uint32_t)h;
+		digits++;
+	}
+	if ((*p != '#') || (digits == 0))
+	{
+		return -1;
+	}
+	rec->Id = (digits > 3) ? CAN_MAKE_EXT_ID(raw) : CAN_MAKE_STD_ID((uint16_t)raw);
+	p++;
+
+	if ((*p == 'R') || (*p == 'r'))
+	{
+		rec->Flags = CAN_TRACE_FLAG_RTR;
+		return 0;
+	}
+	while ((rec->Dlc < 8u) && ((h = CanTrace_Hex(p[0])) >= 0) && ((l = CanTrace_Hex(p[1])) >= 0))
+	{
+		rec->Data[rec->Dlc++] = (uint8_t)((h << 4) | l);
+		p += 2;
+	}
+	return 0;
+}
+
+static int CanTrace_FromText(int argc, char** argv)
+{
+	uint8_t buf[CAN_TRACE_REC_SIZE];
+	CanTrace_RecordType rec;
+	char line[256];
+	uint64_t start = 0u;
+	uint64_t ts;
+	uint64_t count = 0u;
+	uint64_t bad = 0u;
+	bool first = true;
+	FILE* in;
+	FILE* out;
+
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: CanTrace fromtext in.log out.trc\n");
+		return 2;
+	}
+	in = fopen(argv[1], "r");
+	if (in == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	out = fopen(argv[2], "wb");
+	if (out == NULL)
+	{
+		perror(argv[2]);
+		fclose(in);
+		return 1;
+	}
+	setvbuf(out, NULL, _IOFBF, 1u << 20);
+
+	while (fgets(line, sizeof(line), in) != NULL)
+	{
+		if (CanTrace_ParseLine(line, &ts, &rec) != 0)
+		{
+			bad++;
+			continue;
+		}
+		if (first)
+		{
+			/* Header carries the absolute time of the first frame. */
+			start = ts;
+			(void)CanTrace_HeaderEncode(buf, ECU_UNKNOWN, start);
+			fwrite(buf, 1u, CAN_TRACE_HDR_SIZE, out);
+			first = false;
+		}
+		rec.TimestampUs = (ts >= start) ? (ts - start) : 0u;
+		CanTrace_RecordEncode(buf, &rec);
+		fwrite(buf, 1u, CAN_TRACE_REC_SIZE, out);
+		count++;
+	}
+	if (first)
+	{
+		(void)CanTrace_HeaderEncode(buf, ECU_UNKNOWN, 0u);
+		fwrite(buf, 1u, CAN_TRACE_HDR_SIZE, out);
+	}
+
+	fclose(in);
+	fclose(out);
+	fprintf(stderr, "%llu frames converted, %llu lines skipped\n", (unsigned long long)count,
+			(unsigned long long)bad);
+	return 0;
+}
+
+static void CanTrace_Usage(void)
+{
+	fprintf(stderr, "usage: CanTrace record|replay|totext|fromtext ...\n");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		CanTrace_Usage();
+		return 2;
+	}
+
+	if (strcmp(argv[1], "record") == 0)
+	{
+		return CanTrace_Record(argc - 1, &argv[1]);
+	}
+	if (strcmp(argv[1], "replay") == 0)
+	{
+		return CanTrace_Replay(argc - 1, &argv[1]);
+	}
+	if (strcmp(argv[1], "totext") == 0)
+	{
+		return CanTrace_ToText(argc - 1, &argv[1]);
+	}
+	if (strcmp(argv[1], "fromtext") == 0)
+	{
+		return CanTrace_FromText(argc - 1, &argv[1]);
+	}
+
+	CanTrace_Usage();
+	return 2;
+}
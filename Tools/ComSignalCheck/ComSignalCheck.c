@@ -0,0 +1,368 @@
+/* =====================================================================================================================
+ *  File        : ComSignalCheck.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Correctness suite and cycles-per-signal benchmark of Com_Signal.h
+ *                 - Reference: naive bit-by-bit pack/unpack following the DBC bit numbering (Intel: StartBit = LSB,
+ *                   Motorola: StartBit = MSB, bits going down within a byte, bit 0 of byte N followed by bit 7 of
+ *                   byte N+1).
+ *                 - Exhaustive pass on an 8 byte PDU: every start bit, length 1..32, both byte orders, signed and
+ *                   unsigned; Com_SignalCompile must accept exactly the signals that fit.
+ *                 - Random pass on 8 and 64 byte PDUs: random layouts, background and values.
+ *                 - Checks: packed PDU identical to the reference (value truncated, other bits untouched),
+ *                   unpacked value identical (sign extended for signed signals).
+ *                 - Benchmark: an 8 signal group (Intel and Motorola, 1..32 bits) packed and unpacked with the
+ *                   group functions and with the reference; ns and TSC cycles (x86) per signal.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o ComSignalCheck ComSignalCheck.c
+ *  Usage       : ComSignalCheck [-n random] [-b groups] [-s seed]
+ *                  -n  random signals checked (default 2000000)
+ *                  -b  signal groups packed + unpacked in the benchmark (default 10000000)
+ *                  -s  random seed (default 1)
+ *  Example     : ComSignalCheck -n 50000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Com_Signal.h"
+
+#define COM_SIGNAL_CHECK_MAX_PDU	(64u)
+#define COM_SIGNAL_CHECK_GROUP		(8u)
+
+static uint64_t ComSignalCheck_Seed;
+static uint32_t ComSignalCheck_Errors;
+
+static uint32_t ComSignalCheck_Rand(void)
+{
+	ComSignalCheck_Seed ^= ComSignalCheck_Seed >> 12;
+	ComSignalCheck_Seed ^= ComSignalCheck_Seed << 25;
+	ComSignalCheck_Seed ^= ComSignalCheck_Seed >> 27;
+	return (uint32_t)((ComSignalCheck_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double ComSignalCheck_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint64_t ComSignalCheck_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Reference: one bit at a time
+ *  - Bit k of the signal (k = 0 is the LSB) lives at the PDU bit position returned by ComSignalCheck_RefPos.
+ *  - false if a bit falls outside the PDU.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static bool ComSignalCheck_RefPos(const Com_SignalConfigType* cfg, PduLengthType pduLength, uint32_t* pos)
+{
+	uint32_t p = cfg->StartBit;
+	uint8_t k;
+
+	if (cfg->ByteOrder == COM_LITTLE_ENDIAN)
+	{
+		for (k = 0u; k < cfg->Length; k++)
+		{
+			pos[k] = p + k;
+		}
+	}
+	else
+	{
+		/* StartBit is the MSB: walk down inside the byte, then to bit 7 of the next byte */
+		for (k = cfg->Length; k > 0u; k--)
+		{
+			pos[k - 1u] = p;
+			p = ((p % 8u) == 0u) ? (p + 15u) : (p - 1u);
+		}
+	}
+	for (k = 0u; k < cfg->Length; k++)
+	{
+		if ((pos[k] / 8u) >= pduLength)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void ComSignalCheck_RefPack(const Com_SignalConfigType* cfg, const uint32_t* pos, uint8_t* data, uint32_t value)
+{
+	uint8_t k;
+
+	for (k = 0u; k < cfg->Length; k++)
+	{
+		uint8_t bit = (uint8_t)(1u << (pos[k] % 8u));
+
+		if (((value >> k) & 1u) != 0u)
+		{
+			data[pos[k] / 8u] |= bit;
+		}
+		else
+		{
+			data[pos[k] / 8u] &= (uint8_t)~bit;
+		}
+	}
+}
+
+static uint32_t ComSignalCheck_RefUnpack(const Com_SignalConfigType* cfg, const uint32_t* pos, const uint8_t* data)
+{
+	uint32_t value = 0u;
+	uint8_t k;
+
+	for (k = 0u; k < cfg->Length; k++)
+	{
+		if ((data[pos[k] / 8u] & (1u << (pos[k] % 8u))) != 0u)
+		{
+			value |= (1ul << k);
+		}
+	}
+	if (cfg->Signed && ((value >> (cfg->Length - 1u)) & 1u) && (cfg->Length < 32u))
+	{
+		value |= ~((1ul << cfg->Length) - 1u);
+	}
+	return value;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  One signal against the reference: compile, pack, unpack
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void ComSignalCheck_One(const Com_SignalConfigType* cfg, PduLengthType pduLength)
+{
+	uint8_t background[COM_SIGNAL_CHECK_MAX_PDU];
+	uint8_t ref[COM_SIGNAL_CHECK_MAX_PDU];
+	uint8_t out[COM_SIGNAL_CHECK_MAX_PDU];
+	uint32_t pos[COM_SIGNAL_MAX_LENGTH];
+	Com_SignalLayoutType layout;
+	bool fits = ComSignalCheck_RefPos(cfg, pduLength, pos);
+	Std_ReturnType ret = Com_SignalCompile(cfg, pduLength, &layout);
+	uint32_t value;
+	PduLengthType i;
+
+	if (ret != (fits ? E_OK : E_NOT_OK))
+	{
+		fprintf(stderr, "compile: start %u len %u %s, PDU %u: %s\n", cfg->StartBit, cfg->Length,
+				(cfg->ByteOrder == COM_LITTLE_ENDIAN) ? "Intel" : "Motorola", pduLength,
+				fits ? "refused" : "accepted");
+		ComSignalCheck_Errors++;
+		return;
+	}
+	if (!fits)
+	{
+		return;
+	}
+
+	for (i = 0u; i < pduLength; i++)
+	{
+		background[i] = (uint8_t)ComSignalCheck_Rand();
+	}
+	value = ComSignalCheck_Rand();
+
+	memcpy(ref, background, pduLength);
+	memcpy(out, background, pduLength);
+	ComSignalCheck_RefPack(cfg, pos, ref, value);
+	Com_SignalPack(&layout, out, value);
+	if (memcmp(ref, out, pduLength) != 0)
+	{
+		fprintf(stderr, "pack: start %u len %u %s value 0x%08X\n", cfg->StartBit, cfg->Length,
+				(cfg->ByteOrder == COM_LITTLE_ENDIAN) ? "Intel" : "Motorola", value);
+		ComSignalCheck_Errors++;
+	}
+	if ((Com_SignalUnpack(&layout, background) != ComSignalCheck_RefUnpack(cfg, pos, background)) ||
+		(Com_SignalUnpack(&layout, out) != ComSignalCheck_RefUnpack(cfg, pos, ref)))
+	{
+		fprintf(stderr, "unpack: start %u len %u %s%s\n", cfg->StartBit, cfg->Length,
+				(cfg->ByteOrder == COM_LITTLE_ENDIAN) ? "Intel" : "Motorola", cfg->Signed ? " signed" : "");
+		ComSignalCheck_Errors++;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Benchmark group: a typical 8 byte PDU (mixed byte orders and lengths)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static const Com_SignalConfigType ComSignalCheck_GroupCfg[COM_SIGNAL_CHECK_GROUP] =
+{
+	{ 0u, 1u, COM_LITTLE_ENDIAN, false },		/* flag */
+	{ 1u, 3u, COM_LITTLE_ENDIAN, false },		/* state */
+	{ 4u, 12u, COM_LITTLE_ENDIAN, true },		/* temperature */
+	{ 16u, 16u, COM_LITTLE_ENDIAN, false },		/* speed, byte aligned */
+	{ 39u, 10u, COM_BIG_ENDIAN, true },			/* current */
+	{ 45u, 6u, COM_BIG_ENDIAN, false },			/* counter */
+	{ 55u, 4u, COM_BIG_ENDIAN, false },			/* mode */
+	{ 51u, 4u, COM_BIG_ENDIAN, false }			/* checksum nibble */
+};
+
+static void ComSignalCheck_Bench(uint32_t groups)
+{
+	Com_SignalLayoutType layout[COM_SIGNAL_CHECK_GROUP];
+	uint32_t pos[COM_SIGNAL_CHECK_GROUP][COM_SIGNAL_MAX_LENGTH];
+	Com_SignalGroupType group;
+	uint8_t data[8] = { 0u };
+	PduInfoType pdu;
+	uint32_t values[COM_SIGNAL_CHECK_GROUP];
+	uint32_t back[COM_SIGNAL_CHECK_GROUP];
+	volatile uint32_t sink = 0u;
+	double t0;
+	double tEngine;
+	double tRef;
+	uint64_t c0;
+	uint64_t cEngine;
+	uint64_t cRef;
+	uint64_t signals = (uint64_t)groups * COM_SIGNAL_CHECK_GROUP * 2u;
+	uint32_t n;
+	uint8_t i;
+
+	for (i = 0u; i < COM_SIGNAL_CHECK_GROUP; i++)
+	{
+		if ((Com_SignalCompile(&ComSignalCheck_GroupCfg[i], sizeof(data), &layout[i]) != E_OK) ||
+			!ComSignalCheck_RefPos(&ComSignalCheck_GroupCfg[i], sizeof(data), pos[i]))
+		{
+			fprintf(stderr, "benchmark signal %u does not fit\n", i);
+			ComSignalCheck_Errors++;
+			return;
+		}
+		values[i] = ComSignalCheck_Rand();
+	}
+	group.Layout = layout;
+	group.Count = COM_SIGNAL_CHECK_GROUP;
+	pdu.SduDataPtr = data;
+	pdu.MetaDataPtr = NULL;
+	pdu.SduLength = sizeof(data);
+
+	t0 = ComSignalCheck_Now();
+	c0 = ComSignalCheck_Cycles();
+	for (n = 0u; n < groups; n++)
+	{
+		values[n % COM_SIGNAL_CHECK_GROUP] += n;
+		Com_SignalGroupPack(&group, values, &pdu);
+		Com_SignalGroupUnpack(&group, &pdu, back);
+		sink += back[n % COM_SIGNAL_CHECK_GROUP];
+	}
+	cEngine = ComSignalCheck_Cycles() - c0;
+	tEngine = ComSignalCheck_Now() - t0;
+
+	/* The reference is much slower: a tenth of the groups */
+	t0 = ComSignalCheck_Now();
+	c0 = ComSignalCheck_Cycles();
+	for (n = 0u; n < (groups / 10u); n++)
+	{
+		values[n % COM_SIGNAL_CHECK_GROUP] += n;
+		for (i = 0u; i < COM_SIGNAL_CHECK_GROUP; i++)
+		{
+			ComSignalCheck_RefPack(&ComSignalCheck_GroupCfg[i], pos[i], data, values[i]);
+		}
+		for (i = 0u; i < COM_SIGNAL_CHECK_GROUP; i++)
+		{
+			back[i] = ComSignalCheck_RefUnpack(&ComSignalCheck_GroupCfg[i], pos[i], data);
+		}
+		sink += back[n % COM_SIGNAL_CHECK_GROUP];
+	}
+	cRef = (ComSignalCheck_Cycles() - c0) * 10u;
+	tRef = (ComSignalCheck_Now() - t0) * 10.0;
+	(void)sink;
+
+	printf("benchmark       : %u groups of %u signals, pack + unpack\n", groups, COM_SIGNAL_CHECK_GROUP);
+	printf("%-10s %12s %16s\n", "", "ns/signal", "cycles/signal");
+	printf("%-10s %12.2f %16.2f\n", "engine", (tEngine * 1e9) / (double)signals,
+		   (double)cEngine / (double)signals);
+	printf("%-10s %12.2f %16.2f\n", "bitwise", (tRef * 1e9) / (double)signals, (double)cRef / (double)signals);
+	printf("speedup         : %.1fx\n", tRef / tEngine);
+}
+
+static void ComSignalCheck_Usage(void)
+{
+	fprintf(stderr, "usage: ComSignalCheck [-n random] [-b groups] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	Com_SignalConfigType cfg;
+	uint32_t randomCount = 2000000u;
+	uint32_t groups = 10000000u;
+	uint32_t exhaustive = 0u;
+	uint32_t start;
+	uint32_t len;
+	uint32_t order;
+	uint32_t n;
+	int o;
+
+	ComSignalCheck_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:b:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				randomCount = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				groups = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				ComSignalCheck_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				ComSignalCheck_Usage();
+				return 2;
+		}
+	}
+	if (groups == 0u)
+	{
+		ComSignalCheck_Usage();
+		return 2;
+	}
+	ComSignalCheck_Errors = 0u;
+
+	/* Exhaustive: 8 byte PDU, every layout (including the ones that do not fit) */
+	for (order = 0u; order < 2u; order++)
+	{
+		for (start = 0u; start < 64u; start++)
+		{
+			for (len = 1u; len <= COM_SIGNAL_MAX_LENGTH; len++)
+			{
+				cfg.StartBit = (uint16_t)start;
+				cfg.Length = (uint8_t)len;
+				cfg.ByteOrder = (order == 0u) ? COM_LITTLE_ENDIAN : COM_BIG_ENDIAN;
+				cfg.Signed = false;
+				ComSignalCheck_One(&cfg, 8u);
+				cfg.Signed = true;
+				ComSignalCheck_One(&cfg, 8u);
+				exhaustive += 2u;
+			}
+		}
+	}
+	printf("exhaustive      : %u layouts on an 8 byte PDU\n", exhaustive);
+
+	/* Random: 8 and 64 byte PDUs */
+	for (n = 0u; n < randomCount; n++)
+	{
+		uint32_t r = ComSignalCheck_Rand();
+		PduLengthType pduLength = ((r & 1u) != 0u) ? 8u : COM_SIGNAL_CHECK_MAX_PDU;
+
+		cfg.StartBit = (uint16_t)((r >> 1) % (pduLength * 8u));
+		cfg.Length = (uint8_t)(1u + ((r >> 10) % COM_SIGNAL_MAX_LENGTH));
+		cfg.ByteOrder = ((r & 0x8000u) != 0u) ? COM_BIG_ENDIAN : COM_LITTLE_ENDIAN;
+		cfg.Signed = ((r & 0x10000u) != 0u);
+		ComSignalCheck_One(&cfg, pduLength);
+	}
+	printf("random          : %u signals on 8 / %u byte PDUs\n", randomCount, COM_SIGNAL_CHECK_MAX_PDU);
+
+	ComSignalCheck_Bench(groups);
+	printf("errors          : %u\n", ComSignalCheck_Errors);
+	return (ComSignalCheck_Errors == 0u) ? 0 : 1;
+}
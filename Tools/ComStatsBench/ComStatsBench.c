@@ -0,0 +1,287 @@
+/* =====================================================================================================================
+ *  File        : ComStatsBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Overhead and consistency of the lock-free communication statistics (ComStats.h)
+ *                 - Update cost: ns per frame (ComStats_TxFrame + ComStats_Notif, every 16th ComStats_BufResult),
+ *                   single thread, against plain (non atomic, not ISR safe) increments of the same layout.
+ *                 - Concurrency: T writer threads (standing in for the CAN TX/RX ISRs) update both channels and
+ *                   their PDUs while the main thread takes snapshots as a diagnostic task would.
+ *                 - Checks: snapshots never go backwards, a consistent snapshot (E_OK) is never torn (bytes = 8 x
+ *                   frames up to one update in progress per writer), final counters exact, rates of a known load exact.
+ *                 - Report: ns per update (alone and contended), ns per snapshot, E_OK ratio, RAM of the counters.
+ *  Build       : cc -O2 -std=gnu11 -pthread -I../../Inc -o ComStatsBench ComStatsBench.c
+ *  Usage       : ComStatsBench [-t threads] [-n updates]
+ *                  -t  writer threads (1..COMSTATS_BENCH_MAX_THREADS, default 2)
+ *                  -n  frames per writer (default 5000000)
+ *  Example     : ComStatsBench -t 4 -n 20000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ComStats.h"
+
+#define COMSTATS_BENCH_MAX_THREADS	(8u)
+#define COMSTATS_BENCH_LEN			(8u)
+
+typedef struct
+{
+	pthread_t	Thread;
+	uint32_t	Frames;
+}ComStatsBenchThread_t;
+
+/* Same layout without atomics: the cost floor of counting at all */
+typedef struct
+{
+	uint32_t	Channel[COMSTATS_MAX_CHANNELS][COMSTATS_CH_COUNTERS + 1u];
+	uint32_t	Pdu[COMSTATS_MAX_PDU][COMSTATS_PDU_COUNTERS];
+}ComStatsBenchPlain_t;
+
+static ComStats_Type ComStatsBench_Stats;
+static ComStatsBenchPlain_t ComStatsBench_Plain;
+static ComStatsBenchThread_t ComStatsBench_Thread[COMSTATS_BENCH_MAX_THREADS];
+static atomic_uint ComStatsBench_Running;
+
+static uint64_t ComStatsBench_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* One "frame" of the workload: TX frame, its confirmation and every 16th a buffer BUSY answer */
+static inline void ComStatsBench_Update(uint32_t n)
+{
+	NetworkHandleType ch = (NetworkHandleType)(n & 1u);
+	PduIdType pdu = (PduIdType)(n % COMSTATS_MAX_PDU);
+
+	ComStats_TxFrame(&ComStatsBench_Stats, ch, pdu, COMSTATS_BENCH_LEN);
+	ComStats_Notif(&ComStatsBench_Stats, ch, pdu, NTFRSLT_OK);
+	if ((n & 15u) == 0u)
+	{
+		ComStats_BufResult(&ComStatsBench_Stats, ch, pdu, BUFREQ_E_BUSY);
+	}
+}
+
+static inline void ComStatsBench_PlainUpdate(volatile ComStatsBenchPlain_t* s, uint32_t n)
+{
+	uint32_t ch = n & 1u;
+	uint32_t pdu = n % COMSTATS_MAX_PDU;
+
+	s->Channel[ch][COMSTATS_TX_FRAMES]++;
+	s->Channel[ch][COMSTATS_TX_BYTES] += COMSTATS_BENCH_LEN;
+	s->Pdu[pdu][COMSTATS_TX_FRAMES]++;
+	s->Pdu[pdu][COMSTATS_TX_BYTES] += COMSTATS_BENCH_LEN;
+	s->Channel[ch][COMSTATS_CH_NOTIF + (uint32_t)NTFRSLT_OK]++;
+	if ((n & 15u) == 0u)
+	{
+		s->Channel[ch][COMSTATS_BUF_BUSY]++;
+		s->Pdu[pdu][COMSTATS_BUF_BUSY]++;
+	}
+}
+
+static void* ComStatsBench_Writer(void* arg)
+{
+	const ComStatsBenchThread_t* t = (const ComStatsBenchThread_t*)arg;
+	uint32_t n;
+
+	for (n = 0u; n < t->Frames; n++)
+	{
+		ComStatsBench_Update(n);
+	}
+	(void)atomic_fetch_sub(&ComStatsBench_Running, 1u);
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Snapshot checks: monotonic, and frames / bytes in step up to one update in flight per writer
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t ComStatsBench_CheckSnapshot(const ComStats_ChannelSnapshotType* prev,
+											const ComStats_ChannelSnapshotType* cur, bool consistent, uint32_t threads)
+{
+	uint32_t errors = 0u;
+	uint16_t k;
+
+	for (k = 0u; k < (uint16_t)COMSTATS_CH_COUNTERS; k++)
+	{
+		errors += (cur->Counter[k] < prev->Counter[k]) ? 1u : 0u;
+	}
+	if (consistent)
+	{
+		uint32_t expect = cur->Counter[COMSTATS_TX_FRAMES] * COMSTATS_BENCH_LEN;
+
+		errors += ((cur->Counter[COMSTATS_TX_BYTES] > expect) ||
+				   ((expect - cur->Counter[COMSTATS_TX_BYTES]) > (threads * COMSTATS_BENCH_LEN))) ? 1u : 0u;
+	}
+	return errors;
+}
+
+/* Rates of a known load: 1000 frames of 8 bytes and 10 errors in 1 s at 500 kbit/s */
+static uint32_t ComStatsBench_CheckRates(void)
+{
+	ComStats_ChannelSnapshotType a;
+	ComStats_ChannelSnapshotType b;
+	ComStats_RateType rate;
+	uint32_t bits = (1000u * COMSTATS_FRAME_OVERHEAD_BITS) + ((8000u * COMSTATS_BYTE_BITS_X10) / 10u);
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	a.Counter[COMSTATS_TX_FRAMES] = 0xFFFFFF00u;		/* Wraps between the two snapshots. */
+	b.Counter[COMSTATS_TX_FRAMES] = 0xFFFFFF00u + 1000u;
+	b.Counter[COMSTATS_TX_BYTES] = 8000u;
+	b.Counter[COMSTATS_CH_NOTIF + (uint8_t)NTFRSLT_OK] = 990u;
+	b.Counter[COMSTATS_CH_NOTIF + (uint8_t)NTFRSLT_E_TIMEOUT_A] = 6u;
+	b.Counter[COMSTATS_BUF_OVFL] = 4u;
+	ComStats_ComputeRates(&a, &b, 1000u, 500000u, &rate);
+	printf("rates           : %u TX frames/s, %u errors/s, bus load %u permille (expected 1000, 10, %u)\n",
+		   rate.TxFramesPerSec, rate.ErrorsPerSec, rate.BusLoadPermille, bits / 500u);
+	return ((rate.TxFramesPerSec != 1000u) || (rate.ErrorsPerSec != 10u) ||
+			(rate.BusLoadPermille != (bits / 500u))) ? 1u : 0u;
+}
+
+static void ComStatsBench_Usage(void)
+{
+	fprintf(stderr, "usage: ComStatsBench [-t threads] [-n updates]\n");
+}
+
+int main(int argc, char** argv)
+{
+	ComStats_ChannelSnapshotType prev[COMSTATS_MAX_CHANNELS];
+	ComStats_ChannelSnapshotType cur;
+	uint32_t threads = 2u;
+	uint32_t frames = 5000000u;
+	uint64_t snapshots = 0u;
+	uint64_t consistent = 0u;
+	uint64_t snapNs = 0u;
+	uint64_t total;
+	uint64_t t0;
+	double plainNs;
+	double aloneNs;
+	double loadedNs;
+	uint32_t errors = 0u;
+	uint32_t i;
+	int o;
+
+	while ((o = getopt(argc, argv, "t:n:")) != -1)
+	{
+		switch (o)
+		{
+			case 't':
+				threads = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				frames = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				ComStatsBench_Usage();
+				return 2;
+		}
+	}
+	if ((threads == 0u) || (threads > COMSTATS_BENCH_MAX_THREADS) || (frames == 0u) ||
+		(((uint64_t)frames * threads * COMSTATS_BENCH_LEN) > 0xFFFFFFFFull))
+	{
+		ComStatsBench_Usage();
+		return 2;
+	}
+
+	/* Single thread cost against plain increments */
+	t0 = ComStatsBench_NowNs();
+	for (i = 0u; i < frames; i++)
+	{
+		ComStatsBench_PlainUpdate(&ComStatsBench_Plain, i);
+	}
+	plainNs = (double)(ComStatsBench_NowNs() - t0) / (double)frames;
+
+	ComStats_Init(&ComStatsBench_Stats);
+	t0 = ComStatsBench_NowNs();
+	for (i = 0u; i < frames; i++)
+	{
+		ComStatsBench_Update(i);
+	}
+	aloneNs = (double)(ComStatsBench_NowNs() - t0) / (double)frames;
+
+	/* Concurrent writers + snapshot reader */
+	ComStats_Init(&ComStatsBench_Stats);
+	memset(prev, 0, sizeof(prev));
+	atomic_store(&ComStatsBench_Running, threads);
+	t0 = ComStatsBench_NowNs();
+	for (i = 0u; i < threads; i++)
+	{
+		ComStatsBench_Thread[i].Frames = frames;
+		if (pthread_create(&ComStatsBench_Thread[i].Thread, NULL, ComStatsBench_Writer, &ComStatsBench_Thread[i]) != 0)
+		{
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+	while (atomic_load(&ComStatsBench_Running) != 0u)
+	{
+		NetworkHandleType ch = (NetworkHandleType)(snapshots & 1u);
+		uint64_t s0 = ComStatsBench_NowNs();
+		bool ok = (ComStats_SnapshotChannel(&ComStatsBench_Stats, ch, &cur) == E_OK);
+
+		snapNs += ComStatsBench_NowNs() - s0;
+		snapshots++;
+		consistent += ok ? 1u : 0u;
+		errors += ComStatsBench_CheckSnapshot(&prev[ch], &cur, ok, threads);
+		prev[ch] = cur;
+		sched_yield();
+	}
+	for (i = 0u; i < threads; i++)
+	{
+		(void)pthread_join(ComStatsBench_Thread[i].Thread, NULL);
+	}
+	loadedNs = (double)(ComStatsBench_NowNs() - t0) / ((double)frames * threads);
+
+	/* Final totals: every writer counted each frame once on its channel and PDU */
+	total = (uint64_t)frames * threads;
+	for (i = 0u; i < COMSTATS_MAX_CHANNELS; i++)
+	{
+		uint64_t expFrames = (uint64_t)((frames + 1u - i) / 2u) * threads;
+
+		if ((ComStats_SnapshotChannel(&ComStatsBench_Stats, (NetworkHandleType)i, &cur) != E_OK) ||
+			(cur.Counter[COMSTATS_TX_FRAMES] != expFrames) ||
+			(cur.Counter[COMSTATS_TX_BYTES] != (expFrames * COMSTATS_BENCH_LEN)) ||
+			(cur.Counter[COMSTATS_CH_NOTIF + (uint8_t)NTFRSLT_OK] != expFrames))
+		{
+			fprintf(stderr, "channel %u: %u frames, %u bytes, expected %llu\n", i, cur.Counter[COMSTATS_TX_FRAMES],
+					cur.Counter[COMSTATS_TX_BYTES], (unsigned long long)expFrames);
+			errors++;
+		}
+	}
+	for (i = 0u; i < COMSTATS_MAX_PDU; i++)
+	{
+		ComStats_PduSnapshotType pdu;
+		uint64_t expFrames = (uint64_t)((frames + COMSTATS_MAX_PDU - 1u - i) / COMSTATS_MAX_PDU) * threads;
+
+		if ((ComStats_SnapshotPdu(&ComStatsBench_Stats, (PduIdType)i, &pdu) != E_OK) ||
+			(pdu.Counter[COMSTATS_TX_FRAMES] != expFrames) || (pdu.Counter[COMSTATS_PDU_NOTIF_ERRORS] != 0u))
+		{
+			fprintf(stderr, "PDU %u: %u frames, expected %llu\n", i, pdu.Counter[COMSTATS_TX_FRAMES],
+					(unsigned long long)expFrames);
+			errors++;
+		}
+	}
+
+	printf("%u writer(s) x %u frames (%llu updates of channel + PDU counters)\n", threads, frames,
+		   (unsigned long long)total);
+	printf("update          : %.1f ns/frame plain, %.1f ns/frame atomic, %.1f ns/frame contended\n", plainNs,
+		   aloneNs, loadedNs);
+	printf("snapshot        : %llu taken, %.1f ns each, %.1f%% consistent (E_OK)\n", (unsigned long long)snapshots,
+		   (snapshots != 0u) ? ((double)snapNs / (double)snapshots) : 0.0,
+		   (snapshots != 0u) ? ((100.0 * (double)consistent) / (double)snapshots) : 0.0);
+	errors += ComStatsBench_CheckRates();
+	printf("RAM             : %zu bytes (%u channels, %u PDUs)\n", sizeof(ComStats_Type), COMSTATS_MAX_CHANNELS,
+		   COMSTATS_MAX_PDU);
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
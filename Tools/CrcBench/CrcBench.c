@@ -0,0 +1,271 @@
+/* =====================================================================================================================
+ *  File        : CrcBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Conformance and speed of the CRC library (Crc.h) for one kernel mode
+ *                 - The mode is picked at compile time (CRC_BENCH_MODE sets CRC_8/8H2F/16/32_MODE), one binary per
+ *                   mode: build and run the loop below to cover the five modes.
+ *                 - Checks: check value of "123456789" for the four algorithms, random buffers of 0..300 bytes
+ *                   against the bitwise kernel (no table), in one call and streamed in two chunks (IsFirstCall false).
+ *                 - Report per algorithm: MB/s and bytes per TSC cycle (x86) on 8, 64 and 4095 byte buffers (CAN
+ *                   frame, CAN-FD / E2E, full TP message), and the table flash of the mode.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -DCRC_BENCH_MODE=2 -o CrcBench CrcBench.c
+ *                (CRC_BENCH_MODE 0 bitwise, 1 nibble, 2 table, 3 slice4, 4 slice8; default 2)
+ *                All modes:
+ *                  for m in 0 1 2 3 4; do cc -O2 -std=gnu11 -I../../Inc -DCRC_BENCH_MODE=$m -o CrcBench$m CrcBench.c
+ *                  && ./CrcBench$m || echo "mode $m FAILED"; done
+ *  Usage       : CrcBench [-n bytes] [-s seed]
+ *                  -n  bytes hashed per measurement (default 200000000)
+ *                  -s  random seed (default 1)
+ *  Example     : CrcBench -n 1000000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#ifndef CRC_BENCH_MODE
+#define CRC_BENCH_MODE		(2u)
+#endif
+
+#define CRC_8_MODE			CRC_BENCH_MODE
+#define CRC_8H2F_MODE		CRC_BENCH_MODE
+#define CRC_16_MODE			CRC_BENCH_MODE
+#define CRC_32_MODE			CRC_BENCH_MODE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Crc.h"
+
+#define CRC_BENCH_RANDOM			(20000u)
+#define CRC_BENCH_RANDOM_MAX		(300u)
+#define CRC_BENCH_BUF				(4096u)
+
+typedef enum
+{
+	CRCBENCH_CRC8 = 0,
+	CRCBENCH_CRC8H2F,
+	CRCBENCH_CRC16,
+	CRCBENCH_CRC32,
+	CRCBENCH_COUNT
+}CrcBenchAlgo_t;
+
+static const char* const CrcBench_ModeName[] = { "bitwise", "nibble", "table", "slice4", "slice8" };
+static const char* const CrcBench_AlgoName[CRCBENCH_COUNT] = { "CRC-8", "CRC-8H2F", "CRC-16", "CRC-32" };
+static const uint32_t CrcBench_Sizes[] = { 8u, 64u, 4095u };
+
+static uint8_t CrcBench_Buf[CRC_BENCH_BUF];
+static uint64_t CrcBench_Seed;
+
+static uint32_t CrcBench_Rand(void)
+{
+	CrcBench_Seed ^= CrcBench_Seed >> 12;
+	CrcBench_Seed ^= CrcBench_Seed << 25;
+	CrcBench_Seed ^= CrcBench_Seed >> 27;
+	return (uint32_t)((CrcBench_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double CrcBench_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint64_t CrcBench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Configured API and bitwise reference, by algorithm
+ *  - CrcBench_Api: one call, or two chunks split at k (streamed).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t CrcBench_Api(CrcBenchAlgo_t a, const uint8_t* p, uint32_t len, uint32_t k)
+{
+	switch (a)
+	{
+		case CRCBENCH_CRC8:
+			return Crc_CalculateCRC8(&p[k], len - k, Crc_CalculateCRC8(p, k, 0u, true), (k == 0u));
+		case CRCBENCH_CRC8H2F:
+			return Crc_CalculateCRC8H2F(&p[k], len - k, Crc_CalculateCRC8H2F(p, k, 0u, true), (k == 0u));
+		case CRCBENCH_CRC16:
+			return Crc_CalculateCRC16(&p[k], len - k, Crc_CalculateCRC16(p, k, 0u, true), (k == 0u));
+		default:
+			return Crc_CalculateCRC32(&p[k], len - k, Crc_CalculateCRC32(p, k, 0u, true), (k == 0u));
+	}
+}
+
+static uint32_t CrcBench_Reference(CrcBenchAlgo_t a, const uint8_t* p, uint32_t len)
+{
+	switch (a)
+	{
+		case CRCBENCH_CRC8:
+			return (uint8_t)(Crc_8Bitwise(CRC_8_INIT, CRC_8_POLY, p, len) ^ CRC_8_XOR);
+		case CRCBENCH_CRC8H2F:
+			return (uint8_t)(Crc_8Bitwise(CRC_8H2F_INIT, CRC_8H2F_POLY, p, len) ^ CRC_8H2F_XOR);
+		case CRCBENCH_CRC16:
+			return (uint16_t)(Crc_16Bitwise(CRC_16_INIT, CRC_16_POLY, p, len) ^ CRC_16_XOR);
+		default:
+			return Crc_32Bitwise(CRC_32_INIT, CRC_32_POLY, p, len) ^ CRC_32_XOR;
+	}
+}
+
+/* Flash of the tables this mode compiles in */
+static uint32_t CrcBench_TableBytes(CrcBenchAlgo_t a)
+{
+#if (CRC_BENCH_MODE == CRC_MODE_NIBBLE)
+	static const uint32_t bytes[CRCBENCH_COUNT] =
+	{
+		sizeof(Crc_Nibble8), sizeof(Crc_Nibble8H2F), sizeof(Crc_Nibble16), sizeof(Crc_Nibble32)
+	};
+#elif (CRC_BENCH_MODE >= CRC_MODE_TABLE)
+	static const uint32_t bytes[CRCBENCH_COUNT] =
+	{
+		sizeof(Crc_Table8), sizeof(Crc_Table8H2F), sizeof(Crc_Table16), sizeof(Crc_Table32)
+	};
+#else
+	static const uint32_t bytes[CRCBENCH_COUNT] = { 0u, 0u, 0u, 0u };
+#endif
+
+	return bytes[a];
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Conformance: check values, random buffers in one call and streamed
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t CrcBench_Check(void)
+{
+	static const uint32_t check[CRCBENCH_COUNT] = { CRC_8_CHECK, CRC_8H2F_CHECK, CRC_16_CHECK, CRC_32_CHECK };
+	const uint8_t* s = (const uint8_t*)"123456789";
+	uint32_t errors = 0u;
+	uint32_t a;
+	uint32_t n;
+
+	for (a = 0u; a < CRCBENCH_COUNT; a++)
+	{
+		uint32_t v = CrcBench_Api((CrcBenchAlgo_t)a, s, 9u, 0u);
+
+		printf("%-9s check   : 0x%08X (expected 0x%08X)\n", CrcBench_AlgoName[a], v, check[a]);
+		if ((v != check[a]) || (CrcBench_Reference((CrcBenchAlgo_t)a, s, 9u) != check[a]))
+		{
+			errors++;
+		}
+	}
+
+	for (n = 0u; n < CRC_BENCH_RANDOM; n++)
+	{
+		uint32_t len = CrcBench_Rand() % (CRC_BENCH_RANDOM_MAX + 1u);
+		uint32_t k = CrcBench_Rand() % (len + 1u);
+		uint32_t i;
+
+		for (i = 0u; i < len; i++)
+		{
+			CrcBench_Buf[i] = (uint8_t)CrcBench_Rand();
+		}
+		for (a = 0u; a < CRCBENCH_COUNT; a++)
+		{
+			uint32_t ref = CrcBench_Reference((CrcBenchAlgo_t)a, CrcBench_Buf, len);
+
+			if ((CrcBench_Api((CrcBenchAlgo_t)a, CrcBench_Buf, len, 0u) != ref) ||
+				(CrcBench_Api((CrcBenchAlgo_t)a, CrcBench_Buf, len, k) != ref))
+			{
+				fprintf(stderr, "%s: %u bytes (split at %u) differs from the bitwise kernel\n", CrcBench_AlgoName[a],
+						len, k);
+				errors++;
+			}
+		}
+	}
+	printf("random          : %u buffers of 0..%u bytes, one call and streamed\n", CRC_BENCH_RANDOM,
+		   CRC_BENCH_RANDOM_MAX);
+	return errors;
+}
+
+static void CrcBench_Usage(void)
+{
+	fprintf(stderr, "usage: CrcBench [-n bytes] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint64_t bytes = 200000000u;
+	uint32_t errors;
+	uint32_t a;
+	uint32_t s;
+	uint32_t i;
+	int o;
+
+	CrcBench_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				bytes = strtoull(optarg, NULL, 0);
+				break;
+			case 's':
+				CrcBench_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				CrcBench_Usage();
+				return 2;
+		}
+	}
+	if (bytes == 0u)
+	{
+		CrcBench_Usage();
+		return 2;
+	}
+
+	printf("mode            : %s (CRC_BENCH_MODE %u)\n", CrcBench_ModeName[CRC_BENCH_MODE], (unsigned)CRC_BENCH_MODE);
+	errors = CrcBench_Check();
+
+	for (i = 0u; i < CRC_BENCH_BUF; i++)
+	{
+		CrcBench_Buf[i] = (uint8_t)CrcBench_Rand();
+	}
+	printf("%-9s %7s %6s %12s %12s\n", "algorithm", "table", "buffer", "MB/s", "bytes/cycle");
+	for (a = 0u; a < CRCBENCH_COUNT; a++)
+	{
+		for (s = 0u; s < (sizeof(CrcBench_Sizes) / sizeof(CrcBench_Sizes[0])); s++)
+		{
+			uint32_t len = CrcBench_Sizes[s];
+			uint64_t calls = (bytes / len) + 1u;
+			/* The bitwise kernel is about 8x slower: fewer bytes, same buffers */
+			uint64_t runs = (CRC_BENCH_MODE == CRC_MODE_BITWISE) ? ((calls / 8u) + 1u) : calls;
+			volatile uint32_t sink = 0u;
+			uint64_t c0;
+			uint64_t cycles;
+			double t0;
+			double sec;
+			uint64_t n;
+
+			t0 = CrcBench_Now();
+			c0 = CrcBench_Cycles();
+			for (n = 0u; n < runs; n++)
+			{
+				CrcBench_Buf[0] = (uint8_t)n;
+				sink += CrcBench_Api((CrcBenchAlgo_t)a, CrcBench_Buf, len, 0u);
+			}
+			cycles = CrcBench_Cycles() - c0;
+			sec = CrcBench_Now() - t0;
+			(void)sink;
+
+			printf("%-9s %7u %6u %12.1f %12.3f\n", CrcBench_AlgoName[a], CrcBench_TableBytes((CrcBenchAlgo_t)a), len,
+				   (((double)runs * len) / sec) * 1e-6, (cycles != 0u) ? (((double)runs * len) / (double)cycles) : 0.0);
+		}
+	}
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+/* =====================================================================================================================
+ *  File        : DetStress.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Memory and per-report cost of the deduplicating Det (Det.h) under a million reports
+ *                 - Repeat: the same error on every report (a driver failing in its 1 ms loop).
+ *                 - Working set: DET_TABLE_SIZE distinct errors in turn, every one counted.
+ *                 - Overflow: 4 x DET_TABLE_SIZE distinct errors at random, the table fills, the rest goes to the ring.
+ *                 - Checks: exact report / distinct / lost counters, counts and first / last timestamps, one log
+ *                   record per counted error, ring holding the most recent distinct errors, no RAM growth (Det_Type
+ *                   size, process resident set unchanged).
+ *                 - Report: ns and TSC cycles (x86) per report, log records against one per report without Det.
+ *                 - Release build (-DDET_STRESS_RELEASE, DET_ENABLE 0): DET_REPORT_ERROR must expand to nothing.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o DetStress DetStress.c
+ *                cc -O2 -std=gnu11 -I../../Inc -DDET_STRESS_RELEASE -o DetStressRelease DetStress.c
+ *  Usage       : DetStress [-n reports] [-s seed]
+ *                  -n  reports per scenario (default 1000000)
+ *                  -s  random seed (default 1)
+ *  Example     : DetStress -n 100000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#ifdef DET_STRESS_RELEASE
+#define DET_ENABLE					(0)
+#else
+#define DET_ENABLE					(1)
+#endif
+
+/* Det first occurrence log through LogToken, captured by DetStress_Emit */
+#define ENABLE_UART_LOG				(1)
+#define LOG_FMT_TABLE(X)			X(DET_ERR, "det mod=%u inst=%u api=%u err=%u")
+#define DET_LOG_FMT_ERROR			LOG_FMT_DET_ERR
+#define LOG_TOKEN_EMIT(_buf_, _len_)	DetStress_Emit((_buf_), (_len_))
+#define DET_TIMESTAMP()				(DetStress_Tick)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint32_t DetStress_Tick;
+#if !defined(DET_STRESS_RELEASE)
+static uint32_t DetStress_Logs;
+static void DetStress_Emit(const uint8_t* buf, uint8_t len);
+#endif
+
+#include "Std_Types.h"
+#include "Det.h"
+
+#define DETSTRESS_STR2(x)			#x
+#define DETSTRESS_STR(x)			DETSTRESS_STR2(x)
+
+static uint64_t DetStress_Seed;
+
+#if (DET_ENABLE == 1)
+#define DETSTRESS_SET				(4u * DET_TABLE_SIZE)
+
+typedef enum
+{
+	DETSTRESS_REPEAT = 0,
+	DETSTRESS_WORKING_SET,
+	DETSTRESS_OVERFLOW,
+	DETSTRESS_COUNT
+}DetStressScenario_t;
+
+static const char* const DetStress_Name[DETSTRESS_COUNT] = { "repeat", "working set", "overflow" };
+
+Det_Type Det_Instance;
+static uint16_t DetStress_Pick[DETSTRESS_SET];
+
+static void DetStress_Emit(const uint8_t* buf, uint8_t len)
+{
+	(void)buf;
+	(void)len;
+	DetStress_Logs++;
+}
+
+static uint32_t DetStress_Rand(void)
+{
+	DetStress_Seed ^= DetStress_Seed >> 12;
+	DetStress_Seed ^= DetStress_Seed << 25;
+	DetStress_Seed ^= DetStress_Seed >> 27;
+	return (uint32_t)((DetStress_Seed * 2685821657736338717ull) >> 32);
+}
+
+static uint64_t DetStress_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+#endif
+
+static uint64_t DetStress_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* Resident pages of the process (/proc/self/statm), 0 when unknown */
+static unsigned long DetStress_Resident(void)
+{
+	unsigned long size = 0u;
+	unsigned long resident = 0u;
+	FILE* f = fopen("/proc/self/statm", "r");
+
+	if (f != NULL)
+	{
+		if (fscanf(f, "%lu %lu", &size, &resident) != 2)
+		{
+			resident = 0u;
+		}
+		(void)fclose(f);
+	}
+	return resident;
+}
+
+#if (DET_ENABLE == 1)
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Errors of the scenarios: module IDs of the stack, distinct (instance, API, error) per index
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void DetStress_Error(uint32_t i, Det_ErrorIdType* id)
+{
+	static const uint16_t modules[] = { 51u, 60u, 35u, 50u, 80u, 81u, 255u, 15u };
+
+	id->ModuleId = modules[i % 8u];
+	id->InstanceId = (uint8_t)(i / 8u);
+	id->ApiId = (uint8_t)(0x10u + (i % 3u));
+	id->ErrorId = (uint8_t)(1u + (i % 5u));
+}
+
+static uint32_t DetStress_Run(DetStressScenario_t sc, uint32_t reports)
+{
+	static uint32_t expected[DETSTRESS_SET];
+	static uint32_t firstTime[DETSTRESS_SET];
+	static uint32_t lastTime[DETSTRESS_SET];
+	uint32_t set = (sc == DETSTRESS_REPEAT) ? 1u : ((sc == DETSTRESS_WORKING_SET) ? DET_TABLE_SIZE : DETSTRESS_SET);
+	uint32_t errors = 0u;
+	uint32_t counted = 0u;
+	uint64_t sum = 0u;
+	unsigned long resident;
+	uint64_t cycles;
+	uint64_t c0;
+	uint64_t t0;
+	uint64_t ns;
+	uint32_t i;
+	uint8_t n;
+
+	/* Error sequence drawn up front: the timed loop is Det only */
+	for (i = 0u; i < DETSTRESS_SET; i++)
+	{
+		DetStress_Pick[i] = (uint16_t)((sc == DETSTRESS_OVERFLOW) ? (DetStress_Rand() % DETSTRESS_SET) : (i % set));
+	}
+	(void)memset(expected, 0, sizeof(expected));
+
+	/* Warm-up on one round of the sequence: code pages and every path faulted in before the measurement */
+	Det_Init(DET_INSTANCE);
+	for (i = 0u; i < DETSTRESS_SET; i++)
+	{
+		Det_ErrorIdType id;
+
+		DetStress_Error(DetStress_Pick[i], &id);
+		DET_REPORT_ERROR(id.ModuleId, id.InstanceId, id.ApiId, id.ErrorId);
+	}
+	Det_Init(DET_INSTANCE);
+	DetStress_Logs = 0u;
+	DetStress_Tick = 0u;
+
+	resident = DetStress_Resident();
+	t0 = DetStress_NowNs();
+	c0 = DetStress_Cycles();
+	for (i = 0u; i < reports; i++)
+	{
+		Det_ErrorIdType id;
+
+		DetStress_Tick++;
+		DetStress_Error(DetStress_Pick[i % DETSTRESS_SET], &id);
+		DET_REPORT_ERROR(id.ModuleId, id.InstanceId, id.ApiId, id.ErrorId);
+	}
+	cycles = DetStress_Cycles() - c0;
+	ns = DetStress_NowNs() - t0;
+
+	/* Constant memory: nothing allocated or touched beyond Det_Type */
+	if ((resident != 0u) && (DetStress_Resident() != resident))
+	{
+		fprintf(stderr, "%s: resident set grew from %lu to %lu pages\n", DetStress_Name[sc], resident,
+				DetStress_Resident());
+		errors++;
+	}
+
+	/* Replay of the same sequence: what each counted error must show. An error the full table refused at its
+	 * first report is never counted later, so counted errors are exact from their first report. */
+	for (i = 0u; i < reports; i++)
+	{
+		uint32_t e = DetStress_Pick[i % DETSTRESS_SET];
+
+		if (expected[e] == 0u)
+		{
+			firstTime[e] = i + 1u;
+		}
+		expected[e]++;
+		lastTime[e] = i + 1u;
+	}
+	for (i = 0u; i < DETSTRESS_SET; i++)
+	{
+		const Det_EntryType* e;
+		Det_ErrorIdType id;
+
+		DetStress_Error(i, &id);
+		e = Det_Find(DET_INSTANCE, id.ModuleId, id.InstanceId, id.ApiId, id.ErrorId);
+		if (e == NULL_PTR)
+		{
+			errors += ((expected[i] != 0u) && (sc != DETSTRESS_OVERFLOW)) ? 1u : 0u;
+			continue;
+		}
+		counted++;
+		sum += expected[i];
+		if ((e->FirstTime != firstTime[i]) || (e->LastTime != lastTime[i]) ||
+			(e->Count != ((expected[i] < 0xFFFFu) ? expected[i] : 0xFFFFu)))
+		{
+			fprintf(stderr, "%s: error %u count %u first %u last %u, expected %u first %u last %u\n",
+					DetStress_Name[sc], i, e->Count, e->FirstTime, e->LastTime, expected[i], firstTime[i],
+					lastTime[i]);
+			errors++;
+		}
+	}
+
+	if ((Det_Instance.Reports != reports) || (Det_Instance.Distinct != counted) || (DetStress_Logs != counted) ||
+		(counted != ((set < DET_TABLE_SIZE) ? set : DET_TABLE_SIZE)) || ((sum + Det_Instance.Lost) != reports))
+	{
+		fprintf(stderr, "%s: reports %u distinct %u logs %u counted %u lost %u\n", DetStress_Name[sc],
+				Det_Instance.Reports, Det_Instance.Distinct, DetStress_Logs, counted, Det_Instance.Lost);
+		errors++;
+	}
+	if ((sc != DETSTRESS_OVERFLOW) && (Det_Instance.Lost != 0u))
+	{
+		errors++;
+	}
+
+	/* Ring: the most recent distinct errors, no duplicate */
+	for (n = 0u; n < Det_Instance.RecentCount; n++)
+	{
+		Det_RecentType a;
+		Det_RecentType b;
+		uint8_t k;
+
+		(void)Det_GetRecent(DET_INSTANCE, n, &a);
+		for (k = (uint8_t)(n + 1u); k < Det_Instance.RecentCount; k++)
+		{
+			(void)Det_GetRecent(DET_INSTANCE, k, &b);
+			if (Det_SameError(&a.Id, &b.Id) || (b.Time > a.Time))
+			{
+				fprintf(stderr, "%s: ring entries %u and %u out of order or duplicated\n", DetStress_Name[sc], n, k);
+				errors++;
+			}
+		}
+	}
+	if (Det_Instance.RecentCount != ((set < DET_RING_SIZE) ? set : DET_RING_SIZE))
+	{
+		errors++;
+	}
+
+	printf("%-12s %10u %6u %9u %10u %6u %10.2f %10.1f\n", DetStress_Name[sc], reports, set, Det_Instance.Distinct,
+		   Det_Instance.Lost, DetStress_Logs, (double)ns / reports, (double)cycles / reports);
+	return errors;
+}
+#endif
+
+static void DetStress_Usage(void)
+{
+	fprintf(stderr, "usage: DetStress [-n reports] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	const char* expansion = DETSTRESS_STR(DET_REPORT_ERROR(51u, 0u, 3u, 1u));
+	uint32_t reports = 1000000u;
+	uint32_t errors = 0u;
+	int o;
+
+	DetStress_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				reports = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				DetStress_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				DetStress_Usage();
+				return 2;
+		}
+	}
+	if (reports == 0u)
+	{
+		DetStress_Usage();
+		return 2;
+	}
+
+	printf("DET_REPORT_ERROR: %s\n", expansion);
+	/* First stdio, heap and vDSO use out of the measurements */
+	(void)DetStress_Resident();
+	(void)DetStress_NowNs();
+
+#if (DET_ENABLE == 1)
+	{
+		uint32_t sc;
+
+		printf("%-12s %10s %6s %9s %10s %6s %10s %10s\n", "scenario", "reports", "set", "distinct", "lost", "logs",
+			   "ns/report", "cyc/report");
+		for (sc = 0u; sc < DETSTRESS_COUNT; sc++)
+		{
+			errors += DetStress_Run((DetStressScenario_t)sc, reports);
+		}
+		printf("log records     : %u per scenario at most, %u without deduplication\n", DET_TABLE_SIZE, reports);
+		printf("RAM             : %zu bytes (DET_TABLE_BITS %u, DET_RING_SIZE %u), %zu bytes per table entry\n",
+			   sizeof(Det_Type), DET_TABLE_BITS, DET_RING_SIZE, sizeof(Det_EntryType));
+	}
+#else
+	{
+		unsigned long resident = DetStress_Resident();
+		uint64_t t0 = DetStress_NowNs();
+		uint32_t i;
+
+		for (i = 0u; i < reports; i++)
+		{
+			DetStress_Tick++;
+			DET_REPORT_ERROR(51u, (uint8_t)i, 3u, 1u);
+		}
+		t0 = DetStress_NowNs() - t0;
+		if ((strcmp(expansion, "((void)0)") != 0) || ((resident != 0u) && (DetStress_Resident() != resident)))
+		{
+			errors++;
+		}
+		printf("release         : %.3f ns/report (loop only)\n", (double)t0 / reports);
+		/* Nothing of Det may exist in a release build */
+#if defined(DET_INSTANCE) || defined(DET_TABLE_SIZE)
+#error "Det compiled in with DET_ENABLE 0"
+#endif
+	}
+#endif
+
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
@@ -0,0 +1,435 @@
+/* =====================================================================================================================
+ *  File        : FixedPointCheck.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Accuracy of FixedPoint.h against double precision and cost against float
+ *                 - Q15 / Q31 mul and div (random operands plus the edge values), Q15 <-> Q31: error against the
+ *                   exact result rounded and saturated, in LSB.
+ *                 - Scaling: pedal signal (12 bit raw, 0.0390625 % per bit, -40 % offset) raw -> phys over the whole
+ *                   raw range against double, and phys -> raw round trip.
+ *                 - Lookup tables (breakpoints and uniform) against double interpolation, x swept over the range.
+ *                 - PI controller: same error sequence into the fixed-point and a double PI, output difference.
+ *                 - Checks: arithmetic and tables within 0.5 LSB, scaling within 1 unit, PI within 1 unit.
+ *                 - Report: max error of each function, and ns / TSC cycles (x86) per call against the same
+ *                   computation in float. The host has an FPU: on the Cortex-M3 float goes through soft-float
+ *                   calls, so the target ratio is much more in favour of fixed point than the host one.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o FixedPointCheck FixedPointCheck.c -lm
+ *  Usage       : FixedPointCheck [-n operands] [-b calls] [-s seed]
+ *                  -n  random operand pairs per arithmetic function (default 5000000)
+ *                  -b  calls per benchmark (default 50000000)
+ *                  -s  random seed (default 1)
+ *  Example     : FixedPointCheck -n 100000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Std_Types.h"
+#include "FixedPoint.h"
+
+#define FXP_CHECK_BENCH_IN		(1024u)
+
+typedef struct
+{
+	const char*	Name;
+	double		MaxErr;
+	double		Limit;
+}FxpCheckResult_t;
+
+static uint64_t FxpCheck_Seed;
+static uint32_t FxpCheck_Errors;
+static sint32 FxpCheck_In[FXP_CHECK_BENCH_IN];
+
+static uint32_t FxpCheck_Rand(void)
+{
+	FxpCheck_Seed ^= FxpCheck_Seed >> 12;
+	FxpCheck_Seed ^= FxpCheck_Seed << 25;
+	FxpCheck_Seed ^= FxpCheck_Seed >> 27;
+	return (uint32_t)((FxpCheck_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double FxpCheck_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint64_t FxpCheck_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+
+static long double FxpCheck_Clamp(long double v, long double lo, long double hi)
+{
+	return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+static void FxpCheck_Report(const FxpCheckResult_t* r)
+{
+	printf("%-22s %12.4f %8.2f %s\n", r->Name, r->MaxErr, r->Limit, (r->MaxErr <= r->Limit) ? "ok" : "FAIL");
+	if (r->MaxErr > r->Limit)
+	{
+		FxpCheck_Errors++;
+	}
+}
+
+static void FxpCheck_Track(FxpCheckResult_t* r, long double got, long double exact)
+{
+	double e = (double)fabsl(got - exact);
+
+	r->MaxErr = (e > r->MaxErr) ? e : r->MaxErr;
+}
+
+/* Operand: mostly random, 1 in 16 an edge value */
+static sint32 FxpCheck_Operand(bool q31)
+{
+	static const sint32 edge31[] = { FXP_Q31_MIN, FXP_Q31_MIN + 1, -1, 0, 1, FXP_Q31_MAX - 1, FXP_Q31_MAX };
+	static const sint32 edge15[] = { FXP_Q15_MIN, FXP_Q15_MIN + 1, -1, 0, 1, FXP_Q15_MAX - 1, FXP_Q15_MAX };
+	uint32_t r = FxpCheck_Rand();
+
+	if ((r & 15u) == 0u)
+	{
+		return q31 ? edge31[(r >> 4) % 7u] : edge15[(r >> 4) % 7u];
+	}
+	return q31 ? (sint32)FxpCheck_Rand() : (sint32)(sint16)FxpCheck_Rand();
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Accuracy
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void FxpCheck_Arithmetic(uint32_t n)
+{
+	FxpCheckResult_t mul15 = { "Fxp_Q15Mul (LSB)", 0.0, 0.5 };
+	FxpCheckResult_t div15 = { "Fxp_Q15Div (LSB)", 0.0, 0.5 };
+	FxpCheckResult_t mul31 = { "Fxp_Q31Mul (LSB)", 0.0, 0.5 };
+	FxpCheckResult_t div31 = { "Fxp_Q31Div (LSB)", 0.0, 0.5 };
+	FxpCheckResult_t conv = { "Fxp_Q31ToQ15 (LSB)", 0.0, 0.5 };
+	uint32_t i;
+
+	for (i = 0u; i < n; i++)
+	{
+		sint16 a = (sint16)FxpCheck_Operand(false);
+		sint16 b = (sint16)FxpCheck_Operand(false);
+		sint32 A = FxpCheck_Operand(true);
+		sint32 B = FxpCheck_Operand(true);
+
+		FxpCheck_Track(&mul15, Fxp_Q15Mul(a, b), FxpCheck_Clamp(((long double)a * b) / 32768.0L, -32768.0L, 32767.0L));
+		if (b != 0)
+		{
+			FxpCheck_Track(&div15, Fxp_Q15Div(a, b),
+						   FxpCheck_Clamp(((long double)a * 32768.0L) / b, -32768.0L, 32767.0L));
+		}
+		FxpCheck_Track(&mul31, Fxp_Q31Mul(A, B),
+					   FxpCheck_Clamp(((long double)A * B) / 2147483648.0L, -2147483648.0L, 2147483647.0L));
+		if (B != 0)
+		{
+			FxpCheck_Track(&div31, Fxp_Q31Div(A, B),
+						   FxpCheck_Clamp(((long double)A * 2147483648.0L) / B, -2147483648.0L, 2147483647.0L));
+		}
+		FxpCheck_Track(&conv, Fxp_Q31ToQ15(A), FxpCheck_Clamp((long double)A / 65536.0L, -32768.0L, 32767.0L));
+		if (Fxp_Q31ToQ15(Fxp_Q15ToQ31(a)) != a)
+		{
+			FxpCheck_Errors++;
+		}
+	}
+	FxpCheck_Report(&mul15);
+	FxpCheck_Report(&div15);
+	FxpCheck_Report(&mul31);
+	FxpCheck_Report(&div31);
+	FxpCheck_Report(&conv);
+}
+
+/* Pedal: 0.0390625 % per bit, -40 %, in 0.01 % units */
+static const Fxp_ScaleType FxpCheck_Pedal = FXP_SCALE(3.90625, -4000, 20);
+
+static void FxpCheck_Scaling(void)
+{
+	FxpCheckResult_t phys = { "Fxp_ScaleToPhys (unit)", 0.0, 1.0 };
+	FxpCheckResult_t raw = { "Fxp_ScaleToRaw (bit)", 0.0, 0.0 };
+	sint32 r;
+
+	for (r = 0; r < 4096; r++)
+	{
+		sint32 p = Fxp_ScaleToPhys(&FxpCheck_Pedal, r);
+
+		FxpCheck_Track(&phys, p, ((long double)r * 3.90625L) - 4000.0L);
+		FxpCheck_Track(&raw, Fxp_ScaleToRaw(&FxpCheck_Pedal, p), r);
+	}
+	FxpCheck_Report(&phys);
+	FxpCheck_Report(&raw);
+}
+
+static const sint32 FxpCheck_LutX[] = { -100, 0, 50, 400, 1000 };
+static const sint32 FxpCheck_LutY[] = { 500, 0, -250, 1000, 1000 };
+static const Fxp_LutType FxpCheck_Lut = { FxpCheck_LutX, FxpCheck_LutY, 5u };
+static const sint32 FxpCheck_UniY[] = { 0, 100, 400, 900, 1600, 2500, 3600, 4900, 6400 };
+static const Fxp_LutUniformType FxpCheck_Uni = { FxpCheck_UniY, -512, 9u, 8u };
+
+static long double FxpCheck_LutRef(const sint32* xs, const sint32* ys, uint32_t count, sint32 x)
+{
+	uint32_t k = 0u;
+
+	if (x <= xs[0])
+	{
+		return ys[0];
+	}
+	if (x >= xs[count - 1u])
+	{
+		return ys[count - 1u];
+	}
+	while (xs[k + 1u] < x)
+	{
+		k++;
+	}
+	return ys[k] + ((long double)(ys[k + 1u] - ys[k]) * (x - xs[k])) / (long double)(xs[k + 1u] - xs[k]);
+}
+
+static void FxpCheck_Tables(void)
+{
+	FxpCheckResult_t lut = { "Fxp_LutInterp", 0.0, 0.5 };
+	FxpCheckResult_t uni = { "Fxp_LutUniformInterp", 0.0, 0.5 };
+	sint32 ux[9];
+	sint32 x;
+	uint32_t k;
+
+	for (k = 0u; k < 9u; k++)
+	{
+		ux[k] = FxpCheck_Uni.X0 + (sint32)(k << FxpCheck_Uni.Shift);
+	}
+	for (x = -300; x <= 2500; x++)
+	{
+		FxpCheck_Track(&lut, Fxp_LutInterp(&FxpCheck_Lut, x), FxpCheck_LutRef(FxpCheck_LutX, FxpCheck_LutY, 5u, x));
+		FxpCheck_Track(&uni, Fxp_LutUniformInterp(&FxpCheck_Uni, x), FxpCheck_LutRef(ux, FxpCheck_UniY, 9u, x));
+	}
+	FxpCheck_Report(&lut);
+	FxpCheck_Report(&uni);
+}
+
+/* Kp 0.5, Ki 0.05 per step, output -1000..1000, on a first order plant */
+static const Fxp_PiConfigType FxpCheck_PiCfg = { FXP_Q15(0.5), FXP_Q15(0.05), -1000, 1000, 15u };
+
+static void FxpCheck_Pi(void)
+{
+	FxpCheckResult_t res = { "Fxp_PiStep (unit)", 0.0, 1.0 };
+	double kp = (double)FxpCheck_PiCfg.Kp / 32768.0;
+	double ki = (double)FxpCheck_PiCfg.Ki / 32768.0;
+	double integral = 0.0;
+	double plant = 0.0;
+	Fxp_PiType pi;
+	uint32_t k;
+
+	Fxp_PiInit(&pi, &FxpCheck_PiCfg);
+	for (k = 0u; k < 2000u; k++)
+	{
+		sint32 setpoint = ((k / 400u) & 1u) ? -700 : 900;
+		sint32 measured = (sint32)lround(plant);
+		double err = (double)setpoint - measured;
+		double ref;
+		sint32 out = Fxp_PiStep(&pi, setpoint, measured);
+
+		integral += ki * err;
+		integral = (integral > 1000.0) ? 1000.0 : ((integral < -1000.0) ? -1000.0 : integral);
+		ref = (kp * err) + integral;
+		ref = (ref > 1000.0) ? 1000.0 : ((ref < -1000.0) ? -1000.0 : ref);
+		FxpCheck_Track(&res, out, ref);
+		plant += 0.1 * ((double)out - (plant * 0.2));
+	}
+	FxpCheck_Report(&res);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Cost against float: the same computation in both, x from a table of 12 bit raw values
+ * -------------------------------------------------------------------------------------------------------------------*/
+static const float FxpCheck_LutXf[] = { -100.0f, 0.0f, 50.0f, 400.0f, 1000.0f };
+static const float FxpCheck_LutYf[] = { 500.0f, 0.0f, -250.0f, 1000.0f, 1000.0f };
+static Fxp_PiType FxpCheck_BenchPi;
+static float FxpCheck_BenchIntegral;
+
+static inline sint32 FxpCheck_FxpMul(sint32 x)
+{
+	return Fxp_Q15Mul((sint16)(x << 3), (sint16)0x5A5A);
+}
+
+static inline sint32 FxpCheck_FloatMul(sint32 x)
+{
+	return (sint32)lrintf(((float)(x << 3) * (float)0x5A5A) * (1.0f / 32768.0f));
+}
+
+static inline sint32 FxpCheck_FxpDiv(sint32 x)
+{
+	return Fxp_Q31Div(x << 16, 0x40000000 - x);
+}
+
+static inline sint32 FxpCheck_FloatDiv(sint32 x)
+{
+	return (sint32)lrintf(((float)(x << 16) / (float)(0x40000000 - x)) * 2147483648.0f);
+}
+
+static inline sint32 FxpCheck_FxpScale(sint32 x)
+{
+	return Fxp_ScaleToPhys(&FxpCheck_Pedal, x);
+}
+
+static inline sint32 FxpCheck_FloatScale(sint32 x)
+{
+	return (sint32)lrintf(((float)x * 3.90625f) - 4000.0f);
+}
+
+static inline sint32 FxpCheck_FxpLut(sint32 x)
+{
+	return Fxp_LutInterp(&FxpCheck_Lut, x - 200);
+}
+
+static inline sint32 FxpCheck_FloatLut(sint32 x)
+{
+	float fx = (float)(x - 200);
+	float dy;
+	uint32_t j = 0u;
+
+	if (fx <= FxpCheck_LutXf[0])
+	{
+		return (sint32)FxpCheck_LutYf[0];
+	}
+	if (fx >= FxpCheck_LutXf[4])
+	{
+		return (sint32)FxpCheck_LutYf[4];
+	}
+	while (FxpCheck_LutXf[j + 1u] < fx)
+	{
+		j++;
+	}
+	dy = (FxpCheck_LutYf[j + 1u] - FxpCheck_LutYf[j]) * (fx - FxpCheck_LutXf[j]);
+	return (sint32)lrintf(FxpCheck_LutYf[j] + (dy / (FxpCheck_LutXf[j + 1u] - FxpCheck_LutXf[j])));
+}
+
+static inline sint32 FxpCheck_FxpPi(sint32 x)
+{
+	return Fxp_PiStep(&FxpCheck_BenchPi, 900, x - 2048);
+}
+
+static inline sint32 FxpCheck_FloatPi(sint32 x)
+{
+	float e = 900.0f - (float)(x - 2048);
+	float out;
+
+	FxpCheck_BenchIntegral += 0.05f * e;
+	FxpCheck_BenchIntegral = (FxpCheck_BenchIntegral > 1000.0f) ? 1000.0f :
+							 ((FxpCheck_BenchIntegral < -1000.0f) ? -1000.0f : FxpCheck_BenchIntegral);
+	out = (0.5f * e) + FxpCheck_BenchIntegral;
+	return (sint32)lrintf((out > 1000.0f) ? 1000.0f : ((out < -1000.0f) ? -1000.0f : out));
+}
+
+/* calls of fn_ over the input table, results summed so nothing is optimised away, cycles and ns per call */
+#define FXP_CHECK_BENCH(fn_, cyc_, ns_)															\
+	do																							\
+	{																							\
+		volatile sint32 sink_;																	\
+		sint32 acc_ = 0;																		\
+		double t0_ = FxpCheck_Now();															\
+		uint64_t c0_ = FxpCheck_Cycles();														\
+		uint32_t i_;																			\
+																								\
+		for (i_ = 0u; i_ < calls; i_++)															\
+		{																						\
+			acc_ += fn_(FxpCheck_In[i_ & (FXP_CHECK_BENCH_IN - 1u)] ^ (acc_ & 1));				\
+		}																						\
+		(cyc_) = (double)(FxpCheck_Cycles() - c0_) / (double)calls;								\
+		(ns_) = ((FxpCheck_Now() - t0_) * 1e9) / (double)calls;									\
+		sink_ = acc_;																			\
+		(void)sink_;																			\
+	} while (0)
+
+static void FxpCheck_Bench(uint32_t calls)
+{
+	static const char* const names[] = { "Q15 mul", "Q31 div", "scale raw->phys", "LUT interp", "PI step" };
+	double cyc[2][5];
+	double ns[2][5];
+	uint32_t k;
+
+	for (k = 0u; k < FXP_CHECK_BENCH_IN; k++)
+	{
+		FxpCheck_In[k] = (sint32)(FxpCheck_Rand() % 4096u);
+	}
+	Fxp_PiInit(&FxpCheck_BenchPi, &FxpCheck_PiCfg);
+	FxpCheck_BenchIntegral = 0.0f;
+
+	FXP_CHECK_BENCH(FxpCheck_FxpMul, cyc[0][0], ns[0][0]);
+	FXP_CHECK_BENCH(FxpCheck_FloatMul, cyc[1][0], ns[1][0]);
+	FXP_CHECK_BENCH(FxpCheck_FxpDiv, cyc[0][1], ns[0][1]);
+	FXP_CHECK_BENCH(FxpCheck_FloatDiv, cyc[1][1], ns[1][1]);
+	FXP_CHECK_BENCH(FxpCheck_FxpScale, cyc[0][2], ns[0][2]);
+	FXP_CHECK_BENCH(FxpCheck_FloatScale, cyc[1][2], ns[1][2]);
+	FXP_CHECK_BENCH(FxpCheck_FxpLut, cyc[0][3], ns[0][3]);
+	FXP_CHECK_BENCH(FxpCheck_FloatLut, cyc[1][3], ns[1][3]);
+	FXP_CHECK_BENCH(FxpCheck_FxpPi, cyc[0][4], ns[0][4]);
+	FXP_CHECK_BENCH(FxpCheck_FloatPi, cyc[1][4], ns[1][4]);
+
+	printf("%-16s %10s %10s %12s %12s\n", "operation", "fxp ns", "float ns", "fxp cycles", "float cycles");
+	for (k = 0u; k < 5u; k++)
+	{
+		printf("%-16s %10.2f %10.2f %12.2f %12.2f\n", names[k], ns[0][k], ns[1][k], cyc[0][k], cyc[1][k]);
+	}
+}
+
+static void FxpCheck_Usage(void)
+{
+	fprintf(stderr, "usage: FixedPointCheck [-n operands] [-b calls] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t operands = 5000000u;
+	uint32_t calls = 50000000u;
+	int o;
+
+	FxpCheck_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:b:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				operands = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				calls = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				FxpCheck_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				FxpCheck_Usage();
+				return 2;
+		}
+	}
+	if (calls == 0u)
+	{
+		FxpCheck_Usage();
+		return 2;
+	}
+	FxpCheck_Errors = 0u;
+
+	printf("%-22s %12s %8s\n", "function", "max error", "limit");
+	FxpCheck_Arithmetic(operands);
+	FxpCheck_Scaling();
+	FxpCheck_Tables();
+	FxpCheck_Pi();
+	FxpCheck_Bench(calls);
+	printf("errors          : %u\n", FxpCheck_Errors);
+	return (FxpCheck_Errors == 0u) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/* =====================================================================================================================
+ *  File        : LogCaptureGen.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Synthetic log capture (LogCapture.h header + records) for the LogIndex benchmark and tests
+ *                 - Gateway-like traffic: every tag, mostly DEBUG/TRACE, 0..LOG_TOKEN_MAX_ARGS arguments, timestamps
+ *                   1..4 ticks apart. About one record in LOGCAPGEN_DET_PERIOD is an SRV.Det ERROR, the needle of
+ *                   the "DET errors" query.
+ *                 - Token format (LogToken.h) or framed format (LogFrame.h, sync every LOG_FRAME_SYNC_INTERVAL
+ *                   frames). -c damages one frame in N (its COBS code byte is lost on the line), so the decoder
+ *                   runs without a valid timestamp until the next sync frame, as on a real noisy UART.
+ *                 - Reproducible with -s, the same arguments give the same file.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogCaptureGen LogCaptureGen.c
+ *  Usage       : LogCaptureGen [-m MiB] [-F] [-c N] [-r role] [-s seed] out.cap
+ *                  -m  capture size in MiB (default 256)
+ *                  -F  framed format (default token format)
+ *                  -c  framed format: damage one frame in N (default 0 = none)
+ *                  -r  ECU role of the header (SENSOR, MOTOR, UNKNOWN, default MOTOR)
+ *                  -s  random seed (default 1)
+ *  Example     : LogCaptureGen -m 256 motor.cap && LogIndex -B -t SRV.Det -l ERROR motor.cap
+ *                LogCaptureGen -m 64 -F -c 1000 noisy.cap && LogIndex noisy.cap | wc -l
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "LogCapture.h"
+#include "LogFrame.h"
+#include "LogTags.h"
+#include "LogToken.h"
+
+#define LOGCAPGEN_DET_PERIOD		(100000u)		/* one SRV.Det ERROR per this many records, on average */
+#define LOGCAPGEN_BUF_SIZE			(1u << 20)
+
+static uint64_t LogCaptureGen_Seed;
+
+/* xorshift64*, reproducible with -s */
+static uint32_t LogCaptureGen_Rand(void)
+{
+	LogCaptureGen_Seed ^= LogCaptureGen_Seed >> 12;
+	LogCaptureGen_Seed ^= LogCaptureGen_Seed << 25;
+	LogCaptureGen_Seed ^= LogCaptureGen_Seed >> 27;
+	return (uint32_t)((LogCaptureGen_Seed * 2685821657736338717ull) >> 32);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  One record of the mix: DET errors are rare, the rest is spread over the other tags and the chatty levels
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint8_t LogCaptureGen_Record(LogTag_t* tag, LogLevel_t* lvl, LogFmtId_t* fmtId, uint32_t* args)
+{
+	uint32_t r = LogCaptureGen_Rand();
+	uint8_t argc = (uint8_t)(r % (LOG_TOKEN_MAX_ARGS + 1u));
+	uint8_t i;
+
+	if ((LogCaptureGen_Rand() % LOGCAPGEN_DET_PERIOD) == 0u)
+	{
+		*tag = LOGTAG_SRV_DET;
+		*lvl = LOG_ERROR;
+	}
+	else
+	{
+		*tag = (LogTag_t)((r >> 8) % (uint32_t)LOGTAG_COUNT);
+		*tag = (*tag == LOGTAG_SRV_DET) ? LOGTAG_SRV_LOGGER : *tag;
+		switch ((r >> 16) % 16u)
+		{
+			case 0u:	*lvl = LOG_WARN;	break;
+			case 1u:
+			case 2u:	*lvl = LOG_INFO;	break;
+			case 3u:
+			case 4u:
+			case 5u:
+			case 6u:
+			case 7u:	*lvl = LOG_DEBUG;	break;
+			default:	*lvl = LOG_TRACE;	break;
+		}
+	}
+	*fmtId = (LogFmtId_t)((r >> 20) % 64u);
+	for (i = 0u; i < argc; i++)
+	{
+		/* Mostly small values (IDs, lengths, counters), a few full 32-bit words */
+		args[i] = ((LogCaptureGen_Rand() % 8u) == 0u) ? LogCaptureGen_Rand() : (LogCaptureGen_Rand() % 4096u);
+	}
+	return argc;
+}
+
+static int LogCaptureGen_ParseRole(const char* s)
+{
+	int r;
+
+	for (r = ECU_UNKNOWN; r <= ECU_MOTOR; r++)
+	{
+		if (strcasecmp(s, LOG_EcuRoleIdString((uint8_t)r)) == 0)
+		{
+			return r;
+		}
+	}
+	return -1;
+}
+
+static void LogCaptureGen_Usage(void)
+{
+	fprintf(stderr, "usage: LogCaptureGen [-m MiB] [-F] [-c N] [-r role] [-s seed] out.cap\n");
+}
+
+int main(int argc, char** argv)
+{
+	static uint8_t buf[LOGCAPGEN_BUF_SIZE];
+	LogFrameEncoder_t enc;
+	uint32_t args[LOG_TOKEN_MAX_ARGS];
+	uint64_t size = 256u;
+	uint64_t written;
+	uint64_t records = 0u;
+	uint64_t detErrors = 0u;
+	uint64_t damaged = 0u;
+	uint32_t damagePeriod = 0u;
+	uint32_t timestamp = 0u;
+	uint32_t fill = 0u;
+	bool framed = false;
+	int role = ECU_MOTOR;
+	FILE* f;
+	int o;
+
+	LogCaptureGen_Seed = 1u;
+	while ((o = getopt(argc, argv, "m:Fc:r:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'm':
+				size = strtoull(optarg, NULL, 0);
+				break;
+			case 'F':
+				framed = true;
+				break;
+			case 'c':
+				damagePeriod = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				role = LogCaptureGen_ParseRole(optarg);
+				if (role < 0)
+				{
+					fprintf(stderr, "unknown ECU role '%s'\n", optarg);
+					return 2;
+				}
+				break;
+			case 's':
+				LogCaptureGen_Seed = strtoull(optarg, NULL, 0);
+				break;
+			default:
+				LogCaptureGen_Usage();
+				return 2;
+		}
+	}
+	if ((optind != (argc - 1)) || (size == 0u) || (LogCaptureGen_Seed == 0u) || ((damagePeriod != 0u) && !framed))
+	{
+		LogCaptureGen_Usage();
+		return 2;
+	}
+
+	f = fopen(argv[optind], "wb");
+	if (f == NULL)
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	size <<= 20;
+	written = LOG_CaptureHeaderEncode(buf, framed ? LOG_CAPTURE_FMT_FRAMED : LOG_CAPTURE_FMT_TOKEN);
+	buf[6] = (uint8_t)role;			/* LOG_CaptureHeaderEncode writes the ECU_ROLE of this build */
+	fill = (uint32_t)written;
+	LOG_FrameEncoderInit(&enc);
+
+	while (written < size)
+	{
+		LogTag_t tag;
+		LogLevel_t lvl;
+		LogFmtId_t fmtId;
+		uint8_t n;
+		uint8_t count = LogCaptureGen_Record(&tag, &lvl, &fmtId, args);
+
+		timestamp += 1u + (LogCaptureGen_Rand() % 4u);
+		if (framed)
+		{
+			n = LOG_FrameEncode(&enc, tag, lvl, fmtId, timestamp, args, count, &buf[fill]);
+			if ((damagePeriod != 0u) && ((LogCaptureGen_Rand() % damagePeriod) == 0u))
+			{
+				/* Last frame of the group (the record) loses its COBS code byte. */
+				uint8_t last = (uint8_t)(n - 1u);
+
+				while ((last != 0u) && (buf[fill + last - 1u] != LOG_FRAME_DELIMITER))
+				{
+					last--;
+				}
+				(void)memmove(&buf[fill + last], &buf[fill + last + 1u], (size_t)(n - last - 1u));
+				n--;
+				damaged++;
+			}
+		}
+		else
+		{
+			n = LOG_TokenEncode(&buf[fill], LOG_TOKEN_MAX_SIZE, tag, lvl, fmtId, timestamp, args, count);
+		}
+
+		records++;
+		detErrors += (tag == LOGTAG_SRV_DET) ? 1u : 0u;
+		fill += n;
+		written += n;
+		if ((fill + LOG_FRAME_MAX_SIZE + LOG_TOKEN_MAX_SIZE) > LOGCAPGEN_BUF_SIZE)
+		{
+			if (fwrite(buf, 1u, fill, f) != fill)
+			{
+				perror(argv[optind]);
+				fclose(f);
+				return 1;
+			}
+			fill = 0u;
+		}
+	}
+	if ((fwrite(buf, 1u, fill, f) != fill) || (fclose(f) != 0))
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	printf("capture         : %s, %s, %s, %llu bytes\n", argv[optind], framed ? "framed" : "token",
+		   LOG_EcuRoleIdString((uint8_t)role), (unsigned long long)written);
+	printf("records         : %llu (SRV.Det ERROR %llu), last timestamp %u\n", (unsigned long long)records,
+		   (unsigned long long)detErrors, timestamp);
+	printf("damaged frames  : %llu\n", (unsigned long long)damaged);
+	return 0;
+}
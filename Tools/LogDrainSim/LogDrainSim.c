@@ -0,0 +1,483 @@
+/* =====================================================================================================================
+ *  File        : LogDrainSim.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : UART log drain (LogUartDrain.h) on a simulated baud-rate-limited line
+ *                 - Transport thread = UART + DMA: a chunk handed to StartTx occupies the line for len * 10 / baud
+ *                   seconds (real time), then LOG_DrainTxComplete() is called as the TX complete ISR would.
+ *                 - Main thread = producer + logger main function: fixed-size records at an offered load (% of the
+ *                   line), every 1 ms the logger main function runs (Flush / Poll).
+ *                 - Three backends on the same load:
+ *                     byte : byte-at-a-time output, the caller waits for each byte (blocking putc on the UART)
+ *                     push : LOG_DrainWrite from the caller, BUSY = record dropped
+ *                     pull : LOG_RingPush from the caller, drain pulls from LogRing.h (LOG_DrainAttachSource)
+ *                 - Report: line utilisation (busy time / elapsed), producer call latency (avg / worst), drops.
+ *                 - Checks: the transport sees every accepted record once, in order.
+ *                 - Synchronous transport (pull mode): StartTx sends the chunk and raises TX complete before it
+ *                   returns (blocking driver, loopback). One poll must send DRAIN_SIM_SYNC_RECORDS records without
+ *                   StartTx ever being entered again from inside itself.
+ *  Build       : cc -O2 -std=gnu11 -pthread -I../../Inc -o LogDrainSim LogDrainSim.c
+ *  Usage       : LogDrainSim [-b baud] [-l load %] [-t seconds]
+ *                  -b  UART baud rate (default 115200)
+ *                  -l  offered log load in % of the line (default 80)
+ *                  -t  seconds per backend (default 1)
+ *  Example     : LogDrainSim -b 921600 -l 95 -t 2
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#define LOG_RING_SIZE				(64u)
+#define LOG_DRAIN_CHUNK_SIZE		(256u)
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LogTags.h"
+#include "LogRing.h"
+#include "LogUartDrain.h"
+
+#define DRAIN_SIM_REC_LEN			(16u)		/* tag, 32-bit sequence, payload */
+#define DRAIN_SIM_TICK_NS			(1000000u)	/* logger main function period */
+#define DRAIN_SIM_SYNC_RECORDS		(1000000u)
+
+typedef enum
+{
+	DRAIN_SIM_BYTE = 0,
+	DRAIN_SIM_PUSH,
+	DRAIN_SIM_PULL,
+	DRAIN_SIM_MODE_COUNT
+}LogDrainSimMode_t;
+
+static const char* const LogDrainSim_ModeName[DRAIN_SIM_MODE_COUNT] = { "byte", "push", "pull" };
+
+typedef struct
+{
+	/* Transport (UART) model, shared with the transport thread */
+	pthread_mutex_t	Lock;
+	pthread_cond_t	Cond;
+	const uint8_t*	TxData;
+	uint16_t		TxLen;
+	bool			Stop;
+	uint64_t		ByteNs;
+	uint64_t		LineFree;			/* Time the line finishes the current byte/chunk */
+	uint64_t		BusyNs;
+	uint64_t		LineBytes;
+	/* Stream check (transport side) */
+	uint32_t		NextSeq;
+	uint64_t		RxRecords;
+	uint64_t		Errors;
+	/* Producer */
+	uint64_t		Offered;
+	uint64_t		Dropped;
+	uint64_t		LatTotalNs;
+	uint64_t		LatWorstNs;
+	LogDrain_t		Drain;
+	LogRing_t		Ring;
+}LogDrainSim_t;
+
+static LogDrainSim_t LogDrainSim;
+static uint32_t LogDrainSim_SyncSeq;
+static uint32_t LogDrainSim_SyncDepth;
+static uint32_t LogDrainSim_SyncMaxDepth;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Time
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint64_t LogDrainSim_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void LogDrainSim_SleepUntil(uint64_t ns)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)(ns / 1000000000u);
+	ts.tv_nsec = (long)(ns % 1000000000u);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+	{
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Record: tag, 32-bit sequence, payload derived from the sequence
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogDrainSim_Record(uint8_t* rec, uint32_t seq)
+{
+	uint32_t i;
+
+	rec[0] = (uint8_t)LOGTAG_SRV_LOGGER;
+	rec[1] = (uint8_t)seq;
+	rec[2] = (uint8_t)(seq >> 8);
+	rec[3] = (uint8_t)(seq >> 16);
+	rec[4] = (uint8_t)(seq >> 24);
+	for (i = 5u; i < DRAIN_SIM_REC_LEN; i++)
+	{
+		rec[i] = (uint8_t)(seq + i);
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Receiver side: the stream must be whole records with increasing sequence numbers (gaps = counted drops)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogDrainSim_Check(LogDrainSim_t* sim, const uint8_t* data, uint16_t len)
+{
+	uint16_t pos;
+
+	if ((len % DRAIN_SIM_REC_LEN) != 0u)
+	{
+		sim->Errors++;
+		return;
+	}
+	for (pos = 0u; pos < len; pos = (uint16_t)(pos + DRAIN_SIM_REC_LEN))
+	{
+		uint32_t seq = (uint32_t)data[pos + 1u] | ((uint32_t)data[pos + 2u] << 8) |
+					   ((uint32_t)data[pos + 3u] << 16) | ((uint32_t)data[pos + 4u] << 24);
+
+		if ((data[pos] != (uint8_t)LOGTAG_SRV_LOGGER) || (seq < sim->NextSeq))
+		{
+			sim->Errors++;
+		}
+		sim->NextSeq = seq + 1u;
+		sim->RxRecords++;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Transport: StartTx hands the chunk to the UART thread
+ * -------------------------------------------------------------------------------------------------------------------*/
+static Std_ReturnType LogDrainSim_StartTx(void* ctx, const uint8_t* data, uint16_t len)
+{
+	LogDrainSim_t* sim = (LogDrainSim_t*)ctx;
+	Std_ReturnType ret = E_NOT_OK;
+
+	pthread_mutex_lock(&sim->Lock);
+	if (sim->TxData == NULL)
+	{
+		sim->TxData = data;
+		sim->TxLen = len;
+		pthread_cond_signal(&sim->Cond);
+		ret = E_OK;
+	}
+	pthread_mutex_unlock(&sim->Lock);
+	return ret;
+}
+
+static void* LogDrainSim_UartMain(void* arg)
+{
+	LogDrainSim_t* sim = (LogDrainSim_t*)arg;
+
+	for (;;)
+	{
+		const uint8_t* data;
+		uint16_t len;
+		uint64_t start;
+		uint64_t now;
+
+		pthread_mutex_lock(&sim->Lock);
+		while ((sim->TxData == NULL) && !sim->Stop)
+		{
+			pthread_cond_wait(&sim->Cond, &sim->Lock);
+		}
+		if (sim->TxData == NULL)
+		{
+			pthread_mutex_unlock(&sim->Lock);
+			return NULL;
+		}
+		data = sim->TxData;
+		len = sim->TxLen;
+		pthread_mutex_unlock(&sim->Lock);
+
+		/* The line sends the chunk back to back after the previous one, or from now if it was idle. */
+		now = LogDrainSim_NowNs();
+		start = (sim->LineFree > now) ? sim->LineFree : now;
+		sim->LineFree = start + ((uint64_t)len * sim->ByteNs);
+		sim->BusyNs += (uint64_t)len * sim->ByteNs;
+		sim->LineBytes += len;
+		LogDrainSim_Check(sim, data, len);
+		LogDrainSim_SleepUntil(sim->LineFree);
+
+		pthread_mutex_lock(&sim->Lock);
+		sim->TxData = NULL;
+		pthread_mutex_unlock(&sim->Lock);
+		LOG_DrainTxComplete(&sim->Drain);			/* TX complete ISR */
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Byte-at-a-time backend: wait for the UART data register to be empty before each byte
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogDrainSim_PutBytes(LogDrainSim_t* sim, const uint8_t* data, uint16_t len)
+{
+	uint64_t now = LogDrainSim_NowNs();
+	uint64_t start = (sim->LineFree > now) ? sim->LineFree : now;
+
+	/* Each byte can only be written once the previous one left: the caller is held for the whole record. */
+	sim->LineFree = start + ((uint64_t)len * sim->ByteNs);
+	sim->BusyNs += (uint64_t)len * sim->ByteNs;
+	sim->LineBytes += len;
+	LogDrainSim_Check(sim, data, len);
+	while (LogDrainSim_NowNs() < (sim->LineFree - sim->ByteNs))
+	{
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  One backend run
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogDrainSim_Run(LogDrainSim_t* sim, LogDrainSimMode_t mode, uint32_t baud, uint32_t loadPct,
+							uint32_t seconds)
+{
+	static const LogTransport_t transport = { LogDrainSim_StartTx, &LogDrainSim };
+	static const LogSource_t source = { LOG_RingPopInto, &LogDrainSim.Ring };
+	pthread_t uart;
+	uint64_t recPeriodNs;
+	uint64_t nextRec;
+	uint64_t nextTick;
+	uint64_t t0;
+	uint64_t end;
+	uint64_t elapsed;
+	uint32_t seq = 0u;
+
+	memset(sim, 0, sizeof(*sim));
+	pthread_mutex_init(&sim->Lock, NULL);
+	pthread_cond_init(&sim->Cond, NULL);
+	sim->ByteNs = 10000000000ull / baud;
+	recPeriodNs = (DRAIN_SIM_REC_LEN * sim->ByteNs * 100u) / loadPct;
+
+	LOG_RingInit(&sim->Ring);
+	LOG_DrainInit(&sim->Drain, &transport);
+	if (mode == DRAIN_SIM_PULL)
+	{
+		LOG_DrainAttachSource(&sim->Drain, &source);
+	}
+	pthread_create(&uart, NULL, LogDrainSim_UartMain, sim);
+
+	t0 = LogDrainSim_NowNs();
+	end = t0 + ((uint64_t)seconds * 1000000000u);
+	nextRec = t0;
+	nextTick = t0 + DRAIN_SIM_TICK_NS;
+	while (nextRec < end)
+	{
+		uint8_t rec[DRAIN_SIM_REC_LEN];
+		uint64_t c0;
+		uint64_t dt;
+		bool ok = true;
+
+		LogDrainSim_SleepUntil((nextRec < nextTick) ? nextRec : nextTick);
+
+		/* Logger main function */
+		if (LogDrainSim_NowNs() >= nextTick)
+		{
+			nextTick += DRAIN_SIM_TICK_NS;
+			if (mode == DRAIN_SIM_PUSH)
+			{
+				LOG_DrainFlush(&sim->Drain);
+			}
+			else if (mode == DRAIN_SIM_PULL)
+			{
+				LOG_DrainPoll(&sim->Drain);
+			}
+			else
+			{
+			}
+		}
+
+		/* Producers: every record due by now */
+		while ((nextRec <= LogDrainSim_NowNs()) && (nextRec < end))
+		{
+			nextRec += recPeriodNs;
+			LogDrainSim_Record(rec, seq);
+			seq++;
+			sim->Offered++;
+
+			c0 = LogDrainSim_NowNs();
+			switch (mode)
+			{
+				case DRAIN_SIM_BYTE:
+					LogDrainSim_PutBytes(sim, rec, DRAIN_SIM_REC_LEN);
+					break;
+				case DRAIN_SIM_PUSH:
+					ok = (LOG_DrainWrite(&sim->Drain, rec, DRAIN_SIM_REC_LEN) == BUFREQ_OK);
+					break;
+				default:
+					ok = (LOG_RingPush(&sim->Ring, LOGTAG_SRV_LOGGER, rec, DRAIN_SIM_REC_LEN) == E_OK);
+					break;
+			}
+			dt = LogDrainSim_NowNs() - c0;
+			sim->LatTotalNs += dt;
+			if (dt > sim->LatWorstNs)
+			{
+				sim->LatWorstNs = dt;
+			}
+			if (!ok)
+			{
+				sim->Dropped++;
+			}
+		}
+	}
+
+	/* Stop producing, let the backend empty, then stop the UART. */
+	if (mode != DRAIN_SIM_BYTE)
+	{
+		uint64_t drainEnd = LogDrainSim_NowNs() + 1000000000u;
+
+		while ((sim->RxRecords + sim->Dropped) < sim->Offered)
+		{
+			if (LogDrainSim_NowNs() > drainEnd)
+			{
+				break;
+			}
+			LogDrainSim_SleepUntil(LogDrainSim_NowNs() + DRAIN_SIM_TICK_NS);
+			if (mode == DRAIN_SIM_PUSH)
+			{
+				LOG_DrainFlush(&sim->Drain);
+			}
+			else
+			{
+				LOG_DrainPoll(&sim->Drain);
+			}
+		}
+	}
+	LogDrainSim_SleepUntil(sim->LineFree);		/* last chunk on the line */
+	elapsed = LogDrainSim_NowNs() - t0;
+
+	pthread_mutex_lock(&sim->Lock);
+	sim->Stop = true;
+	pthread_cond_signal(&sim->Cond);
+	pthread_mutex_unlock(&sim->Lock);
+	pthread_join(uart, NULL);
+
+	if ((sim->RxRecords + sim->Dropped) != sim->Offered)
+	{
+		sim->Errors++;
+	}
+
+	printf("%-6s %10.1f%% %14.0f %14.0f %10llu %10llu %8llu\n", LogDrainSim_ModeName[mode],
+		   (100.0 * (double)sim->BusyNs) / (double)elapsed, (double)sim->LatTotalNs / (double)sim->Offered,
+		   (double)sim->LatWorstNs, (unsigned long long)sim->Offered, (unsigned long long)sim->Dropped,
+		   (unsigned long long)sim->Errors);
+	pthread_mutex_destroy(&sim->Lock);
+	pthread_cond_destroy(&sim->Cond);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Synchronous transport: the chunk is sent and TX complete raised before StartTx returns
+ * -------------------------------------------------------------------------------------------------------------------*/
+static Std_ReturnType LogDrainSim_SyncStartTx(void* ctx, const uint8_t* data, uint16_t len)
+{
+	LogDrainSim_t* sim = (LogDrainSim_t*)ctx;
+
+	LogDrainSim_SyncDepth++;
+	if (LogDrainSim_SyncDepth > LogDrainSim_SyncMaxDepth)
+	{
+		LogDrainSim_SyncMaxDepth = LogDrainSim_SyncDepth;
+	}
+	sim->LineBytes += len;
+	LogDrainSim_Check(sim, data, len);
+	LOG_DrainTxComplete(&sim->Drain);
+	LogDrainSim_SyncDepth--;
+	return E_OK;
+}
+
+/* Source: whole records until DRAIN_SIM_SYNC_RECORDS are produced. */
+static uint16_t LogDrainSim_SyncFill(void* ctx, uint8_t* dst, uint16_t space)
+{
+	uint16_t n = 0u;
+
+	(void)ctx;
+	while ((LogDrainSim_SyncSeq < DRAIN_SIM_SYNC_RECORDS) && ((uint16_t)(space - n) >= DRAIN_SIM_REC_LEN))
+	{
+		LogDrainSim_Record(&dst[n], LogDrainSim_SyncSeq);
+		LogDrainSim_SyncSeq++;
+		n = (uint16_t)(n + DRAIN_SIM_REC_LEN);
+	}
+	return n;
+}
+
+static void LogDrainSim_Sync(LogDrainSim_t* sim)
+{
+	static const LogTransport_t transport = { LogDrainSim_SyncStartTx, &LogDrainSim };
+	static const LogSource_t source = { LogDrainSim_SyncFill, NULL_PTR };
+	uint32_t chunks = ((DRAIN_SIM_SYNC_RECORDS * DRAIN_SIM_REC_LEN) + LOG_DRAIN_CHUNK_SIZE - 1u) /
+					  LOG_DRAIN_CHUNK_SIZE;
+
+	memset(sim, 0, sizeof(*sim));
+	LogDrainSim_SyncSeq = 0u;
+	LogDrainSim_SyncDepth = 0u;
+	LogDrainSim_SyncMaxDepth = 0u;
+	LOG_DrainInit(&sim->Drain, &transport);
+	LOG_DrainAttachSource(&sim->Drain, &source);
+
+	/* One poll: the whole source must go out, each chunk started by the outer call, then the line is idle. */
+	LOG_DrainPoll(&sim->Drain);
+
+	if ((sim->RxRecords != DRAIN_SIM_SYNC_RECORDS) || (sim->Drain.TxChunks != chunks) ||
+		(LogDrainSim_SyncMaxDepth != 1u) || atomic_load(&sim->Drain.InFlight))
+	{
+		sim->Errors++;
+	}
+	printf("sync   %llu records in %u chunks from one poll, max StartTx nesting %u, %llu errors\n",
+		   (unsigned long long)sim->RxRecords, sim->Drain.TxChunks, LogDrainSim_SyncMaxDepth,
+		   (unsigned long long)sim->Errors);
+}
+
+static void LogDrainSim_Usage(void)
+{
+	fprintf(stderr, "usage: LogDrainSim [-b baud] [-l load %%] [-t seconds]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t baud = 115200u;
+	uint32_t loadPct = 80u;
+	uint32_t seconds = 1u;
+	uint64_t errors = 0u;
+	uint32_t mode;
+	int o;
+
+	while ((o = getopt(argc, argv, "b:l:t:")) != -1)
+	{
+		switch (o)
+		{
+			case 'b':
+				baud = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				loadPct = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				seconds = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				LogDrainSim_Usage();
+				return 2;
+		}
+	}
+	if ((baud == 0u) || (loadPct == 0u) || (loadPct > 200u) || (seconds == 0u))
+	{
+		LogDrainSim_Usage();
+		return 2;
+	}
+
+	printf("%u baud, %u-byte records at %u%% of the line, chunk %u bytes, %u s per backend\n", baud,
+		   DRAIN_SIM_REC_LEN, loadPct, (unsigned)LOG_DRAIN_CHUNK_SIZE, seconds);
+	printf("%-6s %11s %14s %14s %10s %10s %8s\n", "", "line busy", "avg call ns", "worst call ns", "records",
+		   "dropped", "errors");
+	for (mode = 0u; mode < (uint32_t)DRAIN_SIM_MODE_COUNT; mode++)
+	{
+		LogDrainSim_Run(&LogDrainSim, (LogDrainSimMode_t)mode, baud, loadPct, seconds);
+		errors += LogDrainSim.Errors;
+	}
+	LogDrainSim_Sync(&LogDrainSim);
+	errors += LogDrainSim.Errors;
+	return (errors == 0u) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/* =====================================================================================================================
+ *  File        : LogFlashSize.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Code size of compile-time per-tag log thresholds (LogFilter.h) against one global level
+ *                 - One LOG_TOKEN call site per (tag, level), every tag of LOG_TAG_REGISTRY at ERROR..TRACE.
+ *                 - LOGFLASH_ALL_TRACE build: every call compiled in (global LOG_LEVEL_DEFAULT = TRACE), the
+ *                   runtime tag mask decides, as before LogFilter.h.
+ *                 - Default build: TRACE for LOGTAG_MCAL_CAN, ERROR for every other tag; the other calls and their
+ *                   arguments must not exist in the object.
+ *                 - Run: every call site is executed once, the emitted records must be exactly the compiled-in
+ *                   (tag, level) pairs given by LOG_CT_ENABLE.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogFlashSize LogFlashSize.c
+ *                cc -O2 -std=gnu11 -I../../Inc -DLOGFLASH_ALL_TRACE -o LogFlashSize_all LogFlashSize.c
+ *  Size        : same file built twice, compare the text of both objects (host or target compiler):
+ *                  cc -Os -std=gnu11 -I../../Inc -c -o pertag.o LogFlashSize.c
+ *                  cc -Os -std=gnu11 -I../../Inc -DLOGFLASH_ALL_TRACE -c -o all.o LogFlashSize.c
+ *                  size all.o pertag.o
+ *                  (arm-none-eabi-gcc -mcpu=cortex-m3 -mthumb -Os ... / arm-none-eabi-size for STM32F103 numbers)
+ *  Usage       : LogFlashSize
+ *  Example     : LogFlashSize
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+/* Thresholds under test (normally Preprocessor Defines of the app project) */
+#ifdef LOGFLASH_ALL_TRACE
+#define LOG_LEVEL_DEFAULT			LOG_TRACE
+#else
+#define LOG_LEVEL_DEFAULT			LOG_ERROR
+#define LOG_TAG_MASK_LVL_TRACE		LOG_TAG_BIT(LOGTAG_MCAL_CAN)
+#endif
+#define LOG_TOKEN_TAG_MASK			LogFlashSize_Mask
+
+#define LOG_FMT_TABLE(X)							\
+	X(FLASH_ARGS,	"a=%u b=%u c=%u")
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t LogFlashSize_Emitted[64][8];		/* [tag][level] records seen by the backend */
+static uint32_t LogFlashSize_Arg;
+
+static inline void LogFlashSize_Emit(const uint8_t* rec, uint8_t len)
+{
+	(void)len;
+	LogFlashSize_Emitted[rec[0] & 63u][(rec[1] >> 4) & 7u]++;
+}
+
+#define LOG_TOKEN_EMIT(_buf_, _len_)	LogFlashSize_Emit((_buf_), (_len_))
+
+#include "LogLevels.h"
+#include "LogTags.h"
+#include "LogFilter.h"
+#include "LogToken.h"
+
+/* Runtime mask: all tags on, so only the compile-time threshold removes calls. */
+static LogTagMask_t LogFlashSize_Mask = LOG_TAG_MASK_ALL;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Call sites: one per (tag, level), arguments read from a global so they cannot be folded away
+ *  - Tags listed again here: LOG_TAG_REGISTRY cannot be expanded inside LOG_TOKEN (it uses the registry itself).
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOGFLASH_TAGS(X)				\
+	X(LOGTAG_BOOT)						\
+	X(LOGTAG_SYS)						\
+	X(LOGTAG_MCAL_MCU)					\
+	X(LOGTAG_MCAL_PORT)					\
+	X(LOGTAG_MCAL_DIO)					\
+	X(LOGTAG_MCAL_GPT)					\
+	X(LOGTAG_MCAL_ICU)					\
+	X(LOGTAG_MCAL_ADC)					\
+	X(LOGTAG_MCAL_PWM)					\
+	X(LOGTAG_MCAL_CAN)					\
+	X(LOGTAG_MCAL_UART)					\
+	X(LOGTAG_ECU_PORTIF)				\
+	X(LOGTAG_ECU_SENSORIF)				\
+	X(LOGTAG_ECU_ADCIF)					\
+	X(LOGTAG_ECU_PWMIF)					\
+	X(LOGTAG_ECU_MOTORIF)				\
+	X(LOGTAG_ECU_CANIF)					\
+	X(LOGTAG_ECU_UARTIF)				\
+	X(LOGTAG_SRV_ECUM)					\
+	X(LOGTAG_SRV_PDUR)					\
+	X(LOGTAG_SRV_COM)					\
+	X(LOGTAG_SRV_DET)					\
+	X(LOGTAG_SRV_LOGGER)				\
+	X(LOGTAG_RTE)						\
+	X(LOGTAG_APP_SENSORSUPERVISOR)		\
+	X(LOGTAG_APP_OBSTACLEDETECTION)		\
+	X(LOGTAG_APP_PEDALREADER)			\
+	X(LOGTAG_APP_MOTORCONTROL)
+
+#define LOGFLASH_COUNT_ENTRY(_id_)		+ 1u
+
+typedef char LogFlashSize_TagsCheck_t[((0u LOGFLASH_TAGS(LOGFLASH_COUNT_ENTRY)) == (uint32_t)LOGTAG_COUNT) ? 1 : -1];
+
+#define LOGFLASH_CALLS(_id_)																					\
+	LOG_TOKEN(_id_, LOG_ERROR, LOG_FMT_FLASH_ARGS, LogFlashSize_Arg, LogFlashSize_Arg + 1u, LogFlashSize_Arg * 3u);	\
+	LOG_TOKEN(_id_, LOG_WARN,  LOG_FMT_FLASH_ARGS, LogFlashSize_Arg, LogFlashSize_Arg + 1u, LogFlashSize_Arg * 3u);	\
+	LOG_TOKEN(_id_, LOG_INFO,  LOG_FMT_FLASH_ARGS, LogFlashSize_Arg, LogFlashSize_Arg + 1u, LogFlashSize_Arg * 3u);	\
+	LOG_TOKEN(_id_, LOG_DEBUG, LOG_FMT_FLASH_ARGS, LogFlashSize_Arg, LogFlashSize_Arg + 1u, LogFlashSize_Arg * 3u);	\
+	LOG_TOKEN(_id_, LOG_TRACE, LOG_FMT_FLASH_ARGS, LogFlashSize_Arg, LogFlashSize_Arg + 1u, LogFlashSize_Arg * 3u);
+
+void LogFlashSize_CallSites(void)
+{
+	LOGFLASH_TAGS(LOGFLASH_CALLS)
+}
+
+int main(void)
+{
+	static const LogLevel_t levels[] = { LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG, LOG_TRACE };
+	uint32_t compiledIn = 0u;
+	uint32_t emitted = 0u;
+	uint32_t errors = 0u;
+	uint32_t tag;
+	uint32_t l;
+
+	memset(LogFlashSize_Emitted, 0, sizeof(LogFlashSize_Emitted));
+	LogFlashSize_Arg = 7u;
+	LogFlashSize_CallSites();
+
+	for (tag = 0u; tag < (uint32_t)LOGTAG_COUNT; tag++)
+	{
+		for (l = 0u; l < (sizeof(levels) / sizeof(levels[0])); l++)
+		{
+			bool expect = LOG_CT_ENABLE((LogTag_t)tag, levels[l]);
+			uint32_t got = LogFlashSize_Emitted[tag][levels[l]];
+
+			compiledIn += expect ? 1u : 0u;
+			emitted += got;
+			if (got != (expect ? 1u : 0u))
+			{
+				fprintf(stderr, "%s %c: emitted %u, compiled in %d\n", LOG_TagToString((LogTag_t)tag),
+						LOG_LevelChar(levels[l]), got, (int)expect);
+				errors++;
+			}
+		}
+	}
+
+#ifdef LOGFLASH_ALL_TRACE
+	printf("build           : LOGFLASH_ALL_TRACE (global LOG_LEVEL_DEFAULT = TRACE)\n");
+#else
+	printf("build           : per tag (MCAL.CAN TRACE, others ERROR)\n");
+#endif
+	printf("call sites      : %u\n", (unsigned)(LOGTAG_COUNT * (sizeof(levels) / sizeof(levels[0]))));
+	printf("compiled in     : %u\n", compiledIn);
+	printf("records emitted : %u\n", emitted);
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
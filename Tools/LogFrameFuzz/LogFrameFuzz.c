@@ -0,0 +1,344 @@
+/* =====================================================================================================================
+ *  File        : LogFrameFuzz.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Encoder benchmark and decoder fuzz test of the framed wire format (LogFrame.h)
+ *                 - Encoder: N records (random tags/levels/formats, small timestamp steps, mostly small arguments)
+ *                   encoded into one stream. Report bytes/record against the raw token record (LogToken.h) and the
+ *                   ASCII line the host prints for it (LOG_TokenFormat), and ns/record.
+ *                 - Clean decode: every record must come back identical (tag, level, timestamp, format, args).
+ *                 - Corrupted decode: random bytes of the stream are overwritten (delimiters included). Every frame
+ *                   whose bytes and leading delimiter are untouched must still decode to its record, i.e. the
+ *                   decoder recovers at the next delimiter; records accepted from damaged frames (CRC-8 collisions)
+ *                   are counted.
+ *                 - Random fuzz: the decoder is fed pure noise (no crash, no out of bounds with the sanitizer build).
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogFrameFuzz LogFrameFuzz.c
+ *                (sanitizers: cc -O1 -g -std=gnu11 -fsanitize=address,undefined -I../../Inc ...)
+ *  Usage       : LogFrameFuzz [-n records] [-c corruptions] [-s seed]
+ *                  -n  records in the stream (default 200000)
+ *                  -c  bytes overwritten in the corrupted pass (default 5000)
+ *                  -s  random seed (default 1)
+ *  Example     : LogFrameFuzz -n 1000000 -c 50000 -s 7
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+#define LOG_TOKEN_HOST_DECODER
+
+#define LOG_FMT_TABLE(X)											\
+	X(CAN_RX,		"rx id=0x%x dlc=%u")							\
+	X(CAN_BUSOFF,	"bus-off cnt=%u")								\
+	X(PDUR_ROUTE,	"route src=%u dst=%u len=%u res=%d")			\
+	X(DET_REPORT,	"det module=%u inst=%u api=0x%x err=0x%x")		\
+	X(ADC_SAMPLE,	"adc ch=%u raw=%u")								\
+	X(BOOT_DONE,	"boot done")
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LogFrame.h"
+
+/* Arguments per format, as the call sites pass them */
+static const uint8_t LogFrameFuzz_Argc[LOG_FMT_COUNT] = { 2u, 1u, 4u, 4u, 2u, 0u };
+
+typedef struct
+{
+	LogTag_t	Tag;
+	LogLevel_t	Level;
+	LogFmtId_t	FmtId;
+	uint32_t	Timestamp;
+	uint8_t		ArgCount;
+	uint32_t	Args[4];
+}LogFrameFuzzRec_t;
+
+static uint64_t LogFrameFuzz_Seed;
+
+/* xorshift64*, reproducible with -s */
+static uint32_t LogFrameFuzz_Rand(void)
+{
+	LogFrameFuzz_Seed ^= LogFrameFuzz_Seed >> 12;
+	LogFrameFuzz_Seed ^= LogFrameFuzz_Seed << 25;
+	LogFrameFuzz_Seed ^= LogFrameFuzz_Seed >> 27;
+	return (uint32_t)((LogFrameFuzz_Seed * 2685821657736338717ull) >> 32);
+}
+
+static double LogFrameFuzz_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static bool LogFrameFuzz_Same(const LogFrameFuzzRec_t* exp, const LogTokenRecord_t* got, bool timeValid)
+{
+	uint8_t i;
+
+	if ((got->Tag != exp->Tag) || (got->Level != exp->Level) || (got->FmtId != exp->FmtId) ||
+		(got->ArgCount != exp->ArgCount) || (timeValid && (got->Timestamp != exp->Timestamp)))
+	{
+		return false;
+	}
+	for (i = 0u; i < exp->ArgCount; i++)
+	{
+		if (got->Args[i] != exp->Args[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Decode the stream; End[k] = offset of the delimiter closing the frame of record k.
+ *  - damaged == NULL: clean pass, every record must decode identical and in order.
+ *  - damaged != NULL: a record is expected back only when its frame (and the delimiter before it) is untouched.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t LogFrameFuzz_Decode(const uint8_t* stream, size_t len, const LogFrameFuzzRec_t* recs,
+									const size_t* end, uint32_t count, const uint8_t* damaged, uint32_t* falseRecs,
+									uint32_t* decoded)
+{
+	LogFrameDecoder_t dec;
+	LogTokenRecord_t rec;
+	uint32_t errors = 0u;
+	uint32_t k = 0u;
+	size_t i;
+
+	LOG_FrameDecoderInit(&dec);
+	*falseRecs = 0u;
+	*decoded = 0u;
+	for (i = 0u; i < len; i++)
+	{
+		LogFrameResult_t res = LOG_FrameDecodeByte(&dec, stream[i], &rec);
+		bool intact;
+
+		while ((k < count) && (end[k] < i))
+		{
+			k++;
+		}
+		if ((k >= count) || (end[k] != i))
+		{
+			/* Not the end of a record frame: only a damaged region may produce a record here. */
+			if (res == LOG_FRAME_RECORD)
+			{
+				(*falseRecs)++;
+			}
+			continue;
+		}
+
+		intact = true;
+		if (damaged != NULL)
+		{
+			size_t start = (k == 0u) ? 0u : end[k - 1u];
+			size_t j;
+
+			/* From the delimiter of the previous record (sync frames in between included) to ours. */
+			for (j = start; j <= i; j++)
+			{
+				intact = intact && (damaged[j] == 0u);
+			}
+		}
+
+		if (res == LOG_FRAME_RECORD)
+		{
+			(*decoded)++;
+			if (!LogFrameFuzz_Same(&recs[k], &rec, dec.TimeValid))
+			{
+				if (intact)
+				{
+					errors++;
+				}
+				else
+				{
+					(*falseRecs)++;
+				}
+			}
+		}
+		else if (intact)
+		{
+			if (errors < 5u)
+			{
+				fprintf(stderr, "record %u: intact frame not decoded\n", k);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static void LogFrameFuzz_Usage(void)
+{
+	fprintf(stderr, "usage: LogFrameFuzz [-n records] [-c corruptions] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	LogFrameFuzzRec_t* recs;
+	LogFrameEncoder_t enc;
+	size_t* end;
+	uint8_t* stream;
+	uint8_t* damaged;
+	uint32_t count = 200000u;
+	uint32_t corruptions = 5000u;
+	uint64_t tokenBytes = 0u;
+	uint64_t asciiBytes = 0u;
+	size_t len = 0u;
+	uint32_t ts = 1000u;
+	uint32_t errors = 0u;
+	uint32_t falseRecs;
+	uint32_t decoded;
+	uint32_t e;
+	uint32_t k;
+	double t0;
+	double encSec;
+	double decSec;
+	int o;
+
+	LogFrameFuzz_Seed = 1u;
+	while ((o = getopt(argc, argv, "n:c:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				count = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				corruptions = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				LogFrameFuzz_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				LogFrameFuzz_Usage();
+				return 2;
+		}
+	}
+	if (count == 0u)
+	{
+		LogFrameFuzz_Usage();
+		return 2;
+	}
+
+	recs = malloc(sizeof(*recs) * count);
+	end = malloc(sizeof(*end) * count);
+	stream = malloc((size_t)count * LOG_FRAME_MAX_SIZE);
+	damaged = calloc((size_t)count * LOG_FRAME_MAX_SIZE, 1u);
+	if ((recs == NULL) || (end == NULL) || (stream == NULL) || (damaged == NULL))
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	/* Records: mostly small arguments (ids, lengths, counters), some full 32-bit values */
+	for (k = 0u; k < count; k++)
+	{
+		LogFrameFuzzRec_t* r = &recs[k];
+		LogTokenRecord_t tok;
+		char line[256];
+		uint8_t a;
+
+		ts += LogFrameFuzz_Rand() % 20u;
+		r->Tag = (LogTag_t)(LogFrameFuzz_Rand() % (uint32_t)LOGTAG_COUNT);
+		r->Level = (LogLevel_t)(1u + (LogFrameFuzz_Rand() % ((uint32_t)LOG_LEVEL_COUNT - 1u)));
+		r->FmtId = (LogFmtId_t)(LogFrameFuzz_Rand() % LOG_FMT_COUNT);
+		r->Timestamp = ts;
+		r->ArgCount = LogFrameFuzz_Argc[r->FmtId];
+		for (a = 0u; a < r->ArgCount; a++)
+		{
+			uint32_t v = LogFrameFuzz_Rand();
+
+			r->Args[a] = ((v & 15u) == 0u) ? v : (v % 2048u);
+		}
+
+		tok.Tag = r->Tag;
+		tok.Level = r->Level;
+		tok.FmtId = r->FmtId;
+		tok.Timestamp = r->Timestamp;
+		tok.ArgCount = r->ArgCount;
+		memcpy(tok.Args, r->Args, sizeof(r->Args));
+		tokenBytes += LOG_TOKEN_HDR_SIZE + (4u * r->ArgCount);
+		asciiBytes += (uint64_t)LOG_TokenFormat(&tok, LOG_FmtStrings, LOG_FMT_COUNT, line, sizeof(line)) + 1u;
+	}
+
+	/* Encoder */
+	LOG_FrameEncoderInit(&enc);
+	t0 = LogFrameFuzz_Now();
+	for (k = 0u; k < count; k++)
+	{
+		const LogFrameFuzzRec_t* r = &recs[k];
+
+		len += LOG_FrameEncode(&enc, r->Tag, r->Level, r->FmtId, r->Timestamp, r->Args, r->ArgCount, &stream[len]);
+		end[k] = len - 1u;
+	}
+	encSec = LogFrameFuzz_Now() - t0;
+
+	printf("%u records\n", count);
+	printf("bytes/record    : frame %.2f, token %.2f, ASCII %.2f -> %.2fx smaller than ASCII\n",
+		   (double)len / count, (double)tokenBytes / count, (double)asciiBytes / count,
+		   (double)asciiBytes / (double)len);
+	printf("encode          : %.1f ns/record\n", (encSec * 1e9) / count);
+
+	/* Clean decode */
+	t0 = LogFrameFuzz_Now();
+	e = LogFrameFuzz_Decode(stream, len, recs, end, count, NULL, &falseRecs, &decoded);
+	decSec = LogFrameFuzz_Now() - t0;
+	printf("decode clean    : %u/%u records, %u errors, %.1f MB/s\n", decoded, count, e + falseRecs,
+		   ((double)len / decSec) * 1e-6);
+	errors += e + falseRecs + (count - decoded);
+
+	/* Corrupted decode */
+	for (k = 0u; k < corruptions; k++)
+	{
+		size_t pos = (size_t)(((uint64_t)LogFrameFuzz_Rand() << 32 | LogFrameFuzz_Rand()) % len);
+		uint8_t v = (uint8_t)LogFrameFuzz_Rand();
+
+		if ((LogFrameFuzz_Rand() & 7u) == 0u)
+		{
+			v = LOG_FRAME_DELIMITER;		/* Spurious delimiter: splits a frame */
+		}
+		if (stream[pos] != v)
+		{
+			stream[pos] = v;
+			damaged[pos] = 1u;
+		}
+	}
+	e = LogFrameFuzz_Decode(stream, len, recs, end, count, damaged, &falseRecs, &decoded);
+	printf("decode corrupt  : %u bytes hit, %u/%u records recovered, %u intact frames lost, "
+		   "%u records from damaged frames\n", corruptions, decoded, count, e, falseRecs);
+	errors += e;
+
+	/* Pure noise */
+	{
+		LogFrameDecoder_t dec;
+		LogTokenRecord_t rec;
+		uint32_t accepted = 0u;
+
+		LOG_FrameDecoderInit(&dec);
+		for (k = 0u; k < 20000000u; k++)
+		{
+			uint32_t v = LogFrameFuzz_Rand();
+			uint8_t byte = ((v & 0x3Fu) == 0u) ? LOG_FRAME_DELIMITER : (uint8_t)(v >> 8);
+
+			if (LOG_FrameDecodeByte(&dec, byte, &rec) == LOG_FRAME_RECORD)
+			{
+				accepted++;
+				if ((rec.Tag >= LOGTAG_COUNT) || (rec.Level >= LOG_LEVEL_COUNT) ||
+					(rec.ArgCount > LOG_TOKEN_MAX_ARGS))
+				{
+					errors++;
+				}
+			}
+		}
+		printf("random fuzz     : 20000000 bytes, %u frames rejected, %u passed CRC-8\n", dec.Errors, accepted);
+	}
+
+	printf("errors          : %u\n", errors);
+	free(recs);
+	free(end);
+	free(stream);
+	free(damaged);
+	return (errors == 0u) ? 0 : 1;
+}
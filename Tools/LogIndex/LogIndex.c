@@ -0,0 +1,612 @@
+/* =====================================================================================================================
+ *  File        : LogIndex.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Index and query log captures without re-decoding the whole file
+ *                 - The capture (LogCapture.h header + token or framed records) is memory-mapped.
+ *                 - A side index "<capture>.idx" keeps one summary per block of records: file offset, decoder
+ *                   state, tag mask, level mask and timestamp range. It is rebuilt when the capture changes.
+ *                 - A query only decodes the blocks whose summary can match.
+ *                 - Without -s/-e every record matches on tag and level alone, including records of a framed
+ *                   capture whose timestamp is unknown (frame lost since the last sync).
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogIndex LogIndex.c
+ *                (add -DLOG_FMT_TABLE=... or -include <app fmt header> to print formatted text)
+ *  Usage       : LogIndex [-t tag]... [-l level] [-s t1] [-e t2] [-r role] [-f] [-B] capture...
+ *                  -t  tag name ("SRV.Det"), abbreviation ("S.DET"), enum name ("LOGTAG_SRV_DET") or number
+ *                  -l  records at least this severe (ERROR, WARN, ...)
+ *                  -s/-e  timestamp range [t1, t2], only records with a known timestamp match
+ *                  -r  only captures from this ECU role (SENSOR, MOTOR, UNKNOWN)
+ *                  -f  force index rebuild
+ *                  -B  benchmark: index build throughput (GB/s, capture decode only, .idx write not timed) and
+ *                      query latency
+ *  Example     : LogIndex -t LOGTAG_SRV_DET -l ERROR -s 10000 -e 20000 -r MOTOR motor.cap
+ *                (synthetic captures for -B: Tools/LogCaptureGen)
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+#define LOG_TOKEN_HOST_DECODER
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "LogCapture.h"
+#include "LogFrame.h"
+#include "LogTags.h"
+#include "LogToken.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Side index layout
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define LOG_INDEX_MAGIC			"LOGIDX1"
+#define LOG_INDEX_BLOCK_RECORDS	(4096u)
+
+typedef struct
+{
+	char		Magic[8];
+	uint64_t	CaptureSize;
+	int64_t		CaptureMtime;
+	uint32_t	BlockRecords;
+	uint32_t	BlockCount;
+}LogIndexHeader_t;
+
+typedef struct
+{
+	uint64_t	Offset;			/* First record (or frame) of the block.*/
+	uint64_t	TagMask;
+	uint32_t	MinTs;			/* MinTs > MaxTs: no record with a valid timestamp.*/
+	uint32_t	MaxTs;
+	uint32_t	StartTs;		/* Decoder LastTimestamp at Offset (framed format).*/
+	uint32_t	Records;
+	uint8_t		LevelMask;
+	uint8_t		TimeValid;		/* Decoder TimeValid at Offset (framed format).*/
+	uint8_t		Reserved[6];
+}LogIndexBlock_t;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Capture and cursor
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	const char*			Path;
+	const uint8_t*		Data;
+	uint64_t			Size;
+	int64_t				Mtime;
+	LogCaptureHeader_t	Hdr;
+	LogIndexBlock_t*	Blocks;
+	uint32_t			BlockCount;
+}LogCaptureFile_t;
+
+typedef struct
+{
+	uint64_t			Pos;
+	LogFrameDecoder_t	Dec;
+}LogCursor_t;
+
+typedef struct
+{
+	LogTagMask_t	Tags;
+	uint8_t			Levels;
+	uint32_t		T1;
+	uint32_t		T2;
+	bool			TimeRange;	/* -s or -e given: T1..T2 applies.*/
+	int				Role;		/* -1: any.*/
+}LogQuery_t;
+
+static const char* const LogIndex_TagIds[] =
+{
+#define LOG_INDEX_TAG_ID_ENTRY(_id_, _name_, _abbr_, _layer_, _lvl_, _mask_, _burst_, _rate_)	#_id_,
+	LOG_TAG_REGISTRY(LOG_INDEX_TAG_ID_ENTRY)
+#undef LOG_INDEX_TAG_ID_ENTRY
+};
+
+static double LogIndex_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Next record at the cursor, return 0 at end of capture.
+ *  - timeValid: false when the timestamp is unknown (framed capture, frame lost since the last sync).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int LogIndex_Next(const LogCaptureFile_t* cap, LogCursor_t* cur, LogTokenRecord_t* rec, bool* timeValid)
+{
+	uint8_t payload[LOG_FRAME_MAX_ENCODED];
+	const uint8_t* frame;
+	const uint8_t* end;
+	uint64_t len;
+	uint16_t n;
+	uint8_t plen;
+
+	while (cur->Pos < cap->Size)
+	{
+		if (cap->Hdr.Format == (uint8_t)LOG_CAPTURE_FMT_TOKEN)
+		{
+			len = cap->Size - cur->Pos;
+			n = LOG_TokenDecode(&cap->Data[cur->Pos], (uint16_t)((len > 0xFFFFu) ? 0xFFFFu : len), rec);
+			if (n == 0u)
+			{
+				cur->Pos++;			/* Corrupted byte: no framing to resync on, skip it. */
+				continue;
+			}
+			cur->Pos += n;
+			*timeValid = true;
+			return 1;
+		}
+
+		frame = &cap->Data[cur->Pos];
+		end = memchr(frame, LOG_FRAME_DELIMITER, (size_t)(cap->Size - cur->Pos));
+		len = (end != NULL) ? (uint64_t)(end - frame) : (cap->Size - cur->Pos);
+		cur->Pos += len + 1u;
+		if (len == 0u)
+		{
+			continue;
+		}
+
+		plen = (len <= LOG_FRAME_MAX_ENCODED) ? LOG_FrameCobsDecode(frame, (uint8_t)len, payload) : 0u;
+		switch ((plen == 0u) ? LOG_FRAME_ERROR : LOG_FrameParse(&cur->Dec, payload, plen, rec))
+		{
+			case LOG_FRAME_RECORD:
+				*timeValid = cur->Dec.TimeValid;
+				return 1;
+			case LOG_FRAME_ERROR:
+				cur->Dec.Errors++;
+				cur->Dec.TimeValid = false;
+				break;
+			case LOG_FRAME_NONE:
+			default:
+				break;
+		}
+	}
+	return 0;
+}
+
+static void LogIndex_CursorAt(const LogCaptureFile_t* cap, const LogIndexBlock_t* blk, LogCursor_t* cur)
+{
+	(void)cap;
+	LOG_FrameDecoderInit(&cur->Dec);
+	cur->Pos = blk->Offset;
+	cur->Dec.LastTimestamp = blk->StartTs;
+	cur->Dec.TimeValid = (blk->TimeValid != 0u);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Build the index in memory
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int LogIndex_Build(LogCaptureFile_t* cap)
+{
+	LogTokenRecord_t rec;
+	LogIndexBlock_t* blk = NULL;
+	LogCursor_t cur;
+	uint32_t capacity = 64u;
+	uint64_t start;
+	bool timeValid;
+
+	free(cap->Blocks);
+	cap->Blocks = malloc(capacity * sizeof(LogIndexBlock_t));
+	cap->BlockCount = 0u;
+	if (cap->Blocks == NULL)
+	{
+		return -1;
+	}
+
+	LOG_FrameDecoderInit(&cur.Dec);
+	cur.Pos = LOG_CAPTURE_HDR_SIZE;
+
+	for (;;)
+	{
+		start = cur.Pos;
+		if ((blk == NULL) || (blk->Records == LOG_INDEX_BLOCK_RECORDS))
+		{
+			/* Decoder state is saved before the first record of the new block is read. */
+			if (cap->BlockCount == capacity)
+			{
+				LogIndexBlock_t* grown = realloc(cap->Blocks, 2u * capacity * sizeof(LogIndexBlock_t));
+				if (grown == NULL)
+				{
+					return -1;
+				}
+				cap->Blocks = grown;
+				capacity *= 2u;
+			}
+			blk = &cap->Blocks[cap->BlockCount++];
+			memset(blk, 0, sizeof(*blk));
+			blk->Offset = start;
+			blk->StartTs = cur.Dec.LastTimestamp;
+			blk->TimeValid = cur.Dec.TimeValid ? 1u : 0u;
+			blk->MinTs = UINT32_MAX;
+			blk->MaxTs = 0u;
+		}
+
+		if (LogIndex_Next(cap, &cur, &rec, &timeValid) == 0)
+		{
+			break;
+		}
+
+		blk->Records++;
+		blk->TagMask |= LOG_TAG_BIT(rec.Tag);
+		blk->LevelMask |= (uint8_t)(1u << rec.Level);
+		if (timeValid)
+		{
+			blk->MinTs = (rec.Timestamp < blk->MinTs) ? rec.Timestamp : blk->MinTs;
+			blk->MaxTs = (rec.Timestamp > blk->MaxTs) ? rec.Timestamp : blk->MaxTs;
+		}
+	}
+
+	if ((blk != NULL) && (blk->Records == 0u))
+	{
+		cap->BlockCount--;
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Side index file: load it if it matches the capture, return -1 when it has to be built
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int LogIndex_Load(LogCaptureFile_t* cap)
+{
+	LogIndexHeader_t hdr;
+	char path[4096];
+	FILE* f;
+
+	snprintf(path, sizeof(path), "%s.idx", cap->Path);
+
+	f = fopen(path, "rb");
+	if (f != NULL)
+	{
+		if ((fread(&hdr, sizeof(hdr), 1u, f) == 1u) && (memcmp(hdr.Magic, LOG_INDEX_MAGIC, 8u) == 0) &&
+			(hdr.CaptureSize == cap->Size) && (hdr.CaptureMtime == cap->Mtime) &&
+			(hdr.BlockRecords == LOG_INDEX_BLOCK_RECORDS))
+		{
+			cap->Blocks = malloc(((size_t)hdr.BlockCount + 1u) * sizeof(LogIndexBlock_t));
+			if ((cap->Blocks != NULL) &&
+				(fread(cap->Blocks, sizeof(LogIndexBlock_t), hdr.BlockCount, f) == hdr.BlockCount))
+			{
+				cap->BlockCount = hdr.BlockCount;
+				fclose(f);
+				return 0;
+			}
+		}
+		fclose(f);
+	}
+	return -1;
+}
+
+static void LogIndex_Save(const LogCaptureFile_t* cap)
+{
+	LogIndexHeader_t hdr;
+	char path[4096];
+	FILE* f;
+
+	snprintf(path, sizeof(path), "%s.idx", cap->Path);
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.Magic, LOG_INDEX_MAGIC, 8u);
+	hdr.CaptureSize = cap->Size;
+	hdr.CaptureMtime = cap->Mtime;
+	hdr.BlockRecords = LOG_INDEX_BLOCK_RECORDS;
+	hdr.BlockCount = cap->BlockCount;
+
+	f = fopen(path, "wb");
+	if (f != NULL)
+	{
+		/* A capture on read-only media simply keeps the index in memory. */
+		(void)fwrite(&hdr, sizeof(hdr), 1u, f);
+		(void)fwrite(cap->Blocks, sizeof(LogIndexBlock_t), cap->BlockCount, f);
+		fclose(f);
+	}
+}
+
+static int LogIndex_Open(LogCaptureFile_t* cap, const char* path)
+{
+	struct stat st;
+	int fd;
+
+	memset(cap, 0, sizeof(*cap));
+	cap->Path = path;
+
+	fd = open(path, O_RDONLY);
+	if ((fd < 0) || (fstat(fd, &st) != 0))
+	{
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		return -1;
+	}
+
+	cap->Size = (uint64_t)st.st_size;
+	cap->Mtime = (int64_t)st.st_mtime;
+	cap->Data = (cap->Size != 0u) ? mmap(NULL, (size_t)cap->Size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+
+	if (cap->Data == MAP_FAILED)
+	{
+		fprintf(stderr, "%s: cannot map capture\n", path);
+		return -1;
+	}
+	(void)madvise((void*)cap->Data, (size_t)cap->Size, MADV_SEQUENTIAL);
+
+	if (!LOG_CaptureHeaderDecode(cap->Data, (uint32_t)((cap->Size > 0xFFFFFFFFu) ? 0xFFFFFFFFu : cap->Size),
+								 &cap->Hdr))
+	{
+		fprintf(stderr, "%s: missing or invalid capture header\n", path);
+		munmap((void*)cap->Data, (size_t)cap->Size);
+		return -1;
+	}
+	if (cap->Hdr.TagCount != (uint8_t)LOGTAG_COUNT)
+	{
+		fprintf(stderr, "%s: warning, capture has %u tags, this tool %u\n", path,
+				(unsigned)cap->Hdr.TagCount, (unsigned)LOGTAG_COUNT);
+	}
+	return 0;
+}
+
+static void LogIndex_Close(LogCaptureFile_t* cap)
+{
+	free(cap->Blocks);
+	munmap((void*)cap->Data, (size_t)cap->Size);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Query: only blocks whose summary can match are decoded, return number of matching records
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint64_t LogIndex_Query(const LogCaptureFile_t* cap, const LogQuery_t* q, FILE* out)
+{
+	const LogIndexBlock_t* blk;
+	LogTokenRecord_t rec;
+	LogCursor_t cur;
+	uint64_t matches = 0u;
+	uint32_t b;
+	uint32_t r;
+	bool timeValid;
+	char text[512];
+
+	for (b = 0u; b < cap->BlockCount; b++)
+	{
+		blk = &cap->Blocks[b];
+		if (((blk->TagMask & q->Tags) == 0u) || ((blk->LevelMask & q->Levels) == 0u) ||
+			(q->TimeRange && ((blk->MinTs > blk->MaxTs) || (blk->MaxTs < q->T1) || (blk->MinTs > q->T2))))
+		{
+			continue;
+		}
+
+		LogIndex_CursorAt(cap, blk, &cur);
+		for (r = 0u; (r < blk->Records) && (LogIndex_Next(cap, &cur, &rec, &timeValid) != 0); r++)
+		{
+			if (!LOG_TAG_ENABLE(q->Tags, rec.Tag) || ((q->Levels & (1u << rec.Level)) == 0u) ||
+				(q->TimeRange && (!timeValid || (rec.Timestamp < q->T1) || (rec.Timestamp > q->T2))))
+			{
+				continue;
+			}
+
+			matches++;
+			if (out == NULL)
+			{
+				continue;
+			}
+#ifdef LOG_FMT_TABLE
+			(void)LOG_TokenFormat(&rec, LOG_FmtStrings, (uint16_t)LOG_FMT_COUNT, text, sizeof(text));
+#else
+			{
+				uint8_t i;
+				int n = snprintf(text, sizeof(text), "%10lu %c %-12s: fmt=%u", (unsigned long)rec.Timestamp,
+								 LOG_LevelChar(rec.Level), LOG_TagToString(rec.Tag), (unsigned)rec.FmtId);
+				for (i = 0u; (i < rec.ArgCount) && (n > 0) && ((size_t)n < sizeof(text)); i++)
+				{
+					n += snprintf(&text[n], sizeof(text) - (size_t)n, " 0x%lx", (unsigned long)rec.Args[i]);
+				}
+			}
+#endif
+			fprintf(out, "%-7s %s\n", LOG_EcuRoleIdString(cap->Hdr.EcuRole), text);
+		}
+	}
+	return matches;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Argument helpers
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int LogIndex_ParseTag(const char* s)
+{
+	char abbr[LOG_TAG_ABBREV_LEN + 1u];
+	char* endp;
+	long v;
+	int t;
+	int k;
+
+	for (t = 0; t < (int)LOGTAG_COUNT; t++)
+	{
+		memcpy(abbr, LOG_TagAbbrev((LogTag_t)t), sizeof(abbr));
+		for (k = (int)LOG_TAG_ABBREV_LEN - 1; (k >= 0) && (abbr[k] == ' '); k--)
+		{
+			abbr[k] = '\0';
+		}
+		if ((strcasecmp(s, LOG_TagToString((LogTag_t)t)) == 0) || (strcasecmp(s, abbr) == 0) ||
+			(strcasecmp(s, LogIndex_TagIds[t]) == 0))
+		{
+			return t;
+		}
+	}
+
+	v = strtol(s, &endp, 0);
+	return ((*endp == '\0') && (v >= 0) && (v < (long)LOGTAG_COUNT)) ? (int)v : -1;
+}
+
+static int LogIndex_ParseLevel(const char* s)
+{
+	int l;
+
+	for (l = (int)LOG_ERROR; l < (int)LOG_LEVEL_COUNT; l++)
+	{
+		if (strcasecmp(s, LOG_LevelToString((LogLevel_t)l)) == 0)
+		{
+			return l;
+		}
+	}
+	return -1;
+}
+
+static int LogIndex_ParseRole(const char* s)
+{
+	int r;
+
+	for (r = ECU_UNKNOWN; r <= ECU_MOTOR; r++)
+	{
+		if (strcasecmp(s, LOG_EcuRoleIdString((uint8_t)r)) == 0)
+		{
+			return r;
+		}
+	}
+	return -1;
+}
+
+static void LogIndex_Usage(void)
+{
+	fprintf(stderr, "usage: LogIndex [-t tag]... [-l level] [-s t1] [-e t2] [-r role] [-f] [-B] capture...\n");
+}
+
+int main(int argc, char** argv)
+{
+	LogCaptureFile_t cap;
+	LogQuery_t q;
+	uint64_t matches = 0u;
+	uint64_t bytes;
+	double t0;
+	double dt;
+	bool force = false;
+	bool bench = false;
+	int opt;
+	int v;
+	int i;
+	int k;
+
+	q.Tags = LOG_TAG_MASK_NONE;
+	q.Levels = 0xFFu;
+	q.T1 = 0u;
+	q.T2 = UINT32_MAX;
+	q.TimeRange = false;
+	q.Role = -1;
+
+	while ((opt = getopt(argc, argv, "t:l:s:e:r:fB")) != -1)
+	{
+		switch (opt)
+		{
+			case 't':
+				v = LogIndex_ParseTag(optarg);
+				if (v < 0)
+				{
+					fprintf(stderr, "unknown tag '%s'\n", optarg);
+					return 2;
+				}
+				q.Tags |= LOG_TAG_BIT(v);
+				break;
+			case 'l':
+				v = LogIndex_ParseLevel(optarg);
+				if (v < 0)
+				{
+					fprintf(stderr, "unknown level '%s'\n", optarg);
+					return 2;
+				}
+				/* ERROR..level, i.e. at least as severe */
+				q.Levels = (uint8_t)(((1u << (v + 1)) - 1u) & ~(1u << LOG_OFF));
+				break;
+			case 's':
+				q.T1 = (uint32_t)strtoul(optarg, NULL, 0);
+				q.TimeRange = true;
+				break;
+			case 'e':
+				q.T2 = (uint32_t)strtoul(optarg, NULL, 0);
+				q.TimeRange = true;
+				break;
+			case 'r':
+				q.Role = LogIndex_ParseRole(optarg);
+				if (q.Role < 0)
+				{
+					fprintf(stderr, "unknown ECU role '%s'\n", optarg);
+					return 2;
+				}
+				break;
+			case 'f':
+				force = true;
+				break;
+			case 'B':
+				bench = true;
+				break;
+			default:
+				LogIndex_Usage();
+				return 2;
+		}
+	}
+
+	if (optind >= argc)
+	{
+		LogIndex_Usage();
+		return 2;
+	}
+	if (q.Tags == LOG_TAG_MASK_NONE)
+	{
+		q.Tags = LOG_TAG_MASK_ALL;
+	}
+
+	for (i = optind; i < argc; i++)
+	{
+		if (LogIndex_Open(&cap, argv[i]) != 0)
+		{
+			continue;
+		}
+		if ((q.Role >= 0) && (cap.Hdr.EcuRole != (uint8_t)q.Role))
+		{
+			LogIndex_Close(&cap);
+			continue;
+		}
+
+		/* -B always builds: the timed part is the capture decode, the .idx write comes after. */
+		dt = 0.0;
+		if (force || bench || (LogIndex_Load(&cap) != 0))
+		{
+			t0 = LogIndex_Now();
+			if (LogIndex_Build(&cap) != 0)
+			{
+				fprintf(stderr, "%s: cannot build index\n", argv[i]);
+				LogIndex_Close(&cap);
+				continue;
+			}
+			dt = LogIndex_Now() - t0;
+			LogIndex_Save(&cap);
+		}
+
+		if (bench)
+		{
+			bytes = cap.Size;
+			fprintf(stderr, "%s: index %u blocks, %.3f s, %.3f GB/s\n", argv[i], cap.BlockCount, dt,
+					((double)bytes / 1e9) / ((dt > 0.0) ? dt : 1e-9));
+
+			t0 = LogIndex_Now();
+			for (k = 0; k < 100; k++)
+			{
+				matches = LogIndex_Query(&cap, &q, NULL);
+			}
+			dt = (LogIndex_Now() - t0) / 100.0;
+			fprintf(stderr, "%s: query %llu matches, %.3f ms\n", argv[i], (unsigned long long)matches, dt * 1e3);
+		}
+		else
+		{
+			matches += LogIndex_Query(&cap, &q, stdout);
+		}
+
+		LogIndex_Close(&cap);
+	}
+
+	return (matches != 0u) ? 0 : 1;
+}
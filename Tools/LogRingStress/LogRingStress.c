@@ -0,0 +1,307 @@
+/* =====================================================================================================================
+ *  File        : LogRingStress.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Multi-producer stress test of the lock-free log ring (LogRing.h)
+ *                 - P producer threads stand in for the CAN/UART ISRs and tasks, each pushes records of its own tag
+ *                   carrying (producer, sequence); one consumer thread stands in for the logger main function.
+ *                 - Checks: no record lost or duplicated without being counted, per producer FIFO order,
+ *                   Dropped[tag] equals the pushes refused for that tag.
+ *                 - Report: sustained records/s through the ring, refused pushes in % of all pushes and worst /
+ *                   average reserve (push) latency.
+ *                 - Default: a refused record is yielded and pushed again (every refusal still counted), so
+ *                   records/s is the sustained rate with no loss even on a host with fewer cores than threads.
+ *                   -d: a refused record is lost, as in an ISR; on a host with fewer cores than threads most
+ *                   records are then refused, read records/s together with the refused ratio.
+ *  Build       : cc -O2 -std=gnu11 -pthread -I../../Inc -o LogRingStress LogRingStress.c
+ *                (add -DLOG_RING_SIZE=n to test another ring size, default is the target size)
+ *  Usage       : LogRingStress [-p producers] [-n records] [-d]
+ *                  -p  producer threads (1..LOGRING_STRESS_MAX_PRODUCERS, default 4)
+ *                  -n  records per producer (default 2000000)
+ *                  -d  drop refused records (ISR behaviour) instead of retrying after sched_yield()
+ *  Example     : LogRingStress -p 8 -n 10000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LogTags.h"
+#include "LogRing.h"
+
+#define LOGRING_STRESS_MAX_PRODUCERS	(16u)
+#define LOGRING_STRESS_REC_LEN			(6u)		/* tag, producer, 32-bit sequence */
+
+/* Producers rotate over the tags that log from interrupt and task context. */
+static const LogTag_t LogRingStress_Tags[] =
+{
+	LOGTAG_MCAL_CAN,
+	LOGTAG_ECU_CANIF,
+	LOGTAG_SRV_PDUR,
+	LOGTAG_MCAL_UART,
+};
+
+#define LOGRING_STRESS_TAG_COUNT		(sizeof(LogRingStress_Tags) / sizeof(LogRingStress_Tags[0]))
+
+typedef struct
+{
+	pthread_t	Thread;
+	uint8_t		Id;
+	LogTag_t	Tag;
+	uint32_t	Records;
+	uint32_t	Pushed;				/* E_OK */
+	uint32_t	Refused;			/* E_NOT_OK (ring full) */
+	uint64_t	Attempts;
+	uint64_t	WorstNs;
+	uint64_t	TotalNs;
+}LogRingStressProducer_t;
+
+static LogRing_t LogRingStress_Ring;
+static LogRingStressProducer_t LogRingStress_Producer[LOGRING_STRESS_MAX_PRODUCERS];
+static atomic_uint LogRingStress_Running;
+static bool LogRingStress_Retry = true;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Time
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint64_t LogRingStress_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Producer: push Records records, a refused record is counted and retried after a yield or lost as in an ISR (-d)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void* LogRingStress_ProducerMain(void* arg)
+{
+	LogRingStressProducer_t* p = (LogRingStressProducer_t*)arg;
+	uint8_t rec[LOGRING_STRESS_REC_LEN];
+	uint32_t seq;
+
+	rec[0] = (uint8_t)p->Tag;
+	rec[1] = p->Id;
+	for (seq = 0u; seq < p->Records; )
+	{
+		uint64_t t0;
+		uint64_t dt;
+		Std_ReturnType ret;
+
+		rec[2] = (uint8_t)seq;
+		rec[3] = (uint8_t)(seq >> 8);
+		rec[4] = (uint8_t)(seq >> 16);
+		rec[5] = (uint8_t)(seq >> 24);
+
+		t0 = LogRingStress_NowNs();
+		ret = LOG_RingPush(&LogRingStress_Ring, p->Tag, rec, LOGRING_STRESS_REC_LEN);
+		dt = LogRingStress_NowNs() - t0;
+		p->Attempts++;
+		p->TotalNs += dt;
+		if (dt > p->WorstNs)
+		{
+			p->WorstNs = dt;
+		}
+
+		if (ret == E_OK)
+		{
+			p->Pushed++;
+			seq++;
+		}
+		else
+		{
+			p->Refused++;
+			if (LogRingStress_Retry)
+			{
+				(void)sched_yield();
+			}
+			else
+			{
+				seq++;
+			}
+		}
+	}
+	(void)atomic_fetch_sub(&LogRingStress_Running, 1u);
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Consumer: pop until every producer is done and the ring is empty, check order per producer
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint64_t	Popped[LOGRING_STRESS_MAX_PRODUCERS];
+	int64_t		LastSeq[LOGRING_STRESS_MAX_PRODUCERS];
+	uint32_t	Errors;
+}LogRingStressConsumer_t;
+
+static uint32_t LogRingStress_Consume(LogRingStressConsumer_t* c, uint8_t producers)
+{
+	uint8_t buf[LOG_RING_SLOT_SIZE];
+	uint32_t n = 0u;
+	uint8_t len;
+
+	while ((len = LOG_RingPop(&LogRingStress_Ring, buf)) != 0u)
+	{
+		uint8_t id = buf[1];
+		int64_t seq = (int64_t)((uint32_t)buf[2] | ((uint32_t)buf[3] << 8) | ((uint32_t)buf[4] << 16) |
+								((uint32_t)buf[5] << 24));
+
+		n++;
+		if ((len != LOGRING_STRESS_REC_LEN) || (id >= producers) ||
+			(buf[0] != (uint8_t)LogRingStress_Producer[id].Tag) || (seq <= c->LastSeq[id]))
+		{
+			if (c->Errors < 5u)
+			{
+				fprintf(stderr, "bad record: len %u producer %u tag %u seq %lld\n", len, id, buf[0],
+						(long long)seq);
+			}
+			c->Errors++;
+			continue;
+		}
+		c->LastSeq[id] = seq;
+		c->Popped[id]++;
+	}
+	return n;
+}
+
+static void LogRingStress_Usage(void)
+{
+	fprintf(stderr, "usage: LogRingStress [-p producers] [-n records] [-d]\n");
+}
+
+int main(int argc, char** argv)
+{
+	LogRingStressConsumer_t cons;
+	uint32_t expectDropped[LOGTAG_COUNT];
+	uint32_t producers = 4u;
+	uint32_t records = 2000000u;
+	uint64_t popped = 0u;
+	uint64_t worstNs = 0u;
+	uint64_t totalNs = 0u;
+	uint64_t attempts = 0u;
+	uint64_t refused = 0u;
+	uint64_t t0;
+	double sec;
+	uint32_t errors;
+	uint32_t i;
+	int o;
+
+	while ((o = getopt(argc, argv, "p:n:d")) != -1)
+	{
+		switch (o)
+		{
+			case 'p':
+				producers = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				records = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				LogRingStress_Retry = false;
+				break;
+			default:
+				LogRingStress_Usage();
+				return 2;
+		}
+	}
+	if ((producers == 0u) || (producers > LOGRING_STRESS_MAX_PRODUCERS) || (records == 0u))
+	{
+		LogRingStress_Usage();
+		return 2;
+	}
+
+	LOG_RingInit(&LogRingStress_Ring);
+	memset(&cons, 0, sizeof(cons));
+	memset(expectDropped, 0, sizeof(expectDropped));
+	for (i = 0u; i < producers; i++)
+	{
+		cons.LastSeq[i] = -1;
+	}
+
+	atomic_store(&LogRingStress_Running, producers);
+	t0 = LogRingStress_NowNs();
+	for (i = 0u; i < producers; i++)
+	{
+		LogRingStressProducer_t* p = &LogRingStress_Producer[i];
+
+		p->Id = (uint8_t)i;
+		p->Tag = LogRingStress_Tags[i % LOGRING_STRESS_TAG_COUNT];
+		p->Records = records;
+		if (pthread_create(&p->Thread, NULL, LogRingStress_ProducerMain, p) != 0)
+		{
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+
+	/* The main thread is the consumer: drain while producers run, then the rest. */
+	while (atomic_load(&LogRingStress_Running) != 0u)
+	{
+		uint32_t n = LogRingStress_Consume(&cons, (uint8_t)producers);
+
+		popped += n;
+		if (n == 0u)
+		{
+			(void)sched_yield();
+		}
+	}
+	popped += LogRingStress_Consume(&cons, (uint8_t)producers);
+	sec = (double)(LogRingStress_NowNs() - t0) * 1e-9;
+
+	errors = cons.Errors;
+	for (i = 0u; i < producers; i++)
+	{
+		LogRingStressProducer_t* p = &LogRingStress_Producer[i];
+
+		(void)pthread_join(p->Thread, NULL);
+		expectDropped[p->Tag] += p->Refused;
+		attempts += p->Attempts;
+		refused += p->Refused;
+		totalNs += p->TotalNs;
+		if (p->WorstNs > worstNs)
+		{
+			worstNs = p->WorstNs;
+		}
+		if ((LogRingStress_Retry ? (p->Pushed != p->Records) : ((p->Pushed + p->Refused) != p->Records)) ||
+			(cons.Popped[i] != p->Pushed))
+		{
+			fprintf(stderr, "producer %u: pushed %u refused %u, consumer got %llu\n", i, p->Pushed, p->Refused,
+					(unsigned long long)cons.Popped[i]);
+			errors++;
+		}
+	}
+	for (i = 0u; i < (uint32_t)LOGTAG_COUNT; i++)
+	{
+		uint32_t dropped = LOG_RingTakeDropped(&LogRingStress_Ring, (LogTag_t)i);
+
+		if (dropped != expectDropped[i])
+		{
+			fprintf(stderr, "tag %s: Dropped %u, producers refused %u\n", LOG_TagToString((LogTag_t)i), dropped,
+					expectDropped[i]);
+			errors++;
+		}
+		else if (dropped != 0u)
+		{
+			printf("dropped %-12s %10u\n", LOG_TagToString((LogTag_t)i), dropped);
+		}
+	}
+
+	printf("%u producers x %u records, ring %u slots\n", producers, records, (unsigned)LOG_RING_SIZE);
+	printf("mode            : %s\n", LogRingStress_Retry ? "retry refused records" : "drop refused records (-d)");
+	printf("through ring    : %llu records in %.3f s = %.2f M records/s, refused %.1f %% of %llu pushes\n",
+		   (unsigned long long)popped, sec, ((double)popped / sec) * 1e-6, ((double)refused * 100.0) / (double)attempts,
+		   (unsigned long long)attempts);
+	printf("reserve latency : avg %.1f ns, worst %llu ns (includes clock read)\n", (double)totalNs / (double)attempts,
+		   (unsigned long long)worstNs);
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
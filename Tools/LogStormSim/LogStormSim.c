@@ -0,0 +1,300 @@
+/* =====================================================================================================================
+ *  File        : LogStormSim.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Log storm simulation of the per-tag rate limiter (LogRateLimit.h) in front of the UART backend
+ *                 - 1 ms steps. MCAL.CAN logs every received frame at DEBUG (the storm), SRV.Det reports an ERROR
+ *                   every 200 ms (within its own rate), SRV.ECUM an INFO every 10 ms (above its rate).
+ *                 - The UART is a byte FIFO (TX buffer) drained at baud/10 bytes per second; a record that does not
+ *                   fit in the FIFO is lost.
+ *                 - Same scenario without and with the rate limiter. Report per tag: generated, suppressed, lost,
+ *                   line occupancy; FIFO peak; summary records.
+ *                 - Checks (with limiter): no ERROR record lost, the storm tag stays within Burst + Rate * t records,
+ *                   the FIFO never saturates.
+ *                 - Hot path cost of LOG_RateLimitAllow (ns/call).
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogStormSim LogStormSim.c
+ *  Usage       : LogStormSim [-f frames/s] [-b baud] [-q fifo bytes] [-t seconds]
+ *                  -f  CAN frames per second logged by MCAL.CAN (default 4000)
+ *                  -b  UART baud rate (default 115200)
+ *                  -q  UART TX FIFO size (default 1024)
+ *                  -t  simulated seconds (default 10)
+ *  Example     : LogStormSim -f 8000 -b 57600
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LogLevels.h"
+#include "LogTags.h"
+#include "LogToken.h"
+#include "LogRateLimit.h"
+
+/* Encoded record sizes (LogToken.h header + uint32 arguments) */
+#define STORM_REC_CAN_LEN			(LOG_TOKEN_HDR_SIZE + (2u * 4u))		/* id, dlc */
+#define STORM_REC_DET_LEN			(LOG_TOKEN_HDR_SIZE + (3u * 4u))		/* module, api, error */
+#define STORM_REC_ECUM_LEN			(LOG_TOKEN_HDR_SIZE + (1u * 4u))		/* state */
+#define STORM_REC_SUMMARY_LEN		(LOG_TOKEN_HDR_SIZE + (1u * 4u))		/* suppressed count */
+
+#define STORM_DET_PERIOD_MS			(200u)		/* below the SRV.Det registry rate */
+#define STORM_ECUM_PERIOD_MS		(10u)
+
+typedef struct
+{
+	uint64_t	Generated;
+	uint64_t	Suppressed;			/* Rate limiter said no */
+	uint64_t	Lost;				/* FIFO full */
+	uint64_t	Sent;				/* Records queued to the UART */
+	uint64_t	Bytes;				/* Bytes queued to the UART (incl. summaries) */
+}LogStormTagStat_t;
+
+typedef struct
+{
+	/* Config */
+	uint32_t			FramesPerSec;
+	uint32_t			Baud;
+	uint32_t			FifoSize;
+	uint32_t			Seconds;
+	bool				Limit;
+	/* UART model */
+	uint64_t			FifoBytes;			/* Bytes waiting in the TX FIFO */
+	uint64_t			FifoPeak;
+	uint64_t			LineBytes;			/* Bytes sent on the line */
+	uint64_t			LineCapacity;		/* Bytes the line could have sent */
+	uint64_t			Summaries;
+	LogRateLimit_t		Rl;
+	LogStormTagStat_t	Tag[LOGTAG_COUNT];
+}LogStormSim_t;
+
+static LogStormSim_t* LogStormSim_Active;
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  UART FIFO: queue one record, lost when it does not fit
+ * -------------------------------------------------------------------------------------------------------------------*/
+static bool LogStormSim_Queue(LogStormSim_t* sim, LogTag_t tag, uint32_t len)
+{
+	if ((sim->FifoBytes + len) > sim->FifoSize)
+	{
+		sim->Tag[tag].Lost++;
+		return false;
+	}
+	sim->FifoBytes += len;
+	if (sim->FifoBytes > sim->FifoPeak)
+	{
+		sim->FifoPeak = sim->FifoBytes;
+	}
+	sim->Tag[tag].Bytes += len;
+	return true;
+}
+
+/* Rate limiter summary: one "N records suppressed" record of the tag. */
+static void LogStormSim_Report(LogTag_t tag, uint32_t count)
+{
+	(void)count;
+	if (LogStormSim_Queue(LogStormSim_Active, tag, STORM_REC_SUMMARY_LEN))
+	{
+		LogStormSim_Active->Summaries++;
+	}
+}
+
+static void LogStormSim_Log(LogStormSim_t* sim, LogTag_t tag, uint32_t len)
+{
+	sim->Tag[tag].Generated++;
+	if (sim->Limit && !LOG_RateLimitAllow(&sim->Rl, tag))
+	{
+		sim->Tag[tag].Suppressed++;
+		return;
+	}
+	if (LogStormSim_Queue(sim, tag, len))
+	{
+		sim->Tag[tag].Sent++;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Run the scenario
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogStormSim_Run(LogStormSim_t* sim)
+{
+	uint64_t lineCredit = 0u;		/* bits*1000 accumulated for the UART (10 bits per byte) */
+	uint64_t frameCredit = 0u;		/* frames*1000 accumulated */
+	uint32_t ms;
+
+	LogStormSim_Active = sim;
+	LOG_RateLimitInit(&sim->Rl, 0u);
+
+	for (ms = 1u; ms <= (sim->Seconds * 1000u); ms++)
+	{
+		uint64_t canBytes;
+
+		/* Producers */
+		frameCredit += sim->FramesPerSec;
+		while (frameCredit >= 1000u)
+		{
+			frameCredit -= 1000u;
+			LogStormSim_Log(sim, LOGTAG_MCAL_CAN, STORM_REC_CAN_LEN);
+		}
+		if ((ms % STORM_DET_PERIOD_MS) == 0u)
+		{
+			LogStormSim_Log(sim, LOGTAG_SRV_DET, STORM_REC_DET_LEN);
+		}
+		if ((ms % STORM_ECUM_PERIOD_MS) == 0u)
+		{
+			LogStormSim_Log(sim, LOGTAG_SRV_ECUM, STORM_REC_ECUM_LEN);
+		}
+
+		/* Logger main function: refill, summaries go through the same FIFO */
+		if (sim->Limit)
+		{
+			LOG_RateLimitRefill(&sim->Rl, ms, LogStormSim_Report);
+		}
+
+		/* UART drains baud/10 bytes per second */
+		lineCredit += sim->Baud;
+		canBytes = lineCredit / 10000u;
+		lineCredit -= canBytes * 10000u;
+		sim->LineCapacity += canBytes;
+		if (canBytes > sim->FifoBytes)
+		{
+			canBytes = sim->FifoBytes;
+		}
+		sim->FifoBytes -= canBytes;
+		sim->LineBytes += canBytes;
+	}
+}
+
+static void LogStormSim_Print(const LogStormSim_t* sim)
+{
+	static const LogTag_t tags[] = { LOGTAG_MCAL_CAN, LOGTAG_SRV_DET, LOGTAG_SRV_ECUM };
+	uint32_t i;
+
+	printf("%s rate limiter:\n", sim->Limit ? "with" : "without");
+	printf("  %-10s %10s %10s %10s %10s %9s\n", "tag", "generated", "suppressed", "lost", "sent", "line %");
+	for (i = 0u; i < (sizeof(tags) / sizeof(tags[0])); i++)
+	{
+		const LogStormTagStat_t* t = &sim->Tag[tags[i]];
+
+		printf("  %-10s %10llu %10llu %10llu %10llu %8.1f%%\n", LOG_TagToString(tags[i]),
+			   (unsigned long long)t->Generated, (unsigned long long)t->Suppressed, (unsigned long long)t->Lost,
+			   (unsigned long long)t->Sent, (100.0 * (double)t->Bytes) / (double)sim->LineCapacity);
+	}
+	printf("  line busy %.1f%%, FIFO peak %llu / %u bytes, %llu summary records\n",
+		   (100.0 * (double)sim->LineBytes) / (double)sim->LineCapacity, (unsigned long long)sim->FifoPeak,
+		   sim->FifoSize, (unsigned long long)sim->Summaries);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Hot path cost: LOG_RateLimitAllow on a mix of limited and unlimited tags
+ * -------------------------------------------------------------------------------------------------------------------*/
+static double LogStormSim_AllowNs(void)
+{
+	static LogRateLimit_t rl;
+	struct timespec t0;
+	struct timespec t1;
+	uint32_t allowed = 0u;
+	uint32_t i;
+
+	LOG_RateLimitInit(&rl, 0u);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0u; i < 100000000u; i++)
+	{
+		allowed += LOG_RateLimitAllow(&rl, (LogTag_t)(i % (uint32_t)LOGTAG_COUNT)) ? 1u : 0u;
+		if ((i & 0xFFFu) == 0u)
+		{
+			LOG_RateLimitRefill(&rl, i >> 12, (LogRateLimitReportFct_t)0);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if (allowed == 0u)
+	{
+		printf("(no record allowed)\n");
+	}
+	return (((double)(t1.tv_sec - t0.tv_sec) * 1e9) + (double)(t1.tv_nsec - t0.tv_nsec)) / 1e8;
+}
+
+static void LogStormSim_Usage(void)
+{
+	fprintf(stderr, "usage: LogStormSim [-f frames/s] [-b baud] [-q fifo bytes] [-t seconds]\n");
+}
+
+int main(int argc, char** argv)
+{
+	static LogStormSim_t sim[2];
+	const LogStormTagStat_t* can;
+	uint64_t canBound;
+	uint32_t errors = 0u;
+	uint32_t i;
+	int o;
+
+	sim[0].FramesPerSec = 4000u;
+	sim[0].Baud = 115200u;
+	sim[0].FifoSize = 1024u;
+	sim[0].Seconds = 10u;
+	while ((o = getopt(argc, argv, "f:b:q:t:")) != -1)
+	{
+		switch (o)
+		{
+			case 'f':
+				sim[0].FramesPerSec = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				sim[0].Baud = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				sim[0].FifoSize = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				sim[0].Seconds = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				LogStormSim_Usage();
+				return 2;
+		}
+	}
+	if ((sim[0].Baud == 0u) || (sim[0].FifoSize < LOG_TOKEN_MAX_SIZE) || (sim[0].Seconds == 0u))
+	{
+		LogStormSim_Usage();
+		return 2;
+	}
+	sim[1] = sim[0];
+	sim[1].Limit = true;
+
+	printf("storm: MCAL.CAN %u records/s, UART %u baud (%u B/s), FIFO %u bytes, %u s\n", sim[0].FramesPerSec,
+		   sim[0].Baud, sim[0].Baud / 10u, sim[0].FifoSize, sim[0].Seconds);
+	for (i = 0u; i < 2u; i++)
+	{
+		LogStormSim_Run(&sim[i]);
+		LogStormSim_Print(&sim[i]);
+	}
+
+	/* Checks on the limited run */
+	can = &sim[1].Tag[LOGTAG_MCAL_CAN];
+	canBound = (uint64_t)LOG_TagInfo[LOGTAG_MCAL_CAN].Burst +
+			   ((uint64_t)LOG_TagInfo[LOGTAG_MCAL_CAN].Rate * sim[1].Seconds);
+	if (can->Sent > canBound)
+	{
+		fprintf(stderr, "MCAL.CAN sent %llu records, bound %llu\n", (unsigned long long)can->Sent,
+				(unsigned long long)canBound);
+		errors++;
+	}
+	if ((sim[1].Tag[LOGTAG_SRV_DET].Lost != 0u) || (sim[1].Tag[LOGTAG_SRV_DET].Suppressed != 0u))
+	{
+		fprintf(stderr, "SRV.Det errors lost with the rate limiter\n");
+		errors++;
+	}
+	if (sim[1].FifoPeak >= sim[1].FifoSize)
+	{
+		fprintf(stderr, "UART FIFO saturated with the rate limiter\n");
+		errors++;
+	}
+	printf("MCAL.CAN bound  : %llu records (Burst + Rate * t), sent %llu\n", (unsigned long long)canBound,
+		   (unsigned long long)can->Sent);
+	printf("Allow hot path  : %.2f ns/call\n", LogStormSim_AllowNs());
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/* =====================================================================================================================
+ *  File        : LogTokenBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Tokenized logging (LogToken.h) against printf-style formatting on the target
+ *                 - Same call sites logged twice: LOG_TOKEN records into a byte sink, and the text the MCU would
+ *                   have to format and send with snprintf ("<ts> <L> <TAG>: <message>\n").
+ *                 - Report: bytes per record and cost per call (ns and TSC cycles on x86) for both.
+ *                 - Round trip: every token record is decoded and formatted on the host (LOG_TokenFormat) and
+ *                   must give exactly the text formatted on the spot.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o LogTokenBench LogTokenBench.c
+ *  Usage       : LogTokenBench [-n calls]
+ *                  -n  log calls per run (default 2000000)
+ *  Example     : LogTokenBench -n 10000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+#define LOG_TOKEN_HOST_DECODER
+#define LOG_LEVEL_DEFAULT			LOG_TRACE
+#define LOG_TOKEN_TAG_MASK			LOG_TAG_MASK_ALL
+
+#define LOG_FMT_TABLE(X)											\
+	X(CAN_RX,		"rx id=0x%x dlc=%u")							\
+	X(CAN_BUSOFF,	"bus-off cnt=%u")								\
+	X(PDUR_ROUTE,	"route src=%u dst=%u len=%u res=%d")			\
+	X(BOOT_DONE,	"boot done")
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Byte sink standing in for the ring / UART backend */
+#define BENCH_SINK_SIZE				(1u << 20)
+
+static uint8_t LogTokenBench_Sink[BENCH_SINK_SIZE];
+static uint32_t LogTokenBench_SinkLen;
+static uint32_t LogTokenBench_Tick;
+
+static inline void LogTokenBench_Emit(const uint8_t* rec, uint8_t len)
+{
+	if ((LogTokenBench_SinkLen + len) > BENCH_SINK_SIZE)
+	{
+		LogTokenBench_SinkLen = 0u;
+	}
+	memcpy(&LogTokenBench_Sink[LogTokenBench_SinkLen], rec, len);
+	LogTokenBench_SinkLen += len;
+}
+
+#define LOG_TOKEN_TIMESTAMP()			(LogTokenBench_Tick)
+#define LOG_TOKEN_EMIT(_buf_, _len_)	LogTokenBench_Emit((_buf_), (_len_))
+
+#include "LogLevels.h"
+#include "LogTags.h"
+#include "LogToken.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Time
+ * -------------------------------------------------------------------------------------------------------------------*/
+static double LogTokenBench_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint64_t LogTokenBench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  The printf-style alternative: what the MCU formats and sends today
+ * -------------------------------------------------------------------------------------------------------------------*/
+static char LogTokenBench_Text[BENCH_SINK_SIZE];
+static uint32_t LogTokenBench_TextLen;
+
+static inline void LogTokenBench_Printf(LogTag_t tag, LogLevel_t lvl, const char* fmt, uint32_t a0, uint32_t a1,
+										uint32_t a2, uint32_t a3)
+{
+	char line[160];
+	int n;
+	int m;
+
+	n = snprintf(line, sizeof(line), "%10lu %c %-12s: ", (unsigned long)LogTokenBench_Tick, LOG_LevelChar(lvl),
+				 LOG_TagToString(tag));
+	m = snprintf(&line[n], sizeof(line) - (size_t)n, fmt, a0, a1, a2, a3);
+	n += m;
+	line[n++] = '\n';
+	if ((LogTokenBench_TextLen + (uint32_t)n) > BENCH_SINK_SIZE)
+	{
+		LogTokenBench_TextLen = 0u;
+	}
+	memcpy(&LogTokenBench_Text[LogTokenBench_TextLen], line, (size_t)n);
+	LogTokenBench_TextLen += (uint32_t)n;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Call site mix: one of four log calls per iteration
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void LogTokenBench_CallToken(uint32_t i)
+{
+	switch (i & 3u)
+	{
+		case 0u:
+			LOG_TOKEN(LOGTAG_MCAL_CAN, LOG_DEBUG, LOG_FMT_CAN_RX, 0x100u + (i & 0x7FFu), i & 7u);
+			break;
+		case 1u:
+			LOG_TOKEN(LOGTAG_SRV_PDUR, LOG_TRACE, LOG_FMT_PDUR_ROUTE, i & 15u, (i >> 4) & 3u, i & 63u,
+					  (int32_t)(i & 1u) - 1);
+			break;
+		case 2u:
+			LOG_TOKEN(LOGTAG_ECU_CANIF, LOG_WARN, LOG_FMT_CAN_BUSOFF, i);
+			break;
+		default:
+			LOG_TOKEN(LOGTAG_BOOT, LOG_INFO, LOG_FMT_BOOT_DONE);
+			break;
+	}
+}
+
+static void LogTokenBench_CallPrintf(uint32_t i)
+{
+	switch (i & 3u)
+	{
+		case 0u:
+			LogTokenBench_Printf(LOGTAG_MCAL_CAN, LOG_DEBUG, "rx id=0x%x dlc=%u", 0x100u + (i & 0x7FFu), i & 7u,
+								 0u, 0u);
+			break;
+		case 1u:
+			LogTokenBench_Printf(LOGTAG_SRV_PDUR, LOG_TRACE, "route src=%u dst=%u len=%u res=%d", i & 15u,
+								 (i >> 4) & 3u, i & 63u, (uint32_t)((int32_t)(i & 1u) - 1));
+			break;
+		case 2u:
+			LogTokenBench_Printf(LOGTAG_ECU_CANIF, LOG_WARN, "bus-off cnt=%u", i, 0u, 0u, 0u);
+			break;
+		default:
+			LogTokenBench_Printf(LOGTAG_BOOT, LOG_INFO, "boot done", 0u, 0u, 0u, 0u);
+			break;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Round trip: decode + host format of token records == text formatted on the spot
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t LogTokenBench_RoundTrip(uint32_t calls)
+{
+	uint32_t errors = 0u;
+	uint32_t i;
+
+	for (i = 0u; i < calls; i++)
+	{
+		LogTokenRecord_t rec;
+		char host[160];
+		uint16_t used;
+		int n;
+
+		LogTokenBench_SinkLen = 0u;
+		LogTokenBench_TextLen = 0u;
+		LogTokenBench_Tick = i * 7u;
+		LogTokenBench_CallToken(i);
+		LogTokenBench_CallPrintf(i);
+
+		memset(&rec, 0, sizeof(rec));
+		used = LOG_TokenDecode(LogTokenBench_Sink, (uint16_t)LogTokenBench_SinkLen, &rec);
+		n = LOG_TokenFormat(&rec, LOG_FmtStrings, LOG_FMT_COUNT, host, sizeof(host));
+		LogTokenBench_Text[LogTokenBench_TextLen - 1u] = '\0';
+		if ((used != LogTokenBench_SinkLen) || (n < 0) || (strcmp(host, LogTokenBench_Text) != 0))
+		{
+			if (errors < 5u)
+			{
+				fprintf(stderr, "mismatch %u:\n  token : %s\n  printf: %s\n", i, host, LogTokenBench_Text);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static void LogTokenBench_Usage(void)
+{
+	fprintf(stderr, "usage: LogTokenBench [-n calls]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t calls = 2000000u;
+	uint64_t tokBytes = 0u;
+	uint64_t txtBytes = 0u;
+	uint64_t c0;
+	uint64_t tokCycles;
+	uint64_t txtCycles;
+	double t0;
+	double tokSec;
+	double txtSec;
+	uint32_t errors;
+	uint32_t i;
+	int o;
+
+	while ((o = getopt(argc, argv, "n:")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				calls = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				LogTokenBench_Usage();
+				return 2;
+		}
+	}
+	if (calls == 0u)
+	{
+		LogTokenBench_Usage();
+		return 2;
+	}
+
+	errors = LogTokenBench_RoundTrip(4096u);
+
+	LogTokenBench_SinkLen = 0u;
+	t0 = LogTokenBench_Now();
+	c0 = LogTokenBench_Cycles();
+	for (i = 0u; i < calls; i++)
+	{
+		uint32_t before = LogTokenBench_SinkLen;
+
+		LogTokenBench_Tick = i;
+		LogTokenBench_CallToken(i);
+		tokBytes += (LogTokenBench_SinkLen >= before) ? (LogTokenBench_SinkLen - before) : LogTokenBench_SinkLen;
+	}
+	tokCycles = LogTokenBench_Cycles() - c0;
+	tokSec = LogTokenBench_Now() - t0;
+
+	LogTokenBench_TextLen = 0u;
+	t0 = LogTokenBench_Now();
+	c0 = LogTokenBench_Cycles();
+	for (i = 0u; i < calls; i++)
+	{
+		uint32_t before = LogTokenBench_TextLen;
+
+		LogTokenBench_Tick = i;
+		LogTokenBench_CallPrintf(i);
+		txtBytes += (LogTokenBench_TextLen >= before) ? (LogTokenBench_TextLen - before) : LogTokenBench_TextLen;
+	}
+	txtCycles = LogTokenBench_Cycles() - c0;
+	txtSec = LogTokenBench_Now() - t0;
+
+	printf("%u calls, 4 call sites (0..4 args)\n", calls);
+	printf("%-10s %12s %12s %14s\n", "", "bytes/rec", "ns/call", "cycles/call");
+	printf("%-10s %12.2f %12.2f %14.1f\n", "token", (double)tokBytes / calls, (tokSec * 1e9) / calls,
+		   (double)tokCycles / calls);
+	printf("%-10s %12.2f %12.2f %14.1f\n", "printf", (double)txtBytes / calls, (txtSec * 1e9) / calls,
+		   (double)txtCycles / calls);
+	printf("ratio      %12.2fx %11.2fx\n", (double)txtBytes / (double)tokBytes, txtSec / tokSec);
+	printf("round trip: %u mismatches\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
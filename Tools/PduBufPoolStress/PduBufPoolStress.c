@@ -0,0 +1,296 @@
+/* =====================================================================================================================
+ *  File        : PduBufPoolStress.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Multi-thread stress test and RAM report of the PDU buffer pool (PduBufPool.h)
+ *                 - T threads (standing in for CAN RX ISR, TP and Com tasks) allocate random lengths (mostly CAN
+ *                   frames, some CAN-FD / TP sizes), fill the whole block with a per-owner pattern, hold up to H
+ *                   buffers, check the pattern and free them.
+ *                 - Checks: no block handed out twice (pattern intact until free), every free answers E_OK,
+ *                   double free and foreign pointers are refused, nothing leaked at the end, high-water <= count.
+ *                 - Report: alloc+free pairs/s, BUSY/OVFL answers, and per class: block size, count, RAM,
+ *                   high-water mark, and the RAM the pool would need sized down to high-water + 1.
+ *  Build       : cc -O2 -std=gnu11 -pthread -I../../Inc -o PduBufPoolStress PduBufPoolStress.c
+ *                (class sizes/counts as for the target, e.g. -DPDUBUF_CLASS3_COUNT=1 to enable the TP class)
+ *  Usage       : PduBufPoolStress [-t threads] [-n allocations] [-h held]
+ *                  -t  threads (1..PDUBUF_STRESS_MAX_THREADS, default 4)
+ *                  -n  allocations per thread (default 2000000)
+ *                  -h  buffers held at most per thread (1..PDUBUF_STRESS_MAX_HELD, default 4)
+ *  Example     : PduBufPoolStress -t 8 -n 10000000 -h 6
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "PduBufPool.h"
+
+#define PDUBUF_STRESS_MAX_THREADS	(16u)
+#define PDUBUF_STRESS_MAX_HELD		(16u)
+
+typedef struct
+{
+	pthread_t	Thread;
+	uint8_t		Id;
+	uint32_t	Allocs;
+	uint32_t	Held;
+	uint64_t	Seed;
+	uint64_t	Ok;
+	uint64_t	Busy;
+	uint64_t	Ovfl;
+	uint64_t	Errors;
+}PduBufStressThread_t;
+
+static PduBuf_PoolType PduBufStress_Pool;
+static PduBufStressThread_t PduBufStress_Thread[PDUBUF_STRESS_MAX_THREADS];
+
+static uint32_t PduBufStress_Rand(uint64_t* seed)
+{
+	*seed ^= *seed >> 12;
+	*seed ^= *seed << 25;
+	*seed ^= *seed >> 27;
+	return (uint32_t)((*seed * 2685821657736338717ull) >> 32);
+}
+
+/* Length mix: 70% classic CAN, 20% CAN-FD like, 8% small TP, 2% full TP (OVFL when that class is off) */
+static PduLengthType PduBufStress_Len(uint64_t* seed)
+{
+	uint32_t r = PduBufStress_Rand(seed);
+	uint32_t p = r % 100u;
+
+	r >>= 8;
+	if (p < 70u)
+	{
+		return (PduLengthType)(1u + (r % PDUBUF_CLASS0_SIZE));
+	}
+	if (p < 90u)
+	{
+		return (PduLengthType)(1u + (r % PDUBUF_CLASS1_SIZE));
+	}
+	if (p < 98u)
+	{
+		return (PduLengthType)(1u + (r % PDUBUF_CLASS2_SIZE));
+	}
+	return (PduLengthType)(1u + (r % PDUBUF_CLASS3_SIZE));
+}
+
+static bool PduBufStress_Intact(const PduInfoType* info, uint8_t tag)
+{
+	PduLengthType i;
+
+	for (i = 0u; i < info->SduLength; i++)
+	{
+		if (info->SduDataPtr[i] != (uint8_t)(tag + i))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Worker: alloc / fill / hold / check / free
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void* PduBufStress_Main(void* arg)
+{
+	PduBufStressThread_t* t = (PduBufStressThread_t*)arg;
+	PduInfoType held[PDUBUF_STRESS_MAX_HELD];
+	uint8_t tags[PDUBUF_STRESS_MAX_HELD];
+	uint32_t count = 0u;
+	uint32_t n;
+
+	for (n = 0u; n < t->Allocs; n++)
+	{
+		PduInfoType info;
+		BufReq_ReturnType ret;
+
+		ret = PduBuf_Alloc(&PduBufStress_Pool, PduBufStress_Len(&t->Seed), &info);
+		if (ret == BUFREQ_OK)
+		{
+			uint8_t tag = (uint8_t)((t->Id << 5) + n);
+			PduLengthType i;
+
+			for (i = 0u; i < info.SduLength; i++)
+			{
+				info.SduDataPtr[i] = (uint8_t)(tag + i);
+			}
+			held[count] = info;
+			tags[count] = tag;
+			count++;
+			t->Ok++;
+		}
+		else if (ret == BUFREQ_E_BUSY)
+		{
+			t->Busy++;
+		}
+		else
+		{
+			t->Ovfl++;
+		}
+
+		/* Release one (random) buffer when the hold limit is reached or the pool said BUSY */
+		if ((count == t->Held) || ((ret == BUFREQ_E_BUSY) && (count != 0u)))
+		{
+			uint32_t k = PduBufStress_Rand(&t->Seed) % count;
+
+			if (!PduBufStress_Intact(&held[k], tags[k]) || (PduBuf_Free(&PduBufStress_Pool, &held[k]) != E_OK))
+			{
+				t->Errors++;
+			}
+			count--;
+			held[k] = held[count];
+			tags[k] = tags[count];
+		}
+	}
+	while (count != 0u)
+	{
+		count--;
+		if (!PduBufStress_Intact(&held[count], tags[count]) ||
+			(PduBuf_Free(&PduBufStress_Pool, &held[count]) != E_OK))
+		{
+			t->Errors++;
+		}
+	}
+	return NULL;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Single-thread API checks: double free, foreign and misaligned pointers
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t PduBufStress_ApiChecks(void)
+{
+	uint8_t foreign[8];
+	PduInfoType info;
+	PduInfoType bad;
+	uint32_t errors = 0u;
+
+	if (PduBuf_Alloc(&PduBufStress_Pool, 8u, &info) != BUFREQ_OK)
+	{
+		return 1u;
+	}
+	bad = info;
+	bad.SduDataPtr = &info.SduDataPtr[1];
+	errors += (PduBuf_Free(&PduBufStress_Pool, &bad) != E_NOT_OK) ? 1u : 0u;
+	errors += (PduBuf_Free(&PduBufStress_Pool, &info) != E_OK) ? 1u : 0u;
+	errors += (PduBuf_Free(&PduBufStress_Pool, &info) != E_NOT_OK) ? 1u : 0u;
+	bad.SduDataPtr = foreign;
+	errors += (PduBuf_Free(&PduBufStress_Pool, &bad) != E_NOT_OK) ? 1u : 0u;
+	errors += (PduBuf_Alloc(&PduBufStress_Pool, (PduLengthType)(PDUBUF_CLASS3_SIZE + 1u), &info) !=
+			   BUFREQ_E_OVFL) ? 1u : 0u;
+	return errors;
+}
+
+static void PduBufStress_Usage(void)
+{
+	fprintf(stderr, "usage: PduBufPoolStress [-t threads] [-n allocations] [-h held]\n");
+}
+
+int main(int argc, char** argv)
+{
+	struct timespec t0;
+	struct timespec t1;
+	uint32_t threads = 4u;
+	uint32_t allocs = 2000000u;
+	uint32_t held = 4u;
+	uint64_t ok = 0u;
+	uint64_t busy = 0u;
+	uint64_t ovfl = 0u;
+	uint64_t errors = 0u;
+	uint32_t shrunk = 0u;
+	double sec;
+	uint32_t i;
+	uint8_t c;
+	int o;
+
+	while ((o = getopt(argc, argv, "t:n:h:")) != -1)
+	{
+		switch (o)
+		{
+			case 't':
+				threads = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				allocs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'h':
+				held = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				PduBufStress_Usage();
+				return 2;
+		}
+	}
+	if ((threads == 0u) || (threads > PDUBUF_STRESS_MAX_THREADS) || (allocs == 0u) || (held == 0u) ||
+		(held > PDUBUF_STRESS_MAX_HELD))
+	{
+		PduBufStress_Usage();
+		return 2;
+	}
+
+	PduBuf_Init(&PduBufStress_Pool);
+	errors += PduBufStress_ApiChecks();
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0u; i < threads; i++)
+	{
+		PduBufStressThread_t* t = &PduBufStress_Thread[i];
+
+		t->Id = (uint8_t)i;
+		t->Allocs = allocs;
+		t->Held = held;
+		t->Seed = 0x9E3779B97F4A7C15ull * (i + 1u);
+		if (pthread_create(&t->Thread, NULL, PduBufStress_Main, t) != 0)
+		{
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+	for (i = 0u; i < threads; i++)
+	{
+		PduBufStressThread_t* t = &PduBufStress_Thread[i];
+
+		(void)pthread_join(t->Thread, NULL);
+		ok += t->Ok;
+		busy += t->Busy;
+		ovfl += t->Ovfl;
+		errors += t->Errors;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sec = (double)(t1.tv_sec - t0.tv_sec) + ((double)(t1.tv_nsec - t0.tv_nsec) * 1e-9);
+
+	printf("%u threads x %u allocations, up to %u held per thread\n", threads, allocs, held);
+	printf("alloc+free      : %llu pairs in %.3f s = %.2f M pairs/s\n", (unsigned long long)ok, sec,
+		   ((double)ok / sec) * 1e-6);
+	printf("answers         : %llu BUSY (Failed %u), %llu OVFL\n", (unsigned long long)busy,
+		   (unsigned)atomic_load(&PduBufStress_Pool.Failed), (unsigned long long)ovfl);
+
+	/* RAM report */
+	printf("%-7s %6s %6s %6s %9s %10s %6s\n", "class", "size", "stride", "count", "RAM", "high-water", "in use");
+	for (c = 0u; c < PDUBUF_CLASS_COUNT; c++)
+	{
+		PduBuf_StatsType st;
+		uint32_t need;
+
+		PduBuf_GetStats(&PduBufStress_Pool, c, &st);
+		printf("%-7u %6u %6u %6u %9u %10u %6u\n", c, (unsigned)st.Size, (unsigned)PduBuf_Classes[c].Stride,
+			   st.Count, (unsigned)(st.Count * PduBuf_Classes[c].Stride), st.HighWater, st.InUse);
+		if ((st.InUse != 0u) || (st.HighWater > st.Count))
+		{
+			fprintf(stderr, "class %u: %u blocks leaked, high-water %u of %u\n", c, st.InUse, st.HighWater, st.Count);
+			errors++;
+		}
+		need = (st.HighWater < st.Count) ? (uint32_t)st.HighWater + 1u : st.Count;
+		shrunk += need * PduBuf_Classes[c].Stride;
+	}
+	printf("pool RAM        : %u bytes (arena %u + state %u)\n", (unsigned)PDUBUF_RAM_BYTES,
+		   (unsigned)PDUBUF_ARENA_BYTES, (unsigned)(PDUBUF_RAM_BYTES - PDUBUF_ARENA_BYTES));
+	printf("sized to load   : arena %u bytes (high-water + 1 block per class)\n", shrunk);
+	printf("errors          : %llu\n", (unsigned long long)errors);
+	return (errors == 0u) ? 0 : 1;
+}
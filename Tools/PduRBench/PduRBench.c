@@ -0,0 +1,480 @@
+/* =====================================================================================================================
+ *  File        : PduRBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Throughput and latency of the zero-copy PduR routing core (PduR_Routing.h)
+ *                 - Gateway configuration: 1:1 route RX -> CanIf, 1:1 route RX -> Com (local, confirm on accept)
+ *                   and 1:3 route RX -> CanIf + UartIf + Com.
+ *                 - Every routed PDU is a PduBufPool buffer: alloc, fill, PduR_RxIndication, then the TX
+ *                   confirmations of the lower layers (deferred, as from the TX complete ISR, or from inside Transmit).
+ *                 - Checks: every destination gets the SAME descriptor and payload pointer (no copy), payload intact,
+ *                   per destination results match the stub answers (UartIf refuses -r percent), the path is free again
+ *                   after the last confirmation, and no pool block is left in use at the end.
+ *                 - Report per route: routed PDUs/s, average RxIndication latency (hand-over to all destinations)
+ *                   and average / worst route latency (RxIndication to buffer release).
+ *                 - Preemption: the main loop routes on the 1:1 CanIf path and confirms as the TX complete ISR,
+ *                   a periodic signal plays a higher priority RX ISR routing on the same path at any point, e.g.
+ *                   while the last TxConfirmation still releases the previous buffer. Every buffer must be freed
+ *                   once: no leak, no block handed out twice, payloads intact.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o PduRBench PduRBench.c
+ *  Usage       : PduRBench [-n pdus] [-r refuse] [-i]
+ *                  -n  PDUs routed per route (default 5000000)
+ *                  -r  percent of PDUs refused by UartIf (0..100, default 0)
+ *                  -i  confirm from inside Transmit (synchronous lower layer) instead of deferred
+ *  Example     : PduRBench -n 20000000 -r 10
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "PduR_Routing.h"
+
+#define PDUR_BENCH_PDU_LEN			(8u)
+#define PDUR_BENCH_MAX_PENDING		(PDUR_MAX_DESTS)
+#define PDUR_BENCH_ISR_PERIOD_US	(20u)		/* preemption run: RX ISR period */
+
+/* Source PDUs (routing paths) */
+#define PDUR_BENCH_SRC_CAN			(0u)
+#define PDUR_BENCH_SRC_COM			(1u)
+#define PDUR_BENCH_SRC_FANOUT		(2u)
+#define PDUR_BENCH_SRC_COUNT		(3u)
+
+/* Destination PDUs of the lower layers */
+#define PDUR_BENCH_CANIF_GW			(0u)
+#define PDUR_BENCH_CANIF_FANOUT		(1u)
+#define PDUR_BENCH_UARTIF_FANOUT	(0u)
+
+typedef struct
+{
+	PduR_ModuleType	Module;
+	PduIdType		DestPduId;
+}PduRBenchPending_t;
+
+static PduBuf_PoolType PduRBench_Pool;
+static PduR_Type PduRBench_PduR;
+static uint64_t PduRBench_Seed;
+static uint32_t PduRBench_Refuse;
+static bool PduRBench_Inline;
+
+/* What the stubs saw during the current routing */
+static PduRBenchPending_t PduRBench_Pending[PDUR_BENCH_MAX_PENDING];
+static uint32_t PduRBench_PendingCount;
+static const PduInfoType* PduRBench_ExpInfo;
+static const uint8_t* PduRBench_ExpData;
+static uint8_t PduRBench_ExpTag;
+static Std_ReturnType PduRBench_Answer[PDUR_MODULE_COUNT];
+static uint32_t PduRBench_Errors;
+
+/* Preemption run */
+static bool PduRBench_Preempt;
+static atomic_bool PduRBench_TxPending;
+static volatile sig_atomic_t PduRBench_InRx;
+static uint32_t PduRBench_IsrRouted;
+static uint32_t PduRBench_IsrRefused;
+static uint32_t PduRBench_IsrTag;
+
+static Std_ReturnType PduRBench_CanIfTransmit(PduIdType destPduId, const PduInfoType* info);
+static Std_ReturnType PduRBench_UartIfTransmit(PduIdType destPduId, const PduInfoType* info);
+static Std_ReturnType PduRBench_ComRxIndication(PduIdType destPduId, const PduInfoType* info);
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Configuration (as generated for the gateway)
+ * -------------------------------------------------------------------------------------------------------------------*/
+static const PduR_DestType PduRBench_DestCan[] =
+{
+	{ PDUR_MODULE_CANIF, PDUR_BENCH_CANIF_GW }
+};
+
+static const PduR_DestType PduRBench_DestCom[] =
+{
+	{ PDUR_MODULE_COM, PDUR_BENCH_SRC_COM }
+};
+
+static const PduR_DestType PduRBench_DestFanout[] =
+{
+	{ PDUR_MODULE_CANIF, PDUR_BENCH_CANIF_FANOUT },
+	{ PDUR_MODULE_UARTIF, PDUR_BENCH_UARTIF_FANOUT },
+	{ PDUR_MODULE_COM, PDUR_BENCH_SRC_FANOUT }
+};
+
+static const PduR_RoutingPathType PduRBench_Paths[PDUR_BENCH_SRC_COUNT] =
+{
+	{ PduRBench_DestCan, 1u },
+	{ PduRBench_DestCom, 1u },
+	{ PduRBench_DestFanout, 3u }
+};
+
+static const PduR_DestRefType PduRBench_CanIfRef[] =
+{
+	{ PDUR_BENCH_SRC_CAN, 0u },
+	{ PDUR_BENCH_SRC_FANOUT, 0u }
+};
+
+static const PduR_DestRefType PduRBench_UartIfRef[] =
+{
+	{ PDUR_BENCH_SRC_FANOUT, 1u }
+};
+
+static const PduR_ModuleApiType PduRBench_Modules[PDUR_MODULE_COUNT] =
+{
+	{ PduRBench_CanIfTransmit, false, PduRBench_CanIfRef, 2u },
+	{ PduRBench_UartIfTransmit, false, PduRBench_UartIfRef, 1u },
+	{ PduRBench_ComRxIndication, true, NULL, 0u }
+};
+
+static const PduR_ConfigType PduRBench_Config =
+{
+	PduRBench_Paths, PDUR_BENCH_SRC_COUNT, PduRBench_Modules, &PduRBench_Pool
+};
+
+static const char* const PduRBench_RouteName[PDUR_BENCH_SRC_COUNT] =
+{
+	"1:1 CanIf", "1:1 Com", "1:3 CanIf+UartIf+Com"
+};
+
+static uint32_t PduRBench_Rand(void)
+{
+	PduRBench_Seed ^= PduRBench_Seed >> 12;
+	PduRBench_Seed ^= PduRBench_Seed << 25;
+	PduRBench_Seed ^= PduRBench_Seed >> 27;
+	return (uint32_t)((PduRBench_Seed * 2685821657736338717ull) >> 32);
+}
+
+static uint64_t PduRBench_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Lower layer stubs: check the descriptor is the routed one, untouched, then accept or refuse
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void PduRBench_CheckInfo(const PduInfoType* info)
+{
+	uint8_t tail = (uint8_t)(PduRBench_ExpTag ^ 0xFFu);
+
+	/* Same descriptor for every destination, pointing at the caller's buffer */
+	if ((info != PduRBench_ExpInfo) || (info->SduDataPtr != PduRBench_ExpData) ||
+		(info->SduLength != PDUR_BENCH_PDU_LEN) || (info->SduDataPtr[0] != PduRBench_ExpTag) ||
+		(info->SduDataPtr[PDUR_BENCH_PDU_LEN - 1u] != tail))
+	{
+		PduRBench_Errors++;
+	}
+}
+
+static Std_ReturnType PduRBench_LowerTransmit(PduR_ModuleType module, PduIdType destPduId, const PduInfoType* info)
+{
+	if (PduRBench_Preempt)
+	{
+		uint8_t tail = (uint8_t)(info->SduDataPtr[0] ^ 0xFFu);
+
+		/* Routed by the main loop or the RX ISR: payload intact, TX complete comes from the main loop */
+		if (info->SduDataPtr[PDUR_BENCH_PDU_LEN - 1u] != tail)
+		{
+			PduRBench_Errors++;
+		}
+		atomic_store(&PduRBench_TxPending, true);
+		return E_OK;
+	}
+	PduRBench_CheckInfo(info);
+	if (PduRBench_Answer[module] != E_OK)
+	{
+		return E_NOT_OK;
+	}
+	if (PduRBench_Inline)
+	{
+		PduR_TxConfirmation(&PduRBench_PduR, module, destPduId, E_OK);
+	}
+	else
+	{
+		PduRBench_Pending[PduRBench_PendingCount].Module = module;
+		PduRBench_Pending[PduRBench_PendingCount].DestPduId = destPduId;
+		PduRBench_PendingCount++;
+	}
+	return E_OK;
+}
+
+static Std_ReturnType PduRBench_CanIfTransmit(PduIdType destPduId, const PduInfoType* info)
+{
+	return PduRBench_LowerTransmit(PDUR_MODULE_CANIF, destPduId, info);
+}
+
+static Std_ReturnType PduRBench_UartIfTransmit(PduIdType destPduId, const PduInfoType* info)
+{
+	return PduRBench_LowerTransmit(PDUR_MODULE_UARTIF, destPduId, info);
+}
+
+static Std_ReturnType PduRBench_ComRxIndication(PduIdType destPduId, const PduInfoType* info)
+{
+	(void)destPduId;
+	PduRBench_CheckInfo(info);
+	return E_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  One routing: alloc + fill, RxIndication, TX confirmations, checks
+ *  - rxNs (optional): duration of PduR_RxIndication alone.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void PduRBench_RouteOne(PduIdType src, uint32_t n, uint64_t* rxNs)
+{
+	const PduR_RoutingPathType* route = &PduRBench_Paths[src];
+	PduR_RoutingResultType results[PDUR_MAX_DESTS];
+	PduInfoType info;
+	uint64_t t0 = 0u;
+	uint8_t failedMask = 0xFFu;
+	uint8_t expFailed = 0u;
+	uint8_t tag = (uint8_t)n;
+	uint8_t d;
+	uint32_t k;
+
+	if (PduBuf_Alloc(&PduRBench_Pool, PDUR_BENCH_PDU_LEN, &info) != BUFREQ_OK)
+	{
+		PduRBench_Errors++;
+		return;
+	}
+	memset(info.SduDataPtr, tag, PDUR_BENCH_PDU_LEN);
+	info.SduDataPtr[PDUR_BENCH_PDU_LEN - 1u] = (uint8_t)(tag ^ 0xFFu);
+
+	PduRBench_Answer[PDUR_MODULE_UARTIF] = ((PduRBench_Rand() % 100u) < PduRBench_Refuse) ? E_NOT_OK : E_OK;
+	PduRBench_ExpInfo = &PduRBench_PduR.Path[src].Info;
+	PduRBench_ExpData = info.SduDataPtr;
+	PduRBench_ExpTag = tag;
+	PduRBench_PendingCount = 0u;
+
+	if (rxNs != NULL)
+	{
+		t0 = PduRBench_NowNs();
+	}
+	if (PduR_RxIndication(&PduRBench_PduR, src, &info, results) != E_OK)
+	{
+		PduRBench_Errors++;
+	}
+	if (rxNs != NULL)
+	{
+		*rxNs = PduRBench_NowNs() - t0;
+	}
+
+	for (d = 0u; d < route->DestCount; d++)
+	{
+		bool refused = (PduRBench_Answer[route->Dest[d].Module] != E_OK);
+
+		expFailed |= refused ? (uint8_t)(1u << d) : 0u;
+		if (results[d] != (refused ? PDUR_ROUTING_E_NOT_OK : PDUR_ROUTING_OK))
+		{
+			PduRBench_Errors++;
+		}
+	}
+
+	/* Deferred TX complete: the buffer must stay allocated (path busy) until the last one */
+	for (k = 0u; k < PduRBench_PendingCount; k++)
+	{
+		if (!PduR_IsPathBusy(&PduRBench_PduR, src, NULL))
+		{
+			PduRBench_Errors++;
+		}
+		PduR_TxConfirmation(&PduRBench_PduR, PduRBench_Pending[k].Module, PduRBench_Pending[k].DestPduId, E_OK);
+	}
+	if (PduR_IsPathBusy(&PduRBench_PduR, src, &failedMask) || (failedMask != expFailed))
+	{
+		PduRBench_Errors++;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Preemption run
+ *  - PduRBench_RouteTag: alloc + fill + RxIndication on the 1:1 CanIf path, from the main loop or the RX ISR.
+ *  - PduRBench_RxIsr: skipped while the main loop is inside its own RxIndication (one RX context per path).
+ * -------------------------------------------------------------------------------------------------------------------*/
+static Std_ReturnType PduRBench_RouteTag(uint8_t tag)
+{
+	PduInfoType info;
+
+	if (PduBuf_Alloc(&PduRBench_Pool, PDUR_BENCH_PDU_LEN, &info) != BUFREQ_OK)
+	{
+		PduRBench_Errors++;
+		return E_NOT_OK;
+	}
+	memset(info.SduDataPtr, tag, PDUR_BENCH_PDU_LEN);
+	info.SduDataPtr[PDUR_BENCH_PDU_LEN - 1u] = (uint8_t)(tag ^ 0xFFu);
+	return PduR_RxIndication(&PduRBench_PduR, PDUR_BENCH_SRC_CAN, &info, NULL);
+}
+
+static void PduRBench_RxIsr(int sig)
+{
+	(void)sig;
+	if (PduRBench_InRx != 0)
+	{
+		return;
+	}
+	if (PduRBench_RouteTag((uint8_t)PduRBench_IsrTag++) == E_OK)
+	{
+		PduRBench_IsrRouted++;
+	}
+	else
+	{
+		PduRBench_IsrRefused++;
+	}
+}
+
+static void PduRBench_Preemption(uint32_t pdus)
+{
+	struct sigaction sa;
+	struct itimerval it;
+	uint32_t routed = 0u;
+	uint32_t n;
+
+	PduRBench_Preempt = true;
+	atomic_store(&PduRBench_TxPending, false);
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = PduRBench_RxIsr;
+	sigemptyset(&sa.sa_mask);
+	(void)sigaction(SIGALRM, &sa, NULL);
+	memset(&it, 0, sizeof(it));
+	it.it_interval.tv_usec = PDUR_BENCH_ISR_PERIOD_US;
+	it.it_value.tv_usec = PDUR_BENCH_ISR_PERIOD_US;
+	(void)setitimer(ITIMER_REAL, &it, NULL);
+
+	for (n = 0u; n < pdus; n++)
+	{
+		PduRBench_InRx = 1;
+		atomic_signal_fence(memory_order_seq_cst);
+		routed += (PduRBench_RouteTag((uint8_t)n) == E_OK) ? 1u : 0u;
+		atomic_signal_fence(memory_order_seq_cst);
+		PduRBench_InRx = 0;
+
+		/* TX complete ISR: the RX ISR may preempt it anywhere, also inside the last reference drop */
+		if (atomic_exchange(&PduRBench_TxPending, false))
+		{
+			PduR_TxConfirmation(&PduRBench_PduR, PDUR_MODULE_CANIF, PDUR_BENCH_CANIF_GW, E_OK);
+		}
+	}
+
+	memset(&it, 0, sizeof(it));
+	(void)setitimer(ITIMER_REAL, &it, NULL);
+	if (atomic_exchange(&PduRBench_TxPending, false))
+	{
+		PduR_TxConfirmation(&PduRBench_PduR, PDUR_MODULE_CANIF, PDUR_BENCH_CANIF_GW, E_OK);
+	}
+	if (PduR_IsPathBusy(&PduRBench_PduR, PDUR_BENCH_SRC_CAN, NULL))
+	{
+		PduRBench_Errors++;
+	}
+	PduRBench_Preempt = false;
+
+	printf("preempt 1:1 CanIf      : %u PDUs routed by the main loop, RX ISR every %u us: %u routed, %u refused\n",
+		   routed, PDUR_BENCH_ISR_PERIOD_US, PduRBench_IsrRouted, PduRBench_IsrRefused);
+}
+
+static void PduRBench_Usage(void)
+{
+	fprintf(stderr, "usage: PduRBench [-n pdus] [-r refuse] [-i]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t pdus = 5000000u;
+	uint8_t c;
+	PduIdType src;
+	int o;
+
+	PduRBench_Seed = 1u;
+	PduRBench_Refuse = 0u;
+	PduRBench_Inline = false;
+	while ((o = getopt(argc, argv, "n:r:i")) != -1)
+	{
+		switch (o)
+		{
+			case 'n':
+				pdus = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				PduRBench_Refuse = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'i':
+				PduRBench_Inline = true;
+				break;
+			default:
+				PduRBench_Usage();
+				return 2;
+		}
+	}
+	if ((pdus == 0u) || (PduRBench_Refuse > 100u))
+	{
+		PduRBench_Usage();
+		return 2;
+	}
+
+	PduBuf_Init(&PduRBench_Pool);
+	if (PduR_Init(&PduRBench_PduR, &PduRBench_Config) != E_OK)
+	{
+		fprintf(stderr, "PduR_Init failed\n");
+		return 1;
+	}
+	PduRBench_Answer[PDUR_MODULE_CANIF] = E_OK;
+	PduRBench_Answer[PDUR_MODULE_COM] = E_OK;
+	PduRBench_Errors = 0u;
+
+	printf("%u PDUs of %u bytes per route, %s confirmation, UartIf refuses %u%%\n", pdus, PDUR_BENCH_PDU_LEN,
+		   PduRBench_Inline ? "inline" : "deferred", PduRBench_Refuse);
+	printf("%-22s %12s %14s %14s %14s\n", "route", "M PDUs/s", "RxInd avg ns", "route avg ns", "route max ns");
+	for (src = 0u; src < PDUR_BENCH_SRC_COUNT; src++)
+	{
+		uint64_t worst = 0u;
+		uint64_t rxSum = 0u;
+		uint64_t t0;
+		double sec;
+		uint32_t n;
+
+		/* Throughput: back-to-back routings including alloc and confirmations */
+		t0 = PduRBench_NowNs();
+		for (n = 0u; n < pdus; n++)
+		{
+			PduRBench_RouteOne(src, n, NULL);
+		}
+		sec = (double)(PduRBench_NowNs() - t0) * 1e-9;
+
+		/* Latency: timed routings (a tenth of the PDUs, timer overhead included) */
+		for (n = 0u; n < (pdus / 10u) + 1u; n++)
+		{
+			uint64_t rxNs;
+			uint64_t dt;
+
+			t0 = PduRBench_NowNs();
+			PduRBench_RouteOne(src, n, &rxNs);
+			dt = PduRBench_NowNs() - t0;
+			rxSum += rxNs;
+			worst = (dt > worst) ? dt : worst;
+		}
+
+		printf("%-22s %12.2f %14.1f %14.1f %14llu\n", PduRBench_RouteName[src], ((double)pdus / sec) * 1e-6,
+			   (double)rxSum / (double)((pdus / 10u) + 1u), (sec * 1e9) / (double)pdus, (unsigned long long)worst);
+	}
+
+	PduRBench_Preemption(pdus);
+
+	/* Every buffer went back to the pool */
+	for (c = 0u; c < PDUBUF_CLASS_COUNT; c++)
+	{
+		PduBuf_StatsType st;
+
+		PduBuf_GetStats(&PduRBench_Pool, c, &st);
+		if (st.InUse != 0u)
+		{
+			fprintf(stderr, "class %u: %u blocks still in use\n", c, st.InUse);
+			PduRBench_Errors++;
+		}
+	}
+	printf("routed/dropped  : %u / %u\n", PduRBench_PduR.Routed, PduRBench_PduR.Dropped);
+	printf("errors          : %u\n", PduRBench_Errors);
+	return (PduRBench_Errors == 0u) ? 0 : 1;
+}
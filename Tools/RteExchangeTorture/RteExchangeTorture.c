@@ -0,0 +1,553 @@
+/* =====================================================================================================================
+ *  File        : RteExchangeTorture.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Torn read torture and latency of the lock-free RTE exchange (Rte_Exchange.h)
+ *                 - Torture: one writer thread (the CAN RX ISR) publishes a 63 byte value whose every word is derived
+ *                   from its version, R sequence lock readers and one triple buffer reader (the tasks) read it
+ *                   in a loop. Any value that does not match its version is torn, versions must never go back,
+ *                   the triple buffer fresh flag must be set exactly when the version changed.
+ *                 - Control: the same value copied word by word with no protection, to show the test catches tearing.
+ *                 - Latency: write and read ns of sequence lock, triple buffer and a mutex protected copy (the
+ *                   critical section of today), alone and with writer and reader running concurrently (avg, p99, max).
+ *  Build       : cc -O2 -std=gnu11 -pthread -I../../Inc -o RteExchangeTorture RteExchangeTorture.c
+ *  Usage       : RteExchangeTorture [-r readers] [-n writes] [-l samples]
+ *                  -r  sequence lock reader threads (1..RTE_TORTURE_MAX_READERS, default 3)
+ *                  -n  values written in the torture (default 5000000)
+ *                  -l  latency samples per exchange (default 500000)
+ *  Example     : RteExchangeTorture -r 6 -n 50000000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Rte_Exchange.h"
+
+#define RTE_TORTURE_MAX_READERS		(8u)
+#define RTE_TORTURE_WORDS			(15u)
+
+typedef struct
+{
+	uint32_t	Word[RTE_TORTURE_WORDS];
+	uint8_t		Tail[3];
+}RteTortureValue_t;
+
+typedef enum
+{
+	RTETORTURE_MUTEX = 0,
+	RTETORTURE_SEQLOCK,
+	RTETORTURE_TRIPLEBUF,
+	RTETORTURE_COUNT
+}RteTortureExchange_t;
+
+typedef struct
+{
+	pthread_t	Thread;
+	uint64_t	Reads;
+	uint64_t	Failed;		/* E_NOT_OK: write in progress for every retry.*/
+	uint64_t	Fresh;
+	uint64_t	Torn;
+	uint32_t	Errors;
+}RteTortureReader_t;
+
+/* Critical section reference: what interrupt locking around memcpy becomes on a host */
+typedef struct
+{
+	pthread_mutex_t		Lock;
+	RteTortureValue_t	Value;
+	uint32_t			Version;
+}RteTortureMutex_t;
+
+static const char* const RteTorture_Name[RTETORTURE_COUNT] = { "mutex", "seqlock", "triplebuf" };
+
+static atomic_uint_least32_t RteTorture_SeqBuf[RTE_SEQLOCK_WORDS(RteTortureValue_t)];
+static Rte_SeqLockType RteTorture_Seq;
+static uint8_t RteTorture_TripleBuf[3u * sizeof(RteTortureValue_t)];
+static Rte_TripleBufType RteTorture_Triple;
+static RteTortureMutex_t RteTorture_Mutex = { PTHREAD_MUTEX_INITIALIZER, { { 0u }, { 0u } }, 0u };
+static atomic_uint_least32_t RteTorture_Plain[RTE_SEQLOCK_WORDS(RteTortureValue_t)];
+static RteTortureReader_t RteTorture_Reader[RTE_TORTURE_MAX_READERS + 2u];
+static atomic_uint RteTorture_Running;
+static uint32_t RteTorture_Writes;
+static uint32_t* RteTorture_Sample[2];
+static uint32_t RteTorture_SampleCount[2];
+static uint32_t RteTorture_SampleMax;
+static RteTortureExchange_t RteTorture_Exchange;
+
+static uint64_t RteTorture_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Value of a version: version 0 is all zero, like the buffers after init
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void RteTorture_Fill(RteTortureValue_t* v, uint32_t version)
+{
+	uint32_t k;
+
+	for (k = 0u; k < RTE_TORTURE_WORDS; k++)
+	{
+		v->Word[k] = version * (k + 1u);
+	}
+	v->Tail[0] = (uint8_t)version;
+	v->Tail[1] = (uint8_t)(version >> 8);
+	v->Tail[2] = (uint8_t)(version >> 16);
+}
+
+static bool RteTorture_Match(const RteTortureValue_t* v, uint32_t version)
+{
+	RteTortureValue_t ref;
+
+	RteTorture_Fill(&ref, version);
+	return (memcmp(v, &ref, sizeof(ref)) == 0);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Exchanges
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void RteTorture_Write(RteTortureExchange_t x, const RteTortureValue_t* v)
+{
+	switch (x)
+	{
+		case RTETORTURE_MUTEX:
+			(void)pthread_mutex_lock(&RteTorture_Mutex.Lock);
+			RteTorture_Mutex.Value = *v;
+			RteTorture_Mutex.Version++;
+			(void)pthread_mutex_unlock(&RteTorture_Mutex.Lock);
+			break;
+		case RTETORTURE_SEQLOCK:
+			Rte_SeqLockWrite(&RteTorture_Seq, v);
+			break;
+		default:
+			Rte_TripleBufWrite(&RteTorture_Triple, v);
+			break;
+	}
+}
+
+static Std_ReturnType RteTorture_Read(RteTortureExchange_t x, RteTortureValue_t* v, uint32_t* version)
+{
+	switch (x)
+	{
+		case RTETORTURE_MUTEX:
+			(void)pthread_mutex_lock(&RteTorture_Mutex.Lock);
+			*v = RteTorture_Mutex.Value;
+			*version = RteTorture_Mutex.Version;
+			(void)pthread_mutex_unlock(&RteTorture_Mutex.Lock);
+			return E_OK;
+		case RTETORTURE_SEQLOCK:
+			return Rte_SeqLockRead(&RteTorture_Seq, v, version);
+		default:
+			return Rte_TripleBufRead(&RteTorture_Triple, v, version);
+	}
+}
+
+static void RteTorture_Reset(void)
+{
+	Rte_SeqLockInit(&RteTorture_Seq, RteTorture_SeqBuf, (uint16_t)sizeof(RteTortureValue_t));
+	Rte_TripleBufInit(&RteTorture_Triple, RteTorture_TripleBuf, (uint16_t)sizeof(RteTortureValue_t));
+	(void)memset(&RteTorture_Mutex.Value, 0, sizeof(RteTorture_Mutex.Value));
+	RteTorture_Mutex.Version = 0u;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Torture
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void* RteTorture_Writer(void* arg)
+{
+	RteTortureValue_t v;
+	uint32_t n;
+
+	(void)arg;
+	for (n = 1u; n <= RteTorture_Writes; n++)
+	{
+		uint32_t k;
+
+		RteTorture_Fill(&v, n);
+		Rte_SeqLockWrite(&RteTorture_Seq, &v);
+		(void)memcpy(Rte_TripleBufWriteBegin(&RteTorture_Triple), &v, sizeof(v));
+		Rte_TripleBufWriteCommit(&RteTorture_Triple);
+		for (k = 0u; k < RTE_SEQLOCK_WORDS(RteTortureValue_t); k++)
+		{
+			uint32_t w = 0u;
+
+			(void)memcpy(&w, &((const uint8_t*)&v)[k * 4u], ((sizeof(v) - (k * 4u)) < 4u) ? (sizeof(v) - (k * 4u)) :
+						 4u);
+			atomic_store_explicit(&RteTorture_Plain[k], w, memory_order_relaxed);
+		}
+	}
+	atomic_store(&RteTorture_Running, 0u);
+	return NULL;
+}
+
+static void* RteTorture_SeqReader(void* arg)
+{
+	RteTortureReader_t* r = (RteTortureReader_t*)arg;
+	RteTortureValue_t v;
+	uint32_t last = 0u;
+
+	while (atomic_load_explicit(&RteTorture_Running, memory_order_relaxed) != 0u)
+	{
+		uint32_t version;
+
+		r->Reads++;
+		if (Rte_SeqLockRead(&RteTorture_Seq, &v, &version) != E_OK)
+		{
+			r->Failed++;
+			continue;
+		}
+		if (!RteTorture_Match(&v, version))
+		{
+			r->Torn++;
+		}
+		if (version < last)
+		{
+			r->Errors++;
+		}
+		r->Fresh += (version != last) ? 1u : 0u;
+		last = version;
+	}
+	return NULL;
+}
+
+static void* RteTorture_TripleReader(void* arg)
+{
+	RteTortureReader_t* r = (RteTortureReader_t*)arg;
+	uint32_t last = 0u;
+
+	while (atomic_load_explicit(&RteTorture_Running, memory_order_relaxed) != 0u)
+	{
+		uint32_t version;
+		bool fresh;
+		const RteTortureValue_t* v = (const RteTortureValue_t*)Rte_TripleBufReadLatest(&RteTorture_Triple, &version,
+																						 &fresh);
+
+		r->Reads++;
+		if (!RteTorture_Match(v, version))
+		{
+			r->Torn++;
+		}
+		if ((version < last) || (fresh != (version != last)))
+		{
+			r->Errors++;
+		}
+		r->Fresh += fresh ? 1u : 0u;
+		last = version;
+	}
+	return NULL;
+}
+
+/* Control: no protection at all, version taken from the first word */
+static void* RteTorture_PlainReader(void* arg)
+{
+	RteTortureReader_t* r = (RteTortureReader_t*)arg;
+	RteTortureValue_t v;
+
+	while (atomic_load_explicit(&RteTorture_Running, memory_order_relaxed) != 0u)
+	{
+		uint32_t k;
+
+		for (k = 0u; k < RTE_SEQLOCK_WORDS(RteTortureValue_t); k++)
+		{
+			uint32_t w = atomic_load_explicit(&RteTorture_Plain[k], memory_order_relaxed);
+
+			(void)memcpy(&((uint8_t*)&v)[k * 4u], &w, ((sizeof(v) - (k * 4u)) < 4u) ? (sizeof(v) - (k * 4u)) : 4u);
+		}
+		r->Reads++;
+		if (!RteTorture_Match(&v, v.Word[0]))
+		{
+			r->Torn++;
+		}
+	}
+	return NULL;
+}
+
+static uint32_t RteTorture_Torture(uint32_t readers)
+{
+	RteTortureReader_t* triple = &RteTorture_Reader[readers];
+	RteTortureReader_t* plain = &RteTorture_Reader[readers + 1u];
+	RteTortureValue_t v;
+	pthread_t writer;
+	uint32_t errors = 0u;
+	uint32_t version;
+	uint64_t t0;
+	double sec;
+	uint32_t i;
+
+	RteTorture_Reset();
+	(void)memset(RteTorture_Reader, 0, sizeof(RteTorture_Reader));
+	for (i = 0u; i < RTE_SEQLOCK_WORDS(RteTortureValue_t); i++)
+	{
+		atomic_init(&RteTorture_Plain[i], 0u);
+	}
+	atomic_store(&RteTorture_Running, 1u);
+	t0 = RteTorture_NowNs();
+	for (i = 0u; i < (readers + 2u); i++)
+	{
+		void* (*fn)(void*) = (i < readers) ? RteTorture_SeqReader :
+							 ((i == readers) ? RteTorture_TripleReader : RteTorture_PlainReader);
+
+		if (pthread_create(&RteTorture_Reader[i].Thread, NULL, fn, &RteTorture_Reader[i]) != 0)
+		{
+			fprintf(stderr, "pthread_create failed\n");
+			exit(1);
+		}
+	}
+	if (pthread_create(&writer, NULL, RteTorture_Writer, NULL) != 0)
+	{
+		fprintf(stderr, "pthread_create failed\n");
+		exit(1);
+	}
+	(void)pthread_join(writer, NULL);
+	for (i = 0u; i < (readers + 2u); i++)
+	{
+		(void)pthread_join(RteTorture_Reader[i].Thread, NULL);
+	}
+	sec = (double)(RteTorture_NowNs() - t0) * 1e-9;
+
+	printf("torture         : %u writes in %.2f s, %u seqlock readers, 1 triple buffer reader\n", RteTorture_Writes,
+		   sec, readers);
+	printf("%-16s %12s %12s %12s %8s %8s\n", "reader", "reads", "fresh", "retry fail", "torn", "errors");
+	for (i = 0u; i < (readers + 2u); i++)
+	{
+		const RteTortureReader_t* r = &RteTorture_Reader[i];
+		char name[16];
+
+		(void)snprintf(name, sizeof(name), "%s %u", (i < readers) ? "seqlock" : ((r == triple) ? "triplebuf" :
+					   "unprotected"), (i < readers) ? i : 0u);
+		printf("%-16s %12llu %12llu %12llu %8llu %8u\n", name, (unsigned long long)r->Reads,
+			   (unsigned long long)r->Fresh, (unsigned long long)r->Failed, (unsigned long long)r->Torn, r->Errors);
+		if (r != plain)
+		{
+			errors += r->Errors + (uint32_t)r->Torn;
+		}
+	}
+	printf("control         : %llu torn reads without protection%s\n", (unsigned long long)plain->Torn,
+		   (plain->Torn == 0u) ? " (none caught this run, more writes or readers make them likely)" : "");
+
+	/* Last value visible to both */
+	if ((Rte_SeqLockRead(&RteTorture_Seq, &v, &version) != E_OK) || (version != RteTorture_Writes) ||
+		!RteTorture_Match(&v, version))
+	{
+		fprintf(stderr, "seqlock: last value not visible\n");
+		errors++;
+	}
+	if ((Rte_TripleBufRead(&RteTorture_Triple, &v, &version) != E_OK) || (version != RteTorture_Writes) ||
+		!RteTorture_Match(&v, version))
+	{
+		fprintf(stderr, "triple buffer: last value not visible\n");
+		errors++;
+	}
+	return errors;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Latency
+ *  - Sample 0 writer, sample 1 reader, ns per call including one clock read.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void* RteTorture_LatencyWriter(void* arg)
+{
+	RteTortureValue_t v;
+	uint32_t n = 0u;
+
+	(void)arg;
+	while (atomic_load_explicit(&RteTorture_Running, memory_order_relaxed) != 0u)
+	{
+		uint64_t t0;
+		uint32_t dt;
+
+		n++;
+		RteTorture_Fill(&v, n);
+		t0 = RteTorture_NowNs();
+		RteTorture_Write(RteTorture_Exchange, &v);
+		dt = (uint32_t)(RteTorture_NowNs() - t0);
+		if (RteTorture_SampleCount[0] < RteTorture_SampleMax)
+		{
+			RteTorture_Sample[0][RteTorture_SampleCount[0]++] = dt;
+		}
+	}
+	return NULL;
+}
+
+static int RteTorture_Compare(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+static void RteTorture_PrintSamples(const char* name, const char* side, uint32_t* s, uint32_t n)
+{
+	uint64_t sum = 0u;
+	uint32_t i;
+
+	if (n == 0u)
+	{
+		printf("%-10s %-6s %10s\n", name, side, "no sample");
+		return;
+	}
+	for (i = 0u; i < n; i++)
+	{
+		sum += s[i];
+	}
+	qsort(s, n, sizeof(s[0]), RteTorture_Compare);
+	printf("%-10s %-6s %10.1f %10u %10u %10u\n", name, side, (double)sum / n, s[n / 2u], s[(uint32_t)(n * 0.99)],
+		   s[n - 1u]);
+}
+
+static uint32_t RteTorture_Latency(uint32_t samples)
+{
+	RteTortureValue_t v;
+	uint32_t errors = 0u;
+	uint64_t t0;
+	uint32_t x;
+	uint32_t i;
+
+	RteTorture_SampleMax = samples;
+	RteTorture_Sample[0] = (uint32_t*)malloc((size_t)samples * sizeof(uint32_t));
+	RteTorture_Sample[1] = (uint32_t*)malloc((size_t)samples * sizeof(uint32_t));
+	if ((RteTorture_Sample[0] == NULL) || (RteTorture_Sample[1] == NULL))
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	/* Alone: one thread, no contention */
+	printf("%-10s %10s %10s\n", "alone", "write ns", "read ns");
+	for (x = 0u; x < RTETORTURE_COUNT; x++)
+	{
+		uint64_t tw;
+		uint64_t tr;
+
+		RteTorture_Reset();
+		RteTorture_Fill(&v, 1u);
+		t0 = RteTorture_NowNs();
+		for (i = 0u; i < samples; i++)
+		{
+			v.Word[0] = i;
+			RteTorture_Write((RteTortureExchange_t)x, &v);
+		}
+		tw = RteTorture_NowNs() - t0;
+		t0 = RteTorture_NowNs();
+		for (i = 0u; i < samples; i++)
+		{
+			uint32_t version;
+
+			(void)RteTorture_Read((RteTortureExchange_t)x, &v, &version);
+		}
+		tr = RteTorture_NowNs() - t0;
+		printf("%-10s %10.1f %10.1f\n", RteTorture_Name[x], (double)tw / samples, (double)tr / samples);
+	}
+
+	/* Concurrent: writer thread publishing while the reader samples */
+	printf("%-10s %-6s %10s %10s %10s %10s\n", "concurrent", "side", "avg ns", "p50 ns", "p99 ns", "max ns");
+	for (x = 0u; x < RTETORTURE_COUNT; x++)
+	{
+		pthread_t writer;
+		uint32_t failed = 0u;
+
+		RteTorture_Reset();
+		RteTorture_Exchange = (RteTortureExchange_t)x;
+		RteTorture_SampleCount[0] = 0u;
+		RteTorture_SampleCount[1] = 0u;
+		atomic_store(&RteTorture_Running, 1u);
+		if (pthread_create(&writer, NULL, RteTorture_LatencyWriter, NULL) != 0)
+		{
+			fprintf(stderr, "pthread_create failed\n");
+			exit(1);
+		}
+		for (i = 0u; i < samples; i++)
+		{
+			uint32_t version;
+			Std_ReturnType ret;
+			uint32_t dt;
+
+			t0 = RteTorture_NowNs();
+			ret = RteTorture_Read((RteTortureExchange_t)x, &v, &version);
+			dt = (uint32_t)(RteTorture_NowNs() - t0);
+			RteTorture_Sample[1][i] = dt;
+			if (ret != E_OK)
+			{
+				/* Triple buffer: nothing written yet */
+				failed += (x == RTETORTURE_SEQLOCK) ? 1u : 0u;
+			}
+			else if (!RteTorture_Match(&v, version))
+			{
+				errors++;
+			}
+		}
+		RteTorture_SampleCount[1] = samples;
+		atomic_store(&RteTorture_Running, 0u);
+		(void)pthread_join(writer, NULL);
+		RteTorture_PrintSamples(RteTorture_Name[x], "write", RteTorture_Sample[0], RteTorture_SampleCount[0]);
+		RteTorture_PrintSamples(RteTorture_Name[x], "read", RteTorture_Sample[1], RteTorture_SampleCount[1]);
+		if (failed != 0u)
+		{
+			printf("%-10s %u reads gave up after %u retries\n", RteTorture_Name[x], failed, RTE_SEQLOCK_RETRIES);
+		}
+	}
+	t0 = RteTorture_NowNs();
+	for (i = 0u; i < 1000u; i++)
+	{
+		(void)RteTorture_NowNs();
+	}
+	printf("clock read      : %.1f ns (included in every sample)\n", (double)(RteTorture_NowNs() - t0) / 1000.0);
+
+	free(RteTorture_Sample[0]);
+	free(RteTorture_Sample[1]);
+	return errors;
+}
+
+static void RteTorture_Usage(void)
+{
+	fprintf(stderr, "usage: RteExchangeTorture [-r readers] [-n writes] [-l samples]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t readers = 3u;
+	uint32_t samples = 500000u;
+	uint32_t errors = 0u;
+	int o;
+
+	RteTorture_Writes = 5000000u;
+	while ((o = getopt(argc, argv, "r:n:l:")) != -1)
+	{
+		switch (o)
+		{
+			case 'r':
+				readers = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				RteTorture_Writes = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				samples = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				RteTorture_Usage();
+				return 2;
+		}
+	}
+	if ((readers == 0u) || (readers > RTE_TORTURE_MAX_READERS) || (RteTorture_Writes == 0u) || (samples == 0u))
+	{
+		RteTorture_Usage();
+		return 2;
+	}
+
+	errors += RteTorture_Torture(readers);
+	errors += RteTorture_Latency(samples);
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
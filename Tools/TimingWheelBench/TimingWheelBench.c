@@ -0,0 +1,425 @@
+/* =====================================================================================================================
+ *  File        : TimingWheelBench.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Per-tick cost of the Com timing wheel (ComTimingWheel.h) from 10 to 2000 PDUs, and conformance
+ *                 - Conformance: random PDUs (cyclic, on change with minimum delay, mixed, RX deadline, periods up to
+ *                   65535 ticks, tick counter wrapping) and random Trigger / RxIndication / Stop / Start between ticks;
+ *                   every Transmit / Notify must match a naive per-tick evaluation of each PDU, tick by tick.
+ *                 - Benchmark: gateway load (TX cyclic at 10 / 20 / 100 / 1000 ms, one PDU in eight an RX deadline
+ *                   that keeps expiring) for 10..2000 PDUs, 1 tick = 1 ms, against the countdown scan of every PDU
+ *                   on every tick (the current Com main function).
+ *                 - Report: ns per tick and ns per due PDU of both, due PDUs per tick, RAM of the wheel.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o TimingWheelBench TimingWheelBench.c
+ *  Usage       : TimingWheelBench [-t ticks] [-c check-ticks] [-s seed]
+ *                  -t  ticks per benchmark run (default 1000000)
+ *                  -c  ticks of the conformance run (default 200000)
+ *                  -s  random seed (default 1)
+ *  Example     : TimingWheelBench -t 10000000 -c 2000000 -s 7
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+/* Capacity for the biggest configuration measured */
+#define COM_TW_MAX_PDU				(2000u)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ComTimingWheel.h"
+
+#define TW_BENCH_CHECK_PDU			(600u)
+
+typedef struct
+{
+	uint32_t	Next;			/* Next cyclic transmission.*/
+	uint32_t	Last;			/* Last transmission.*/
+	uint32_t	Deadline;		/* RX deadline.*/
+	bool		Pending;
+	bool		Running;
+	uint32_t	Events;
+}TwBenchRef_t;
+
+static const uint32_t TwBench_Sizes[] = { 10u, 50u, 100u, 250u, 500u, 1000u, 2000u };
+
+static ComTimingWheel_PduConfigType TwBench_Cfg[COM_TW_MAX_PDU];
+static ComTimingWheel_Type TwBench_Wheel;
+static TwBenchRef_t TwBench_Ref[COM_TW_MAX_PDU];
+static uint32_t TwBench_Events[COM_TW_MAX_PDU];
+static uint32_t TwBench_Count[COM_TW_MAX_PDU];
+static uint64_t TwBench_Seed;
+static volatile uint32_t TwBench_Sink;
+
+static uint32_t TwBench_Rand(void)
+{
+	TwBench_Seed ^= TwBench_Seed >> 12;
+	TwBench_Seed ^= TwBench_Seed << 25;
+	TwBench_Seed ^= TwBench_Seed >> 27;
+	return (uint32_t)((TwBench_Seed * 2685821657736338717ull) >> 32);
+}
+
+static uint64_t TwBench_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+static bool TwBench_Reached(uint32_t now, uint32_t t)
+{
+	return ((int32_t)(now - t) >= 0);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Conformance: wheel callbacks count events, Transmit = +1, Notify = +1000
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void TwBench_CheckTransmit(PduIdType pduId)
+{
+	TwBench_Events[pduId] += 1u;
+}
+
+static void TwBench_CheckNotify(PduIdType pduId, NotifResultType result)
+{
+	TwBench_Events[pduId] += (result == COM_TW_RX_TIMEOUT_RESULT) ? 1000u : 1000000u;
+}
+
+static void TwBench_RefStart(uint32_t p, uint32_t now)
+{
+	const ComTimingWheel_PduConfigType* cfg = &TwBench_Cfg[p];
+	TwBenchRef_t* r = &TwBench_Ref[p];
+
+	r->Running = true;
+	r->Pending = false;
+	if (cfg->Direction == COM_TW_TX)
+	{
+		r->Next = now + cfg->OffsetTicks;
+		r->Last = now - cfg->MinDelayTicks;
+	}
+	else
+	{
+		r->Deadline = now + ((cfg->OffsetTicks != 0u) ? cfg->OffsetTicks : cfg->TimeoutTicks);
+	}
+}
+
+/* Naive evaluation of one PDU at tick now */
+static void TwBench_RefTick(uint32_t p, uint32_t now)
+{
+	const ComTimingWheel_PduConfigType* cfg = &TwBench_Cfg[p];
+	TwBenchRef_t* r = &TwBench_Ref[p];
+	bool send = false;
+
+	if (!r->Running)
+	{
+		return;
+	}
+	if (cfg->Direction == COM_TW_RX)
+	{
+		if ((cfg->TimeoutTicks != 0u) && TwBench_Reached(now, r->Deadline))
+		{
+			r->Events += 1000u;
+			r->Deadline = now + cfg->TimeoutTicks;
+		}
+		return;
+	}
+	if ((cfg->PeriodTicks != 0u) && TwBench_Reached(now, r->Next))
+	{
+		r->Next += cfg->PeriodTicks;
+		if (TwBench_Reached(now, r->Next))
+		{
+			r->Next = now + cfg->PeriodTicks;
+		}
+		send = true;
+	}
+	if (r->Pending && TwBench_Reached(now, r->Last + cfg->MinDelayTicks))
+	{
+		send = true;
+	}
+	if (send)
+	{
+		r->Pending = false;
+		r->Last = now;
+		r->Events += 1u;
+	}
+}
+
+static uint32_t TwBench_Check(uint32_t ticks)
+{
+	static const uint16_t periods[] = { 0u, 10u, 20u, 100u, 1000u, 7u, 5000u, 65535u };
+	ComTimingWheel_ConfigType config;
+	uint32_t now = 0xFFFF0000u - (TwBench_Rand() % 100000u);		/* Wraps during the run. */
+	uint32_t errors = 0u;
+	uint64_t events = 0u;
+	uint32_t p;
+	uint32_t t;
+
+	for (p = 0u; p < TW_BENCH_CHECK_PDU; p++)
+	{
+		ComTimingWheel_PduConfigType* c = &TwBench_Cfg[p];
+
+		c->Direction = ((TwBench_Rand() % 3u) == 0u) ? COM_TW_RX : COM_TW_TX;
+		c->PeriodTicks = periods[TwBench_Rand() % 8u];
+		c->MinDelayTicks = ((TwBench_Rand() % 4u) == 0u) ? 0u : (uint16_t)(TwBench_Rand() % 300u);
+		c->OffsetTicks = ((TwBench_Rand() % 2u) == 0u) ? 0u : (uint16_t)(TwBench_Rand() % 5000u);
+		c->TimeoutTicks = ((TwBench_Rand() % 5u) == 0u) ? 0u : (((TwBench_Rand() % 3u) != 0u) ?
+						  (uint16_t)(1u + (TwBench_Rand() % 500u)) : (uint16_t)(TwBench_Rand() % 65536u));
+	}
+	config.Pdu = TwBench_Cfg;
+	config.PduCount = TW_BENCH_CHECK_PDU;
+	config.Transmit = TwBench_CheckTransmit;
+	config.Notify = TwBench_CheckNotify;
+	if (ComTimingWheel_Init(&TwBench_Wheel, &config, now) != E_OK)
+	{
+		return 1u;
+	}
+	memset(TwBench_Ref, 0, sizeof(TwBench_Ref));
+	memset(TwBench_Events, 0, sizeof(TwBench_Events));
+	for (p = 0u; p < TW_BENCH_CHECK_PDU; p++)
+	{
+		errors += (ComTimingWheel_Start(&TwBench_Wheel, (PduIdType)p) != E_OK) ? 1u : 0u;
+		TwBench_RefStart(p, now);
+	}
+
+	for (t = 0u; t < ticks; t++)
+	{
+		uint32_t k;
+
+		/* Random actions between two ticks */
+		for (k = 0u; k < 3u; k++)
+		{
+			uint32_t a = TwBench_Rand() % 100u;
+
+			p = TwBench_Rand() % TW_BENCH_CHECK_PDU;
+			if (a < 50u)
+			{
+				bool ok = (TwBench_Cfg[p].Direction == COM_TW_TX) && TwBench_Ref[p].Running;
+
+				errors += ((ComTimingWheel_Trigger(&TwBench_Wheel, (PduIdType)p) == E_OK) != ok) ? 1u : 0u;
+				TwBench_Ref[p].Pending = TwBench_Ref[p].Pending || ok;
+			}
+			else if (a < 90u)
+			{
+				ComTimingWheel_RxIndication(&TwBench_Wheel, (PduIdType)p);
+				if (TwBench_Ref[p].Running && (TwBench_Cfg[p].Direction == COM_TW_RX) &&
+					(TwBench_Cfg[p].TimeoutTicks != 0u))
+				{
+					TwBench_Ref[p].Deadline = now + TwBench_Cfg[p].TimeoutTicks;
+				}
+			}
+			else if (a < 95u)
+			{
+				ComTimingWheel_Stop(&TwBench_Wheel, (PduIdType)p);
+				TwBench_Ref[p].Running = false;
+				TwBench_Ref[p].Pending = false;
+			}
+			else
+			{
+				(void)ComTimingWheel_Start(&TwBench_Wheel, (PduIdType)p);
+				TwBench_RefStart(p, now);
+			}
+		}
+
+		now++;
+		(void)ComTimingWheel_MainFunction(&TwBench_Wheel);
+		for (p = 0u; p < TW_BENCH_CHECK_PDU; p++)
+		{
+			TwBench_RefTick(p, now);
+			if (TwBench_Ref[p].Events != TwBench_Events[p])
+			{
+				if (errors < 5u)
+				{
+					fprintf(stderr, "tick %u PDU %u: reference %u, wheel %u\n", t, p, TwBench_Ref[p].Events,
+							TwBench_Events[p]);
+				}
+				errors++;
+				TwBench_Events[p] = TwBench_Ref[p].Events;
+			}
+		}
+	}
+	for (p = 0u; p < TW_BENCH_CHECK_PDU; p++)
+	{
+		events += TwBench_Ref[p].Events;
+	}
+	printf("conformance     : %u PDUs, %u ticks, event sum %llu, %u mismatches\n", TW_BENCH_CHECK_PDU, ticks,
+		   (unsigned long long)events, errors);
+	return errors;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Benchmark
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void TwBench_Transmit(PduIdType pduId)
+{
+	TwBench_Sink += pduId;
+}
+
+static void TwBench_Notify(PduIdType pduId, NotifResultType result)
+{
+	TwBench_Sink += pduId + (uint32_t)result;
+}
+
+static void TwBench_MakeLoad(uint32_t n)
+{
+	static const uint16_t periods[] = { 10u, 20u, 100u, 1000u };
+	uint32_t p;
+
+	for (p = 0u; p < n; p++)
+	{
+		ComTimingWheel_PduConfigType* c = &TwBench_Cfg[p];
+
+		memset(c, 0, sizeof(*c));
+		if ((p & 7u) == 7u)
+		{
+			c->Direction = COM_TW_RX;
+			c->TimeoutTicks = (uint16_t)(periods[(p >> 3) & 3u] * 3u);
+		}
+		else
+		{
+			c->Direction = COM_TW_TX;
+			c->PeriodTicks = periods[p & 3u];
+			c->OffsetTicks = (uint16_t)(p % c->PeriodTicks);
+		}
+	}
+}
+
+/* Countdown scan: every PDU decremented on every tick */
+static uint32_t TwBench_Scan(uint32_t n)
+{
+	uint32_t fired = 0u;
+	uint32_t p;
+
+	for (p = 0u; p < n; p++)
+	{
+		const ComTimingWheel_PduConfigType* c = &TwBench_Cfg[p];
+
+		if (--TwBench_Count[p] == 0u)
+		{
+			if (c->Direction == COM_TW_TX)
+			{
+				TwBench_Count[p] = c->PeriodTicks;
+				TwBench_Transmit((PduIdType)p);
+			}
+			else
+			{
+				TwBench_Count[p] = c->TimeoutTicks;
+				TwBench_Notify((PduIdType)p, COM_TW_RX_TIMEOUT_RESULT);
+			}
+			fired++;
+		}
+	}
+	return fired;
+}
+
+static uint32_t TwBench_Bench(uint32_t ticks)
+{
+	ComTimingWheel_ConfigType config;
+	uint32_t errors = 0u;
+	uint32_t s;
+
+	config.Pdu = TwBench_Cfg;
+	config.Transmit = TwBench_Transmit;
+	config.Notify = TwBench_Notify;
+	printf("%6s %10s %12s %12s %12s %12s\n", "PDUs", "due/tick", "wheel ns/t", "scan ns/t", "wheel ns/due",
+		   "scan ns/due");
+	for (s = 0u; s < (sizeof(TwBench_Sizes) / sizeof(TwBench_Sizes[0])); s++)
+	{
+		uint32_t n = TwBench_Sizes[s];
+		uint64_t firedWheel = 0u;
+		uint64_t firedScan = 0u;
+		uint64_t tWheel;
+		uint64_t tScan;
+		uint64_t t0;
+		uint32_t p;
+		uint32_t t;
+
+		TwBench_MakeLoad(n);
+		config.PduCount = (uint16_t)n;
+		if (ComTimingWheel_Init(&TwBench_Wheel, &config, 0u) != E_OK)
+		{
+			errors++;
+			continue;
+		}
+		for (p = 0u; p < n; p++)
+		{
+			(void)ComTimingWheel_Start(&TwBench_Wheel, (PduIdType)p);
+			TwBench_Count[p] = (TwBench_Cfg[p].Direction == COM_TW_TX) ?
+							   ((TwBench_Cfg[p].OffsetTicks != 0u) ? TwBench_Cfg[p].OffsetTicks :
+																	 TwBench_Cfg[p].PeriodTicks) :
+							   TwBench_Cfg[p].TimeoutTicks;
+		}
+
+		t0 = TwBench_NowNs();
+		for (t = 0u; t < ticks; t++)
+		{
+			firedWheel += ComTimingWheel_MainFunction(&TwBench_Wheel);
+		}
+		tWheel = TwBench_NowNs() - t0;
+
+		t0 = TwBench_NowNs();
+		for (t = 0u; t < ticks; t++)
+		{
+			firedScan += TwBench_Scan(n);
+		}
+		tScan = TwBench_NowNs() - t0;
+
+		/* Both fire the same PDUs (up to the phase of offset 0 PDUs in the first period) */
+		if ((firedWheel > (firedScan + n)) || (firedScan > (firedWheel + n)))
+		{
+			fprintf(stderr, "%u PDUs: wheel fired %llu, scan %llu\n", n, (unsigned long long)firedWheel,
+					(unsigned long long)firedScan);
+			errors++;
+		}
+		printf("%6u %10.2f %12.1f %12.1f %12.1f %12.1f\n", n, (double)firedWheel / ticks, (double)tWheel / ticks,
+			   (double)tScan / ticks, (double)tWheel / (double)firedWheel, (double)tScan / (double)firedScan);
+	}
+	printf("RAM             : %zu bytes for %u PDUs (20 x PDUs + 384 on the target)\n", sizeof(ComTimingWheel_Type),
+		   COM_TW_MAX_PDU);
+	return errors;
+}
+
+static void TwBench_Usage(void)
+{
+	fprintf(stderr, "usage: TimingWheelBench [-t ticks] [-c check-ticks] [-s seed]\n");
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t ticks = 1000000u;
+	uint32_t checkTicks = 200000u;
+	uint32_t errors = 0u;
+	int o;
+
+	TwBench_Seed = 1u;
+	while ((o = getopt(argc, argv, "t:c:s:")) != -1)
+	{
+		switch (o)
+		{
+			case 't':
+				ticks = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				checkTicks = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				TwBench_Seed = strtoull(optarg, NULL, 0) | 1u;
+				break;
+			default:
+				TwBench_Usage();
+				return 2;
+		}
+	}
+	if (ticks == 0u)
+	{
+		TwBench_Usage();
+		return 2;
+	}
+
+	errors += TwBench_Check(checkTicks);
+	errors += TwBench_Bench(ticks);
+	printf("errors          : %u\n", errors);
+	return (errors == 0u) ? 0 : 1;
+}
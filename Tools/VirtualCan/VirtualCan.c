@@ -0,0 +1,919 @@
+/* =====================================================================================================================
+ *  File        : VirtualCan.c
+ *  Layer       : Host tool (Linux)
+ *  Purpose     : Deterministic in-process virtual CAN bus and end-to-end PDU path benchmark
+ *                 - Time unit is one bit time. Every frame is laid out bit by bit (SOF..CRC) to get its exact
+ *                   length including stuff bits, so 11-bit and 29-bit frames cost what they cost on the wire.
+ *                 - Each node has 3 TX mailboxes (bxCAN) filled from its CanTxQueue: CanTxQueue_SelectMailbox picks
+ *                   an empty one, or the one to abort when the queue head outranks every pending frame; the aborted
+ *                   frame goes back with CanTxQueue_Requeue. Mailboxes are filled when a frame is released (also
+ *                   during a transmission, the mailbox on the bus cannot be aborted) and on TX complete. A node offers
+ *                   its highest priority mailbox (TXFP = 0), a frame still in a mailbox at its deadline is aborted
+ *                   and dropped.
+ *                 - Arbitration on every idle bus: the lowest CanTxQueue_ArbKey() among the offered mailboxes
+ *                   wins, frames released during a transmission wait for the next idle bus.
+ *                 - Simulated ECUs (ECU_SENSOR, ECU_MOTOR) run the real shared code on their PDU paths:
+ *                     TX: Com_SignalGroupPack -> CanTxQueue (deadline = period)
+ *                     RX: CanFilter_Lookup -> PduR_RxIndication -> Com_SignalGroupUnpack (values checked)
+ *                 - Optional background load of random frames (-u), spread over a background node and the two ECUs
+ *                   (gatewayed traffic), so the application PDUs compete with it for the 3 mailboxes of their node.
+ *                 - Report: frames/s, bus utilisation, per PDU latency percentiles (release -> Com unpack on
+ *                   the receiver), expired frames, per CAN ID queue wait (release -> mailbox granted) with the
+ *                   mailbox aborts, and simulator speed (wall clock) to catch regressions.
+ *                 - Checks: values unpacked as packed, every sent frame received, and no priority inversion: a
+ *                   node never sends while its queue holds a frame that outranks it.
+ *  Build       : cc -O2 -std=gnu11 -I../../Inc -o VirtualCan VirtualCan.c
+ *  Usage       : VirtualCan [-b bitrate] [-d ms] [-u load%] [-s seed] [-x]
+ *                  -b  bit rate in bit/s (default 500000)
+ *                  -d  simulated time in ms (default 10000)
+ *                  -u  background bus load in percent (default 0)
+ *                  -s  seed of the background traffic (default 1)
+ *                  -x  send the application PDUs with 29-bit IDs (same base ID) to compare with 11-bit
+ *  Example     : VirtualCan -b 250000 -u 40 -d 60000
+ * ===================================================================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CanFilter.h"
+#include "CanTxQueue.h"
+#include "Com_Signal.h"
+#include "LogTags.h"
+#include "PduR_Routing.h"
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Frame layout on the wire
+ * -------------------------------------------------------------------------------------------------------------------*/
+#define VCAN_CRC15_POLY			(0x4599u)
+#define VCAN_TAIL_BITS			(1u + 2u + 7u + 3u)		/* CRC delimiter, ACK slot + delimiter, EOF, IFS.*/
+#define VCAN_MAX_STUFFED_BITS	(160u)
+
+#define VCAN_NODE_COUNT			(3u)
+#define VCAN_NODE_LOAD			(2u)
+#define VCAN_LOAD_PDU			((PduIdType)0xFFFFu)
+#define VCAN_ENQ_FIFO			(8u)
+#define VCAN_MAILBOX_COUNT		(3u)					/* bxCAN TX mailboxes.*/
+#define VCAN_MAILBOX_EMPTY		(0xFFFFFFFFu)			/* CanTxQueue_SelectMailbox convention.*/
+#define VCAN_MAILBOX_ON_BUS		(0u)					/* Being sent: never the one to abort (ID 0 unused here).*/
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Application PDUs (PduIdType = index in VirtualCan_Msgs)
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	const char*					Name;
+	uint32_t					RawId;
+	bool						Ext;
+	uint8_t						Dlc;
+	uint16_t					PeriodMs;
+	uint8_t						TxRole;				/* ECU_SENSOR / ECU_MOTOR.*/
+	const Com_SignalConfigType*	Signals;
+	uint8_t						SignalCount;
+}VCanMsgCfg_t;
+
+static const Com_SignalConfigType VirtualCan_SigTorque[] =
+{
+	{ 0u,	16u,	COM_LITTLE_ENDIAN,	true },
+	{ 16u,	16u,	COM_LITTLE_ENDIAN,	false },
+	{ 32u,	12u,	COM_LITTLE_ENDIAN,	false },
+	{ 44u,	4u,		COM_LITTLE_ENDIAN,	false },
+	{ 48u,	16u,	COM_LITTLE_ENDIAN,	false },
+};
+
+static const Com_SignalConfigType VirtualCan_SigWheel[] =
+{
+	{ 7u,	16u,	COM_BIG_ENDIAN,		false },
+	{ 23u,	16u,	COM_BIG_ENDIAN,		false },
+	{ 39u,	16u,	COM_BIG_ENDIAN,		false },
+	{ 55u,	13u,	COM_BIG_ENDIAN,		false },
+	{ 58u,	3u,		COM_BIG_ENDIAN,		false },
+};
+
+static const Com_SignalConfigType VirtualCan_SigStatus[] =
+{
+	{ 0u,	10u,	COM_LITTLE_ENDIAN,	false },
+	{ 10u,	10u,	COM_LITTLE_ENDIAN,	true },
+	{ 20u,	1u,		COM_LITTLE_ENDIAN,	false },
+	{ 21u,	27u,	COM_LITTLE_ENDIAN,	false },
+};
+
+static const Com_SignalConfigType VirtualCan_SigDiag[] =
+{
+	{ 7u,	8u,		COM_BIG_ENDIAN,		false },
+	{ 15u,	24u,	COM_BIG_ENDIAN,		false },
+};
+
+static const Com_SignalConfigType VirtualCan_SigExt[] =
+{
+	{ 0u,	32u,	COM_LITTLE_ENDIAN,	false },
+	{ 32u,	32u,	COM_LITTLE_ENDIAN,	true },
+};
+
+#define VCAN_SIGNALS(_tab_)		(_tab_), (uint8_t)(sizeof(_tab_) / sizeof((_tab_)[0]))
+
+static const VCanMsgCfg_t VirtualCan_Msgs[] =
+{
+	{ "MotorTorque",	0x0C0u,			false,	8u,	5u,		ECU_MOTOR,	VCAN_SIGNALS(VirtualCan_SigTorque) },
+	{ "WheelSpeed",		0x100u,			false,	8u,	10u,	ECU_SENSOR,	VCAN_SIGNALS(VirtualCan_SigWheel) },
+	{ "SensorDiag",		0x180u,			false,	4u,	20u,	ECU_SENSOR,	VCAN_SIGNALS(VirtualCan_SigDiag) },
+	{ "MotorStatus",	0x200u,			false,	6u,	10u,	ECU_MOTOR,	VCAN_SIGNALS(VirtualCan_SigStatus) },
+	{ "MotorExt",		0x18FF2002u,	true,	8u,	50u,	ECU_MOTOR,	VCAN_SIGNALS(VirtualCan_SigExt) },
+	{ "SensorExt",		0x18FF1001u,	true,	8u,	100u,	ECU_SENSOR,	VCAN_SIGNALS(VirtualCan_SigExt) },
+};
+
+#define VCAN_MSG_COUNT			((PduIdType)(sizeof(VirtualCan_Msgs) / sizeof(VirtualCan_Msgs[0])))
+
+typedef char VCanMsgCountCheck_t[(VCAN_MSG_COUNT <= PDUR_MAX_PATHS) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Runtime state
+ * -------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+	uint32_t*				Val;				/* Bit times.*/
+	uint64_t				Count;
+	uint64_t				Cap;
+}VCanSamples_t;
+
+typedef struct
+{
+	CAN_IdType				Id;
+	Com_SignalLayoutType	Layout[8];
+	Com_SignalGroupType		Group;
+	uint32_t				NextRelease;		/* Bit time.*/
+	uint32_t				Counter;
+	uint32_t				EnqTime[VCAN_ENQ_FIFO];	/* Release time of the frames in the queue, FIFO.*/
+	uint32_t				EnqCounter[VCAN_ENQ_FIFO];	/* Counter packed in them.*/
+	uint8_t					EnqHead;
+	uint8_t					EnqCount;
+	uint32_t				Bits;				/* Wire length of the last frame.*/
+	uint64_t				Sent;
+	uint64_t				Expired;
+	uint64_t				Dropped;			/* Queue full.*/
+	uint64_t				Received;
+	uint64_t				Errors;				/* Unpacked values != packed values.*/
+	uint64_t				Aborted;			/* Taken back from a mailbox by a higher priority frame.*/
+	VCanSamples_t			Latency;			/* Release -> Com unpack, one per received frame.*/
+	VCanSamples_t			Wait;				/* Release -> mailbox granted, one per sent frame.*/
+}VCanMsg_t;
+
+typedef struct
+{
+	const char*				Name;
+	uint8_t					Role;
+	CanTxQueue_Type			Queue;
+	CanTxQueue_FrameType	Mb[VCAN_MAILBOX_COUNT];
+	uint32_t				MbKey[VCAN_MAILBOX_COUNT];	/* VCAN_MAILBOX_EMPTY when free.*/
+	uint32_t				MbGrant[VCAN_MAILBOX_COUNT];	/* Time the frame got the mailbox.*/
+	uint64_t				Aborts;
+	CanFilter_Type			Filter;
+	PduR_Type				PduR;
+	PduR_ConfigType			PduRCfg;
+	PduR_RoutingPathType	Paths[PDUR_MAX_PATHS];
+	PduR_DestType			Dest[PDUR_MAX_PATHS];
+	uint64_t				RxFrames;
+}VCanNode_t;
+
+typedef struct
+{
+	uint32_t	Bitrate;
+	uint32_t	DurationMs;
+	uint32_t	LoadPercent;
+	uint32_t	Seed;
+	bool		ExtIds;
+}VCanOptions_t;
+
+static VCanMsg_t VirtualCan_Msg[VCAN_MSG_COUNT];
+static VCanNode_t VirtualCan_Node[VCAN_NODE_COUNT];
+static uint32_t VirtualCan_LoadRng;
+
+/* Delivery context of the Com RX callback (PduR destinations have no user pointer). */
+static VCanNode_t* VirtualCan_RxNode;
+static uint32_t VirtualCan_RxCounter;
+
+static double VirtualCan_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static uint32_t VirtualCan_Rand(void)
+{
+	VirtualCan_LoadRng = (VirtualCan_LoadRng * 1664525u) + 1013904223u;
+	return VirtualCan_LoadRng >> 8;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Exact wire length of a data frame: SOF..CRC stuffed, plus the fixed tail
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t VirtualCan_FrameBits(CAN_IdType id, uint8_t dlc, const uint8_t* data)
+{
+	uint8_t bits[VCAN_MAX_STUFFED_BITS];
+	uint32_t raw = CAN_ID_GET_RAW(id);
+	uint32_t n = 0u;
+	uint32_t stuff = 0u;
+	uint32_t run = 0u;
+	uint16_t crc = 0u;
+	uint8_t last = 2u;
+	uint32_t i;
+	int b;
+
+	bits[n++] = 0u;											/* SOF */
+	if (CAN_ID_IS_EXT(id))
+	{
+		for (b = 28; b >= 18; b--)
+		{
+			bits[n++] = (uint8_t)((raw >> b) & 1u);
+		}
+		bits[n++] = 1u;										/* SRR */
+		bits[n++] = 1u;										/* IDE */
+		for (b = 17; b >= 0; b--)
+		{
+			bits[n++] = (uint8_t)((raw >> b) & 1u);
+		}
+		bits[n++] = 0u;										/* RTR */
+		bits[n++] = 0u;										/* r1 */
+		bits[n++] = 0u;										/* r0 */
+	}
+	else
+	{
+		for (b = 10; b >= 0; b--)
+		{
+			bits[n++] = (uint8_t)((raw >> b) & 1u);
+		}
+		bits[n++] = 0u;										/* RTR */
+		bits[n++] = 0u;										/* IDE */
+		bits[n++] = 0u;										/* r0 */
+	}
+	for (b = 3; b >= 0; b--)
+	{
+		bits[n++] = (uint8_t)((dlc >> b) & 1u);
+	}
+	for (i = 0u; i < dlc; i++)
+	{
+		for (b = 7; b >= 0; b--)
+		{
+			bits[n++] = (uint8_t)((data[i] >> b) & 1u);
+		}
+	}
+
+	for (i = 0u; i < n; i++)
+	{
+		uint16_t nxt = (uint16_t)(bits[i] ^ ((crc >> 14) & 1u));
+		crc = (uint16_t)((crc << 1) & 0x7FFFu);
+		if (nxt != 0u)
+		{
+			crc ^= VCAN_CRC15_POLY;
+		}
+	}
+	for (b = 14; b >= 0; b--)
+	{
+		bits[n++] = (uint8_t)((crc >> b) & 1u);
+	}
+
+	/* A stuff bit follows 5 equal bits and starts the next run itself. */
+	for (i = 0u; i < n; i++)
+	{
+		if (bits[i] == last)
+		{
+			run++;
+		}
+		else
+		{
+			last = bits[i];
+			run = 1u;
+		}
+		if (run == 5u)
+		{
+			stuff++;
+			last = (uint8_t)(last ^ 1u);
+			run = 1u;
+		}
+	}
+
+	return n + stuff + VCAN_TAIL_BITS;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  RX path: Com destination of PduR
+ * -------------------------------------------------------------------------------------------------------------------*/
+static Std_ReturnType VirtualCan_ComRx(PduIdType destPduId, const PduInfoType* info)
+{
+	VCanMsg_t* msg = &VirtualCan_Msg[destPduId];
+	uint32_t values[8];
+	uint8_t i;
+
+	Com_SignalGroupUnpack(&msg->Group, info, values);
+
+	/* The sender packs counter + i in signal i: check it back after truncation to the signal length. */
+	for (i = 0u; i < msg->Group.Count; i++)
+	{
+		const Com_SignalLayoutType* l = &msg->Group.Layout[i];
+		uint32_t expect = (VirtualCan_RxCounter + i) & l->Mask;
+
+		if ((values[i] != ((expect ^ l->SignBit) - l->SignBit)))
+		{
+			msg->Errors++;
+			break;
+		}
+	}
+
+	msg->Received++;
+	VirtualCan_RxNode->RxFrames++;
+	return E_OK;
+}
+
+static Std_ReturnType VirtualCan_NoTx(PduIdType destPduId, const PduInfoType* info)
+{
+	(void)destPduId;
+	(void)info;
+	return E_NOT_OK;
+}
+
+static const PduR_ModuleApiType VirtualCan_Modules[PDUR_MODULE_COUNT] =
+{
+	{ VirtualCan_NoTx,	false,	NULL,	0u },			/* CanIf: no gateway route in this setup.*/
+	{ VirtualCan_NoTx,	false,	NULL,	0u },			/* UartIf */
+	{ VirtualCan_ComRx,	true,	NULL,	0u },			/* Com */
+};
+
+static void VirtualCan_Expired(PduIdType pduId)
+{
+	VCanMsg_t* msg;
+
+	if (pduId == VCAN_LOAD_PDU)
+	{
+		return;
+	}
+	msg = &VirtualCan_Msg[pduId];
+	msg->Expired++;
+	msg->EnqHead = (uint8_t)((msg->EnqHead + 1u) % VCAN_ENQ_FIFO);
+	msg->EnqCount--;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Setup
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int VirtualCan_Setup(const VCanOptions_t* opt)
+{
+	CanFilter_EntryType rx[VCAN_MSG_COUNT];
+	uint32_t bitsPerMs = opt->Bitrate / 1000u;
+	PduIdType m;
+	uint16_t nRx;
+	uint8_t s;
+	uint8_t i;
+
+	memset(VirtualCan_Msg, 0, sizeof(VirtualCan_Msg));
+	memset(VirtualCan_Node, 0, sizeof(VirtualCan_Node));
+
+	for (m = 0u; m < VCAN_MSG_COUNT; m++)
+	{
+		const VCanMsgCfg_t* cfg = &VirtualCan_Msgs[m];
+		VCanMsg_t* msg = &VirtualCan_Msg[m];
+
+		if (cfg->Ext)
+		{
+			msg->Id = CAN_MAKE_EXT_ID(cfg->RawId);
+		}
+		else if (opt->ExtIds)
+		{
+			msg->Id = CAN_MAKE_EXT_ID(cfg->RawId << 18);		/* Same base ID, 18 more ID bits. */
+		}
+		else
+		{
+			msg->Id = CAN_MAKE_STD_ID((uint16_t)cfg->RawId);
+		}
+
+		for (s = 0u; s < cfg->SignalCount; s++)
+		{
+			if (Com_SignalCompile(&cfg->Signals[s], cfg->Dlc, &msg->Layout[s]) != E_OK)
+			{
+				fprintf(stderr, "%s: signal %u does not fit\n", cfg->Name, s);
+				return -1;
+			}
+		}
+		msg->Group.Layout = msg->Layout;
+		msg->Group.Count = cfg->SignalCount;
+		/* Spread the first releases a little so periodic PDUs do not all collide at t = 0. */
+		msg->NextRelease = (uint32_t)m * (bitsPerMs / 4u);
+	}
+
+	for (i = 0u; i < VCAN_NODE_COUNT; i++)
+	{
+		VCanNode_t* node = &VirtualCan_Node[i];
+
+		node->Role = (i == 0u) ? ECU_SENSOR : ((i == 1u) ? ECU_MOTOR : ECU_UNKNOWN);
+		node->Name = (i == VCAN_NODE_LOAD) ? "LOAD" : LOG_EcuRoleIdString(node->Role);
+		CanTxQueue_Init(&node->Queue, VirtualCan_Expired);
+		for (s = 0u; s < VCAN_MAILBOX_COUNT; s++)
+		{
+			node->MbKey[s] = VCAN_MAILBOX_EMPTY;
+		}
+
+		/* Receive every application PDU of the other ECU. */
+		nRx = 0u;
+		for (m = 0u; m < VCAN_MSG_COUNT; m++)
+		{
+			node->Dest[m].Module = PDUR_MODULE_COM;
+			node->Dest[m].DestPduId = m;
+			node->Paths[m].Dest = &node->Dest[m];
+			node->Paths[m].DestCount = 0u;
+			if ((i != VCAN_NODE_LOAD) && (VirtualCan_Msgs[m].TxRole != node->Role))
+			{
+				node->Paths[m].DestCount = 1u;
+				rx[nRx].Id = VirtualCan_Msg[m].Id;
+				rx[nRx].Mask = CAN_FILTER_MASK_EXACT;
+				rx[nRx].Handle = m;
+				nRx++;
+			}
+		}
+		if (CanFilter_Build(&node->Filter, rx, nRx) != E_OK)
+		{
+			fprintf(stderr, "%s: CAN filter does not fit\n", node->Name);
+			return -1;
+		}
+
+		node->PduRCfg.Paths = node->Paths;
+		node->PduRCfg.PathCount = VCAN_MSG_COUNT;
+		node->PduRCfg.Modules = VirtualCan_Modules;
+		node->PduRCfg.Pool = NULL;
+		if (PduR_Init(&node->PduR, &node->PduRCfg) != E_OK)
+		{
+			return -1;
+		}
+	}
+
+	VirtualCan_LoadRng = opt->Seed;
+	return 0;
+}
+
+static VCanNode_t* VirtualCan_TxNode(const VCanMsgCfg_t* cfg)
+{
+	return &VirtualCan_Node[(cfg->TxRole == ECU_SENSOR) ? 0u : 1u];
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  TX path: pack the signals and queue the frame
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void VirtualCan_Release(PduIdType m, uint32_t now, uint32_t bitsPerMs)
+{
+	const VCanMsgCfg_t* cfg = &VirtualCan_Msgs[m];
+	VCanMsg_t* msg = &VirtualCan_Msg[m];
+	CanTxQueue_FrameType f;
+	PduInfoType pdu;
+	uint32_t values[8];
+	uint8_t i;
+
+	memset(&f, 0, sizeof(f));
+	for (i = 0u; i < msg->Group.Count; i++)
+	{
+		values[i] = msg->Counter + i;
+	}
+	pdu.SduDataPtr = f.Data;
+	pdu.SduLength = cfg->Dlc;
+	pdu.MetaDataPtr = NULL;
+	Com_SignalGroupPack(&msg->Group, values, &pdu);
+	msg->Counter++;
+
+	f.Id = msg->Id;
+	f.PduId = m;
+	f.Dlc = cfg->Dlc;
+	f.HasDeadline = true;
+	f.Deadline = now + ((uint32_t)cfg->PeriodMs * bitsPerMs);
+
+	if ((msg->EnqCount < VCAN_ENQ_FIFO) && (CanTxQueue_Push(&VirtualCan_TxNode(cfg)->Queue, &f) == E_OK))
+	{
+		msg->EnqTime[(msg->EnqHead + msg->EnqCount) % VCAN_ENQ_FIFO] = now;
+		msg->EnqCounter[(msg->EnqHead + msg->EnqCount) % VCAN_ENQ_FIFO] = msg->Counter - 1u;
+		msg->EnqCount++;
+	}
+	else
+	{
+		msg->Dropped++;
+	}
+	msg->NextRelease += (uint32_t)cfg->PeriodMs * bitsPerMs;
+}
+
+static VCanNode_t* VirtualCan_ReleaseLoad(void)
+{
+	VCanNode_t* node = &VirtualCan_Node[VirtualCan_Rand() % VCAN_NODE_COUNT];
+	CanTxQueue_FrameType f;
+	uint32_t raw = 0x300u + (VirtualCan_Rand() % 0x400u);
+	uint8_t i;
+
+	memset(&f, 0, sizeof(f));
+	f.Id = ((VirtualCan_Rand() % 4u) == 0u) ? CAN_MAKE_EXT_ID((raw << 18) | (VirtualCan_Rand() & 0x3FFFFu))
+											 : CAN_MAKE_STD_ID((uint16_t)raw);
+	f.PduId = VCAN_LOAD_PDU;
+	f.Dlc = 8u;
+	for (i = 0u; i < 8u; i++)
+	{
+		f.Data[i] = (uint8_t)VirtualCan_Rand();
+	}
+	f.HasDeadline = false;
+	(void)CanTxQueue_Push(&node->Queue, &f);
+	return node;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  CAN driver: mailboxes of one node (TX complete ISR / CanIf transmit path)
+ *  - A frame past its deadline is aborted and dropped, as the queue drops it at its head.
+ *  - Then the queue head takes an empty mailbox, or aborts the lowest priority pending frame it outranks, which is
+ *    requeued with its sequence, until no mailbox is left for the head.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void VirtualCan_FillMailboxes(VCanNode_t* node, uint32_t now)
+{
+	const CanTxQueue_FrameType* head;
+	CanTxQueue_FrameType f;
+	uint8_t mb;
+
+	for (mb = 0u; mb < VCAN_MAILBOX_COUNT; mb++)
+	{
+		if ((node->MbKey[mb] != VCAN_MAILBOX_EMPTY) && (node->MbKey[mb] != VCAN_MAILBOX_ON_BUS) &&
+			node->Mb[mb].HasDeadline && ((int32_t)(now - node->Mb[mb].Deadline) >= 0))
+		{
+			node->MbKey[mb] = VCAN_MAILBOX_EMPTY;
+			VirtualCan_Expired(node->Mb[mb].PduId);
+		}
+	}
+
+	while ((head = CanTxQueue_Peek(&node->Queue, now)) != NULL)
+	{
+		mb = CanTxQueue_SelectMailbox(node->MbKey, VCAN_MAILBOX_COUNT, CanTxQueue_ArbKey(head->Id));
+		if (mb == CAN_TXQ_NO_MAILBOX)
+		{
+			break;
+		}
+		(void)CanTxQueue_Pop(&node->Queue, now, &f);
+		if (node->MbKey[mb] != VCAN_MAILBOX_EMPTY)
+		{
+			/* Abort: the slot just freed by Pop takes the frame back. */
+			(void)CanTxQueue_Requeue(&node->Queue, &node->Mb[mb]);
+			node->Aborts++;
+			if (node->Mb[mb].PduId != VCAN_LOAD_PDU)
+			{
+				VirtualCan_Msg[node->Mb[mb].PduId].Aborted++;
+			}
+		}
+		node->Mb[mb] = f;
+		node->MbKey[mb] = CanTxQueue_ArbKey(f.Id);
+		node->MbGrant[mb] = now;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Releases up to t in time order, each one offered to the mailboxes of its node when released (CanIf_Transmit
+ *  writes a free mailbox at once). Returns the time of the next release.
+ * -------------------------------------------------------------------------------------------------------------------*/
+static uint32_t VirtualCan_ReleaseUntil(uint32_t t, uint32_t* nextLoad, uint32_t loadMean, uint32_t bitsPerMs)
+{
+	for (;;)
+	{
+		uint32_t rel = *nextLoad;
+		PduIdType first = VCAN_MSG_COUNT;
+		PduIdType m;
+
+		for (m = 0u; m < VCAN_MSG_COUNT; m++)
+		{
+			if (VirtualCan_Msg[m].NextRelease < rel)
+			{
+				rel = VirtualCan_Msg[m].NextRelease;
+				first = m;
+			}
+		}
+		if (rel > t)
+		{
+			return rel;
+		}
+
+		if (first == VCAN_MSG_COUNT)
+		{
+			VCanNode_t* node = VirtualCan_ReleaseLoad();
+
+			*nextLoad += 1u + (VirtualCan_Rand() % (2u * loadMean));
+			VirtualCan_FillMailboxes(node, rel);
+		}
+		else
+		{
+			VirtualCan_Release(first, rel, bitsPerMs);
+			VirtualCan_FillMailboxes(VirtualCan_TxNode(&VirtualCan_Msgs[first]), rel);
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  RX path of every other node: filter -> PduR -> Com
+ * -------------------------------------------------------------------------------------------------------------------*/
+static void VirtualCan_Deliver(uint8_t txNode, CanTxQueue_FrameType* f, uint32_t counter)
+{
+	PduInfoType info;
+	PduIdType handle;
+	uint8_t i;
+
+	info.SduDataPtr = f->Data;
+	info.SduLength = f->Dlc;
+	info.MetaDataPtr = NULL;
+	VirtualCan_RxCounter = counter;
+
+	for (i = 0u; i < VCAN_NODE_COUNT; i++)
+	{
+		if (i == txNode)
+		{
+			continue;
+		}
+		handle = CanFilter_Lookup(&VirtualCan_Node[i].Filter, f->Id);
+		if (handle == CAN_FILTER_REJECT)
+		{
+			continue;
+		}
+		VirtualCan_RxNode = &VirtualCan_Node[i];
+		(void)PduR_RxIndication(&VirtualCan_Node[i].PduR, handle, &info, NULL);
+	}
+}
+
+static void VirtualCan_Record(VCanSamples_t* smp, uint32_t bits)
+{
+	if (smp->Count == smp->Cap)
+	{
+		smp->Cap = (smp->Cap == 0u) ? 4096u : (smp->Cap * 2u);
+		smp->Val = realloc(smp->Val, smp->Cap * sizeof(uint32_t));
+		if (smp->Val == NULL)
+		{
+			perror("realloc");
+			exit(1);
+		}
+	}
+	smp->Val[smp->Count++] = bits;
+}
+
+static int VirtualCan_CmpU32(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+/* smp sorted */
+static double VirtualCan_Percentile(const VCanSamples_t* smp, double p, double usPerBit)
+{
+	uint64_t idx;
+
+	if (smp->Count == 0u)
+	{
+		return 0.0;
+	}
+	idx = (uint64_t)(p * (double)(smp->Count - 1u) + 0.5);
+	return (double)smp->Val[idx] * usPerBit;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ *  Simulation
+ * -------------------------------------------------------------------------------------------------------------------*/
+static int VirtualCan_Run(const VCanOptions_t* opt)
+{
+	uint32_t bitsPerMs = opt->Bitrate / 1000u;
+	uint32_t end = opt->DurationMs * bitsPerMs;
+	double usPerBit = 1e6 / (double)opt->Bitrate;
+	uint64_t busyBits = 0u;
+	uint64_t frames = 0u;
+	uint64_t loadFrames = 0u;
+	uint64_t errors = 0u;
+	uint64_t stdBits = 0u;
+	uint64_t stdCount = 0u;
+	uint64_t extBits = 0u;
+	uint64_t extCount = 0u;
+	uint64_t inversions = 0u;
+	uint64_t aborts = 0u;
+	uint32_t loadMean = 0u;
+	uint32_t nextLoad = UINT32_MAX;
+	uint32_t now = 0u;
+	double t0;
+	double wall;
+	PduIdType m;
+	uint8_t i;
+
+	if (opt->LoadPercent > 0u)
+	{
+		/* ~125 bits per 8-byte standard frame, uniform gaps around the mean. */
+		loadMean = (125u * 100u) / opt->LoadPercent;
+		nextLoad = 0u;
+	}
+
+	t0 = VirtualCan_Now();
+	while (now < end)
+	{
+		const CanTxQueue_FrameType* head;
+		CanTxQueue_FrameType f;
+		uint32_t bestKey = UINT32_MAX;
+		uint32_t next = end;
+		uint32_t grant;
+		uint32_t rel;
+		uint32_t bits;
+		uint8_t winner = VCAN_NODE_COUNT;
+		uint8_t winMb = 0u;
+		uint8_t k;
+
+		/* Releases due now */
+		rel = VirtualCan_ReleaseUntil(now, &nextLoad, loadMean, bitsPerMs);
+		if (rel < next)
+		{
+			next = rel;
+		}
+
+		/* TX complete: mailboxes refilled, then arbitration between the highest priority mailbox of every node */
+		for (i = 0u; i < VCAN_NODE_COUNT; i++)
+		{
+			VirtualCan_FillMailboxes(&VirtualCan_Node[i], now);
+			for (k = 0u; k < VCAN_MAILBOX_COUNT; k++)
+			{
+				if (VirtualCan_Node[i].MbKey[k] < bestKey)
+				{
+					bestKey = VirtualCan_Node[i].MbKey[k];
+					winner = i;
+					winMb = k;
+				}
+			}
+		}
+		if (winner == VCAN_NODE_COUNT)
+		{
+			now = next;			/* Bus idle until the next release. */
+			continue;
+		}
+
+		/* The winner must not leave a higher priority frame of its own in the queue */
+		head = CanTxQueue_Peek(&VirtualCan_Node[winner].Queue, now);
+		if ((head != NULL) && (CanTxQueue_ArbKey(head->Id) < bestKey))
+		{
+			inversions++;
+		}
+
+		f = VirtualCan_Node[winner].Mb[winMb];
+		grant = VirtualCan_Node[winner].MbGrant[winMb];
+		VirtualCan_Node[winner].MbKey[winMb] = VCAN_MAILBOX_ON_BUS;
+		bits = VirtualCan_FrameBits(f.Id, f.Dlc, f.Data);
+		(void)VirtualCan_ReleaseUntil(now + bits - 1u, &nextLoad, loadMean, bitsPerMs);
+		now += bits;
+		VirtualCan_Node[winner].MbKey[winMb] = VCAN_MAILBOX_EMPTY;
+		busyBits += bits;
+		frames++;
+		if (f.Dlc == 8u)
+		{
+			if (CAN_ID_IS_EXT(f.Id))
+			{
+				extBits += bits;
+				extCount++;
+			}
+			else
+			{
+				stdBits += bits;
+				stdCount++;
+			}
+		}
+
+		if (f.PduId == VCAN_LOAD_PDU)
+		{
+			loadFrames++;
+			continue;
+		}
+
+		{
+			VCanMsg_t* msg = &VirtualCan_Msg[f.PduId];
+			uint32_t released = msg->EnqTime[msg->EnqHead];
+			uint32_t counter = msg->EnqCounter[msg->EnqHead];
+
+			msg->EnqHead = (uint8_t)((msg->EnqHead + 1u) % VCAN_ENQ_FIFO);
+			msg->EnqCount--;
+			msg->Sent++;
+			msg->Bits = bits;
+			VirtualCan_Deliver(winner, &f, counter);
+			VirtualCan_Record(&msg->Latency, now - released);
+			VirtualCan_Record(&msg->Wait, grant - released);
+		}
+	}
+	wall = VirtualCan_Now() - t0;
+
+	printf("VirtualCan: %u bit/s, %u ms simulated, %s application IDs, background load %u %%\n", opt->Bitrate,
+		   opt->DurationMs, opt->ExtIds ? "29-bit" : "11-bit", opt->LoadPercent);
+	printf("frames %llu (%.1f frames/s, %llu background), bus utilisation %.1f %%\n", (unsigned long long)frames,
+		   (double)frames * 1000.0 / (double)opt->DurationMs, (unsigned long long)loadFrames,
+		   100.0 * (double)busyBits / (double)end);
+	printf("8-byte frame length: 11-bit %.1f bits, 29-bit %.1f bits (stuffing included)\n\n",
+		   (stdCount != 0u) ? ((double)stdBits / (double)stdCount) : 0.0,
+		   (extCount != 0u) ? ((double)extBits / (double)extCount) : 0.0);
+
+	printf("%-7s %-12s %-10s %3s %4s %6s %8s %7s %7s %8s %8s %8s %8s\n", "ECU", "PDU", "ID", "DLC", "bits", "period",
+		   "sent", "expired", "dropped", "rx", "p50 us", "p99 us", "max us");
+	for (m = 0u; m < VCAN_MSG_COUNT; m++)
+	{
+		VCanMsg_t* msg = &VirtualCan_Msg[m];
+		const VCanMsgCfg_t* cfg = &VirtualCan_Msgs[m];
+
+		qsort(msg->Latency.Val, msg->Latency.Count, sizeof(uint32_t), VirtualCan_CmpU32);
+		printf("%-7s %-12s 0x%08X %3u %4u %4u ms %8llu %7llu %7llu %8llu %8.1f %8.1f %8.1f\n",
+			   LOG_EcuRoleIdString(cfg->TxRole), cfg->Name, (unsigned)CAN_ID_GET_RAW(msg->Id), cfg->Dlc, msg->Bits,
+			   cfg->PeriodMs, (unsigned long long)msg->Sent, (unsigned long long)msg->Expired,
+			   (unsigned long long)msg->Dropped, (unsigned long long)msg->Received,
+			   VirtualCan_Percentile(&msg->Latency, 0.50, usPerBit),
+			   VirtualCan_Percentile(&msg->Latency, 0.99, usPerBit), VirtualCan_Percentile(&msg->Latency, 1.0, usPerBit));
+		errors += msg->Errors;
+		if (msg->Received != msg->Sent)
+		{
+			errors++;
+		}
+		free(msg->Latency.Val);
+		msg->Latency.Val = NULL;
+	}
+
+	for (i = 0u; i < VCAN_NODE_COUNT; i++)
+	{
+		aborts += VirtualCan_Node[i].Aborts;
+	}
+	printf("\nqueue wait, release -> mailbox granted (%u TX mailboxes per node, %llu aborted and requeued)\n",
+		   VCAN_MAILBOX_COUNT, (unsigned long long)aborts);
+	printf("%-7s %-12s %-10s %8s %8s %8s %8s\n", "ECU", "PDU", "ID", "aborted", "p50 us", "p99 us", "max us");
+	for (m = 0u; m < VCAN_MSG_COUNT; m++)
+	{
+		VCanMsg_t* msg = &VirtualCan_Msg[m];
+		const VCanMsgCfg_t* cfg = &VirtualCan_Msgs[m];
+
+		qsort(msg->Wait.Val, msg->Wait.Count, sizeof(uint32_t), VirtualCan_CmpU32);
+		printf("%-7s %-12s 0x%08X %8llu %8.1f %8.1f %8.1f\n", LOG_EcuRoleIdString(cfg->TxRole), cfg->Name,
+			   (unsigned)CAN_ID_GET_RAW(msg->Id), (unsigned long long)msg->Aborted,
+			   VirtualCan_Percentile(&msg->Wait, 0.50, usPerBit), VirtualCan_Percentile(&msg->Wait, 0.99, usPerBit),
+			   VirtualCan_Percentile(&msg->Wait, 1.0, usPerBit));
+		free(msg->Wait.Val);
+		msg->Wait.Val = NULL;
+	}
+	if (inversions != 0u)
+	{
+		printf("priority inversions: %llu\n", (unsigned long long)inversions);
+		errors += inversions;
+	}
+
+	printf("\nsimulator: %.3f s wall clock, %.2f Mframes/s, %llu RX errors\n", wall,
+		   ((double)frames / 1e6) / ((wall > 0.0) ? wall : 1e-9), (unsigned long long)errors);
+	return (errors == 0u) ? 0 : 1;
+}
+
+static void VirtualCan_Usage(void)
+{
+	fprintf(stderr, "usage: VirtualCan [-b bitrate] [-d ms] [-u load%%] [-s seed] [-x]\n");
+}
+
+int main(int argc, char** argv)
+{
+	VCanOptions_t opt;
+	int o;
+
+	opt.Bitrate = 500000u;
+	opt.DurationMs = 10000u;
+	opt.LoadPercent = 0u;
+	opt.Seed = 1u;
+	opt.ExtIds = false;
+
+	while ((o = getopt(argc, argv, "b:d:u:s:x")) != -1)
+	{
+		switch (o)
+		{
+			case 'b':
+				opt.Bitrate = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				opt.DurationMs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'u':
+				opt.LoadPercent = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				opt.Seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'x':
+				opt.ExtIds = true;
+				break;
+			default:
+				VirtualCan_Usage();
+				return 2;
+		}
+	}
+
+	if ((opt.Bitrate < 10000u) || ((opt.Bitrate % 1000u) != 0u) || (opt.LoadPercent > 100u) ||
+		(((uint64_t)opt.DurationMs * (opt.Bitrate / 1000u)) >= (UINT32_MAX / 2u)))
+	{
+		fprintf(stderr, "bit rate must be a multiple of 1000 >= 10000, load <= 100 %%, duration within 2^31 bits\n");
+		return 2;
+	}
+
+	if (VirtualCan_Setup(&opt) != 0)
+	{
+		return 2;
+	}
+	return VirtualCan_Run(&opt);
+}